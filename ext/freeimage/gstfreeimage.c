@@ -49,6 +49,6 @@ plugin_init (GstPlugin * plugin)
 
 GST_PLUGIN_DEFINE (GST_VERSION_MAJOR,
     GST_VERSION_MINOR,
-    "freeimage",
-    "FreeImage plugin library", plugin_init, VERSION, "LGPL", PACKAGE_NAME,
-    GST_PACKAGE_ORIGIN)
+    freeimage,
+    "FreeImage plugin library", plugin_init, GST_PACKAGE_VERSION,
+    GST_PACKAGE_LICENSE, GST_PACKAGE_NAME, GST_PACKAGE_ORIGIN)
@@ -15,12 +15,14 @@
 /**
  * SECTION:element-freeimagedec
  *
- * Decodes image types supported by FreeImage. If there is no framerate set on sink caps, it sends EOS
- * after the first picture.
+ * Decodes image types supported by FreeImage. Each input buffer holding a
+ * whole image, as from multifilesrc, is decoded straight from its mapped
+ * memory. Otherwise, as from filesrc, input is gathered until EOS and
+ * decoded as a single picture.
  *
- * Due to the nature of FreeImage, these decoders can only be used with
- * filesrc (for a single image) or multifilesrc (for multiple images). This
- * of course means it cannot be used with streaming sources such as HTTP.
+ * Decoded images are copied, flipped to top-down, into buffers from the
+ * negotiated pool. Images FreeImage can't describe as raw video are
+ * converted to RGB, RGBA or 8-bit gray first.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -45,29 +47,23 @@ static void gst_freeimagedec_class_init (GstFreeImageDecClass * klass,
     GstFreeImageDecClassData * class_data);
 static void gst_freeimagedec_init (GstFreeImageDec * freeimagedec);
 
-static GstStateChangeReturn gst_freeimagedec_change_state (GstElement * element,
-    GstStateChange transition);
+static gboolean gst_freeimagedec_start (GstVideoDecoder * decoder);
+static gboolean gst_freeimagedec_stop (GstVideoDecoder * decoder);
+static gboolean gst_freeimagedec_set_format (GstVideoDecoder * decoder,
+    GstVideoCodecState * state);
+static GstFlowReturn gst_freeimagedec_parse (GstVideoDecoder * decoder,
+    GstVideoCodecFrame * frame, GstAdapter * adapter, gboolean at_eos);
+static GstFlowReturn gst_freeimagedec_handle_frame (GstVideoDecoder *
+    decoder, GstVideoCodecFrame * frame);
+static gboolean gst_freeimagedec_decide_allocation (GstVideoDecoder *
+    decoder, GstQuery * query);
 
-static gboolean gst_freeimagedec_sink_activate_push (GstPad * sinkpad,
-    gboolean active);
-static gboolean gst_freeimagedec_sink_activate_pull (GstPad * sinkpad,
-    gboolean active);
-static gboolean gst_freeimagedec_sink_activate (GstPad * sinkpad);
-static GstFlowReturn gst_freeimagedec_chain (GstPad * pad, GstBuffer * buffer);
-static gboolean gst_freeimagedec_sink_event (GstPad * pad, GstEvent * event);
-static gboolean gst_freeimagedec_sink_setcaps (GstPad * pad, GstCaps * caps);
+static FIBITMAP *gst_freeimagedec_convert_dib (GstFreeImageDec *
+    freeimagedec, FIBITMAP * dib, GstVideoFormat * format);
+static GstFlowReturn gst_freeimagedec_push_dib (GstFreeImageDec *
+    freeimagedec, GstVideoCodecFrame * frame, FIBITMAP * dib);
 
-static void gst_freeimagedec_task (GstPad * pad);
-
-static gboolean gst_freeimagedec_freeimage_init (GstFreeImageDec *
-    freeimagedec);
-static gboolean gst_freeimagedec_freeimage_clear (GstFreeImageDec *
-    freeimagedec);
-static GstFlowReturn gst_freeimagedec_caps_create_and_set (GstFreeImageDec *
-    freeimagedec);
-static GstFlowReturn gst_freeimagedec_push_dib (GstFreeImageDec * freeimagedec);
-
-static GstElementClass *parent_class = NULL;
+static GstVideoDecoderClass *parent_class = NULL;
 
 void DLL_CALLCONV
 gst_freeimagedec_user_error (FREE_IMAGE_FORMAT fif, const char *message)
@@ -75,97 +71,12 @@ gst_freeimagedec_user_error (FREE_IMAGE_FORMAT fif, const char *message)
   GST_ERROR ("%s", message);
 }
 
-static int DLL_CALLCONV
-gst_freeimagedec_user_seek (fi_handle handle, long offset, int origin)
-{
-  GstFreeImageDec *freeimagedec = GST_FREEIMAGEDEC (handle);
-
-  switch (origin) {
-    case SEEK_SET:
-      freeimagedec->offset = offset;
-      break;
-    case SEEK_CUR:
-      freeimagedec->offset += offset;
-      break;
-    case SEEK_END:
-      freeimagedec->offset = freeimagedec->length + offset;
-      break;
-  }
-  return 0;
-}
-
-static long DLL_CALLCONV
-gst_freeimagedec_user_tell (fi_handle handle)
-{
-  GstFreeImageDec *freeimagedec = GST_FREEIMAGEDEC (handle);
-
-  return freeimagedec->offset;
-}
-
-unsigned DLL_CALLCONV
-gst_freeimagedec_user_read (void *data, unsigned elsize, unsigned elcount,
-    fi_handle handle)
-{
-  GstFreeImageDec *freeimagedec;
-  GstBuffer *buffer;
-  GstFlowReturn ret = GST_FLOW_OK;
-  guint size;
-  guint length = elsize * elcount;
-
-  freeimagedec = GST_FREEIMAGEDEC (handle);
-
-  GST_LOG ("reading %" G_GSIZE_FORMAT " bytes of data at offset %d", length,
-      freeimagedec->offset);
-
-  ret =
-      gst_pad_pull_range (freeimagedec->sinkpad, freeimagedec->offset, length,
-      &buffer);
-  if (ret != GST_FLOW_OK)
-    goto pause;
-
-  size = GST_BUFFER_SIZE (buffer);
-
-  if (size != length)
-    goto short_buffer;
-
-  memcpy (data, GST_BUFFER_DATA (buffer), size);
-
-  gst_buffer_unref (buffer);
-
-  freeimagedec->offset += length;
-
-  return size;
-
-  /* ERRORS */
-pause:
-  {
-    GST_INFO_OBJECT (freeimagedec, "pausing task, reason %s",
-        gst_flow_get_name (ret));
-    gst_pad_pause_task (freeimagedec->sinkpad);
-    if (GST_FLOW_IS_FATAL (ret) || ret == GST_FLOW_NOT_LINKED) {
-      GST_ELEMENT_ERROR (freeimagedec, STREAM, FAILED,
-          (("Internal data stream error.")),
-          ("stream stopped, reason %s", gst_flow_get_name (ret)));
-      gst_pad_push_event (freeimagedec->srcpad, gst_event_new_eos ());
-    }
-    return 0;
-  }
-short_buffer:
-  {
-    gst_buffer_unref (buffer);
-    GST_ELEMENT_ERROR (freeimagedec, STREAM, FAILED,
-        (("Internal data stream error.")),
-        ("Read %u, needed %" G_GSIZE_FORMAT "bytes", size, length));
-    ret = GST_FLOW_ERROR;
-    goto pause;
-  }
-}
-
 static void
 gst_freeimagedec_class_init (GstFreeImageDecClass * klass,
     GstFreeImageDecClassData * class_data)
 {
   GstElementClass *gstelement_class;
+  GstVideoDecoderClass *vdec_class;
   GstCaps *caps;
   GstPadTemplate *templ;
   const gchar *mimetype;
@@ -178,6 +89,7 @@ gst_freeimagedec_class_init (GstFreeImageDecClass * klass,
   klass->fif = class_data->fif;
 
   gstelement_class = (GstElementClass *) klass;
+  vdec_class = (GstVideoDecoderClass *) klass;
 
   parent_class = g_type_class_peek_parent (klass);
 
@@ -188,522 +100,320 @@ gst_freeimagedec_class_init (GstFreeImageDecClass * klass,
 
   /* add sink pad template from FIF mimetype */
   if (mimetype)
-    caps = gst_caps_new_simple (mimetype, NULL);
+    caps = gst_caps_new_empty_simple (mimetype);
   else
-    caps = gst_caps_new_simple ("image/freeimage-unknown", NULL);
+    caps = gst_caps_new_empty_simple ("image/freeimage-unknown");
   templ = gst_pad_template_new ("sink", GST_PAD_SINK, GST_PAD_ALWAYS, caps);
   gst_element_class_add_pad_template (gstelement_class, templ);
+  gst_caps_unref (caps);
 
   /* add src pad template */
-  caps = gst_freeimageutils_caps_from_freeimage_format (klass->fif);
+  caps = gst_freeimageutils_caps_for_decoder ();
   templ = gst_pad_template_new ("src", GST_PAD_SRC, GST_PAD_ALWAYS, caps);
   gst_element_class_add_pad_template (gstelement_class, templ);
+  gst_caps_unref (caps);
 
   /* set details */
   longname = g_strdup_printf ("FreeImage %s image decoder", format);
   description = g_strdup_printf ("Decode %s (%s) images",
       format_description, extensions);
-  gst_element_class_set_details_simple (gstelement_class, longname,
+  gst_element_class_set_metadata (gstelement_class, longname,
       "Codec/Decoder/Image", description, "Joshua M. Doe <oss@nvl.army.mil>");
   g_free (longname);
   g_free (description);
 
-  gstelement_class->change_state = gst_freeimagedec_change_state;
+  vdec_class->start = GST_DEBUG_FUNCPTR (gst_freeimagedec_start);
+  vdec_class->stop = GST_DEBUG_FUNCPTR (gst_freeimagedec_stop);
+  vdec_class->set_format = GST_DEBUG_FUNCPTR (gst_freeimagedec_set_format);
+  vdec_class->parse = GST_DEBUG_FUNCPTR (gst_freeimagedec_parse);
+  vdec_class->handle_frame = GST_DEBUG_FUNCPTR (gst_freeimagedec_handle_frame);
+  vdec_class->decide_allocation =
+      GST_DEBUG_FUNCPTR (gst_freeimagedec_decide_allocation);
 }
 
 static void
 gst_freeimagedec_init (GstFreeImageDec * freeimagedec)
 {
-  GstElementClass *klass = GST_ELEMENT_GET_CLASS (freeimagedec);
-
-  freeimagedec->sinkpad =
-      gst_pad_new_from_template (gst_element_class_get_pad_template (klass,
-          "sink"), "sink");
-
-  gst_pad_set_activate_function (freeimagedec->sinkpad,
-      gst_freeimagedec_sink_activate);
-  gst_pad_set_activatepull_function (freeimagedec->sinkpad,
-      gst_freeimagedec_sink_activate_pull);
-  gst_pad_set_activatepush_function (freeimagedec->sinkpad,
-      gst_freeimagedec_sink_activate_push);
-  gst_pad_set_chain_function (freeimagedec->sinkpad, gst_freeimagedec_chain);
-  gst_pad_set_event_function (freeimagedec->sinkpad,
-      gst_freeimagedec_sink_event);
-  gst_pad_set_setcaps_function (freeimagedec->sinkpad,
-      gst_freeimagedec_sink_setcaps);
-  gst_element_add_pad (GST_ELEMENT (freeimagedec), freeimagedec->sinkpad);
-
-  freeimagedec->srcpad =
-      gst_pad_new_from_template (gst_element_class_get_pad_template (klass,
-          "src"), "src");
-  gst_pad_use_fixed_caps (freeimagedec->srcpad);
-  gst_element_add_pad (GST_ELEMENT (freeimagedec), freeimagedec->srcpad);
-
-
-  freeimagedec->setup = FALSE;
-
-  freeimagedec->in_timestamp = GST_CLOCK_TIME_NONE;
-  freeimagedec->in_duration = GST_CLOCK_TIME_NONE;
-  freeimagedec->in_offset = GST_BUFFER_OFFSET_NONE;
-
-  freeimagedec->fps_n = 0;
-  freeimagedec->fps_d = 1;
-
-  gst_segment_init (&freeimagedec->segment, GST_FORMAT_UNDEFINED);
-
-  /* Set user IO functions to FreeImageIO struct */
-  freeimagedec->fiio.read_proc = gst_freeimagedec_user_read;
-  freeimagedec->fiio.write_proc = NULL;
-  freeimagedec->fiio.seek_proc = gst_freeimagedec_user_seek;
-  freeimagedec->fiio.tell_proc = gst_freeimagedec_user_tell;
+  freeimagedec->input_state = NULL;
 }
 
-static GstFlowReturn
-gst_freeimagedec_caps_create_and_set (GstFreeImageDec * freeimagedec)
+static gboolean
+gst_freeimagedec_start (GstVideoDecoder * decoder)
 {
-  GstFlowReturn ret = GST_FLOW_OK;
-  GstCaps *caps = NULL, *res = NULL;
-  GstPadTemplate *templ = NULL;
-
-  caps = gst_freeimageutils_caps_from_dib (freeimagedec->dib,
-      freeimagedec->fps_n, freeimagedec->fps_d);
-
-  if (caps == NULL) {
-    /* we have an unsupported type, we'll try converting to RGB/RGBA */
-    FIBITMAP *dib;
-    if (FreeImage_IsTransparent (freeimagedec->dib)) {
-      GST_DEBUG_OBJECT (freeimagedec,
-          "Image is non-standard format with transparency, convert to 32-bit RGB");
-      dib = FreeImage_ConvertTo32Bits (freeimagedec->dib);
-    } else {
-      GST_DEBUG_OBJECT (freeimagedec,
-          "Image is non-standard format, convert to 24-bit RGB");
-      dib = FreeImage_ConvertTo24Bits (freeimagedec->dib);
-    }
-
-    caps = gst_freeimageutils_caps_from_dib (freeimagedec->dib,
-        freeimagedec->fps_n, freeimagedec->fps_d);
-    if (caps == NULL) {
-      GST_DEBUG_OBJECT (freeimagedec,
-          "Image could not be converted to RGB/RGBA, try grayscale");
-      if (dib)
-        FreeImage_Unload (dib);
-      dib = FreeImage_ConvertToStandardType (freeimagedec->dib, TRUE);
-
-      caps = gst_freeimageutils_caps_from_dib (freeimagedec->dib,
-          freeimagedec->fps_n, freeimagedec->fps_d);
-
-      if (caps == NULL) {
-        GST_WARNING_OBJECT (freeimagedec, "Failed to convert image");
-        if (dib)
-          FreeImage_Unload (dib);
-        ret = GST_FLOW_NOT_SUPPORTED;
-        goto beach;
-      }
-    }
+  GST_LOG_OBJECT (decoder, "init freeimage");
 
-    /* set the converted dib as our new dib */
-    FreeImage_Unload (freeimagedec->dib);
-    freeimagedec->dib = dib;
-  }
+  gst_video_decoder_set_packetized (decoder, TRUE);
 
-  GST_DEBUG_OBJECT (caps, "are the caps");
+  return TRUE;
+}
 
-  if (!gst_pad_set_caps (freeimagedec->srcpad, caps))
-    ret = GST_FLOW_NOT_NEGOTIATED;
+static gboolean
+gst_freeimagedec_stop (GstVideoDecoder * decoder)
+{
+  GstFreeImageDec *freeimagedec = GST_FREEIMAGEDEC (decoder);
 
-  gst_caps_unref (caps);
+  GST_LOG_OBJECT (freeimagedec, "cleaning up freeimage structures");
 
-  /* Push a newsegment event */
-  if (freeimagedec->need_newsegment) {
-    gst_pad_push_event (freeimagedec->srcpad,
-        gst_event_new_new_segment (FALSE, 1.0, GST_FORMAT_TIME, 0, -1, 0));
-    freeimagedec->need_newsegment = FALSE;
+  if (freeimagedec->input_state) {
+    gst_video_codec_state_unref (freeimagedec->input_state);
+    freeimagedec->input_state = NULL;
   }
 
-beach:
-  return ret;
+  return TRUE;
 }
 
-static void
-gst_freeimagedec_task (GstPad * pad)
+/* With a framerate every buffer is an image, otherwise the input is a single
+ * picture of unknown size split across buffers. */
+static gboolean
+gst_freeimagedec_set_format (GstVideoDecoder * decoder,
+    GstVideoCodecState * state)
 {
-  GstFreeImageDec *freeimagedec;
-  GstFlowReturn ret = GST_FLOW_OK;
-  FREE_IMAGE_FORMAT imagetype;
-  GstFormat format;
-
-  freeimagedec = GST_FREEIMAGEDEC (GST_OBJECT_PARENT (pad));
+  GstFreeImageDec *freeimagedec = GST_FREEIMAGEDEC (decoder);
+  GstStructure *s;
+  gint num, denom;
 
-  GST_LOG_OBJECT (freeimagedec, "read frame");
+  if (freeimagedec->input_state)
+    gst_video_codec_state_unref (freeimagedec->input_state);
+  freeimagedec->input_state = gst_video_codec_state_ref (state);
 
-  /* Query length of file for use by gst_freeimagedec_user_seek (SEEK_END) */
-  format = GST_FORMAT_BYTES;
-  gst_pad_query_peer_duration (pad, &format, &freeimagedec->length);
+  s = gst_caps_get_structure (state->caps, 0);
+  if (gst_structure_get_fraction (s, "framerate", &num, &denom)) {
+    GST_DEBUG_OBJECT (freeimagedec, "framed input");
+    gst_video_decoder_set_packetized (decoder, TRUE);
+  } else {
+    GST_DEBUG_OBJECT (freeimagedec, "single picture input");
+    gst_video_decoder_set_packetized (decoder, FALSE);
+  }
 
-  imagetype =
-      FreeImage_GetFileTypeFromHandle (&freeimagedec->fiio, freeimagedec, 0);
-  freeimagedec->dib =
-      FreeImage_LoadFromHandle (imagetype, &freeimagedec->fiio, freeimagedec,
-      0);
+  return TRUE;
+}
 
-  ret = gst_freeimagedec_push_dib (freeimagedec);
-  if (ret != GST_FLOW_OK)
-    goto pause;
+/* Only used for single picture input: the whole stream is the picture. */
+static GstFlowReturn
+gst_freeimagedec_parse (GstVideoDecoder * decoder, GstVideoCodecFrame * frame,
+    GstAdapter * adapter, gboolean at_eos)
+{
+  if (!at_eos)
+    return GST_VIDEO_DECODER_FLOW_NEED_DATA;
 
-  /* And we are done */
-  gst_pad_pause_task (freeimagedec->sinkpad);
-  gst_pad_push_event (freeimagedec->srcpad, gst_event_new_eos ());
-  return;
+  gst_video_decoder_add_to_frame (decoder, gst_adapter_available (adapter));
 
-pause:
-  {
-    GST_INFO_OBJECT (freeimagedec, "pausing task, reason %s",
-        gst_flow_get_name (ret));
-    gst_pad_pause_task (freeimagedec->sinkpad);
-    if (GST_FLOW_IS_FATAL (ret) || ret == GST_FLOW_NOT_LINKED) {
-      GST_ELEMENT_ERROR (freeimagedec, STREAM, FAILED,
-          ("Internal data stream error."),
-          ("stream stopped, reason %s", gst_flow_get_name (ret)));
-      gst_pad_push_event (freeimagedec->srcpad, gst_event_new_eos ());
-    }
-  }
+  return gst_video_decoder_have_frame (decoder);
 }
 
 static GstFlowReturn
-gst_freeimagedec_chain (GstPad * pad, GstBuffer * buffer)
+gst_freeimagedec_handle_frame (GstVideoDecoder * decoder,
+    GstVideoCodecFrame * frame)
 {
-  GstFreeImageDec *freeimagedec;
+  GstFreeImageDec *freeimagedec = GST_FREEIMAGEDEC (decoder);
+  GstFreeImageDecClass *klass = GST_FREEIMAGEDEC_GET_CLASS (freeimagedec);
   GstFlowReturn ret = GST_FLOW_OK;
+  GstMapInfo map;
   FIMEMORY *fimem;
   FREE_IMAGE_FORMAT format;
+  FIBITMAP *dib;
 
-  freeimagedec = GST_FREEIMAGEDEC (gst_pad_get_parent (pad));
-
-  GST_LOG_OBJECT (freeimagedec, "Got buffer, size=%u",
-      GST_BUFFER_SIZE (buffer));
+  if (!gst_buffer_map (frame->input_buffer, &map, GST_MAP_READ))
+    goto map_failed;
 
-  if (G_UNLIKELY (!freeimagedec->setup))
-    goto not_configured;
-
-  /* Return if we have bad flow conditions */
-  ret = freeimagedec->ret;
-  if (G_UNLIKELY (ret != GST_FLOW_OK)) {
-    GST_WARNING_OBJECT (freeimagedec, "we have a pending return code of %d",
-        ret);
-    goto beach;
-  }
+  GST_LOG_OBJECT (freeimagedec, "Got buffer, size=%" G_GSIZE_FORMAT,
+      map.size);
 
-  /* Decode image to DIB */
-  fimem =
-      FreeImage_OpenMemory (GST_BUFFER_DATA (buffer), GST_BUFFER_SIZE (buffer));
+  /* Decode image to DIB, reading the mapped buffer in place */
+  fimem = FreeImage_OpenMemory (map.data, map.size);
   format = FreeImage_GetFileTypeFromMemory (fimem, 0);
+  if (format == FIF_UNKNOWN)
+    format = klass->fif;
   GST_LOG ("FreeImage format is %d", format);
-  freeimagedec->dib = FreeImage_LoadFromMemory (format, fimem, 0);
+  dib = FreeImage_LoadFromMemory (format, fimem, 0);
+  FreeImage_CloseMemory (fimem);
+  gst_buffer_unmap (frame->input_buffer, &map);
 
-  if (freeimagedec->dib == NULL)
+  if (dib == NULL)
     goto invalid_dib;
 
-  freeimagedec->in_timestamp = GST_BUFFER_TIMESTAMP (buffer);
-  freeimagedec->in_duration = GST_BUFFER_DURATION (buffer);
-
-  ret = gst_freeimagedec_push_dib (freeimagedec);
-  if (ret != GST_FLOW_OK)
-    goto beach;
-
-  if (freeimagedec->framed) {
-    /* Reset ourselves for the next frame */
-    gst_freeimagedec_freeimage_clear (freeimagedec);
-    gst_freeimagedec_freeimage_init (freeimagedec);
-  } else {
-    GST_LOG_OBJECT (freeimagedec, "sending EOS");
-    freeimagedec->ret =
-        gst_pad_push_event (freeimagedec->srcpad, gst_event_new_eos ());
-  }
-
-  /* grab new return code */
-  ret = freeimagedec->ret;
-
-  /* And release the buffer */
-  gst_buffer_unref (buffer);
-
-beach:
-  gst_object_unref (freeimagedec);
+  ret = gst_freeimagedec_push_dib (freeimagedec, frame, dib);
+  FreeImage_Unload (dib);
 
   return ret;
 
   /* ERRORS */
-not_configured:
+map_failed:
   {
-    GST_LOG_OBJECT (freeimagedec, "we are not configured yet");
-    ret = GST_FLOW_WRONG_STATE;
-    goto beach;
+    GST_ELEMENT_ERROR (freeimagedec, RESOURCE, READ,
+        ("Failed to map input buffer"), (NULL));
+    gst_video_decoder_drop_frame (decoder, frame);
+    return GST_FLOW_ERROR;
   }
 invalid_dib:
   {
-    GST_LOG_OBJECT (freeimagedec, "file is not recognized");
-    ret = GST_FLOW_UNEXPECTED;
-    goto beach;
-  }
-}
-
-static gboolean
-gst_freeimagedec_sink_setcaps (GstPad * pad, GstCaps * caps)
-{
-  GstStructure *s;
-  GstFreeImageDec *freeimagedec;
-  gint num, denom;
-
-  freeimagedec = GST_FREEIMAGEDEC (gst_pad_get_parent (pad));
-
-  s = gst_caps_get_structure (caps, 0);
-  if (gst_structure_get_fraction (s, "framerate", &num, &denom)) {
-    GST_DEBUG_OBJECT (freeimagedec, "framed input");
-    freeimagedec->framed = TRUE;
-    freeimagedec->fps_n = num;
-    freeimagedec->fps_d = denom;
-  } else {
-    GST_DEBUG_OBJECT (freeimagedec, "single picture input");
-    freeimagedec->framed = FALSE;
-    freeimagedec->fps_n = 0;
-    freeimagedec->fps_d = 1;
-  }
-
-  gst_object_unref (freeimagedec);
-  return TRUE;
-}
-
-static gboolean
-gst_freeimagedec_sink_event (GstPad * pad, GstEvent * event)
-{
-  GstFreeImageDec *freeimagedec;
-  gboolean res;
-
-  freeimagedec = GST_FREEIMAGEDEC (gst_pad_get_parent (pad));
-
-  switch (GST_EVENT_TYPE (event)) {
-    case GST_EVENT_NEWSEGMENT:{
-      gdouble rate, arate;
-      gboolean update;
-      gint64 start, stop, position;
-      GstFormat fmt;
-
-      gst_event_parse_new_segment_full (event, &update, &rate, &arate, &fmt,
-          &start, &stop, &position);
-
-      gst_segment_set_newsegment_full (&freeimagedec->segment, update, rate,
-          arate, fmt, start, stop, position);
-
-      GST_LOG_OBJECT (freeimagedec, "NEWSEGMENT (%s)",
-          gst_format_get_name (fmt));
-
-      if (fmt == GST_FORMAT_TIME) {
-        freeimagedec->need_newsegment = FALSE;
-        res = gst_pad_push_event (freeimagedec->srcpad, event);
-      } else {
-        gst_event_unref (event);
-        res = TRUE;
-      }
-
-      /* set offset of outgoing buffers */
-      freeimagedec->in_offset = 0;
-
-      break;
-    }
-    case GST_EVENT_FLUSH_STOP:
-    {
-      gst_freeimagedec_freeimage_clear (freeimagedec);
-      gst_freeimagedec_freeimage_init (freeimagedec);
-      freeimagedec->ret = GST_FLOW_OK;
-
-      gst_segment_init (&freeimagedec->segment, GST_FORMAT_UNDEFINED);
-      res = gst_pad_push_event (freeimagedec->srcpad, event);
-      break;
-    }
-    case GST_EVENT_EOS:
-    {
-      GST_LOG_OBJECT (freeimagedec, "EOS");
-      gst_freeimagedec_freeimage_clear (freeimagedec);
-      freeimagedec->ret = GST_FLOW_UNEXPECTED;
-      res = gst_pad_push_event (freeimagedec->srcpad, event);
-      break;
-    }
-    default:
-      res = gst_pad_push_event (freeimagedec->srcpad, event);
-      break;
-  }
-
-  gst_object_unref (freeimagedec);
-  return res;
-}
-
-
-/* Clean up the freeimage structures */
-static gboolean
-gst_freeimagedec_freeimage_clear (GstFreeImageDec * freeimagedec)
-{
-  GST_LOG ("cleaning up freeimage structures");
-
-  if (freeimagedec->dib) {
-    FreeImage_Unload (freeimagedec->dib);
-    freeimagedec->dib = NULL;
+    GST_VIDEO_DECODER_ERROR (freeimagedec, 1, STREAM, DECODE,
+        ("Failed to decode image"), ("file is not recognized"), ret);
+    gst_video_decoder_drop_frame (decoder, frame);
+    return ret;
   }
-
-  freeimagedec->in_timestamp = GST_CLOCK_TIME_NONE;
-  freeimagedec->in_duration = GST_CLOCK_TIME_NONE;
-
-  freeimagedec->setup = FALSE;
-
-  return TRUE;
 }
 
 static gboolean
-gst_freeimagedec_freeimage_init (GstFreeImageDec * freeimagedec)
+gst_freeimagedec_decide_allocation (GstVideoDecoder * decoder,
+    GstQuery * query)
 {
-  if (freeimagedec->setup)
-    return TRUE;
-
-  GST_LOG ("init freeimage");
-
-  freeimagedec->setup = TRUE;
+  GstBufferPool *pool = NULL;
+  GstStructure *config;
 
-  return TRUE;
-}
+  if (!GST_VIDEO_DECODER_CLASS (parent_class)->decide_allocation (decoder,
+          query))
+    return FALSE;
 
-static GstStateChangeReturn
-gst_freeimagedec_change_state (GstElement * element, GstStateChange transition)
-{
-  GstStateChangeReturn ret;
-  GstFreeImageDec *freeimagedec;
-
-  freeimagedec = GST_FREEIMAGEDEC (element);
-
-  switch (transition) {
-    case GST_STATE_CHANGE_READY_TO_PAUSED:
-      gst_freeimagedec_freeimage_init (freeimagedec);
-      freeimagedec->need_newsegment = TRUE;
-      freeimagedec->framed = FALSE;
-      freeimagedec->ret = GST_FLOW_OK;
-      gst_segment_init (&freeimagedec->segment, GST_FORMAT_UNDEFINED);
-      break;
-    default:
-      break;
-  }
+  if (gst_query_get_n_allocation_pools (query) > 0)
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, NULL, NULL, NULL);
 
-  ret = parent_class->change_state (element, transition);
-  if (ret != GST_STATE_CHANGE_SUCCESS)
-    return ret;
+  if (pool == NULL)
+    return FALSE;
 
-  switch (transition) {
-    case GST_STATE_CHANGE_PAUSED_TO_READY:
-      gst_freeimagedec_freeimage_clear (freeimagedec);
-      break;
-    default:
-      break;
+  /* strides may differ from FreeImage's pitch when downstream knows them */
+  config = gst_buffer_pool_get_config (pool);
+  if (gst_query_find_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL)) {
+    gst_buffer_pool_config_add_option (config,
+        GST_BUFFER_POOL_OPTION_VIDEO_META);
   }
-
-  return ret;
-}
-
-/* this function gets called when we activate ourselves in push mode. */
-static gboolean
-gst_freeimagedec_sink_activate_push (GstPad * sinkpad, gboolean active)
-{
-  GstFreeImageDec *freeimagedec;
-
-  freeimagedec = GST_FREEIMAGEDEC (GST_OBJECT_PARENT (sinkpad));
-
-  freeimagedec->ret = GST_FLOW_OK;
+  gst_buffer_pool_set_config (pool, config);
+  gst_object_unref (pool);
 
   return TRUE;
 }
 
-/* this function gets called when we activate ourselves in pull mode.
- * We can perform random access to the resource and we start a task
- * to start reading */
-static gboolean
-gst_freeimagedec_sink_activate_pull (GstPad * sinkpad, gboolean active)
+/* Returns a DIB with a raw video layout, which is either @dib or a
+ * converted copy the caller must unload. */
+static FIBITMAP *
+gst_freeimagedec_convert_dib (GstFreeImageDec * freeimagedec, FIBITMAP * dib,
+    GstVideoFormat * format)
 {
-  if (active) {
-    return gst_pad_start_task (sinkpad, (GstTaskFunction) gst_freeimagedec_task,
-        sinkpad);
-  } else {
-    return gst_pad_stop_task (sinkpad);
+  FIBITMAP *converted = NULL;
+  FIBITMAP *tmp;
+
+  *format = gst_freeimageutils_video_format_from_dib (dib);
+  if (*format != GST_VIDEO_FORMAT_UNKNOWN)
+    return dib;
+
+  /* we have an unsupported type, bring it to a standard bitmap first */
+  if (FreeImage_GetImageType (dib) != FIT_BITMAP) {
+    GST_DEBUG_OBJECT (freeimagedec,
+        "Image is non-standard type, convert to standard bitmap");
+    converted = FreeImage_ConvertToStandardType (dib, TRUE);
+    if (converted == NULL)
+      goto failed;
+
+    *format = gst_freeimageutils_video_format_from_dib (converted);
+    if (*format != GST_VIDEO_FORMAT_UNKNOWN)
+      return converted;
   }
-}
 
-/* this function is called when the pad is activated and should start
- * processing data.
- *
- */
-static gboolean
-gst_freeimagedec_sink_activate (GstPad * sinkpad)
-{
-  if (gst_pad_check_pull_range (sinkpad)) {
-    return gst_pad_activate_pull (sinkpad, TRUE);
+  /* then try converting to RGB/RGBA */
+  if (FreeImage_IsTransparent (converted ? converted : dib)) {
+    GST_DEBUG_OBJECT (freeimagedec,
+        "Image is non-standard format with transparency, convert to 32-bit RGB");
+    tmp = FreeImage_ConvertTo32Bits (converted ? converted : dib);
   } else {
-    return gst_pad_activate_push (sinkpad, TRUE);
+    GST_DEBUG_OBJECT (freeimagedec,
+        "Image is non-standard format, convert to 24-bit RGB");
+    tmp = FreeImage_ConvertTo24Bits (converted ? converted : dib);
   }
+  if (converted)
+    FreeImage_Unload (converted);
+  converted = tmp;
+
+  *format = gst_freeimageutils_video_format_from_dib (converted);
+  if (*format != GST_VIDEO_FORMAT_UNKNOWN)
+    return converted;
+
+failed:
+  GST_WARNING_OBJECT (freeimagedec, "Failed to convert image");
+  if (converted)
+    FreeImage_Unload (converted);
+  *format = GST_VIDEO_FORMAT_UNKNOWN;
+  return NULL;
 }
 
-
 static GstFlowReturn
-gst_freeimagedec_push_dib (GstFreeImageDec * freeimagedec)
+gst_freeimagedec_push_dib (GstFreeImageDec * freeimagedec,
+    GstVideoCodecFrame * frame, FIBITMAP * dib)
 {
+  GstVideoDecoder *decoder = GST_VIDEO_DECODER (freeimagedec);
+  GstVideoCodecState *state;
+  GstVideoFormat format;
+  GstVideoFrame vframe;
   GstFlowReturn ret;
-  GstBuffer *buffer = NULL;
-  size_t buffer_size = 0;
-  guint pitch, height;
-  gint i;
-
-  if (freeimagedec->dib == NULL)
-    return GST_FLOW_UNEXPECTED;
+  FIBITMAP *out;
+  guint width, height;
+
+  out = gst_freeimagedec_convert_dib (freeimagedec, dib, &format);
+  if (out == NULL)
+    goto convert_failed;
+
+  width = FreeImage_GetWidth (out);
+  height = FreeImage_GetHeight (out);
+
+  /* Generate the caps and configure when the image layout changes */
+  state = gst_video_decoder_get_output_state (decoder);
+  if (state == NULL || GST_VIDEO_INFO_FORMAT (&state->info) != format ||
+      GST_VIDEO_INFO_WIDTH (&state->info) != width ||
+      GST_VIDEO_INFO_HEIGHT (&state->info) != height) {
+    if (state)
+      gst_video_codec_state_unref (state);
+    state = gst_video_decoder_set_output_state (decoder, format, width,
+        height, freeimagedec->input_state);
+    if (!gst_video_decoder_negotiate (decoder)) {
+      gst_video_codec_state_unref (state);
+      ret = GST_FLOW_NOT_NEGOTIATED;
+      goto beach;
+    }
+  }
 
-  /* Generate the caps and configure */
-  ret = gst_freeimagedec_caps_create_and_set (freeimagedec);
+  ret = gst_video_decoder_allocate_output_frame (decoder, frame);
   if (ret != GST_FLOW_OK) {
-    return ret;
+    gst_video_codec_state_unref (state);
+    goto beach;
   }
 
-  /* Allocate output buffer */
-  height = FreeImage_GetHeight (freeimagedec->dib);
-  pitch = FreeImage_GetPitch (freeimagedec->dib);
-  buffer_size = pitch * height;
+  if (!gst_video_frame_map (&vframe, &state->info, frame->output_buffer,
+          GST_MAP_WRITE)) {
+    gst_video_codec_state_unref (state);
+    ret = GST_FLOW_ERROR;
+    goto beach;
+  }
+  gst_video_codec_state_unref (state);
 
-  GST_LOG ("Buffer size must be %d", buffer_size);
+  /* FreeImage stores images bottom-up: copy and flip in a single pass into
+   * the pool buffer, with its stride */
+  FreeImage_ConvertToRawBits (GST_VIDEO_FRAME_PLANE_DATA (&vframe, 0), out,
+      GST_VIDEO_FRAME_PLANE_STRIDE (&vframe, 0), FreeImage_GetBPP (out),
+      FreeImage_GetRedMask (out), FreeImage_GetGreenMask (out),
+      FreeImage_GetBlueMask (out), TRUE);
 
-  ret = gst_pad_alloc_buffer_and_set_caps (freeimagedec->srcpad,
-      GST_BUFFER_OFFSET_NONE, buffer_size,
-      GST_PAD_CAPS (freeimagedec->srcpad), &buffer);
-  if (ret != GST_FLOW_OK)
-    return ret;
+  gst_video_frame_unmap (&vframe);
 
-  /* flip image and copy to buffer */
-  for (i = 0; i < height; i++) {
-    memcpy (GST_BUFFER_DATA (buffer) + i * pitch,
-        FreeImage_GetBits (freeimagedec->dib) + (height - i - 1) * pitch,
-        pitch);
-  }
-
-  if (GST_BUFFER_TIMESTAMP_IS_VALID (freeimagedec->in_timestamp))
-    GST_BUFFER_TIMESTAMP (buffer) = freeimagedec->in_timestamp;
-  else if (freeimagedec->fps_d != 0)
-    GST_BUFFER_TIMESTAMP (buffer) =
-        (freeimagedec->in_offset * freeimagedec->fps_n) / freeimagedec->fps_d;
-  if (GST_BUFFER_TIMESTAMP_IS_VALID (freeimagedec->in_duration))
-    GST_BUFFER_DURATION (buffer) = freeimagedec->in_duration;
-  else if (freeimagedec->fps_n != 0)
-    GST_BUFFER_DURATION (buffer) = freeimagedec->fps_d / freeimagedec->fps_n;
-  GST_BUFFER_OFFSET (buffer) = freeimagedec->in_offset;
-  GST_BUFFER_OFFSET_END (buffer) = freeimagedec->in_offset;
+  if (out != dib)
+    FreeImage_Unload (out);
 
   /* Push the raw frame */
-  ret = gst_pad_push (freeimagedec->srcpad, buffer);
-
-  /* increment output buffer offset */
-  freeimagedec->in_offset++;
+  return gst_video_decoder_finish_frame (decoder, frame);
 
+beach:
+  if (out != dib)
+    FreeImage_Unload (out);
+  gst_video_decoder_drop_frame (decoder, frame);
   return ret;
+
+  /* ERRORS */
+convert_failed:
+  {
+    GST_VIDEO_DECODER_ERROR (freeimagedec, 1, STREAM, DECODE,
+        ("Failed to decode image"),
+        ("image can't be converted to a raw video format"), ret);
+    gst_video_decoder_drop_frame (decoder, frame);
+    return ret;
+  }
 }
 
 gboolean
@@ -747,7 +457,8 @@ gst_freeimagedec_register_plugin (GstPlugin * plugin, FREE_IMAGE_FORMAT fif)
   class_data->fif = fif;
   typeinfo.class_data = class_data;
 
-  type = g_type_register_static (GST_TYPE_ELEMENT, type_name, &typeinfo, 0);
+  type = g_type_register_static (GST_TYPE_VIDEO_DECODER, type_name, &typeinfo,
+      0);
   ret = gst_element_register (plugin, type_name, GST_RANK_NONE, type);
 
   g_free (type_name);
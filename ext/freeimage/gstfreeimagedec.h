@@ -22,6 +22,7 @@
 #define __GST_FREEIMAGEDEC_H__
 
 #include <gst/gst.h>
+#include <gst/video/video.h>
 #include <FreeImage.h>
 
 G_BEGIN_DECLS
@@ -39,41 +40,14 @@ typedef struct _GstFreeImageDecClass GstFreeImageDecClass;
 
 struct _GstFreeImageDec
 {
-  GstElement element;
+  GstVideoDecoder parent;
 
-  GstPad *sinkpad, *srcpad;
-
-  gboolean need_newsegment;
-  
-  /* Pull range */
-  long offset;
-
-
-  guint64 in_timestamp;
-  guint64 in_duration;
-  guint64 in_offset;
-
-  gboolean framed;
-
-  gint ret;
-
-  FIBITMAP *dib;
-
-  gboolean setup;
-
-  gint fps_n;
-  gint fps_d;
-
-  GstSegment segment;
-  gboolean image_ready;
-
-  FreeImageIO fiio;
-  guint64 length;
+  GstVideoCodecState *input_state;
 };
 
 struct _GstFreeImageDecClass
 {
-  GstElementClass parent_class;
+  GstVideoDecoderClass parent_class;
 
   FREE_IMAGE_FORMAT fif;
 };
@@ -15,7 +15,8 @@
 /**
  * SECTION:element-freeimageenc
  *
- * Encodes image types supported by FreeImage.
+ * Encodes image types supported by FreeImage. Each frame is encoded into
+ * FreeImage's memory stream, which is pushed downstream without copying.
  *
  */
 
@@ -41,24 +42,16 @@ static void gst_freeimageenc_class_init (GstFreeImageEncClass * klass,
     GstFreeImageEncClassData * class_data);
 static void gst_freeimageenc_init (GstFreeImageEnc * freeimageenc);
 
-static gboolean gst_freeimageenc_sink_activate_push (GstPad * sinkpad,
-    gboolean active);
-static gboolean gst_freeimageenc_sink_activate_pull (GstPad * sinkpad,
-    gboolean active);
-static gboolean gst_freeimageenc_sink_activate (GstPad * sinkpad);
-static GstFlowReturn gst_freeimageenc_chain (GstPad * pad, GstBuffer * buffer);
-static gboolean gst_freeimageenc_sink_event (GstPad * pad, GstEvent * event);
-static gboolean gst_freeimageenc_sink_setcaps (GstPad * pad, GstCaps * caps);
+static gboolean gst_freeimageenc_stop (GstVideoEncoder * encoder);
+static gboolean gst_freeimageenc_set_format (GstVideoEncoder * encoder,
+    GstVideoCodecState * state);
+static GstFlowReturn gst_freeimageenc_handle_frame (GstVideoEncoder *
+    encoder, GstVideoCodecFrame * frame);
 
-static void gst_freeimageenc_task (GstPad * pad);
-
-static gboolean gst_freeimageenc_freeimage_init (GstFreeImageEnc *
-    freeimageenc);
 static gboolean gst_freeimageenc_freeimage_clear (GstFreeImageEnc *
     freeimageenc);
-static GstFlowReturn gst_freeimageenc_push_dib (GstFreeImageEnc * freeimageenc);
 
-static GstElementClass *parent_class = NULL;
+static GstVideoEncoderClass *parent_class = NULL;
 
 void DLL_CALLCONV
 gst_freeimageenc_user_error (FREE_IMAGE_FORMAT fif, const char *message)
@@ -66,38 +59,12 @@ gst_freeimageenc_user_error (FREE_IMAGE_FORMAT fif, const char *message)
   GST_ERROR ("%s", message);
 }
 
-static int DLL_CALLCONV
-gst_freeimageenc_user_seek (fi_handle handle, long offset, int origin)
-{
-  GstFreeImageEnc *freeimageenc = GST_FREEIMAGEENC (handle);
-
-  switch (origin) {
-    case SEEK_SET:
-      freeimageenc->offset = offset;
-      break;
-    case SEEK_CUR:
-      freeimageenc->offset += offset;
-      break;
-    case SEEK_END:
-      freeimageenc->offset = freeimageenc->length + offset;
-      break;
-  }
-  return 0;
-}
-
-static long DLL_CALLCONV
-gst_freeimageenc_user_tell (fi_handle handle)
-{
-  GstFreeImageEnc *freeimageenc = GST_FREEIMAGEENC (handle);
-
-  return freeimageenc->offset;
-}
-
 static void
 gst_freeimageenc_class_init (GstFreeImageEncClass * klass,
     GstFreeImageEncClassData * class_data)
 {
   GstElementClass *gstelement_class;
+  GstVideoEncoderClass *venc_class;
   GstCaps *caps;
   GstPadTemplate *templ;
   const gchar *mimetype;
@@ -110,6 +77,7 @@ gst_freeimageenc_class_init (GstFreeImageEncClass * klass,
   klass->fif = class_data->fif;
 
   gstelement_class = (GstElementClass *) klass;
+  venc_class = (GstVideoEncoderClass *) klass;
 
   parent_class = g_type_class_peek_parent (klass);
 
@@ -120,183 +88,154 @@ gst_freeimageenc_class_init (GstFreeImageEncClass * klass,
 
   /* add src pad template from FIF mimetype */
   if (mimetype)
-    caps = gst_caps_new_simple (mimetype, NULL);
+    caps = gst_caps_new_empty_simple (mimetype);
   else
-    caps = gst_caps_new_simple ("image/freeimage-unknown", NULL);
+    caps = gst_caps_new_empty_simple ("image/freeimage-unknown");
   templ = gst_pad_template_new ("src", GST_PAD_SRC, GST_PAD_ALWAYS, caps);
   gst_element_class_add_pad_template (gstelement_class, templ);
+  gst_caps_unref (caps);
 
   /* add sink pad template */
   caps = gst_freeimageutils_caps_from_freeimage_format (klass->fif);
   templ = gst_pad_template_new ("sink", GST_PAD_SINK, GST_PAD_ALWAYS, caps);
   gst_element_class_add_pad_template (gstelement_class, templ);
+  gst_caps_unref (caps);
 
   /* set details */
   longname = g_strdup_printf ("FreeImage %s image encoder", format);
   description = g_strdup_printf ("Encode %s (%s) images",
       format_description, extensions);
-  gst_element_class_set_details_simple (gstelement_class, longname,
+  gst_element_class_set_metadata (gstelement_class, longname,
       "Codec/Encoder/Image", description, "Joshua M. Doe <oss@nvl.army.mil>");
   g_free (longname);
   g_free (description);
+
+  venc_class->stop = GST_DEBUG_FUNCPTR (gst_freeimageenc_stop);
+  venc_class->set_format = GST_DEBUG_FUNCPTR (gst_freeimageenc_set_format);
+  venc_class->handle_frame = GST_DEBUG_FUNCPTR (gst_freeimageenc_handle_frame);
 }
 
 static void
 gst_freeimageenc_init (GstFreeImageEnc * freeimageenc)
 {
-  GstElementClass *klass = GST_ELEMENT_GET_CLASS (freeimageenc);
-
-  freeimageenc->sinkpad =
-      gst_pad_new_from_template (gst_element_class_get_pad_template (klass,
-          "sink"), "sink");
-  gst_pad_set_chain_function (freeimageenc->sinkpad, gst_freeimageenc_chain);
-  gst_pad_set_setcaps_function (freeimageenc->sinkpad,
-      gst_freeimageenc_sink_setcaps);
-  gst_element_add_pad (GST_ELEMENT (freeimageenc), freeimageenc->sinkpad);
-
-  freeimageenc->srcpad =
-      gst_pad_new_from_template (gst_element_class_get_pad_template (klass,
-          "src"), "src");
-  gst_pad_use_fixed_caps (freeimageenc->srcpad);
-  gst_element_add_pad (GST_ELEMENT (freeimageenc), freeimageenc->srcpad);
-
-  freeimageenc->setup = FALSE;
-
-  freeimageenc->in_timestamp = GST_CLOCK_TIME_NONE;
-  freeimageenc->in_duration = GST_CLOCK_TIME_NONE;
-
-  freeimageenc->fps_n = 0;
-  freeimageenc->fps_d = 1;
-
-  /* Set user IO functions to FreeImageIO struct */
-  freeimageenc->fiio.read_proc = NULL;
-  freeimageenc->fiio.write_proc = NULL;
-  freeimageenc->fiio.seek_proc = gst_freeimageenc_user_seek;
-  freeimageenc->fiio.tell_proc = gst_freeimageenc_user_tell;
+  freeimageenc->input_state = NULL;
+  freeimageenc->dib = NULL;
+}
+
+static gboolean
+gst_freeimageenc_stop (GstVideoEncoder * encoder)
+{
+  return gst_freeimageenc_freeimage_clear (GST_FREEIMAGEENC (encoder));
+}
+
+/* FreeImage_CloseMemory is DLL_CALLCONV, not a GDestroyNotify */
+static void
+gst_freeimageenc_close_memory (gpointer data)
+{
+  FreeImage_CloseMemory ((FIMEMORY *) data);
 }
 
 static GstFlowReturn
-gst_freeimageenc_chain (GstPad * pad, GstBuffer * buffer)
+gst_freeimageenc_handle_frame (GstVideoEncoder * encoder,
+    GstVideoCodecFrame * frame)
 {
-  GstFreeImageEnc *freeimageenc;
-  GstFreeImageEncClass *klass;
-  GstFlowReturn ret = GST_FLOW_OK;
-  GstBuffer *buffer_out;
+  GstFreeImageEnc *freeimageenc = GST_FREEIMAGEENC (encoder);
+  GstFreeImageEncClass *klass = GST_FREEIMAGEENC_GET_CLASS (freeimageenc);
+  GstVideoFrame vframe;
   FIMEMORY *hmem = NULL;
-  gint srcPitch, dstPitch;
-  guint8 *pSrc, *pDst;
-  gint width, height, bpp;
-  size_t y;
+  guint line, height;
+  guint y;
   BYTE *mem_buffer;
   DWORD size_in_bytes;
 
-  freeimageenc = GST_FREEIMAGEENC (gst_pad_get_parent (pad));
-  klass = GST_FREEIMAGEENC_GET_CLASS (freeimageenc);
-
-  GST_LOG_OBJECT (freeimageenc, "Got buffer, size=%u",
-      GST_BUFFER_SIZE (buffer));
+  GST_LOG_OBJECT (freeimageenc, "Got buffer, size=%" G_GSIZE_FORMAT,
+      gst_buffer_get_size (frame->input_buffer));
 
-  /* convert raw buffer to FIBITMAP */
-  width = FreeImage_GetWidth (freeimageenc->dib);
-  height = FreeImage_GetHeight (freeimageenc->dib);
-  bpp = FreeImage_GetBPP (freeimageenc->dib);
-
-  dstPitch = FreeImage_GetPitch (freeimageenc->dib);
-  srcPitch = GST_ROUND_UP_4 (width * bpp / 8);
+  if (!gst_video_frame_map (&vframe, &freeimageenc->input_state->info,
+          frame->input_buffer, GST_MAP_READ)) {
+    GST_ELEMENT_ERROR (freeimageenc, RESOURCE, READ,
+        ("Failed to map input buffer"), (NULL));
+    gst_video_codec_frame_unref (frame);
+    return GST_FLOW_ERROR;
+  }
 
   /* Copy data, invert scanlines and respect FreeImage pitch */
-  pDst = FreeImage_GetBits (freeimageenc->dib);
+  height = FreeImage_GetHeight (freeimageenc->dib);
+  line = FreeImage_GetLine (freeimageenc->dib);
   for (y = 0; y < height; ++y) {
-    pSrc = GST_BUFFER_DATA (buffer) + (height - y - 1) * srcPitch;
-    memcpy (pDst, pSrc, srcPitch);
-    pDst += dstPitch;
+    memcpy (FreeImage_GetScanLine (freeimageenc->dib, height - y - 1),
+        (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&vframe, 0) +
+        y * GST_VIDEO_FRAME_PLANE_STRIDE (&vframe, 0), line);
   }
+  gst_video_frame_unmap (&vframe);
 
   /* open memory stream */
   hmem = FreeImage_OpenMemory (0, 0);
 
   /* encode raw image to memory */
   if (!FreeImage_SaveToMemory (klass->fif, freeimageenc->dib, hmem, 0)) {
-    GST_ERROR ("Failed to encode image");
+    GST_ELEMENT_ERROR (freeimageenc, STREAM, ENCODE, (NULL),
+        ("Failed to encode image"));
     FreeImage_CloseMemory (hmem);
-    gst_buffer_unref (buffer);
+    gst_video_codec_frame_unref (frame);
     return GST_FLOW_ERROR;
   }
 
   if (!FreeImage_AcquireMemory (hmem, &mem_buffer, &size_in_bytes)) {
-    GST_ERROR ("Failed to acquire encoded image");
+    GST_ELEMENT_ERROR (freeimageenc, STREAM, ENCODE, (NULL),
+        ("Failed to acquire encoded image"));
     FreeImage_CloseMemory (hmem);
-    gst_buffer_unref (buffer);
+    gst_video_codec_frame_unref (frame);
     return GST_FLOW_ERROR;
   }
 
-  buffer_out = gst_buffer_new_and_alloc (size_in_bytes);
-
-  /* copy compressed image to buffer */
-  memcpy (GST_BUFFER_DATA (buffer_out), mem_buffer, size_in_bytes);
-
-  FreeImage_CloseMemory (hmem);
+  /* the buffer owns the memory stream, closing it when freed */
+  frame->output_buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+      mem_buffer, size_in_bytes, 0, size_in_bytes, hmem,
+      gst_freeimageenc_close_memory);
 
-  gst_buffer_copy_metadata (buffer_out, buffer, GST_BUFFER_COPY_TIMESTAMPS);
-  gst_buffer_unref (buffer);
-  gst_buffer_set_caps (buffer, GST_PAD_CAPS (freeimageenc->srcpad));
+  /* every image stands on its own */
+  GST_VIDEO_CODEC_FRAME_SET_SYNC_POINT (frame);
 
-  if ((ret = gst_pad_push (freeimageenc->srcpad, buffer_out)) != GST_FLOW_OK)
-    goto done;
-
-  //if (pngenc->snapshot) {
-  //  GstEvent *event;
-
-  //  GST_DEBUG_OBJECT (pngenc, "snapshot mode, sending EOS");
-  //  /* send EOS event, since a frame has been pushed out */
-  //  event = gst_event_new_eos ();
-
-  //  gst_pad_push_event (pngenc->srcpad, event);
-  //  ret = GST_FLOW_UNEXPECTED;
-  //}
-
-done:
-  GST_DEBUG_OBJECT (freeimageenc, "END, ret:%d", ret);
-
-  if (buffer_out != NULL) {
-    gst_buffer_unref (buffer_out);
-    buffer_out = NULL;
-  }
-
-  gst_object_unref (freeimageenc);
-  return ret;
+  return gst_video_encoder_finish_frame (encoder, frame);
 }
 
 static gboolean
-gst_freeimageenc_sink_setcaps (GstPad * pad, GstCaps * caps)
+gst_freeimageenc_set_format (GstVideoEncoder * encoder,
+    GstVideoCodecState * state)
 {
-  GstFreeImageEnc *freeimageenc;
+  GstFreeImageEnc *freeimageenc = GST_FREEIMAGEENC (encoder);
+  GstVideoCodecState *output_state;
   FREE_IMAGE_TYPE type;
-  gint width, height, bpp;
-  gint red_mask, green_mask, blue_mask;
-
-  freeimageenc = GST_FREEIMAGEENC (gst_pad_get_parent (pad));
+  gint bpp;
+  guint red_mask, green_mask, blue_mask;
 
-  if (gst_freeimageutils_parse_caps (caps, &type, &width, &height, &bpp,
-          &red_mask, &green_mask, &blue_mask) == FALSE) {
+  if (gst_freeimageutils_parse_video_format (GST_VIDEO_INFO_FORMAT
+          (&state->info), &type, &bpp, &red_mask, &green_mask,
+          &blue_mask) == FALSE) {
     GST_DEBUG ("Failed to parse caps");
     return FALSE;
   }
 
-  if (freeimageenc->dib) {
-    FreeImage_Unload (freeimageenc->dib);
-    freeimageenc->dib = NULL;
-  }
+  gst_freeimageenc_freeimage_clear (freeimageenc);
 
-  freeimageenc->dib = FreeImage_AllocateT (type, width, height, bpp,
-      red_mask, green_mask, blue_mask);
+  freeimageenc->dib = FreeImage_AllocateT (type,
+      GST_VIDEO_INFO_WIDTH (&state->info),
+      GST_VIDEO_INFO_HEIGHT (&state->info), bpp, red_mask, green_mask,
+      blue_mask);
 
-  if (freeimageenc == NULL) {
+  if (freeimageenc->dib == NULL) {
     GST_DEBUG ("Failed to allocate memory for DIB");
     return FALSE;
   }
 
-  gst_object_unref (freeimageenc);
+  freeimageenc->input_state = gst_video_codec_state_ref (state);
+
+  output_state = gst_video_encoder_set_output_state (encoder,
+      gst_pad_get_pad_template_caps (GST_VIDEO_ENCODER_SRC_PAD (encoder)),
+      state);
+  gst_video_codec_state_unref (output_state);
+
   return TRUE;
 }
 
@@ -311,23 +250,10 @@ gst_freeimageenc_freeimage_clear (GstFreeImageEnc * freeimageenc)
     freeimageenc->dib = NULL;
   }
 
-  freeimageenc->in_timestamp = GST_CLOCK_TIME_NONE;
-  freeimageenc->in_duration = GST_CLOCK_TIME_NONE;
-
-  freeimageenc->setup = FALSE;
-
-  return TRUE;
-}
-
-static gboolean
-gst_freeimageenc_freeimage_init (GstFreeImageEnc * freeimageenc)
-{
-  if (freeimageenc->setup)
-    return TRUE;
-
-  GST_LOG ("init freeimage");
-
-  freeimageenc->setup = TRUE;
+  if (freeimageenc->input_state) {
+    gst_video_codec_state_unref (freeimageenc->input_state);
+    freeimageenc->input_state = NULL;
+  }
 
   return TRUE;
 }
@@ -373,7 +299,8 @@ gst_freeimageenc_register_plugin (GstPlugin * plugin, FREE_IMAGE_FORMAT fif)
   class_data->fif = fif;
   typeinfo.class_data = class_data;
 
-  type = g_type_register_static (GST_TYPE_ELEMENT, type_name, &typeinfo, 0);
+  type = g_type_register_static (GST_TYPE_VIDEO_ENCODER, type_name, &typeinfo,
+      0);
   ret = gst_element_register (plugin, type_name, GST_RANK_NONE, type);
 
   g_free (type_name);
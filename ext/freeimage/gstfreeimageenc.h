@@ -22,6 +22,7 @@
 #define __GST_FREEIMAGEENC_H__
 
 #include <gst/gst.h>
+#include <gst/video/video.h>
 #include <FreeImage.h>
 
 G_BEGIN_DECLS
@@ -39,39 +40,17 @@ typedef struct _GstFreeImageEncClass GstFreeImageEncClass;
 
 struct _GstFreeImageEnc
 {
-  GstElement element;
+  GstVideoEncoder parent;
 
-  GstPad *sinkpad, *srcpad;
-
-  gboolean need_newsegment;
-  
-  /* Pull range */
-  long offset;
-
-
-  guint64 in_timestamp;
-  guint64 in_duration;
-
-  gboolean framed;
-
-  gint ret;
+  GstVideoCodecState *input_state;
 
+  /* bottom-up copy of each frame, allocated when caps are set */
   FIBITMAP *dib;
-
-  gboolean setup;
-
-  gint fps_n;
-  gint fps_d;
-
-  gboolean image_ready;
-
-  FreeImageIO fiio;
-  guint64 length;
 };
 
 struct _GstFreeImageEncClass
 {
-  GstElementClass parent_class;
+  GstVideoEncoderClass parent_class;
 
   FREE_IMAGE_FORMAT fif;
 };
@@ -2,17 +2,30 @@
 
 #include "gstfreeimageutils.h"
 
-GstCaps *
-gst_freeimageutils_caps_from_dib (FIBITMAP * dib, gint fps_n, gint fps_d)
+/* FreeImage keeps 24- and 32-bit pixels in the byte order of the host */
+#if FREEIMAGE_COLORORDER == FREEIMAGE_COLORORDER_BGR
+#define GST_FREEIMAGE_FORMAT_24 GST_VIDEO_FORMAT_BGR
+#define GST_FREEIMAGE_FORMAT_32 GST_VIDEO_FORMAT_BGRA
+#else
+#define GST_FREEIMAGE_FORMAT_24 GST_VIDEO_FORMAT_RGB
+#define GST_FREEIMAGE_FORMAT_32 GST_VIDEO_FORMAT_RGBA
+#endif
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+#define GST_FREEIMAGE_FORMAT_GRAY16 GST_VIDEO_FORMAT_GRAY16_LE
+#else
+#define GST_FREEIMAGE_FORMAT_GRAY16 GST_VIDEO_FORMAT_GRAY16_BE
+#endif
+
+GstVideoFormat
+gst_freeimageutils_video_format_from_dib (FIBITMAP * dib)
 {
   FREE_IMAGE_TYPE image_type;
   guint width, height, bpp;
-  gint video_format = -1;
-  GstCaps *caps = NULL;
-  gint endianness;
+  guint red_mask, green_mask, blue_mask;
 
   if (dib == NULL)
-    return NULL;
+    return GST_VIDEO_FORMAT_UNKNOWN;
 
   /* Get bits per channel */
   bpp = FreeImage_GetBPP (dib);
@@ -26,176 +39,157 @@ gst_freeimageutils_caps_from_dib (FIBITMAP * dib, gint fps_n, gint fps_d)
 
   GST_LOG ("Image_type=%d, %dx%dx%d", image_type, width, height, bpp);
 
+  red_mask = FreeImage_GetRedMask (dib);
+  green_mask = FreeImage_GetGreenMask (dib);
+  blue_mask = FreeImage_GetBlueMask (dib);
+
   switch (image_type) {
     case FIT_BITMAP:
-      if (bpp == 24) {
-        if (FreeImage_GetRedMask (dib) == GST_VIDEO_BYTE1_MASK_24_INT &&
-            FreeImage_GetGreenMask (dib) == GST_VIDEO_BYTE2_MASK_24_INT &&
-            FreeImage_GetBlueMask (dib) == GST_VIDEO_BYTE3_MASK_24_INT) {
-          video_format = GST_VIDEO_FORMAT_RGB;
-        } else if (FreeImage_GetRedMask (dib) == GST_VIDEO_BYTE3_MASK_24_INT &&
-            FreeImage_GetGreenMask (dib) == GST_VIDEO_BYTE2_MASK_24_INT &&
-            FreeImage_GetBlueMask (dib) == GST_VIDEO_BYTE1_MASK_24_INT) {
-          video_format = GST_VIDEO_FORMAT_BGR;
-        } else {
-          return NULL;
-        }
-      } else if (bpp == 32) {
-        if (FreeImage_GetRedMask (dib) == GST_VIDEO_BYTE1_MASK_32_INT &&
-            FreeImage_GetGreenMask (dib) == GST_VIDEO_BYTE2_MASK_32_INT &&
-            FreeImage_GetBlueMask (dib) == GST_VIDEO_BYTE3_MASK_32_INT) {
-          video_format = GST_VIDEO_FORMAT_RGBA;
-        } else if (FreeImage_GetRedMask (dib) == GST_VIDEO_BYTE3_MASK_32_INT &&
-            FreeImage_GetGreenMask (dib) == GST_VIDEO_BYTE2_MASK_32_INT &&
-            FreeImage_GetBlueMask (dib) == GST_VIDEO_BYTE1_MASK_32_INT) {
-          video_format = GST_VIDEO_FORMAT_BGRA;
-        } else {
-          return NULL;
-        }
-      } else {
-        return NULL;
-      }
-
-      /* We could not find a supported format */
-      if (video_format == -1) {
-        caps = NULL;
-      } else {
-        caps = gst_video_format_new_caps (video_format, width, height,
-            fps_n, fps_d, 1, 1);
+      if (bpp == 8 && FreeImage_GetColorType (dib) == FIC_MINISBLACK) {
+        return GST_VIDEO_FORMAT_GRAY8;
+      } else if (bpp == 16) {
+        if (red_mask == FI16_565_RED_MASK &&
+            green_mask == FI16_565_GREEN_MASK &&
+            blue_mask == FI16_565_BLUE_MASK)
+          return GST_VIDEO_FORMAT_RGB16;
+        else if (red_mask == FI16_555_RED_MASK &&
+            green_mask == FI16_555_GREEN_MASK &&
+            blue_mask == FI16_555_BLUE_MASK)
+          return GST_VIDEO_FORMAT_RGB15;
+      } else if (bpp == 24 || bpp == 32) {
+        if (red_mask == FI_RGBA_RED_MASK &&
+            green_mask == FI_RGBA_GREEN_MASK &&
+            blue_mask == FI_RGBA_BLUE_MASK)
+          return bpp == 24 ? GST_FREEIMAGE_FORMAT_24 : GST_FREEIMAGE_FORMAT_32;
       }
       break;
     case FIT_UINT16:
-      endianness = G_BYTE_ORDER;
-
-      caps = gst_caps_new_simple ("video/x-raw-gray",
-          "width", G_TYPE_INT, width,
-          "height", G_TYPE_INT, height,
-          "bpp", G_TYPE_INT, 16,
-          "depth", G_TYPE_INT, 16,
-          "endianness", G_TYPE_INT, endianness,
-          "framerate", GST_TYPE_FRACTION, fps_n, fps_d, NULL);
-      break;
-    case FIT_INT16:
-      endianness = G_BYTE_ORDER;
-
-      caps = gst_caps_new_simple ("video/x-raw-gray",
-          "width", G_TYPE_INT, width,
-          "height", G_TYPE_INT, height,
-          "bpp", G_TYPE_INT, 16,
-          "depth", G_TYPE_INT, 16,
-          "endianness", G_TYPE_INT, endianness,
-          "framerate", GST_TYPE_FRACTION, fps_n, fps_d,
-          "signed", G_TYPE_BOOLEAN, TRUE, NULL);
-      break;
+      return GST_FREEIMAGE_FORMAT_GRAY16;
     default:
-      caps = NULL;
+      break;
   }
+
+  return GST_VIDEO_FORMAT_UNKNOWN;
+}
+
+static void
+gst_freeimageutils_append_format (GValue * formats, GstVideoFormat format)
+{
+  GValue value = G_VALUE_INIT;
+
+  g_value_init (&value, G_TYPE_STRING);
+  g_value_set_static_string (&value, gst_video_format_to_string (format));
+  gst_value_list_append_value (formats, &value);
+  g_value_unset (&value);
+}
+
+/* Takes the list of formats and unsets it. */
+static GstCaps *
+gst_freeimageutils_caps_from_formats (GValue * formats)
+{
+  GstCaps *caps;
+
+  caps = gst_caps_new_simple ("video/x-raw",
+      "width", GST_TYPE_INT_RANGE, 1, G_MAXINT,
+      "height", GST_TYPE_INT_RANGE, 1, G_MAXINT,
+      "framerate", GST_TYPE_FRACTION_RANGE, 0, 1, G_MAXINT, 1, NULL);
+  gst_caps_set_value (caps, "format", formats);
+  g_value_unset (formats);
+
   return caps;
 }
 
+/* The formats an encoder can be given, from what the FIF can export. */
 GstCaps *
 gst_freeimageutils_caps_from_freeimage_format (FREE_IMAGE_FORMAT fif)
 {
-  GstCaps *caps = gst_caps_new_empty ();
+  GValue formats = G_VALUE_INIT;
+
+  g_value_init (&formats, GST_TYPE_LIST);
 
   if (FreeImage_FIFSupportsExportType (fif, FIT_BITMAP)) {
+    if (FreeImage_FIFSupportsExportBPP (fif, 8))
+      gst_freeimageutils_append_format (&formats, GST_VIDEO_FORMAT_GRAY8);
     if (FreeImage_FIFSupportsExportBPP (fif, 1) ||
         FreeImage_FIFSupportsExportBPP (fif, 4) ||
         FreeImage_FIFSupportsExportBPP (fif, 8) ||
-        FreeImage_FIFSupportsExportBPP (fif, 24)) {
-      if (G_BYTE_ORDER == G_LITTLE_ENDIAN) {
-        gst_caps_append (caps, gst_caps_from_string (GST_VIDEO_CAPS_BGR));
-      } else {
-        gst_caps_append (caps, gst_caps_from_string (GST_VIDEO_CAPS_RGB));
-      }
-
-    }
+        FreeImage_FIFSupportsExportBPP (fif, 24))
+      gst_freeimageutils_append_format (&formats, GST_FREEIMAGE_FORMAT_24);
     if (FreeImage_FIFSupportsExportBPP (fif, 16)) {
-      gst_caps_append (caps, gst_caps_from_string (GST_VIDEO_CAPS_RGB_15));
-      gst_caps_append (caps, gst_caps_from_string (GST_VIDEO_CAPS_RGB_16));
-    }
-    if (FreeImage_FIFSupportsExportBPP (fif, 32)) {
-      if (G_BYTE_ORDER == G_LITTLE_ENDIAN) {
-        gst_caps_append (caps, gst_caps_from_string (GST_VIDEO_CAPS_BGRA));
-      } else {
-        gst_caps_append (caps, gst_caps_from_string (GST_VIDEO_CAPS_RGBA));
-      }
-
+      gst_freeimageutils_append_format (&formats, GST_VIDEO_FORMAT_RGB15);
+      gst_freeimageutils_append_format (&formats, GST_VIDEO_FORMAT_RGB16);
     }
+    if (FreeImage_FIFSupportsExportBPP (fif, 32))
+      gst_freeimageutils_append_format (&formats, GST_FREEIMAGE_FORMAT_32);
   }
-  if (FreeImage_FIFSupportsExportType (fif, FIT_UINT16)) {
-    if (G_BYTE_ORDER == G_BIG_ENDIAN)
-      gst_caps_append (caps,
-          gst_caps_from_string (GST_VIDEO_CAPS_GRAY16 ("BIG_ENDIAN")));
-    else
-      gst_caps_append (caps,
-          gst_caps_from_string (GST_VIDEO_CAPS_GRAY16 ("LITTLE_ENDIAN")));
-  }
-  if (FreeImage_FIFSupportsExportType (fif, FIT_INT16)) {
-  }
-  if (FreeImage_FIFSupportsExportType (fif, FIT_UINT32)) {
-  }
-  if (FreeImage_FIFSupportsExportType (fif, FIT_INT32)) {
-  }
-  if (FreeImage_FIFSupportsExportType (fif, FIT_FLOAT)) {
-  }
-  if (FreeImage_FIFSupportsExportType (fif, FIT_DOUBLE)) {
-  }
-  if (FreeImage_FIFSupportsExportType (fif, FIT_COMPLEX)) {
-  }
-  if (FreeImage_FIFSupportsExportType (fif, FIT_RGB16)) {
-  }
-  if (FreeImage_FIFSupportsExportType (fif, FIT_RGBA16)) {
-  }
-  if (FreeImage_FIFSupportsExportType (fif, FIT_RGBF)) {
-  }
-  if (FreeImage_FIFSupportsExportType (fif, FIT_RGBAF)) {
-  }
+  if (FreeImage_FIFSupportsExportType (fif, FIT_UINT16))
+    gst_freeimageutils_append_format (&formats, GST_FREEIMAGE_FORMAT_GRAY16);
 
   /* non-standard format, we'll try and convert to RGB */
-  if (gst_caps_get_size (caps) == 0) {
-    if (G_BYTE_ORDER == G_LITTLE_ENDIAN) {
-      gst_caps_append (caps, gst_caps_from_string (GST_VIDEO_CAPS_BGR));
-      gst_caps_append (caps, gst_caps_from_string (GST_VIDEO_CAPS_BGRA));
-    } else {
-      gst_caps_append (caps, gst_caps_from_string (GST_VIDEO_CAPS_RGB));
-      gst_caps_append (caps, gst_caps_from_string (GST_VIDEO_CAPS_RGBA));
-    }
+  if (gst_value_list_get_size (&formats) == 0) {
+    gst_freeimageutils_append_format (&formats, GST_FREEIMAGE_FORMAT_24);
+    gst_freeimageutils_append_format (&formats, GST_FREEIMAGE_FORMAT_32);
   }
 
-  return caps;
+  return gst_freeimageutils_caps_from_formats (&formats);
+}
+
+/* The formats a decoder can output, which are those
+ * gst_freeimageutils_video_format_from_dib() recognizes, whatever the FIF,
+ * as images in any other layout are converted to 24 or 32-bit RGB. */
+GstCaps *
+gst_freeimageutils_caps_for_decoder (void)
+{
+  GValue formats = G_VALUE_INIT;
+
+  g_value_init (&formats, GST_TYPE_LIST);
+  gst_freeimageutils_append_format (&formats, GST_VIDEO_FORMAT_GRAY8);
+  gst_freeimageutils_append_format (&formats, GST_FREEIMAGE_FORMAT_GRAY16);
+  gst_freeimageutils_append_format (&formats, GST_VIDEO_FORMAT_RGB15);
+  gst_freeimageutils_append_format (&formats, GST_VIDEO_FORMAT_RGB16);
+  gst_freeimageutils_append_format (&formats, GST_FREEIMAGE_FORMAT_24);
+  gst_freeimageutils_append_format (&formats, GST_FREEIMAGE_FORMAT_32);
+
+  return gst_freeimageutils_caps_from_formats (&formats);
 }
 
 gboolean
-gst_freeimageutils_parse_caps (const GstCaps * caps, FREE_IMAGE_TYPE * type,
-    gint * width, gint * height, gint * bpp, guint32 * red_mask,
-    guint32 * green_mask, guint32 * blue_mask)
+gst_freeimageutils_parse_video_format (GstVideoFormat format,
+    FREE_IMAGE_TYPE * type, gint * bpp, guint * red_mask,
+    guint * green_mask, guint * blue_mask)
 {
-  GstStructure *s;
-
-  s = gst_caps_get_structure (caps, 0);
-
-  gst_structure_get_int (s, "width", width);
-  gst_structure_get_int (s, "height", height);
-  gst_structure_get_int (s, "bpp", bpp);
-
-  if (g_strcmp0 (gst_structure_get_name (s), "video/x-raw-rgb") == 0) {
-    *type = FIT_BITMAP;
-    gst_structure_get_int (s, "red_mask", red_mask);
-    gst_structure_get_int (s, "green_mask", green_mask);
-    gst_structure_get_int (s, "blue_mask", blue_mask);
-  } else if (g_strcmp0 (gst_structure_get_name (s), "video/x-raw-gray") == 0) {
-    gboolean is_signed;
-    if (!gst_structure_get_boolean (s, "signed", &is_signed))
-      is_signed = FALSE;
-
-    if (*bpp == 8)
-      *type = FIT_BITMAP;       /* need to create palette for this later */
-    else if (*bpp == 16 && is_signed == FALSE)
+  *type = FIT_BITMAP;
+  *red_mask = *green_mask = *blue_mask = 0;
+
+  switch (format) {
+    case GST_VIDEO_FORMAT_GRAY8:
+      /* 8-bit bitmaps are allocated with a grayscale palette */
+      *bpp = 8;
+      break;
+    case GST_VIDEO_FORMAT_RGB15:
+      *bpp = 16;
+      *red_mask = FI16_555_RED_MASK;
+      *green_mask = FI16_555_GREEN_MASK;
+      *blue_mask = FI16_555_BLUE_MASK;
+      break;
+    case GST_VIDEO_FORMAT_RGB16:
+      *bpp = 16;
+      *red_mask = FI16_565_RED_MASK;
+      *green_mask = FI16_565_GREEN_MASK;
+      *blue_mask = FI16_565_BLUE_MASK;
+      break;
+    case GST_FREEIMAGE_FORMAT_24:
+    case GST_FREEIMAGE_FORMAT_32:
+      *bpp = format == GST_FREEIMAGE_FORMAT_24 ? 24 : 32;
+      *red_mask = FI_RGBA_RED_MASK;
+      *green_mask = FI_RGBA_GREEN_MASK;
+      *blue_mask = FI_RGBA_BLUE_MASK;
+      break;
+    case GST_FREEIMAGE_FORMAT_GRAY16:
       *type = FIT_UINT16;
-    else if (*bpp == 16 && is_signed == TRUE)
-      *type = FIT_INT16;
-    else
+      *bpp = 16;
+      break;
+    default:
       return FALSE;
   }
 
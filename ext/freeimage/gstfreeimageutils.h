@@ -2,15 +2,16 @@
 #define __GST_FREEIMAGEUTILS_H__
 
 #include <gst/gst.h>
+#include <gst/video/video.h>
 #include <FreeImage.h>
 
-GstCaps * gst_freeimageutils_caps_from_dib (FIBITMAP * dib,
-    gint fps_n, gint fps_d);
+GstVideoFormat gst_freeimageutils_video_format_from_dib (FIBITMAP * dib);
 GstCaps * gst_freeimageutils_caps_from_freeimage_format (
     FREE_IMAGE_FORMAT fif);
+GstCaps * gst_freeimageutils_caps_for_decoder (void);
 
-gboolean gst_freeimageutils_parse_caps (const GstCaps * caps,
-    FREE_IMAGE_TYPE * type, gint * width, gint * height, gint * bpp,
-    unsigned * red_mask, unsigned * green_mask, unsigned * blue_mask);
+gboolean gst_freeimageutils_parse_video_format (GstVideoFormat format,
+    FREE_IMAGE_TYPE * type, gint * bpp, guint * red_mask,
+    guint * green_mask, guint * blue_mask);
  
-#endif // __GST_FREEIMAGEUTILS_H__
\ No newline at end of file
+#endif // __GST_FREEIMAGEUTILS_H__
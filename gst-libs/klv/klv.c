@@ -99,6 +99,8 @@ gst_klv_meta_transform (GstBuffer * dest, GstMeta * meta,
   smeta = (GstKLVMetaImpl *) meta;
 
   if (GST_META_TRANSFORM_IS_COPY (type)) {
+    /* the payload is immutable, so the copy shares it, including any memory
+     * it references */
     dmeta = gst_buffer_add_klv_meta_from_bytes (dest, smeta->bytes);
     if (!dmeta)
       return FALSE;
@@ -244,6 +246,118 @@ gst_buffer_add_klv_meta_take_bytes (GstBuffer * buffer, GBytes * bytes)
   return gst_buffer_add_klv_meta_internal (buffer, bytes);
 }
 
+/* A read mapping of a GstMemory kept for as long as a GBytes needs it */
+typedef struct
+{
+  GstMemory *mem;
+  GstMapInfo map;
+} GstKLVMemoryRegion;
+
+static void
+gst_klv_memory_region_free (gpointer data)
+{
+  GstKLVMemoryRegion *region = data;
+
+  gst_memory_unmap (region->mem, &region->map);
+  gst_memory_unref (region->mem);
+  g_slice_free (GstKLVMemoryRegion, region);
+}
+
+/**
+ * gst_buffer_add_klv_meta_from_memory:
+ * @buffer: a #GstBuffer
+ * @mem: (transfer none): a #GstMemory holding KLV data with 16-byte KLV
+ *     Universal Label prefix
+ * @offset: offset of the KLV data in @mem
+ * @size: size of the KLV data in bytes
+ *
+ * Attaches #GstKLVMeta metadata to @buffer without copying the KLV data.
+ * The meta keeps a reference to @mem and a read mapping of it for as long
+ * as the data is used, so @mem should not be written to afterwards. @mem
+ * may belong to @buffer itself.
+ *
+ * Returns: (transfer none): the #GstKLVMeta on @buffer, or %NULL if @mem
+ *     could not be mapped or doesn't hold valid KLV data.
+ *
+ * Since: 1.18
+ */
+GstKLVMeta *
+gst_buffer_add_klv_meta_from_memory (GstBuffer * buffer, GstMemory * mem,
+    gsize offset, gsize size)
+{
+  GstKLVMemoryRegion *region;
+
+  g_return_val_if_fail (buffer != NULL, NULL);
+  g_return_val_if_fail (mem != NULL, NULL);
+  g_return_val_if_fail (size > 16, NULL);
+
+  region = g_slice_new (GstKLVMemoryRegion);
+  if (!gst_memory_map (mem, &region->map, GST_MAP_READ)) {
+    GST_ERROR ("Failed to map memory holding KLV data");
+    g_slice_free (GstKLVMemoryRegion, region);
+    return NULL;
+  }
+  region->mem = gst_memory_ref (mem);
+
+  if (offset + size > region->map.size) {
+    GST_ERROR ("KLV data exceeds memory size");
+    gst_klv_memory_region_free (region);
+    return NULL;
+  }
+
+  return gst_buffer_add_klv_meta_internal (buffer,
+      g_bytes_new_with_free_func (region->map.data + offset, size,
+          gst_klv_memory_region_free, region));
+}
+
+/**
+ * gst_buffer_add_klv_meta_from_buffer:
+ * @buffer: a #GstBuffer
+ * @src: (transfer none): a #GstBuffer holding KLV data with 16-byte KLV
+ *     Universal Label prefix, may be the same as @buffer
+ * @offset: offset of the KLV data in @src
+ * @size: size of the KLV data in bytes
+ *
+ * Attaches #GstKLVMeta metadata to @buffer, referencing the memory of @src
+ * when the KLV data lies within a single #GstMemory as with
+ * gst_buffer_add_klv_meta_from_memory(), and copying it otherwise.
+ *
+ * Returns: (transfer none): the #GstKLVMeta on @buffer, or %NULL if the
+ *     region is out of range or doesn't hold valid KLV data.
+ *
+ * Since: 1.18
+ */
+GstKLVMeta *
+gst_buffer_add_klv_meta_from_buffer (GstBuffer * buffer, GstBuffer * src,
+    gsize offset, gsize size)
+{
+  guint idx, length;
+  gsize skip;
+  gpointer data;
+
+  g_return_val_if_fail (buffer != NULL, NULL);
+  g_return_val_if_fail (src != NULL, NULL);
+  g_return_val_if_fail (size > 16, NULL);
+
+  if (!gst_buffer_find_memory (src, offset, size, &idx, &length, &skip)) {
+    GST_ERROR ("KLV data exceeds buffer size");
+    return NULL;
+  }
+
+  if (length == 1) {
+    GstMemory *mem = gst_buffer_peek_memory (src, idx);
+
+    return gst_buffer_add_klv_meta_from_memory (buffer, mem, skip, size);
+  }
+
+  /* spread over several memories, which mapping would merge anyway */
+  data = g_malloc (size);
+  gst_buffer_extract (src, offset, data, size);
+
+  return gst_buffer_add_klv_meta_internal (buffer, g_bytes_new_take (data,
+          size));
+}
+
 /* Get KLV meta data from a buffer */
 
 /**
@@ -84,6 +84,12 @@ GstKLVMeta        * gst_buffer_add_klv_meta_from_bytes (GstBuffer * buffer, GByt
 GST_TAG_API
 GstKLVMeta        * gst_buffer_add_klv_meta_take_bytes (GstBuffer * buffer, GBytes * bytes);
 
+GST_TAG_API
+GstKLVMeta        * gst_buffer_add_klv_meta_from_memory (GstBuffer * buffer, GstMemory * mem, gsize offset, gsize size);
+
+GST_TAG_API
+GstKLVMeta        * gst_buffer_add_klv_meta_from_buffer (GstBuffer * buffer, GstBuffer * src, gsize offset, gsize size);
+
 /* Get KLV meta data from a buffer */
 
 GST_TAG_API
@@ -0,0 +1,351 @@
+/* GStreamer KLV Metadata Support Library
+ * Copyright (C) 2026 gst-plugins-vision authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstklvlocalset
+ * @short_description: KLV local set parsing
+ * @title: KLV local set parsing
+ *
+ * <refsect2>
+ * <para>
+ * Parses KLV local set packets such as the MISB ST 0601 UAS Datalink Local
+ * Set. Keys, tags and lengths may use any BER encoding: lengths in short or
+ * long form and tags as BER-OID. While parsing, the offset of every tag is
+ * recorded in the #GstKLVLocalSet, so looking tags up afterwards doesn't
+ * walk the set again.
+ * </para>
+ * <para>
+ * See SMPTE 336M for BER lengths and MISB ST 0601 for the local set and its
+ * checksum.
+ * </para>
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "klvlocalset.h"
+
+/* MISB ST 0601 UAS Datalink Local Set */
+static const guint8 uas_datalink_key[16] = {
+  0x06, 0x0e, 0x2b, 0x34, 0x02, 0x0b, 0x01, 0x01,
+  0x0e, 0x01, 0x03, 0x01, 0x01, 0x00, 0x00, 0x00
+};
+
+/**
+ * gst_klv_parse_ber_length:
+ * @data: (array length=size): BER encoded length
+ * @size: size of @data in bytes
+ * @length: (out): the decoded length
+ * @consumed: (out): number of bytes used by the encoding
+ *
+ * Decodes a short or long form BER length. The indefinite form and lengths
+ * over 8 bytes are not supported.
+ *
+ * Returns: %TRUE if a length could be decoded from @data
+ */
+gboolean
+gst_klv_parse_ber_length (const guint8 * data, gsize size, guint64 * length,
+    guint * consumed)
+{
+  guint i, n;
+  guint64 len;
+
+  g_return_val_if_fail (length != NULL, FALSE);
+  g_return_val_if_fail (consumed != NULL, FALSE);
+
+  if (size == 0)
+    return FALSE;
+
+  if (data[0] < 0x80) {
+    *length = data[0];
+    *consumed = 1;
+    return TRUE;
+  }
+
+  n = data[0] & 0x7f;
+  if (n == 0 || n > 8 || n >= size)
+    return FALSE;
+
+  len = 0;
+  for (i = 1; i <= n; i++)
+    len = (len << 8) | data[i];
+
+  *length = len;
+  *consumed = n + 1;
+  return TRUE;
+}
+
+/**
+ * gst_klv_parse_ber_oid:
+ * @data: (array length=size): BER-OID encoded tag
+ * @size: size of @data in bytes
+ * @tag: (out): the decoded tag
+ * @consumed: (out): number of bytes used by the encoding
+ *
+ * Decodes a BER-OID tag, seven bits per byte with the high bit set on all
+ * bytes but the last. Tags of up to four bytes are supported.
+ *
+ * Returns: %TRUE if a tag could be decoded from @data
+ */
+gboolean
+gst_klv_parse_ber_oid (const guint8 * data, gsize size, guint32 * tag,
+    guint * consumed)
+{
+  guint32 value = 0;
+  guint i;
+
+  g_return_val_if_fail (tag != NULL, FALSE);
+  g_return_val_if_fail (consumed != NULL, FALSE);
+
+  for (i = 0; i < size && i < 4; i++) {
+    value = (value << 7) | (data[i] & 0x7f);
+    if (!(data[i] & 0x80)) {
+      *tag = value;
+      *consumed = i + 1;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/* the tag, the offset of its length field and its value, from @pos */
+static gboolean
+gst_klv_local_set_parse_item (const guint8 * value, gsize value_size,
+    gsize pos, guint32 * tag, gsize * len_pos, gsize * item_pos,
+    gsize * item_size)
+{
+  guint64 len;
+  guint n;
+
+  if (!gst_klv_parse_ber_oid (value + pos, value_size - pos, tag, &n))
+    return FALSE;
+  pos += n;
+
+  *len_pos = pos;
+  if (!gst_klv_parse_ber_length (value + pos, value_size - pos, &len, &n))
+    return FALSE;
+  pos += n;
+
+  if (len > value_size - pos)
+    return FALSE;
+
+  *item_pos = pos;
+  *item_size = len;
+  return TRUE;
+}
+
+/**
+ * gst_klv_local_set_parse:
+ * @set: (out caller-allocates): the #GstKLVLocalSet to fill
+ * @data: (array length=size): a KLV packet starting with its 16-byte
+ *     Universal Label key
+ * @size: size of @data in bytes, which may include padding after the packet
+ *
+ * Parses the packet in @data as a local set and indexes its items. When a
+ * tag appears more than once, lookups return the first occurrence. @data is
+ * not copied and must outlive @set.
+ *
+ * Returns: %TRUE if @data holds a complete, well-formed local set
+ */
+gboolean
+gst_klv_local_set_parse (GstKLVLocalSet * set, const guint8 * data, gsize size)
+{
+  guint64 length;
+  guint n;
+  gsize pos;
+
+  g_return_val_if_fail (set != NULL, FALSE);
+  g_return_val_if_fail (data != NULL || size == 0, FALSE);
+
+  memset (set, 0, sizeof (GstKLVLocalSet));
+
+  if (size < 17 || GST_READ_UINT32_BE (data) != 0x060E2B34) {
+    GST_DEBUG ("No KLV Universal Label key");
+    return FALSE;
+  }
+
+  if (!gst_klv_parse_ber_length (data + 16, size - 16, &length, &n) ||
+      length > size - 16 - n) {
+    GST_DEBUG ("Invalid or truncated KLV length");
+    return FALSE;
+  }
+
+  set->data = data;
+  set->value = data + 16 + n;
+  set->value_size = length;
+  set->size = 16 + n + length;
+
+  pos = 0;
+  while (pos < set->value_size) {
+    guint32 tag;
+    gsize len_pos, item_pos, item_size;
+
+    if (!gst_klv_local_set_parse_item (set->value, set->value_size, pos,
+            &tag, &len_pos, &item_pos, &item_size)) {
+      GST_DEBUG ("Malformed local set item at offset %" G_GSIZE_FORMAT, pos);
+      return FALSE;
+    }
+
+    if (tag < GST_KLV_LOCAL_SET_INDEX_SIZE && set->index[tag] == 0)
+      set->index[tag] = len_pos + 1;
+
+    pos = item_pos + item_size;
+  }
+
+  return TRUE;
+}
+
+/**
+ * gst_klv_local_set_is_uas_datalink:
+ * @set: a parsed #GstKLVLocalSet
+ *
+ * Returns: %TRUE if @set has the key of the MISB ST 0601 UAS Datalink Local
+ *     Set
+ */
+gboolean
+gst_klv_local_set_is_uas_datalink (const GstKLVLocalSet * set)
+{
+  g_return_val_if_fail (set != NULL, FALSE);
+
+  return set->data != NULL &&
+      memcmp (set->data, uas_datalink_key, sizeof (uas_datalink_key)) == 0;
+}
+
+/**
+ * gst_klv_local_set_verify_checksum:
+ * @set: a parsed #GstKLVLocalSet
+ *
+ * Checks the MISB ST 0601 checksum, a 16-bit sum of the packet up to the
+ * checksum value taken as big-endian words, carried by the last item.
+ *
+ * Returns: %TRUE if @set ends with a checksum item matching its contents
+ */
+gboolean
+gst_klv_local_set_verify_checksum (const GstKLVLocalSet * set)
+{
+  const guint32 tag = GST_KLV_UAS_DATALINK_TAG_CHECKSUM;
+  guint16 sum = 0;
+  gsize i, n;
+
+  g_return_val_if_fail (set != NULL, FALSE);
+
+  /* tag 1, length 2, two bytes of checksum, and nothing after it */
+  if (set->value_size < 4 || set->index[tag] != set->value_size - 3 + 1 ||
+      set->value[set->value_size - 3] != 0x02)
+    return FALSE;
+
+  n = set->size - 2;
+  for (i = 0; i + 1 < n; i += 2)
+    sum += (set->data[i] << 8) + set->data[i + 1];
+  if (i < n)
+    sum += set->data[i] << 8;
+
+  return sum == GST_READ_UINT16_BE (set->data + n);
+}
+
+/**
+ * gst_klv_local_set_get:
+ * @set: a parsed #GstKLVLocalSet
+ * @tag: the tag to look up
+ * @value: (out) (transfer none): the value of @tag, pointing into the
+ *     packet
+ * @size: (out): the size of the value in bytes
+ *
+ * Looks up @tag, through the index for tags below
+ * %GST_KLV_LOCAL_SET_INDEX_SIZE.
+ *
+ * Returns: %TRUE if @set has @tag
+ */
+gboolean
+gst_klv_local_set_get (const GstKLVLocalSet * set, guint32 tag,
+    const guint8 ** value, gsize * size)
+{
+  gsize pos, len_pos, item_pos, item_size;
+  guint32 item_tag;
+  guint64 len;
+  guint n;
+
+  g_return_val_if_fail (set != NULL, FALSE);
+  g_return_val_if_fail (value != NULL, FALSE);
+  g_return_val_if_fail (size != NULL, FALSE);
+
+  if (tag < GST_KLV_LOCAL_SET_INDEX_SIZE) {
+    if (set->index[tag] == 0)
+      return FALSE;
+
+    /* validated while parsing */
+    pos = set->index[tag] - 1;
+    gst_klv_parse_ber_length (set->value + pos, set->value_size - pos, &len,
+        &n);
+    *value = set->value + pos + n;
+    *size = len;
+    return TRUE;
+  }
+
+  for (pos = 0; pos < set->value_size; pos = item_pos + item_size) {
+    if (!gst_klv_local_set_parse_item (set->value, set->value_size, pos,
+            &item_tag, &len_pos, &item_pos, &item_size))
+      return FALSE;
+
+    if (item_tag == tag) {
+      *value = set->value + item_pos;
+      *size = item_size;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+ * gst_klv_local_set_get_uint:
+ * @set: a parsed #GstKLVLocalSet
+ * @tag: the tag to look up
+ * @value: (out): the value of @tag
+ *
+ * Looks up @tag and decodes its value as a big-endian unsigned integer of
+ * one to eight bytes.
+ *
+ * Returns: %TRUE if @set has @tag with a value of a suitable size
+ */
+gboolean
+gst_klv_local_set_get_uint (const GstKLVLocalSet * set, guint32 tag,
+    guint64 * value)
+{
+  const guint8 *data;
+  gsize i, size;
+  guint64 v = 0;
+
+  g_return_val_if_fail (value != NULL, FALSE);
+
+  if (!gst_klv_local_set_get (set, tag, &data, &size) || size == 0 ||
+      size > 8)
+    return FALSE;
+
+  for (i = 0; i < size; i++)
+    v = (v << 8) | data[i];
+
+  *value = v;
+  return TRUE;
+}
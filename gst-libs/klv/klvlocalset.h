@@ -0,0 +1,97 @@
+/* GStreamer KLV Metadata Support Library
+ * Copyright (C) 2026 gst-plugins-vision authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_KLV_LOCAL_SET_H__
+#define __GST_KLV_LOCAL_SET_H__
+
+#include "klv.h"
+
+G_BEGIN_DECLS
+
+/**
+ * GST_KLV_LOCAL_SET_INDEX_SIZE:
+ *
+ * Tags below this value are looked up through the index of a
+ * #GstKLVLocalSet, which covers every tag defined by MISB ST 0601. Larger
+ * tags are found by walking the set.
+ */
+#define GST_KLV_LOCAL_SET_INDEX_SIZE 256
+
+/**
+ * GST_KLV_UAS_DATALINK_TAG_CHECKSUM:
+ *
+ * MISB ST 0601 tag of the checksum, which must be the last item of the set.
+ */
+#define GST_KLV_UAS_DATALINK_TAG_CHECKSUM 1
+
+/**
+ * GST_KLV_UAS_DATALINK_TAG_TIMESTAMP:
+ *
+ * MISB ST 0601 tag of the precision time stamp, microseconds since the
+ * epoch as an 8-byte unsigned integer.
+ */
+#define GST_KLV_UAS_DATALINK_TAG_TIMESTAMP 2
+
+/**
+ * GstKLVLocalSet:
+ * @data: start of the packet, i.e. its 16-byte Universal Label key
+ * @size: size of the packet, from the key to the end of the value
+ * @value: start of the items
+ * @value_size: size of the items in bytes
+ *
+ * A parsed KLV local set packet. It points into the data it was parsed
+ * from, which must stay valid while the set is used, and holds an index of
+ * the items so a tag is found without walking the set again. It is meant
+ * to live on the stack, parsing never allocates.
+ */
+typedef struct {
+  const guint8 *data;
+  gsize size;
+  const guint8 *value;
+  gsize value_size;
+
+  /*< private >*/
+  /* offset + 1 into value of the length field of each tag, 0 if absent */
+  guint32 index[GST_KLV_LOCAL_SET_INDEX_SIZE];
+} GstKLVLocalSet;
+
+GST_KLV_API
+gboolean            gst_klv_parse_ber_length (const guint8 * data, gsize size, guint64 * length, guint * consumed);
+
+GST_KLV_API
+gboolean            gst_klv_parse_ber_oid (const guint8 * data, gsize size, guint32 * tag, guint * consumed);
+
+GST_KLV_API
+gboolean            gst_klv_local_set_parse (GstKLVLocalSet * set, const guint8 * data, gsize size);
+
+GST_KLV_API
+gboolean            gst_klv_local_set_is_uas_datalink (const GstKLVLocalSet * set);
+
+GST_KLV_API
+gboolean            gst_klv_local_set_verify_checksum (const GstKLVLocalSet * set);
+
+GST_KLV_API
+gboolean            gst_klv_local_set_get (const GstKLVLocalSet * set, guint32 tag, const guint8 ** value, gsize * size);
+
+GST_KLV_API
+gboolean            gst_klv_local_set_get_uint (const GstKLVLocalSet * set, guint32 tag, guint64 * value);
+
+G_END_DECLS
+
+#endif /* __GST_KLV_LOCAL_SET_H__ */
@@ -0,0 +1,302 @@
+/* GStreamer
+ * Copyright (C) 2026 gst-plugins-vision authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstparallel
+ * @short_description: row band parallelism for video filters
+ *
+ * <refsect2>
+ * <para>
+ * A #GstParallelRunner splits a frame into horizontal bands of rows and
+ * processes them on a set of worker threads that live as long as the runner,
+ * similar to the task runner used internally by videoconvert. The calling
+ * thread always processes one of the bands itself, so a runner with one
+ * thread never creates any threads and simply calls the function inline.
+ * </para>
+ * <para>
+ * A runner must only be used from one thread at a time, typically the
+ * streaming thread of the element that owns it.
+ * </para>
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+
+#include "parallel.h"
+
+struct _GstParallelRunner
+{
+  guint n_threads;
+  GThread **threads;
+
+  GMutex lock;
+  GCond cond_todo;
+  GCond cond_done;
+  gboolean quit;
+
+  /* current job, protected by lock */
+  GstParallelRowFunc func;
+  gpointer user_data;
+  gint n_rows;
+  gint band_rows;
+  guint n_bands;
+  guint next_band;
+  guint n_done;
+};
+
+static guint
+gst_parallel_runner_clamp_n_threads (guint n_threads)
+{
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  return MIN (n_threads, GST_PARALLEL_MAX_THREADS);
+}
+
+/* called with the lock held, returns with the lock held */
+static void
+gst_parallel_runner_process_bands (GstParallelRunner * runner)
+{
+  while (runner->next_band < runner->n_bands) {
+    guint band = runner->next_band++;
+    gint row_start = band * runner->band_rows;
+    gint row_end = MIN (row_start + runner->band_rows, runner->n_rows);
+
+    g_mutex_unlock (&runner->lock);
+    runner->func (runner->user_data, band, row_start, row_end);
+    g_mutex_lock (&runner->lock);
+
+    if (++runner->n_done == runner->n_bands)
+      g_cond_signal (&runner->cond_done);
+  }
+}
+
+static gpointer
+gst_parallel_runner_thread_func (gpointer data)
+{
+  GstParallelRunner *runner = (GstParallelRunner *) data;
+
+  g_mutex_lock (&runner->lock);
+  while (TRUE) {
+    while (!runner->quit && runner->next_band >= runner->n_bands)
+      g_cond_wait (&runner->cond_todo, &runner->lock);
+
+    if (runner->quit)
+      break;
+
+    gst_parallel_runner_process_bands (runner);
+  }
+  g_mutex_unlock (&runner->lock);
+
+  return NULL;
+}
+
+/**
+ * gst_parallel_runner_new:
+ * @n_threads: total number of threads to use, including the calling thread,
+ *   or 0 to use one thread per processor
+ *
+ * Creates a runner and starts its worker threads. At most
+ * %GST_PARALLEL_MAX_THREADS threads are used.
+ *
+ * Returns: a new #GstParallelRunner, free with gst_parallel_runner_free()
+ *
+ * Since: 1.18
+ */
+GstParallelRunner *
+gst_parallel_runner_new (guint n_threads)
+{
+  GstParallelRunner *runner;
+  guint i;
+
+  n_threads = gst_parallel_runner_clamp_n_threads (n_threads);
+
+  runner = g_new0 (GstParallelRunner, 1);
+  runner->n_threads = n_threads;
+  g_mutex_init (&runner->lock);
+  g_cond_init (&runner->cond_todo);
+  g_cond_init (&runner->cond_done);
+
+  if (n_threads > 1) {
+    runner->threads = g_new0 (GThread *, n_threads - 1);
+    for (i = 0; i < n_threads - 1; i++) {
+      runner->threads[i] = g_thread_new ("parallel-runner",
+          gst_parallel_runner_thread_func, runner);
+    }
+  }
+
+  return runner;
+}
+
+/**
+ * gst_parallel_runner_free:
+ * @runner: a #GstParallelRunner
+ *
+ * Stops and joins the worker threads and frees the runner.
+ *
+ * Since: 1.18
+ */
+void
+gst_parallel_runner_free (GstParallelRunner * runner)
+{
+  guint i;
+
+  g_return_if_fail (runner != NULL);
+
+  g_mutex_lock (&runner->lock);
+  runner->quit = TRUE;
+  g_cond_broadcast (&runner->cond_todo);
+  g_mutex_unlock (&runner->lock);
+
+  for (i = 0; runner->threads && i < runner->n_threads - 1; i++)
+    g_thread_join (runner->threads[i]);
+  g_free (runner->threads);
+
+  g_mutex_clear (&runner->lock);
+  g_cond_clear (&runner->cond_todo);
+  g_cond_clear (&runner->cond_done);
+  g_free (runner);
+}
+
+/**
+ * gst_parallel_runner_get_n_threads:
+ * @runner: a #GstParallelRunner
+ *
+ * Returns: the number of threads, and so the maximum number of bands, used
+ *   by @runner
+ *
+ * Since: 1.18
+ */
+guint
+gst_parallel_runner_get_n_threads (GstParallelRunner * runner)
+{
+  g_return_val_if_fail (runner != NULL, 0);
+
+  return runner->n_threads;
+}
+
+/**
+ * gst_parallel_runner_ensure:
+ * @runner: (inout) (nullable): location of a #GstParallelRunner pointer
+ * @n_threads: wanted number of threads, or 0 to use one thread per processor
+ *
+ * Makes sure *@runner uses @n_threads threads, replacing it when it is %NULL
+ * or was created with a different number of threads. Elements call this from
+ * their streaming thread before every frame, so an n-threads property can be
+ * changed at any time. The caller frees *@runner with
+ * gst_parallel_runner_free() when it is done.
+ *
+ * Returns: (transfer none): the runner in *@runner
+ *
+ * Since: 1.18
+ */
+GstParallelRunner *
+gst_parallel_runner_ensure (GstParallelRunner ** runner, guint n_threads)
+{
+  g_return_val_if_fail (runner != NULL, NULL);
+
+  n_threads = gst_parallel_runner_clamp_n_threads (n_threads);
+
+  if (*runner && (*runner)->n_threads != n_threads) {
+    gst_parallel_runner_free (*runner);
+    *runner = NULL;
+  }
+
+  if (*runner == NULL)
+    *runner = gst_parallel_runner_new (n_threads);
+
+  return *runner;
+}
+
+/**
+ * gst_parallel_runner_run_rows:
+ * @runner: a #GstParallelRunner
+ * @n_rows: number of rows to process
+ * @align: bands other than the last start on a multiple of this many rows,
+ *   e.g. 2 for Bayer or vertically subsampled chroma
+ * @func: function called once per band
+ * @user_data: data passed to @func
+ *
+ * Splits @n_rows into at most one band per thread and calls @func for each
+ * band, blocking until all bands are done.
+ *
+ * Since: 1.18
+ */
+void
+gst_parallel_runner_run_rows (GstParallelRunner * runner, gint n_rows,
+    gint align, GstParallelRowFunc func, gpointer user_data)
+{
+  gint band_rows;
+
+  g_return_if_fail (runner != NULL);
+  g_return_if_fail (func != NULL);
+  g_return_if_fail (align > 0);
+
+  if (n_rows <= 0)
+    return;
+
+  band_rows = (n_rows + runner->n_threads - 1) / runner->n_threads;
+  band_rows = (band_rows + align - 1) / align * align;
+
+  if (runner->n_threads == 1 || band_rows >= n_rows) {
+    func (user_data, 0, 0, n_rows);
+    return;
+  }
+
+  g_mutex_lock (&runner->lock);
+  runner->func = func;
+  runner->user_data = user_data;
+  runner->n_rows = n_rows;
+  runner->band_rows = band_rows;
+  runner->n_bands = (n_rows + band_rows - 1) / band_rows;
+  runner->next_band = 0;
+  runner->n_done = 0;
+  g_cond_broadcast (&runner->cond_todo);
+
+  /* the calling thread takes bands too, then waits for the stragglers */
+  gst_parallel_runner_process_bands (runner);
+  while (runner->n_done < runner->n_bands)
+    g_cond_wait (&runner->cond_done, &runner->lock);
+  g_mutex_unlock (&runner->lock);
+}
+
+/**
+ * gst_parallel_param_spec_n_threads:
+ *
+ * Creates the n-threads property shared by the elements using a
+ * #GstParallelRunner, so they all accept the same range and can all change
+ * it while playing, since gst_parallel_runner_ensure() picks the new value
+ * up on the next frame.
+ *
+ * Returns: (transfer floating): a new #GParamSpec
+ *
+ * Since: 1.18
+ */
+GParamSpec *
+gst_parallel_param_spec_n_threads (void)
+{
+  return g_param_spec_uint ("n-threads", "Threads",
+      "Number of threads used to process row bands (0 uses one per processor)",
+      0, GST_PARALLEL_MAX_THREADS, 0,
+      G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING);
+}
@@ -0,0 +1,81 @@
+/* GStreamer
+ * Copyright (C) 2026 gst-plugins-vision authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_PARALLEL_H__
+#define __GST_PARALLEL_H__
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GST_PARALLEL_MAX_THREADS:
+ *
+ * Upper bound on the number of threads of a #GstParallelRunner, and the
+ * maximum of the n-threads property.
+ *
+ * Since: 1.18
+ */
+#define GST_PARALLEL_MAX_THREADS 256
+
+/**
+ * GstParallelRunner:
+ *
+ * Opaque structure owning a set of persistent worker threads that process
+ * bands of rows in parallel.
+ *
+ * Since: 1.18
+ */
+typedef struct _GstParallelRunner GstParallelRunner;
+
+/**
+ * GstParallelRowFunc:
+ * @user_data: user data passed to gst_parallel_runner_run_rows()
+ * @band: index of the band, from 0 to the number of threads - 1
+ * @row_start: first row of the band
+ * @row_end: one past the last row of the band
+ *
+ * Processes rows [@row_start, @row_end). Bands never overlap, and @band can
+ * be used to index per-thread scratch data such as partial histograms.
+ *
+ * Since: 1.18
+ */
+typedef void (*GstParallelRowFunc) (gpointer user_data, guint band,
+    gint row_start, gint row_end);
+
+GstParallelRunner * gst_parallel_runner_new (guint n_threads);
+
+void                gst_parallel_runner_free (GstParallelRunner * runner);
+
+guint               gst_parallel_runner_get_n_threads (GstParallelRunner * runner);
+
+GstParallelRunner * gst_parallel_runner_ensure (GstParallelRunner ** runner,
+                                                guint n_threads);
+
+void                gst_parallel_runner_run_rows (GstParallelRunner * runner,
+                                                  gint n_rows,
+                                                  gint align,
+                                                  GstParallelRowFunc func,
+                                                  gpointer user_data);
+
+GParamSpec *        gst_parallel_param_spec_n_threads (void);
+
+G_END_DECLS
+
+#endif /* __GST_PARALLEL_H__ */
@@ -24,7 +24,9 @@
 /**
 * SECTION:element-bayer2gray
 *
-* Convert grayscale video from one bpp/depth combination to another.
+* Relabel Bayer video as grayscale video without touching the pixel data.
+* Buffers are passed through in place, only their #GstVideoMeta is replaced
+* when upstream provided one, so downstream sees the same strides.
 *
 * <refsect2>
 * <title>Example launch line</title>
@@ -102,8 +104,8 @@ static GstCaps *gst_bayer2gray_transform_caps (GstBaseTransform * trans,
     GstPadDirection direction, GstCaps * caps, GstCaps * filter_caps);
 static gboolean gst_bayer2gray_set_caps (GstBaseTransform * btrans,
     GstCaps * incaps, GstCaps * outcaps);
-static GstFlowReturn gst_bayer2gray_transform (GstBaseTransform * btrans,
-    GstBuffer * inbuf, GstBuffer * outbuf);
+static gboolean gst_bayer2gray_propose_allocation (GstBaseTransform * trans,
+    GstQuery * decide_query, GstQuery * query);
 static GstFlowReturn gst_bayer2gray_transform_ip (GstBaseTransform * btrans,
     GstBuffer * buf);
 
@@ -175,8 +177,8 @@ gst_bayer2gray_class_init (GstBayer2GrayClass * klass)
       GST_DEBUG_FUNCPTR (gst_bayer2gray_transform_caps);
   gstbasetransform_class->set_caps =
       GST_DEBUG_FUNCPTR (gst_bayer2gray_set_caps);
-  gstbasetransform_class->transform =
-      GST_DEBUG_FUNCPTR (gst_bayer2gray_transform);
+  gstbasetransform_class->propose_allocation =
+      GST_DEBUG_FUNCPTR (gst_bayer2gray_propose_allocation);
   gstbasetransform_class->transform_ip =
       GST_DEBUG_FUNCPTR (gst_bayer2gray_transform_ip);
 }
@@ -186,8 +188,9 @@ gst_bayer2gray_init (GstBayer2Gray * filt)
 {
   GST_DEBUG_OBJECT (filt, "init class instance");
 
-  /* FIXME: fix in-place transform */
-  gst_base_transform_set_in_place (GST_BASE_TRANSFORM (filt), FALSE);
+  /* pixel data is never touched, so non-writable buffers are only shallow
+   * copied by the base class to make their metadata writable */
+  gst_base_transform_set_in_place (GST_BASE_TRANSFORM (filt), TRUE);
 
   gst_bayer2gray_reset (filt);
 }
@@ -222,17 +225,23 @@ gst_bayer2gray_get_property (GObject * object, guint prop_id, GValue * value,
   }
 }
 
+/**
+ * gst_bayer2gray_caps_transform:
+ * @direction: the pad direction @caps apply to
+ * @caps: Bayer caps on the sink side or gray caps on the src side
+ *
+ * Maps Bayer caps to the gray caps with the same size, depth and byte order,
+ * or the reverse. Other elements of the plugin build their own caps on top.
+ *
+ * Returns: (transfer full): the caps on the other side
+ */
 GstCaps *
-gst_bayer2gray_transform_caps (GstBaseTransform * trans,
-    GstPadDirection direction, GstCaps * caps, GstCaps * filter_caps)
+gst_bayer2gray_caps_transform (GstPadDirection direction, GstCaps * caps)
 {
-  GstBayer2Gray *filt = GST_BAYER2GRAY (trans);
   GstCaps *normalized_caps, *other_caps;
   GstCaps *bayer8_caps, *bayer16_caps, *gray8_caps, *gray16_caps;
   guint i, n;
 
-  GST_LOG_OBJECT (filt, "transforming caps from %" GST_PTR_FORMAT, caps);
-
   other_caps = gst_caps_new_empty ();
   normalized_caps = gst_caps_normalize (gst_caps_ref (caps));
   gray8_caps = gst_caps_from_string (GST_VIDEO_CAPS_MAKE ("GRAY8"));
@@ -246,6 +255,7 @@ gst_bayer2gray_transform_caps (GstBaseTransform * trans,
     GstCaps *c = gst_caps_copy_nth (normalized_caps, i);
     GstStructure *s, *s_other;
     const GstCaps *tgt_caps = NULL;
+    gboolean have_format = FALSE;
     if (i > 0 && gst_caps_is_subset (other_caps, c))
       continue;
 
@@ -266,9 +276,27 @@ gst_bayer2gray_transform_caps (GstBaseTransform * trans,
     }
     s = gst_caps_get_structure (c, 0);
     s_other = gst_caps_get_structure (tgt_caps, 0);
+
+    /* the data is reinterpreted as is, so byte order must carry over */
+    if (tgt_caps == gray16_caps) {
+      gint endianness;
+      if (gst_structure_get_int (s, "endianness", &endianness)) {
+        gst_structure_set (s, "format", G_TYPE_STRING,
+            endianness == G_BIG_ENDIAN ? "GRAY16_BE" : "GRAY16_LE", NULL);
+        have_format = TRUE;
+      }
+    } else if (tgt_caps == bayer16_caps) {
+      const gchar *format = gst_structure_get_string (s, "format");
+      if (format)
+        gst_structure_set (s, "endianness", G_TYPE_INT,
+            g_str_equal (format, "GRAY16_BE") ? G_BIG_ENDIAN : G_LITTLE_ENDIAN,
+            NULL);
+    }
+
     gst_structure_set_name (s, gst_structure_get_name (s_other));
-    gst_structure_set_value (s, "format", gst_structure_get_value (s_other,
-            "format"));
+    if (!have_format)
+      gst_structure_set_value (s, "format", gst_structure_get_value (s_other,
+              "format"));
 
     gst_caps_merge (other_caps, c);
   }
@@ -279,6 +307,20 @@ gst_bayer2gray_transform_caps (GstBaseTransform * trans,
   gst_caps_unref (bayer16_caps);
   gst_caps_unref (normalized_caps);
 
+  return other_caps;
+}
+
+static GstCaps *
+gst_bayer2gray_transform_caps (GstBaseTransform * trans,
+    GstPadDirection direction, GstCaps * caps, GstCaps * filter_caps)
+{
+  GstBayer2Gray *filt = GST_BAYER2GRAY (trans);
+  GstCaps *other_caps;
+
+  GST_LOG_OBJECT (filt, "transforming caps from %" GST_PTR_FORMAT, caps);
+
+  other_caps = gst_bayer2gray_caps_transform (direction, caps);
+
   if (!gst_caps_is_empty (other_caps) && filter_caps) {
     GstCaps *tmp = gst_caps_intersect_full (filter_caps, other_caps,
         GST_CAPS_INTERSECT_FIRST);
@@ -308,38 +350,48 @@ gst_bayer2gray_set_caps (GstBaseTransform * btrans, GstCaps * incaps,
   return res;
 }
 
-static GstFlowReturn
-gst_bayer2gray_transform (GstBaseTransform * btrans,
-    GstBuffer * inbuf, GstBuffer * outbuf)
+static gboolean
+gst_bayer2gray_propose_allocation (GstBaseTransform * trans,
+    GstQuery * decide_query, GstQuery * query)
 {
-  GstBayer2Gray *filt = GST_BAYER2GRAY (btrans);
-  GstMapInfo minfo_in, minfo_out;
-
-  GST_LOG_OBJECT (filt, "Doing non-inplace transform, copying data (FIX THIS)");
+  /* we translate any upstream video meta, so strides can be arbitrary */
+  gst_query_add_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
 
-  gst_buffer_map (inbuf, &minfo_in, GST_MAP_READ);
-  gst_buffer_map (outbuf, &minfo_out, GST_MAP_WRITE);
-  memcpy (minfo_out.data, minfo_in.data, minfo_in.size);
-  gst_buffer_unmap (inbuf, &minfo_in);
-  gst_buffer_unmap (outbuf, &minfo_out);
-
-  return GST_FLOW_OK;
+  return GST_BASE_TRANSFORM_CLASS (gst_bayer2gray_parent_class)->
+      propose_allocation (trans, decide_query, query);
 }
 
-/* FIXME: inplace transform doesn't work now due to buffer meta issue with
-   videoconvert, or really at least all elements using videofilter base
-   class */
 static GstFlowReturn
 gst_bayer2gray_transform_ip (GstBaseTransform * btrans, GstBuffer * buf)
 {
   GstBayer2Gray *filt = GST_BAYER2GRAY (btrans);
+  GstVideoMeta *meta;
+  gsize offset[GST_VIDEO_MAX_PLANES] = { 0, };
+  gint stride[GST_VIDEO_MAX_PLANES] = { 0, };
+  GstVideoFrameFlags flags;
+
+  meta = gst_buffer_get_video_meta (buf);
+  if (meta == NULL) {
+    /* default Bayer and gray strides are the same, nothing to relabel */
+    GST_LOG_OBJECT (filt, "in-place transform, doing nothing");
+    return GST_FLOW_OK;
+  }
+
+  offset[0] = meta->offset[0];
+  stride[0] = meta->stride[0];
+  flags = meta->flags;
+
+  /* drop the Bayer meta, a stale format would make downstream mapping fail */
+  while ((meta = gst_buffer_get_video_meta (buf)) != NULL)
+    gst_buffer_remove_meta (buf, (GstMeta *) meta);
 
-  GST_LOG_OBJECT (filt, "in-place transform, doing nothing");
+  GST_LOG_OBJECT (filt, "relabeling video meta, offset %" G_GSIZE_FORMAT
+      ", stride %d", offset[0], stride[0]);
+
+  gst_buffer_add_video_meta_full (buf, flags,
+      GST_VIDEO_INFO_FORMAT (&filt->vinfo), GST_VIDEO_INFO_WIDTH (&filt->vinfo),
+      GST_VIDEO_INFO_HEIGHT (&filt->vinfo), 1, offset, stride);
 
-  gst_buffer_add_video_meta (buf, GST_VIDEO_FRAME_FLAG_NONE,
-      filt->vinfo.finfo->format, filt->vinfo.width, filt->vinfo.height);
-  GST_ERROR ("%d,%d,%d", filt->vinfo.finfo->format, filt->vinfo.width,
-      filt->vinfo.height);
   return GST_FLOW_OK;
 }
 
@@ -347,28 +399,3 @@ static void
 gst_bayer2gray_reset (GstBayer2Gray * bayer2gray)
 {
 }
-
-/* Register filters that make up the gstgl plugin */
-static gboolean
-plugin_init (GstPlugin * plugin)
-{
-  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, "bayer2gray", 0, "bayer2gray");
-
-  GST_DEBUG ("plugin_init");
-
-  GST_CAT_INFO (GST_CAT_DEFAULT, "registering bayer2gray element");
-
-  if (!gst_element_register (plugin, "bayer2gray", GST_RANK_NONE,
-          GST_TYPE_BAYER2GRAY)) {
-    return FALSE;
-  }
-
-  return TRUE;
-}
-
-GST_PLUGIN_DEFINE (GST_VERSION_MAJOR,
-    GST_VERSION_MINOR,
-    bayerutils,
-    "Plugins for working with Bayer video",
-    plugin_init, GST_PACKAGE_VERSION, GST_PACKAGE_LICENSE, GST_PACKAGE_NAME,
-    GST_PACKAGE_ORIGIN);
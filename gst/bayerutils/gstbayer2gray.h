@@ -73,6 +73,9 @@ struct _GstBayer2GrayClass
 
 GType gst_bayer2gray_get_type(void);
 
+GstCaps *gst_bayer2gray_caps_transform (GstPadDirection direction,
+    GstCaps * caps);
+
 G_END_DECLS
 
 #endif /* __GST_BAYER2GRAY_H__ */
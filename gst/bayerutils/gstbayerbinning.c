@@ -0,0 +1,666 @@
+/* GStreamer
+ * Copyright (C) <1999> Erik Walthinsen <omega@cse.ogi.edu>
+ * Copyright (C) <2003> David Schleef <ds@schleef.org>
+ * Copyright (C) 2003 Arwed v. Merkatz <v.merkatz@gmx.net>
+ * Copyright (C) 2006 Mark Nauwelaerts <manauw@skynet.be>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+* SECTION:element-bayerbinning
+*
+* Reduces Bayer video by an integer factor straight from the color filter
+* array, for previews that don't need a full resolution demosaic. In rgb
+* mode each NxN block becomes one pixel holding the mean of its red, green
+* and blue samples, the 2x2 case being the classic superpixel demosaic. In
+* gray mode all samples of a block are averaged into one gray pixel.
+*
+* <refsect2>
+* <title>Example launch line</title>
+* |[
+* gst-launch-1.0 pylonsrc ! bayerbinning factor=4 ! videoconvert ! autovideosink
+* ]|
+* </refsect2>
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "gstbayerbinning.h"
+#include "gstbayer2gray.h"
+#include "genicampixelformat.h"
+
+#include <gst/video/video.h>
+
+enum
+{
+  PROP_0,
+  PROP_MODE,
+  PROP_FACTOR
+};
+
+#define DEFAULT_PROP_MODE GST_BAYER_BINNING_MODE_RGB
+#define DEFAULT_PROP_FACTOR 2
+
+#define VIDEO_CAPS_RGB8 GST_VIDEO_CAPS_MAKE ("{ RGBx, RGB }")
+#define VIDEO_CAPS_RGB16 GST_VIDEO_CAPS_MAKE ("ARGB64")
+
+static GstStaticPadTemplate gst_bayer_binning_sink_template =
+    GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_GENICAM_PIXEL_FORMAT_MAKE_BAYER8
+        ("{ bggr, grbg, gbrg, rggb }") ";"
+        GST_GENICAM_PIXEL_FORMAT_MAKE_BAYER16
+        ("{ bggr16, grbg16, gbrg16, rggb16 }", "{1234, 4321}"))
+    );
+
+static GstStaticPadTemplate gst_bayer_binning_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE
+        ("{ RGBx, RGB, ARGB64, GRAY8, GRAY16_LE, GRAY16_BE }"))
+    );
+
+#define GST_TYPE_BAYER_BINNING_MODE (gst_bayer_binning_mode_get_type())
+static GType
+gst_bayer_binning_mode_get_type (void)
+{
+  static GType bayer_binning_mode_type = 0;
+  static const GEnumValue bayer_binning_mode[] = {
+    {GST_BAYER_BINNING_MODE_RGB, "RGB superpixels", "rgb"},
+    {GST_BAYER_BINNING_MODE_GRAY, "Gray binning", "gray"},
+    {0, NULL, NULL},
+  };
+
+  if (!bayer_binning_mode_type) {
+    bayer_binning_mode_type =
+        g_enum_register_static ("GstBayerBinningMode", bayer_binning_mode);
+  }
+  return bayer_binning_mode_type;
+}
+
+/* GObject vmethod declarations */
+static void gst_bayer_binning_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_bayer_binning_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+static void gst_bayer_binning_dispose (GObject * object);
+
+/* GstBaseTransform vmethod declarations */
+static GstCaps *gst_bayer_binning_transform_caps (GstBaseTransform * trans,
+    GstPadDirection direction, GstCaps * caps, GstCaps * filter_caps);
+static gboolean gst_bayer_binning_get_unit_size (GstBaseTransform * trans,
+    GstCaps * caps, gsize * size);
+static gboolean gst_bayer_binning_set_caps (GstBaseTransform * btrans,
+    GstCaps * incaps, GstCaps * outcaps);
+static GstFlowReturn gst_bayer_binning_transform (GstBaseTransform * btrans,
+    GstBuffer * inbuf, GstBuffer * outbuf);
+
+/* setup debug */
+GST_DEBUG_CATEGORY_STATIC (bayer_binning_debug);
+#define GST_CAT_DEFAULT bayer_binning_debug
+
+G_DEFINE_TYPE (GstBayerBinning, gst_bayer_binning, GST_TYPE_BASE_TRANSFORM);
+
+/************************************************************************/
+/* GObject vmethod implementations                                      */
+/************************************************************************/
+
+static void
+gst_bayer_binning_dispose (GObject * object)
+{
+  GstBayerBinning *filt = GST_BAYER_BINNING (object);
+
+  GST_DEBUG ("dispose");
+
+  g_free (filt->sums);
+  filt->sums = NULL;
+  filt->sums_size = 0;
+
+  /* chain up to the parent class */
+  G_OBJECT_CLASS (gst_bayer_binning_parent_class)->dispose (object);
+}
+
+static void
+gst_bayer_binning_class_init (GstBayerBinningClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+  GstBaseTransformClass *gstbasetransform_class =
+      GST_BASE_TRANSFORM_CLASS (klass);
+
+  GST_DEBUG_CATEGORY_INIT (bayer_binning_debug, "bayerbinning", 0,
+      "Bayer binning filter");
+
+  GST_DEBUG ("class init");
+
+  /* Register GObject vmethods */
+  gobject_class->dispose = GST_DEBUG_FUNCPTR (gst_bayer_binning_dispose);
+  gobject_class->set_property =
+      GST_DEBUG_FUNCPTR (gst_bayer_binning_set_property);
+  gobject_class->get_property =
+      GST_DEBUG_FUNCPTR (gst_bayer_binning_get_property);
+
+  /* Install GObject properties */
+  g_object_class_install_property (gobject_class, PROP_MODE,
+      g_param_spec_enum ("mode", "Mode", "How the samples of a block combine",
+          GST_TYPE_BAYER_BINNING_MODE, DEFAULT_PROP_MODE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_FACTOR,
+      g_param_spec_uint ("factor", "Factor",
+          "Size of the square block reduced to one pixel (rounded down to even in rgb mode)",
+          2, 64, DEFAULT_PROP_FACTOR,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&gst_bayer_binning_sink_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&gst_bayer_binning_src_template));
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "Bayer binning", "Filter/Converter/Video/Scaler",
+      "Bins 8- and 16-bit Bayer video into reduced size RGB or gray",
+      "Joshua M. Doe <oss@nvl.army.mil>");
+
+  /* Register GstBaseTransform vmethods */
+  gstbasetransform_class->transform_caps =
+      GST_DEBUG_FUNCPTR (gst_bayer_binning_transform_caps);
+  gstbasetransform_class->get_unit_size =
+      GST_DEBUG_FUNCPTR (gst_bayer_binning_get_unit_size);
+  gstbasetransform_class->set_caps =
+      GST_DEBUG_FUNCPTR (gst_bayer_binning_set_caps);
+  gstbasetransform_class->transform =
+      GST_DEBUG_FUNCPTR (gst_bayer_binning_transform);
+}
+
+static void
+gst_bayer_binning_init (GstBayerBinning * filt)
+{
+  GST_DEBUG_OBJECT (filt, "init class instance");
+
+  filt->mode = DEFAULT_PROP_MODE;
+  filt->factor = DEFAULT_PROP_FACTOR;
+}
+
+static void
+gst_bayer_binning_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstBayerBinning *filt = GST_BAYER_BINNING (object);
+
+  GST_DEBUG_OBJECT (filt, "setting property %s", pspec->name);
+
+  switch (prop_id) {
+    case PROP_MODE:
+      GST_OBJECT_LOCK (filt);
+      filt->mode = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (filt);
+      gst_base_transform_reconfigure_src (GST_BASE_TRANSFORM (filt));
+      break;
+    case PROP_FACTOR:
+      GST_OBJECT_LOCK (filt);
+      filt->factor = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (filt);
+      gst_base_transform_reconfigure_src (GST_BASE_TRANSFORM (filt));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_bayer_binning_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstBayerBinning *filt = GST_BAYER_BINNING (object);
+
+  GST_DEBUG_OBJECT (filt, "getting property %s", pspec->name);
+
+  switch (prop_id) {
+    case PROP_MODE:
+      g_value_set_enum (value, filt->mode);
+      break;
+    case PROP_FACTOR:
+      g_value_set_uint (value, filt->factor);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+/************************************************************************/
+/* GstBaseTransform vmethod implementations                             */
+/************************************************************************/
+
+/* superpixels must cover whole CFA cells, so rgb mode needs an even factor */
+static gint
+gst_bayer_binning_get_factor (GstBayerBinning * filt)
+{
+  if (filt->mode == GST_BAYER_BINNING_MODE_RGB)
+    return MAX (filt->factor & ~1, 2);
+  return filt->factor;
+}
+
+/* v * factor, or the last size binning to v, saturating at G_MAXINT */
+static gint
+scale_up (gint v, gint factor, gboolean last)
+{
+  if (v > (G_MAXINT - factor + 1) / factor)
+    return G_MAXINT;
+  return v * factor + (last ? factor - 1 : 0);
+}
+
+/* scale a width or height from the Bayer side to the binned side, or back to
+ * every Bayer size that bins to it */
+static void
+scale_dimension (GstStructure * s, const gchar * field, gint factor,
+    GstPadDirection direction)
+{
+  const GValue *value = gst_structure_get_value (s, field);
+  gint min, max;
+
+  if (value == NULL)
+    return;
+
+  if (G_VALUE_HOLDS_INT (value)) {
+    min = max = g_value_get_int (value);
+  } else if (GST_VALUE_HOLDS_INT_RANGE (value)) {
+    min = gst_value_get_int_range_min (value);
+    max = gst_value_get_int_range_max (value);
+  } else {
+    return;
+  }
+
+  if (direction == GST_PAD_SINK) {
+    min = MAX (min / factor, 1);
+    max = MAX (max / factor, 1);
+  } else {
+    min = scale_up (min, factor, FALSE);
+    max = scale_up (max, factor, TRUE);
+  }
+
+  if (min == max)
+    gst_structure_set (s, field, G_TYPE_INT, min, NULL);
+  else
+    gst_structure_set (s, field, GST_TYPE_INT_RANGE, min, max, NULL);
+}
+
+static GstCaps *
+gst_bayer_binning_transform_caps (GstBaseTransform * trans,
+    GstPadDirection direction, GstCaps * caps, GstCaps * filter_caps)
+{
+  GstBayerBinning *filt = GST_BAYER_BINNING (trans);
+  GstCaps *normalized_caps, *other_caps, *tmp;
+  GstCaps *rgb8_caps, *rgb16_caps, *gray8_caps, *gray16_caps;
+  GstBayerBinningMode mode;
+  gint factor;
+  guint i, n;
+
+  GST_LOG_OBJECT (filt, "transforming caps from %" GST_PTR_FORMAT, caps);
+
+  GST_OBJECT_LOCK (filt);
+  mode = filt->mode;
+  factor = gst_bayer_binning_get_factor (filt);
+  GST_OBJECT_UNLOCK (filt);
+
+  rgb8_caps = gst_caps_from_string (VIDEO_CAPS_RGB8);
+  rgb16_caps = gst_caps_from_string (VIDEO_CAPS_RGB16);
+  gray8_caps = gst_caps_from_string (GST_VIDEO_CAPS_MAKE ("GRAY8"));
+  gray16_caps =
+      gst_caps_from_string (GST_VIDEO_CAPS_MAKE ("{ GRAY16_LE, GRAY16_BE }"));
+
+  /* the binned side matches the gray caps bayer2gray would produce, with
+   * the size divided and, in rgb mode, the format swapped for RGB of the
+   * same depth */
+  if (direction == GST_PAD_SINK)
+    normalized_caps = gst_bayer2gray_caps_transform (direction, caps);
+  else
+    normalized_caps = gst_caps_normalize (gst_caps_ref (caps));
+
+  tmp = gst_caps_new_empty ();
+  n = gst_caps_get_size (normalized_caps);
+  for (i = 0; i < n; ++i) {
+    GstCaps *c = gst_caps_copy_nth (normalized_caps, i);
+    GstStructure *s = gst_caps_get_structure (c, 0);
+    const GstCaps *tgt_caps = NULL;
+
+    if (mode == GST_BAYER_BINNING_MODE_RGB) {
+      if (direction == GST_PAD_SINK) {
+        tgt_caps = gst_caps_is_subset (c, gray8_caps) ? rgb8_caps : rgb16_caps;
+      } else if (gst_caps_is_subset (c, rgb8_caps)) {
+        tgt_caps = gray8_caps;
+      } else if (gst_caps_is_subset (c, rgb16_caps)) {
+        tgt_caps = gray16_caps;
+      } else {
+        /* gray caps can't be produced in rgb mode */
+        gst_caps_unref (c);
+        continue;
+      }
+    } else if (direction == GST_PAD_SRC && !gst_caps_is_subset (c, gray8_caps)
+        && !gst_caps_is_subset (c, gray16_caps)) {
+      gst_caps_unref (c);
+      continue;
+    }
+
+    if (tgt_caps)
+      gst_structure_set_value (s, "format",
+          gst_structure_get_value (gst_caps_get_structure (tgt_caps, 0),
+              "format"));
+
+    scale_dimension (s, "width", factor, direction);
+    scale_dimension (s, "height", factor, direction);
+
+    gst_caps_merge (tmp, c);
+  }
+  gst_caps_unref (normalized_caps);
+
+  if (direction == GST_PAD_SRC) {
+    other_caps = gst_bayer2gray_caps_transform (direction, tmp);
+    gst_caps_unref (tmp);
+  } else {
+    other_caps = tmp;
+  }
+
+  gst_caps_unref (rgb8_caps);
+  gst_caps_unref (rgb16_caps);
+  gst_caps_unref (gray8_caps);
+  gst_caps_unref (gray16_caps);
+
+  if (!gst_caps_is_empty (other_caps) && filter_caps) {
+    tmp = gst_caps_intersect_full (filter_caps, other_caps,
+        GST_CAPS_INTERSECT_FIRST);
+    gst_caps_replace (&other_caps, tmp);
+    gst_caps_unref (tmp);
+  }
+
+  GST_LOG_OBJECT (filt, "transformed caps to %" GST_PTR_FORMAT, other_caps);
+
+  return other_caps;
+}
+
+static gboolean
+gst_bayer_binning_get_unit_size (GstBaseTransform * trans, GstCaps * caps,
+    gsize * size)
+{
+  GstStructure *st = gst_caps_get_structure (caps, 0);
+  GstVideoInfo info;
+  gint width, height;
+
+  if (gst_structure_has_name (st, "video/x-bayer")) {
+    const gchar *format = gst_structure_get_string (st, "format");
+    gint bytes = format && g_str_has_suffix (format, "16") ? 2 : 1;
+
+    if (!gst_structure_get_int (st, "width", &width) ||
+        !gst_structure_get_int (st, "height", &height))
+      return FALSE;
+
+    *size = GST_ROUND_UP_4 (width * bytes) * height;
+    return TRUE;
+  }
+
+  if (!gst_video_info_from_caps (&info, caps))
+    return FALSE;
+
+  *size = GST_VIDEO_INFO_SIZE (&info);
+  return TRUE;
+}
+
+static gboolean
+gst_bayer_binning_set_caps (GstBaseTransform * btrans, GstCaps * incaps,
+    GstCaps * outcaps)
+{
+  GstBayerBinning *filt = GST_BAYER_BINNING (btrans);
+  GstStructure *st;
+  const gchar *format;
+  gint factor;
+
+  GST_DEBUG_OBJECT (filt,
+      "set_caps: in '%" GST_PTR_FORMAT "' out '%" GST_PTR_FORMAT "'", incaps,
+      outcaps);
+
+  if (!gst_video_info_from_caps (&filt->info_out, outcaps))
+    return FALSE;
+
+  st = gst_caps_get_structure (incaps, 0);
+  format = gst_structure_get_string (st, "format");
+  if (!format || !gst_structure_get_int (st, "width", &filt->width) ||
+      !gst_structure_get_int (st, "height", &filt->height))
+    return FALSE;
+
+  if (g_str_has_prefix (format, "bggr")) {
+    filt->red_x = 1;
+    filt->red_y = 1;
+  } else if (g_str_has_prefix (format, "grbg")) {
+    filt->red_x = 1;
+    filt->red_y = 0;
+  } else if (g_str_has_prefix (format, "gbrg")) {
+    filt->red_x = 0;
+    filt->red_y = 1;
+  } else if (g_str_has_prefix (format, "rggb")) {
+    filt->red_x = 0;
+    filt->red_y = 0;
+  } else {
+    GST_ERROR_OBJECT (filt, "unsupported Bayer format %s", format);
+    return FALSE;
+  }
+
+  filt->endianness = G_BYTE_ORDER;
+  if (g_str_has_suffix (format, "16")) {
+    filt->bytes_in = 2;
+    filt->bpp = 16;
+    gst_structure_get_int (st, "bpp", &filt->bpp);
+    gst_structure_get_int (st, "endianness", &filt->endianness);
+  } else {
+    filt->bytes_in = 1;
+    filt->bpp = 8;
+  }
+  filt->stride_in = GST_ROUND_UP_4 (filt->width * filt->bytes_in);
+
+  GST_OBJECT_LOCK (filt);
+  factor = filt->block = gst_bayer_binning_get_factor (filt);
+  GST_OBJECT_UNLOCK (filt);
+  if (GST_VIDEO_INFO_WIDTH (&filt->info_out) * factor > filt->width ||
+      GST_VIDEO_INFO_HEIGHT (&filt->info_out) * factor > filt->height) {
+    GST_ERROR_OBJECT (filt, "%dx%d is too small to bin by %d", filt->width,
+        filt->height, factor);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* accumulate one input row, split by column parity within each block */
+static void
+gst_bayer_binning_accumulate_row (const guint16 * line, gint out_width,
+    gint factor, guint32 * even, guint32 * odd)
+{
+  gint ox, k;
+
+  for (ox = 0; ox < out_width; ox++) {
+    const guint16 *block = line + ox * factor;
+    guint32 sum_even = 0, sum_odd = 0;
+
+    for (k = 0; k + 1 < factor; k += 2) {
+      sum_even += block[k];
+      sum_odd += block[k + 1];
+    }
+    if (k < factor)
+      sum_even += block[k];
+
+    even[ox] += sum_even;
+    odd[ox] += sum_odd;
+  }
+}
+
+static GstFlowReturn
+gst_bayer_binning_transform (GstBaseTransform * btrans, GstBuffer * inbuf,
+    GstBuffer * outbuf)
+{
+  GstBayerBinning *filt = GST_BAYER_BINNING (btrans);
+  GstVideoFrame out_frame;
+  GstVideoMeta *meta;
+  GstMapInfo minfo;
+  const guint8 *in_data;
+  gint in_stride, out_width, out_height, factor, ox, oy, dy;
+  const guint16 max_in = (1 << filt->bpp) - 1;
+  guint32 *sums[4], n_color, n_green, n_all;
+  guint16 *line;
+  gsize sums_size;
+  gint r_idx, b_idx, g1_idx, g2_idx;
+  gboolean swap_out;
+
+  if (!gst_buffer_map (inbuf, &minfo, GST_MAP_READ)) {
+    GST_ELEMENT_ERROR (filt, STREAM, FAILED, ("Failed to map buffer"), (NULL));
+    return GST_FLOW_ERROR;
+  }
+  if (!gst_video_frame_map (&out_frame, &filt->info_out, outbuf,
+          GST_MAP_WRITE)) {
+    gst_buffer_unmap (inbuf, &minfo);
+    GST_ELEMENT_ERROR (filt, STREAM, FAILED, ("Failed to map buffer"), (NULL));
+    return GST_FLOW_ERROR;
+  }
+
+  in_data = minfo.data;
+  in_stride = filt->stride_in;
+  meta = gst_buffer_get_video_meta (inbuf);
+  if (meta) {
+    in_data += meta->offset[0];
+    in_stride = meta->stride[0];
+  }
+
+  factor = filt->block;
+  out_width = GST_VIDEO_FRAME_WIDTH (&out_frame);
+  out_height = GST_VIDEO_FRAME_HEIGHT (&out_frame);
+
+  /* four sums per output column, one per CFA position, plus an input line */
+  sums_size = 4 * out_width + (filt->width + 1) / 2;
+  if (filt->sums_size < sums_size) {
+    g_free (filt->sums);
+    filt->sums = g_new (guint32, sums_size);
+    filt->sums_size = sums_size;
+  }
+  sums[0] = filt->sums;
+  sums[1] = sums[0] + out_width;
+  sums[2] = sums[1] + out_width;
+  sums[3] = sums[2] + out_width;
+  line = (guint16 *) (sums[3] + out_width);
+
+  r_idx = filt->red_y * 2 + filt->red_x;
+  b_idx = (1 - filt->red_y) * 2 + (1 - filt->red_x);
+  g1_idx = filt->red_y * 2 + (1 - filt->red_x);
+  g2_idx = (1 - filt->red_y) * 2 + filt->red_x;
+  n_all = factor * factor;
+  n_color = n_all / 4;
+  n_green = n_all / 2;
+
+  swap_out =
+      (GST_VIDEO_FRAME_FORMAT (&out_frame) == GST_VIDEO_FORMAT_GRAY16_LE &&
+      G_BYTE_ORDER != G_LITTLE_ENDIAN) ||
+      (GST_VIDEO_FRAME_FORMAT (&out_frame) == GST_VIDEO_FORMAT_GRAY16_BE &&
+      G_BYTE_ORDER != G_BIG_ENDIAN);
+
+  for (oy = 0; oy < out_height; oy++) {
+    guint8 *dst = GST_VIDEO_FRAME_PLANE_DATA (&out_frame, 0) +
+        oy * GST_VIDEO_FRAME_PLANE_STRIDE (&out_frame, 0);
+
+    memset (sums[0], 0, 4 * out_width * sizeof (guint32));
+
+    for (dy = 0; dy < factor; dy++) {
+      const gint y = oy * factor + dy;
+      const guint8 *src = in_data + y * in_stride;
+      const gint n = out_width * factor;
+      gint x;
+
+      if (filt->bytes_in == 1) {
+        for (x = 0; x < n; x++)
+          line[x] = src[x];
+      } else if (filt->endianness == G_BYTE_ORDER) {
+        const guint16 *src16 = (const guint16 *) src;
+        for (x = 0; x < n; x++)
+          line[x] = MIN (src16[x], max_in);
+      } else {
+        const guint16 *src16 = (const guint16 *) src;
+        for (x = 0; x < n; x++)
+          line[x] = MIN (GUINT16_SWAP_LE_BE (src16[x]), max_in);
+      }
+
+      /* factor is even in rgb mode, so block parity is CFA parity */
+      gst_bayer_binning_accumulate_row (line, out_width, factor,
+          sums[(dy & 1) * 2], sums[(dy & 1) * 2 + 1]);
+    }
+
+    switch (GST_VIDEO_FRAME_FORMAT (&out_frame)) {
+      case GST_VIDEO_FORMAT_RGB:
+      case GST_VIDEO_FORMAT_RGBx:{
+        const gint shift = filt->bpp - 8;
+        const gint pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (&out_frame, 0);
+        for (ox = 0; ox < out_width; ox++) {
+          guint8 *p = dst + ox * pstride;
+          p[0] = ((sums[r_idx][ox] + n_color / 2) / n_color) >> shift;
+          p[1] = ((sums[g1_idx][ox] + sums[g2_idx][ox] + n_green / 2) /
+              n_green) >> shift;
+          p[2] = ((sums[b_idx][ox] + n_color / 2) / n_color) >> shift;
+          if (pstride == 4)
+            p[3] = 0xff;
+        }
+        break;
+      }
+      case GST_VIDEO_FORMAT_ARGB64:{
+        const gint shift = 16 - filt->bpp;
+        guint16 *p = (guint16 *) dst;
+        for (ox = 0; ox < out_width; ox++, p += 4) {
+          p[0] = 0xffff;
+          p[1] = ((sums[r_idx][ox] + n_color / 2) / n_color) << shift;
+          p[2] = ((sums[g1_idx][ox] + sums[g2_idx][ox] + n_green / 2) /
+              n_green) << shift;
+          p[3] = ((sums[b_idx][ox] + n_color / 2) / n_color) << shift;
+        }
+        break;
+      }
+      case GST_VIDEO_FORMAT_GRAY8:
+        for (ox = 0; ox < out_width; ox++)
+          dst[ox] = (sums[0][ox] + sums[1][ox] + sums[2][ox] + sums[3][ox] +
+              n_all / 2) / n_all;
+        break;
+      case GST_VIDEO_FORMAT_GRAY16_LE:
+      case GST_VIDEO_FORMAT_GRAY16_BE:{
+        /* values keep the input depth, as with bayer2gray */
+        guint16 *p = (guint16 *) dst;
+        for (ox = 0; ox < out_width; ox++) {
+          guint16 v = (sums[0][ox] + sums[1][ox] + sums[2][ox] + sums[3][ox] +
+              n_all / 2) / n_all;
+          p[ox] = swap_out ? GUINT16_SWAP_LE_BE (v) : v;
+        }
+        break;
+      }
+      default:
+        g_assert_not_reached ();
+    }
+  }
+
+  gst_video_frame_unmap (&out_frame);
+  gst_buffer_unmap (inbuf, &minfo);
+
+  return GST_FLOW_OK;
+}
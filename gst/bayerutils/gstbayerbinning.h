@@ -0,0 +1,101 @@
+/* GStreamer
+ * Copyright (C) <1999> Erik Walthinsen <omega@cse.ogi.edu>
+ * Copyright (C) <2003> David Schleef <ds@schleef.org>
+ * Copyright (C) 2003 Arwed v. Merkatz <v.merkatz@gmx.net>
+ * Copyright (C) 2006 Mark Nauwelaerts <manauw@skynet.be>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __GST_BAYER_BINNING_H__
+#define __GST_BAYER_BINNING_H__
+
+#include <gst/base/gstbasetransform.h>
+#include <gst/video/video.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_BAYER_BINNING \
+  (gst_bayer_binning_get_type())
+#define GST_BAYER_BINNING(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_BAYER_BINNING,GstBayerBinning))
+#define GST_BAYER_BINNING_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_BAYER_BINNING,GstBayerBinningClass))
+#define GST_IS_BAYER_BINNING(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_BAYER_BINNING))
+#define GST_IS_BAYER_BINNING_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_BAYER_BINNING))
+
+typedef struct _GstBayerBinning GstBayerBinning;
+typedef struct _GstBayerBinningClass GstBayerBinningClass;
+
+/**
+* GstBayerBinningMode:
+* @GST_BAYER_BINNING_MODE_RGB: average each color of a block into one RGB pixel
+* @GST_BAYER_BINNING_MODE_GRAY: average all samples of a block into one gray pixel
+*
+* How the samples of each block are combined.
+*/
+typedef enum {
+  GST_BAYER_BINNING_MODE_RGB,
+  GST_BAYER_BINNING_MODE_GRAY
+} GstBayerBinningMode;
+
+/**
+* GstBayerBinning:
+* @element: the parent element.
+*
+*
+* The opaque GstBayerBinning data structure.
+*/
+struct _GstBayerBinning
+{
+  GstBaseTransform element;
+
+  /* format */
+  GstVideoInfo info_out;
+  gint width;
+  gint height;
+  gint bpp;
+  gint bytes_in;
+  gint endianness;
+  gint stride_in;
+  /* position of the red sample in each 2x2 cell */
+  gint red_x;
+  gint red_y;
+  /* block size the caps were negotiated with */
+  gint block;
+
+  /* properties */
+  GstBayerBinningMode mode;
+  guint factor;
+
+  /* per output column sums of each CFA position */
+  guint32 *sums;
+  gsize sums_size;
+};
+
+struct _GstBayerBinningClass
+{
+  GstBaseTransformClass parent_class;
+};
+
+GType gst_bayer_binning_get_type(void);
+
+G_END_DECLS
+
+#endif /* __GST_BAYER_BINNING_H__ */
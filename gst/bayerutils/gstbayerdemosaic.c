@@ -0,0 +1,697 @@
+/* GStreamer
+ * Copyright (C) <1999> Erik Walthinsen <omega@cse.ogi.edu>
+ * Copyright (C) <2003> David Schleef <ds@schleef.org>
+ * Copyright (C) 2003 Arwed v. Merkatz <v.merkatz@gmx.net>
+ * Copyright (C) 2006 Mark Nauwelaerts <manauw@skynet.be>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+* SECTION:element-bayerdemosaic
+*
+* Demosaic 8- or 16-bit Bayer video into RGB, RGBx or ARGB64. Unlike
+* bayer2rgb this accepts the high bit depth Bayer caps produced by GenICam
+* sources, and can use the gradient corrected kernels of Malvar, He and
+* Cutler. Frames are split into bands of rows processed in parallel.
+*
+* <refsect2>
+* <title>Example launch line</title>
+* |[
+* gst-launch-1.0 pylonsrc ! bayerdemosaic method=malvar ! videoconvert ! autovideosink
+* ]|
+* </refsect2>
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "gstbayerdemosaic.h"
+#include "genicampixelformat.h"
+
+#include <gst/video/video.h>
+
+enum
+{
+  PROP_0,
+  PROP_METHOD,
+  PROP_N_THREADS
+};
+
+#define DEFAULT_PROP_METHOD GST_BAYER_DEMOSAIC_METHOD_BILINEAR
+#define DEFAULT_PROP_N_THREADS 0
+
+/* each line has two mirrored samples on either side */
+#define LINE_PAD 2
+
+static GstStaticPadTemplate gst_bayer_demosaic_sink_template =
+    GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_GENICAM_PIXEL_FORMAT_MAKE_BAYER8
+        ("{ bggr, grbg, gbrg, rggb }") ";"
+        GST_GENICAM_PIXEL_FORMAT_MAKE_BAYER16
+        ("{ bggr16, grbg16, gbrg16, rggb16 }", "{1234, 4321}"))
+    );
+
+static GstStaticPadTemplate gst_bayer_demosaic_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("{ RGBx, RGB, ARGB64 }"))
+    );
+
+#define GST_TYPE_BAYER_DEMOSAIC_METHOD (gst_bayer_demosaic_method_get_type())
+static GType
+gst_bayer_demosaic_method_get_type (void)
+{
+  static GType bayer_demosaic_method_type = 0;
+  static const GEnumValue bayer_demosaic_method[] = {
+    {GST_BAYER_DEMOSAIC_METHOD_BILINEAR, "Bilinear", "bilinear"},
+    {GST_BAYER_DEMOSAIC_METHOD_MALVAR, "Malvar-He-Cutler", "malvar"},
+    {0, NULL, NULL},
+  };
+
+  if (!bayer_demosaic_method_type) {
+    bayer_demosaic_method_type =
+        g_enum_register_static ("GstBayerDemosaicMethod",
+        bayer_demosaic_method);
+  }
+  return bayer_demosaic_method_type;
+}
+
+/* GObject vmethod declarations */
+static void gst_bayer_demosaic_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_bayer_demosaic_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+static void gst_bayer_demosaic_dispose (GObject * object);
+
+/* GstBaseTransform vmethod declarations */
+static GstCaps *gst_bayer_demosaic_transform_caps (GstBaseTransform * trans,
+    GstPadDirection direction, GstCaps * caps, GstCaps * filter_caps);
+static gboolean gst_bayer_demosaic_get_unit_size (GstBaseTransform * trans,
+    GstCaps * caps, gsize * size);
+static gboolean gst_bayer_demosaic_set_caps (GstBaseTransform * btrans,
+    GstCaps * incaps, GstCaps * outcaps);
+static GstFlowReturn gst_bayer_demosaic_transform (GstBaseTransform * btrans,
+    GstBuffer * inbuf, GstBuffer * outbuf);
+
+/* setup debug */
+GST_DEBUG_CATEGORY_STATIC (bayer_demosaic_debug);
+#define GST_CAT_DEFAULT bayer_demosaic_debug
+
+G_DEFINE_TYPE (GstBayerDemosaic, gst_bayer_demosaic, GST_TYPE_BASE_TRANSFORM);
+
+/************************************************************************/
+/* GObject vmethod implementations                                      */
+/************************************************************************/
+
+static void
+gst_bayer_demosaic_dispose (GObject * object)
+{
+  GstBayerDemosaic *filt = GST_BAYER_DEMOSAIC (object);
+
+  GST_DEBUG ("dispose");
+
+  if (filt->runner) {
+    gst_parallel_runner_free (filt->runner);
+    filt->runner = NULL;
+  }
+
+  g_free (filt->scratch);
+  filt->scratch = NULL;
+  filt->scratch_size = 0;
+
+  /* chain up to the parent class */
+  G_OBJECT_CLASS (gst_bayer_demosaic_parent_class)->dispose (object);
+}
+
+static void
+gst_bayer_demosaic_class_init (GstBayerDemosaicClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+  GstBaseTransformClass *gstbasetransform_class =
+      GST_BASE_TRANSFORM_CLASS (klass);
+
+  GST_DEBUG_CATEGORY_INIT (bayer_demosaic_debug, "bayerdemosaic", 0,
+      "Bayer demosaic filter");
+
+  GST_DEBUG ("class init");
+
+  /* Register GObject vmethods */
+  gobject_class->dispose = GST_DEBUG_FUNCPTR (gst_bayer_demosaic_dispose);
+  gobject_class->set_property =
+      GST_DEBUG_FUNCPTR (gst_bayer_demosaic_set_property);
+  gobject_class->get_property =
+      GST_DEBUG_FUNCPTR (gst_bayer_demosaic_get_property);
+
+  /* Install GObject properties */
+  g_object_class_install_property (gobject_class, PROP_METHOD,
+      g_param_spec_enum ("method", "Method", "Interpolation method",
+          GST_TYPE_BAYER_DEMOSAIC_METHOD, DEFAULT_PROP_METHOD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      gst_parallel_param_spec_n_threads ());
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&gst_bayer_demosaic_sink_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&gst_bayer_demosaic_src_template));
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "Bayer demosaic", "Filter/Converter/Video",
+      "Converts 8- and 16-bit Bayer video to RGB",
+      "Joshua M. Doe <oss@nvl.army.mil>");
+
+  /* Register GstBaseTransform vmethods */
+  gstbasetransform_class->transform_caps =
+      GST_DEBUG_FUNCPTR (gst_bayer_demosaic_transform_caps);
+  gstbasetransform_class->get_unit_size =
+      GST_DEBUG_FUNCPTR (gst_bayer_demosaic_get_unit_size);
+  gstbasetransform_class->set_caps =
+      GST_DEBUG_FUNCPTR (gst_bayer_demosaic_set_caps);
+  gstbasetransform_class->transform =
+      GST_DEBUG_FUNCPTR (gst_bayer_demosaic_transform);
+}
+
+static void
+gst_bayer_demosaic_init (GstBayerDemosaic * filt)
+{
+  GST_DEBUG_OBJECT (filt, "init class instance");
+
+  filt->method = DEFAULT_PROP_METHOD;
+  filt->n_threads = DEFAULT_PROP_N_THREADS;
+}
+
+static void
+gst_bayer_demosaic_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstBayerDemosaic *filt = GST_BAYER_DEMOSAIC (object);
+
+  GST_DEBUG_OBJECT (filt, "setting property %s", pspec->name);
+
+  switch (prop_id) {
+    case PROP_METHOD:
+      filt->method = g_value_get_enum (value);
+      break;
+    case PROP_N_THREADS:
+      filt->n_threads = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_bayer_demosaic_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstBayerDemosaic *filt = GST_BAYER_DEMOSAIC (object);
+
+  GST_DEBUG_OBJECT (filt, "getting property %s", pspec->name);
+
+  switch (prop_id) {
+    case PROP_METHOD:
+      g_value_set_enum (value, filt->method);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, filt->n_threads);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+/************************************************************************/
+/* GstBaseTransform vmethod implementations                             */
+/************************************************************************/
+
+static void
+copy_video_fields (const GstStructure * st, GstStructure * newst)
+{
+  static const gchar *fields[] =
+      { "width", "height", "framerate", "pixel-aspect-ratio" };
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (fields); i++) {
+    const GValue *value = gst_structure_get_value (st, fields[i]);
+    if (value)
+      gst_structure_set_value (newst, fields[i], value);
+  }
+}
+
+static GstCaps *
+gst_bayer_demosaic_transform_caps (GstBaseTransform * trans,
+    GstPadDirection direction, GstCaps * caps, GstCaps * filter_caps)
+{
+  GstBayerDemosaic *filt = GST_BAYER_DEMOSAIC (trans);
+  GstCaps *other_caps;
+  guint i, n;
+
+  GST_LOG_OBJECT (filt, "transforming caps from %" GST_PTR_FORMAT, caps);
+
+  other_caps = gst_caps_new_empty ();
+
+  n = gst_caps_get_size (caps);
+  for (i = 0; i < n; ++i) {
+    GstStructure *st = gst_caps_get_structure (caps, i);
+    GstStructure *newst;
+
+    if (direction == GST_PAD_SINK) {
+      /* prefer an output as deep as the input */
+      if (gst_structure_has_field (st, "endianness"))
+        newst = gst_structure_from_string
+            ("video/x-raw,format={ARGB64,RGBx,RGB}", NULL);
+      else
+        newst = gst_structure_from_string
+            ("video/x-raw,format={RGBx,RGB,ARGB64}", NULL);
+      copy_video_fields (st, newst);
+      gst_caps_append_structure (other_caps, newst);
+    } else {
+      const gchar *format = gst_structure_get_string (st, "format");
+      GstStructure *bayer8, *bayer16;
+
+      bayer8 = gst_structure_from_string
+          ("video/x-bayer,format={bggr,grbg,gbrg,rggb}", NULL);
+      bayer16 = gst_structure_from_string
+          ("video/x-bayer,format={bggr16,grbg16,gbrg16,rggb16},"
+          "endianness={1234,4321},bpp={16,14,12,10}", NULL);
+      copy_video_fields (st, bayer8);
+      copy_video_fields (st, bayer16);
+
+      if (g_strcmp0 (format, "ARGB64") == 0) {
+        gst_caps_append_structure (other_caps, bayer16);
+        gst_caps_append_structure (other_caps, bayer8);
+      } else {
+        gst_caps_append_structure (other_caps, bayer8);
+        gst_caps_append_structure (other_caps, bayer16);
+      }
+    }
+  }
+
+  if (!gst_caps_is_empty (other_caps) && filter_caps) {
+    GstCaps *tmp = gst_caps_intersect_full (filter_caps, other_caps,
+        GST_CAPS_INTERSECT_FIRST);
+    gst_caps_replace (&other_caps, tmp);
+    gst_caps_unref (tmp);
+  }
+
+  GST_LOG_OBJECT (filt, "transformed caps to %" GST_PTR_FORMAT, other_caps);
+
+  return other_caps;
+}
+
+static gboolean
+gst_bayer_demosaic_get_unit_size (GstBaseTransform * trans, GstCaps * caps,
+    gsize * size)
+{
+  GstStructure *st = gst_caps_get_structure (caps, 0);
+  GstVideoInfo info;
+  gint width, height;
+
+  if (gst_structure_has_name (st, "video/x-bayer")) {
+    const gchar *format = gst_structure_get_string (st, "format");
+    gint bytes = format && g_str_has_suffix (format, "16") ? 2 : 1;
+
+    if (!gst_structure_get_int (st, "width", &width) ||
+        !gst_structure_get_int (st, "height", &height))
+      return FALSE;
+
+    *size = GST_ROUND_UP_4 (width * bytes) * height;
+    return TRUE;
+  }
+
+  if (!gst_video_info_from_caps (&info, caps))
+    return FALSE;
+
+  *size = GST_VIDEO_INFO_SIZE (&info);
+  return TRUE;
+}
+
+static gboolean
+gst_bayer_demosaic_set_caps (GstBaseTransform * btrans, GstCaps * incaps,
+    GstCaps * outcaps)
+{
+  GstBayerDemosaic *filt = GST_BAYER_DEMOSAIC (btrans);
+  GstStructure *st;
+  const gchar *format;
+
+  GST_DEBUG_OBJECT (filt,
+      "set_caps: in '%" GST_PTR_FORMAT "' out '%" GST_PTR_FORMAT "'", incaps,
+      outcaps);
+
+  if (!gst_video_info_from_caps (&filt->info_out, outcaps))
+    return FALSE;
+
+  st = gst_caps_get_structure (incaps, 0);
+  format = gst_structure_get_string (st, "format");
+  if (!format || !gst_structure_get_int (st, "width", &filt->width) ||
+      !gst_structure_get_int (st, "height", &filt->height))
+    return FALSE;
+
+  if (g_str_has_prefix (format, "bggr")) {
+    filt->red_x = 1;
+    filt->red_y = 1;
+  } else if (g_str_has_prefix (format, "grbg")) {
+    filt->red_x = 1;
+    filt->red_y = 0;
+  } else if (g_str_has_prefix (format, "gbrg")) {
+    filt->red_x = 0;
+    filt->red_y = 1;
+  } else if (g_str_has_prefix (format, "rggb")) {
+    filt->red_x = 0;
+    filt->red_y = 0;
+  } else {
+    GST_ERROR_OBJECT (filt, "unsupported Bayer format %s", format);
+    return FALSE;
+  }
+
+  filt->endianness = G_BYTE_ORDER;
+  if (g_str_has_suffix (format, "16")) {
+    filt->bytes_in = 2;
+    filt->bpp = 16;
+    gst_structure_get_int (st, "bpp", &filt->bpp);
+    gst_structure_get_int (st, "endianness", &filt->endianness);
+  } else {
+    filt->bytes_in = 1;
+    filt->bpp = 8;
+  }
+  filt->stride_in = GST_ROUND_UP_4 (filt->width * filt->bytes_in);
+
+  return TRUE;
+}
+
+/* reflected index, which keeps the CFA phase: -1 -> 1, n -> n - 2 */
+static inline gint
+reflect (gint i, gint n)
+{
+  if (i < 0)
+    i = -i;
+  if (i >= n)
+    i = 2 * (n - 1) - i;
+  return CLAMP (i, 0, n - 1);
+}
+
+/* convert one input row to native 16-bit samples with mirrored padding */
+static void
+gst_bayer_demosaic_load_line (GstBayerDemosaic * filt, const guint8 * src,
+    guint16 * line)
+{
+  const gint width = filt->width;
+  const guint16 max_in = (1 << filt->bpp) - 1;
+  guint16 *dst = line + LINE_PAD;
+  gint x;
+
+  if (filt->bytes_in == 1) {
+    for (x = 0; x < width; x++)
+      dst[x] = src[x];
+  } else if (filt->endianness == G_BYTE_ORDER) {
+    const guint16 *src16 = (const guint16 *) src;
+    for (x = 0; x < width; x++)
+      dst[x] = MIN (src16[x], max_in);
+  } else {
+    const guint16 *src16 = (const guint16 *) src;
+    for (x = 0; x < width; x++)
+      dst[x] = MIN (GUINT16_SWAP_LE_BE (src16[x]), max_in);
+  }
+
+  for (x = 1; x <= LINE_PAD; x++) {
+    dst[-x] = dst[reflect (-x, width)];
+    dst[width - 1 + x] = dst[reflect (width - 1 + x, width)];
+  }
+}
+
+/* In each row one color shares the row with green (hc), the other is only
+ * found on the rows above and below (vc). Green sites take hc from their
+ * left and right neighbours and vc from above and below, the other sites take
+ * green from all four and vc from the diagonals. */
+
+static inline void
+bilinear_green_site (const guint16 ** l, gint x, guint16 * hc, guint16 * vc,
+    guint16 * g)
+{
+  g[x] = l[2][x];
+  hc[x] = (l[2][x - 1] + l[2][x + 1] + 1) >> 1;
+  vc[x] = (l[1][x] + l[3][x] + 1) >> 1;
+}
+
+static inline void
+bilinear_color_site (const guint16 ** l, gint x, guint16 * hc, guint16 * vc,
+    guint16 * g)
+{
+  hc[x] = l[2][x];
+  g[x] = (l[1][x] + l[3][x] + l[2][x - 1] + l[2][x + 1] + 2) >> 2;
+  vc[x] = (l[1][x - 1] + l[1][x + 1] + l[3][x - 1] + l[3][x + 1] + 2) >> 2;
+}
+
+/* Malvar, He and Cutler 5x5 kernels, scaled by 16 */
+static inline void
+malvar_green_site (const guint16 ** l, gint x, guint16 * hc, guint16 * vc,
+    guint16 * g, gint max)
+{
+  const gint c = l[2][x];
+  const gint diag = l[1][x - 1] + l[1][x + 1] + l[3][x - 1] + l[3][x + 1];
+  const gint ew = l[2][x - 1] + l[2][x + 1];
+  const gint ns = l[1][x] + l[3][x];
+  const gint eeww = l[2][x - 2] + l[2][x + 2];
+  const gint nnss = l[0][x] + l[4][x];
+  gint v;
+
+  g[x] = c;
+  v = (10 * c + 8 * ew - 2 * eeww - 2 * diag + nnss + 8) >> 4;
+  hc[x] = CLAMP (v, 0, max);
+  v = (10 * c + 8 * ns - 2 * nnss - 2 * diag + eeww + 8) >> 4;
+  vc[x] = CLAMP (v, 0, max);
+}
+
+static inline void
+malvar_color_site (const guint16 ** l, gint x, guint16 * hc, guint16 * vc,
+    guint16 * g, gint max)
+{
+  const gint c = l[2][x];
+  const gint diag = l[1][x - 1] + l[1][x + 1] + l[3][x - 1] + l[3][x + 1];
+  const gint nsew = l[1][x] + l[3][x] + l[2][x - 1] + l[2][x + 1];
+  const gint far = l[0][x] + l[4][x] + l[2][x - 2] + l[2][x + 2];
+  gint v;
+
+  hc[x] = c;
+  v = (8 * c + 4 * nsew - 2 * far + 8) >> 4;
+  g[x] = CLAMP (v, 0, max);
+  v = (12 * c + 4 * diag - 3 * far + 8) >> 4;
+  vc[x] = CLAMP (v, 0, max);
+}
+
+/* the sites alternate, so handle them in pairs to keep the loops free of
+ * per pixel branches */
+static void
+gst_bayer_demosaic_row_bilinear (const guint16 ** l, gint width, gint green_x,
+    guint16 * hc, guint16 * vc, guint16 * g)
+{
+  gint x = 0;
+
+  if (green_x) {
+    bilinear_color_site (l, 0, hc, vc, g);
+    x = 1;
+  }
+  for (; x + 1 < width; x += 2) {
+    bilinear_green_site (l, x, hc, vc, g);
+    bilinear_color_site (l, x + 1, hc, vc, g);
+  }
+  if (x < width)
+    bilinear_green_site (l, x, hc, vc, g);
+}
+
+static void
+gst_bayer_demosaic_row_malvar (const guint16 ** l, gint width, gint green_x,
+    guint16 * hc, guint16 * vc, guint16 * g, gint max)
+{
+  gint x = 0;
+
+  if (green_x) {
+    malvar_color_site (l, 0, hc, vc, g, max);
+    x = 1;
+  }
+  for (; x + 1 < width; x += 2) {
+    malvar_green_site (l, x, hc, vc, g, max);
+    malvar_color_site (l, x + 1, hc, vc, g, max);
+  }
+  if (x < width)
+    malvar_green_site (l, x, hc, vc, g, max);
+}
+
+static void
+gst_bayer_demosaic_pack_row (GstBayerDemosaic * filt, const guint16 * r,
+    const guint16 * g, const guint16 * b, guint8 * dst)
+{
+  const gint width = filt->width;
+  gint x;
+
+  switch (GST_VIDEO_INFO_FORMAT (&filt->info_out)) {
+    case GST_VIDEO_FORMAT_RGB:{
+      const gint shift = filt->bpp - 8;
+      for (x = 0; x < width; x++) {
+        dst[3 * x] = r[x] >> shift;
+        dst[3 * x + 1] = g[x] >> shift;
+        dst[3 * x + 2] = b[x] >> shift;
+      }
+      break;
+    }
+    case GST_VIDEO_FORMAT_RGBx:{
+      const gint shift = filt->bpp - 8;
+      for (x = 0; x < width; x++) {
+        dst[4 * x] = r[x] >> shift;
+        dst[4 * x + 1] = g[x] >> shift;
+        dst[4 * x + 2] = b[x] >> shift;
+        dst[4 * x + 3] = 0xff;
+      }
+      break;
+    }
+    case GST_VIDEO_FORMAT_ARGB64:{
+      /* scale up to the full 16-bit range */
+      const gint shift = 16 - filt->bpp;
+      guint16 *dst16 = (guint16 *) dst;
+      for (x = 0; x < width; x++) {
+        dst16[4 * x] = 0xffff;
+        dst16[4 * x + 1] = r[x] << shift;
+        dst16[4 * x + 2] = g[x] << shift;
+        dst16[4 * x + 3] = b[x] << shift;
+      }
+      break;
+    }
+    default:
+      g_assert_not_reached ();
+  }
+}
+
+typedef struct
+{
+  GstBayerDemosaic *filt;
+  const guint8 *in_data;
+  gint in_stride;
+  GstVideoFrame *out_frame;
+} GstBayerDemosaicFrame;
+
+static void
+gst_bayer_demosaic_rows (gpointer user_data, guint band, gint row_start,
+    gint row_end)
+{
+  GstBayerDemosaicFrame *frame = (GstBayerDemosaicFrame *) user_data;
+  GstBayerDemosaic *filt = frame->filt;
+  const gint width = filt->width;
+  const gint line_len = width + 2 * LINE_PAD;
+  const gint max = (1 << filt->bpp) - 1;
+  guint16 *scratch = filt->scratch + band * (5 * line_len + 3 * width);
+  guint16 *r = scratch + 5 * line_len;
+  guint16 *g = r + width;
+  guint16 *b = g + width;
+  gint loaded[5] = { -1, -1, -1, -1, -1 };
+  gint y, k;
+
+  for (y = row_start; y < row_end; y++) {
+    const guint16 *l[5];
+    gboolean red_row = ((y ^ filt->red_y) & 1) == 0;
+    /* green shares red rows with red and blue rows with blue */
+    gint green_x = red_row ? !filt->red_x : filt->red_x;
+    guint8 *dst = GST_VIDEO_FRAME_PLANE_DATA (frame->out_frame, 0) +
+        y * GST_VIDEO_FRAME_PLANE_STRIDE (frame->out_frame, 0);
+
+    /* the five rows around y live in a ring indexed by row modulo 5 */
+    for (k = 0; k < 5; k++) {
+      gint ry = reflect (y + k - 2, filt->height);
+      gint slot = ry % 5;
+      guint16 *line = scratch + slot * line_len;
+
+      if (loaded[slot] != ry) {
+        gst_bayer_demosaic_load_line (filt,
+            frame->in_data + ry * frame->in_stride, line);
+        loaded[slot] = ry;
+      }
+      l[k] = line + LINE_PAD;
+    }
+
+    if (filt->method == GST_BAYER_DEMOSAIC_METHOD_MALVAR)
+      gst_bayer_demosaic_row_malvar (l, width, green_x, red_row ? r : b,
+          red_row ? b : r, g, max);
+    else
+      gst_bayer_demosaic_row_bilinear (l, width, green_x, red_row ? r : b,
+          red_row ? b : r, g);
+
+    gst_bayer_demosaic_pack_row (filt, r, g, b, dst);
+  }
+}
+
+static GstFlowReturn
+gst_bayer_demosaic_transform (GstBaseTransform * btrans, GstBuffer * inbuf,
+    GstBuffer * outbuf)
+{
+  GstBayerDemosaic *filt = GST_BAYER_DEMOSAIC (btrans);
+  GstBayerDemosaicFrame frame;
+  GstVideoFrame out_frame;
+  GstVideoMeta *meta;
+  GstMapInfo minfo;
+  guint n_threads;
+  gsize scratch_size;
+
+  if (!gst_buffer_map (inbuf, &minfo, GST_MAP_READ)) {
+    GST_ELEMENT_ERROR (filt, STREAM, FAILED, ("Failed to map buffer"), (NULL));
+    return GST_FLOW_ERROR;
+  }
+  if (!gst_video_frame_map (&out_frame, &filt->info_out, outbuf,
+          GST_MAP_WRITE)) {
+    gst_buffer_unmap (inbuf, &minfo);
+    GST_ELEMENT_ERROR (filt, STREAM, FAILED, ("Failed to map buffer"), (NULL));
+    return GST_FLOW_ERROR;
+  }
+
+  frame.filt = filt;
+  frame.in_data = minfo.data;
+  frame.in_stride = filt->stride_in;
+  frame.out_frame = &out_frame;
+
+  /* honor the layout of upstream, e.g. from bayer2gray or a camera source */
+  meta = gst_buffer_get_video_meta (inbuf);
+  if (meta) {
+    frame.in_data += meta->offset[0];
+    frame.in_stride = meta->stride[0];
+  }
+
+  gst_parallel_runner_ensure (&filt->runner, filt->n_threads);
+  n_threads = gst_parallel_runner_get_n_threads (filt->runner);
+
+  scratch_size = n_threads * (5 * (filt->width + 2 * LINE_PAD) +
+      3 * filt->width);
+  if (filt->scratch_size < scratch_size) {
+    g_free (filt->scratch);
+    filt->scratch = g_new (guint16, scratch_size);
+    filt->scratch_size = scratch_size;
+  }
+
+  gst_parallel_runner_run_rows (filt->runner, filt->height, 2,
+      gst_bayer_demosaic_rows, &frame);
+
+  gst_video_frame_unmap (&out_frame);
+  gst_buffer_unmap (inbuf, &minfo);
+
+  return GST_FLOW_OK;
+}
@@ -0,0 +1,65 @@
+/* GStreamer
+ * Copyright (C) <1999> Erik Walthinsen <omega@cse.ogi.edu>
+ * Copyright (C) <2003> David Schleef <ds@schleef.org>
+ * Copyright (C) 2003 Arwed v. Merkatz <v.merkatz@gmx.net>
+ * Copyright (C) 2006 Mark Nauwelaerts <manauw@skynet.be>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstbayer2gray.h"
+#include "gstbayerbinning.h"
+#include "gstbayerdemosaic.h"
+
+static gboolean
+plugin_init (GstPlugin * plugin)
+{
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, "bayerutils", 0,
+      "debug category for bayerutils");
+
+  GST_DEBUG ("plugin_init");
+
+  GST_CAT_INFO (GST_CAT_DEFAULT, "registering bayer2gray element");
+  if (!gst_element_register (plugin, "bayer2gray", GST_RANK_NONE,
+          GST_TYPE_BAYER2GRAY)) {
+    return FALSE;
+  }
+
+  GST_CAT_INFO (GST_CAT_DEFAULT, "registering bayerdemosaic element");
+  if (!gst_element_register (plugin, "bayerdemosaic", GST_RANK_NONE,
+          GST_TYPE_BAYER_DEMOSAIC)) {
+    return FALSE;
+  }
+
+  GST_CAT_INFO (GST_CAT_DEFAULT, "registering bayerbinning element");
+  if (!gst_element_register (plugin, "bayerbinning", GST_RANK_NONE,
+          GST_TYPE_BAYER_BINNING)) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+GST_PLUGIN_DEFINE (GST_VERSION_MAJOR,
+    GST_VERSION_MINOR,
+    bayerutils,
+    "Plugins for working with Bayer video",
+    plugin_init, GST_PACKAGE_VERSION, GST_PACKAGE_LICENSE, GST_PACKAGE_NAME,
+    GST_PACKAGE_ORIGIN);
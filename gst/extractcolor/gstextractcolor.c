@@ -24,12 +24,25 @@
 /**
 * SECTION:element-extractcolor
 *
-* Convert grayscale video from one bpp/depth combination to another.
+* Extract a single color component from packed, planar or semi-planar video
+* as gray video. Further components can be extracted in the same pass by
+* requesting pads named after them, e.g. src_green.
+*
+* Components stored in a plane of their own, like those of I420, Y444, GBR or
+* the luma of NV12, are not copied at all with zero-copy enabled: the output
+* buffer shares the input memory, with a video meta giving the plane's offset
+* and stride.
 *
 * <refsect2>
 * <title>Example launch line</title>
 * |[
-* gst-launch videotestsrc ! extractcolor ! ffmpegcolorspace ! autovideosink
+* gst-launch-1.0 videotestsrc ! extractcolor component=red ! videoconvert ! autovideosink
+* ]|
+* |[
+* gst-launch-1.0 videotestsrc ! video/x-raw,format=RGBA ! extractcolor name=e
+*     e.src ! queue ! videoconvert ! autovideosink
+*     e.src_green ! queue ! videoconvert ! autovideosink
+*     e.src_blue ! queue ! videoconvert ! autovideosink
 * ]|
 * </refsect2>
 */
@@ -38,6 +51,8 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include "gstextractcolor.h"
 
 #include <gst/video/video.h>
@@ -55,13 +70,19 @@ enum
 {
   PROP_0,
   PROP_COMPONENT,
+  PROP_ZERO_COPY,
+  PROP_N_THREADS,
   PROP_LAST
 };
 
 #define DEFAULT_PROP_COMPONENT GST_EXTRACT_COLOR_COMPONENT_RED
+#define DEFAULT_PROP_ZERO_COPY TRUE
+#define DEFAULT_PROP_N_THREADS 0
 
 #define RGB8_FORMATS "{ RGBx, BGRx, xRGB, xBGR, RGBA, BGRA, ARGB, ABGR, RGB, BGR }"
 #define RGB16_FORMATS "ARGB64"
+#define PLANAR8_FORMATS "{ GBR, GBRA, Y444, Y42B, I420, YV12, A420 }"
+#define SEMI_PLANAR8_FORMATS "{ NV12, NV21, NV16, NV61, NV24 }"
 
 /* the capabilities of the inputs and outputs */
 static GstStaticPadTemplate gst_extract_color_sink_template =
@@ -69,7 +90,9 @@ static GstStaticPadTemplate gst_extract_color_sink_template =
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE (RGB8_FORMATS) ";"
-        GST_VIDEO_CAPS_MAKE (RGB16_FORMATS))
+        GST_VIDEO_CAPS_MAKE (RGB16_FORMATS) ";"
+        GST_VIDEO_CAPS_MAKE (PLANAR8_FORMATS) ";"
+        GST_VIDEO_CAPS_MAKE (SEMI_PLANAR8_FORMATS))
     );
 
 static GstStaticPadTemplate gst_extract_color_src_template =
@@ -80,6 +103,14 @@ static GstStaticPadTemplate gst_extract_color_src_template =
         GST_VIDEO_CAPS_MAKE ("GRAY16_LE"))
     );
 
+static GstStaticPadTemplate gst_extract_color_request_src_template =
+    GST_STATIC_PAD_TEMPLATE ("src_%s",
+    GST_PAD_SRC,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("GRAY8") ";"
+        GST_VIDEO_CAPS_MAKE ("GRAY16_LE"))
+    );
+
 
 #define GST_TYPE_EXTRACT_COLOR_COMPONENT (gst_extract_color_component_get_type())
 static GType
@@ -90,6 +121,7 @@ gst_extract_color_component_get_type (void)
     {GST_EXTRACT_COLOR_COMPONENT_RED, "extract red component", "red"},
     {GST_EXTRACT_COLOR_COMPONENT_GREEN, "extract green component", "green"},
     {GST_EXTRACT_COLOR_COMPONENT_BLUE, "extract blue component", "blue"},
+    {GST_EXTRACT_COLOR_COMPONENT_ALPHA, "extract alpha component", "alpha"},
     {0, NULL, NULL},
   };
 
@@ -108,9 +140,23 @@ static void gst_extract_color_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 static void gst_extract_color_dispose (GObject * object);
 
+/* GstElement vmethod declarations */
+static GstPad *gst_extract_color_request_new_pad (GstElement * element,
+    GstPadTemplate * templ, const gchar * name, const GstCaps * caps);
+static void gst_extract_color_release_pad (GstElement * element,
+    GstPad * pad);
+
 /* GstBaseTransform vmethod declarations */
 static GstCaps *gst_extract_color_transform_caps (GstBaseTransform * trans,
     GstPadDirection direction, GstCaps * caps, GstCaps * filter_caps);
+static gboolean gst_extract_color_sink_event (GstBaseTransform * trans,
+    GstEvent * event);
+static gboolean gst_extract_color_decide_allocation (GstBaseTransform * trans,
+    GstQuery * query);
+static GstFlowReturn gst_extract_color_prepare_output_buffer (GstBaseTransform
+    * trans, GstBuffer * input, GstBuffer ** outbuf);
+static GstFlowReturn gst_extract_color_transform (GstBaseTransform * trans,
+    GstBuffer * inbuf, GstBuffer * outbuf);
 
 /* GstVideoFilter vmethod declarations */
 static gboolean gst_extract_color_set_info (GstVideoFilter * filter,
@@ -146,6 +192,15 @@ gst_extract_color_dispose (GObject * object)
 
   gst_extract_color_reset (extract_color);
 
+  g_free (extract_color->scratch);
+  extract_color->scratch = NULL;
+  extract_color->scratch_size = 0;
+
+  if (extract_color->runner) {
+    gst_parallel_runner_free (extract_color->runner);
+    extract_color->runner = NULL;
+  }
+
   /* chain up to the parent class */
   G_OBJECT_CLASS (gst_extract_color_parent_class)->dispose (object);
 }
@@ -182,20 +237,44 @@ gst_extract_color_class_init (GstExtractColorClass * klass)
           GST_TYPE_EXTRACT_COLOR_COMPONENT, DEFAULT_PROP_COMPONENT,
           G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE |
           GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_ZERO_COPY,
+      g_param_spec_boolean ("zero-copy", "Zero copy",
+          "Output planar components as buffers sharing the input memory",
+          DEFAULT_PROP_ZERO_COPY,
+          G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE |
+          GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      gst_parallel_param_spec_n_threads ());
 
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&gst_extract_color_sink_template));
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&gst_extract_color_src_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&gst_extract_color_request_src_template));
 
   gst_element_class_set_static_metadata (gstelement_class,
       "Extract color filter", "Filter/Effect/Video",
       "Extracts single color component from RGB video",
       "Joshua M. Doe <oss@nvl.army.mil>");
 
+  /* Register GstElement vmethods */
+  gstelement_class->request_new_pad =
+      GST_DEBUG_FUNCPTR (gst_extract_color_request_new_pad);
+  gstelement_class->release_pad =
+      GST_DEBUG_FUNCPTR (gst_extract_color_release_pad);
+
   /* Register GstBaseTransform vmethods */
   gstbasetransform_class->transform_caps =
       GST_DEBUG_FUNCPTR (gst_extract_color_transform_caps);
+  gstbasetransform_class->sink_event =
+      GST_DEBUG_FUNCPTR (gst_extract_color_sink_event);
+  gstbasetransform_class->decide_allocation =
+      GST_DEBUG_FUNCPTR (gst_extract_color_decide_allocation);
+  gstbasetransform_class->prepare_output_buffer =
+      GST_DEBUG_FUNCPTR (gst_extract_color_prepare_output_buffer);
+  gstbasetransform_class->transform =
+      GST_DEBUG_FUNCPTR (gst_extract_color_transform);
 
   gstvideofilter_class->set_info =
       GST_DEBUG_FUNCPTR (gst_extract_color_set_info);
@@ -209,6 +288,8 @@ gst_extract_color_init (GstExtractColor * filt)
   GST_DEBUG_OBJECT (filt, "init class instance");
 
   filt->component = DEFAULT_PROP_COMPONENT;
+  filt->zero_copy = DEFAULT_PROP_ZERO_COPY;
+  filt->n_threads = DEFAULT_PROP_N_THREADS;
   gst_base_transform_set_in_place (GST_BASE_TRANSFORM (filt), FALSE);
 
   gst_extract_color_reset (filt);
@@ -225,6 +306,14 @@ gst_extract_color_set_property (GObject * object, guint prop_id,
   switch (prop_id) {
     case PROP_COMPONENT:
       filt->component = g_value_get_enum (value);
+      /* the size differs between components of subsampled formats */
+      gst_base_transform_reconfigure_src (GST_BASE_TRANSFORM (filt));
+      break;
+    case PROP_ZERO_COPY:
+      filt->zero_copy = g_value_get_boolean (value);
+      break;
+    case PROP_N_THREADS:
+      filt->n_threads = g_value_get_uint (value);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -244,20 +333,205 @@ gst_extract_color_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_COMPONENT:
       g_value_set_enum (value, filt->component);
       break;
+    case PROP_ZERO_COPY:
+      g_value_set_boolean (value, filt->zero_copy);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, filt->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+/************************************************************************/
+/* GstElement vmethod implementations                                   */
+/************************************************************************/
+
+/* caps of the gray video holding one component of the current input */
+static GstCaps *
+gst_extract_color_component_caps (GstExtractColor * filt, guint comp)
+{
+  GstVideoInfo *in_info = &filt->info_in;
+  GstVideoInfo info;
+
+  if (GST_VIDEO_INFO_FORMAT (in_info) == GST_VIDEO_FORMAT_UNKNOWN ||
+      comp >= GST_VIDEO_INFO_N_COMPONENTS (in_info))
+    return NULL;
+
+  gst_video_info_set_format (&info,
+      GST_VIDEO_INFO_COMP_DEPTH (in_info, comp) > 8 ?
+      GST_VIDEO_FORMAT_GRAY16_LE : GST_VIDEO_FORMAT_GRAY8,
+      GST_VIDEO_INFO_COMP_WIDTH (in_info, comp),
+      GST_VIDEO_INFO_COMP_HEIGHT (in_info, comp));
+  GST_VIDEO_INFO_FPS_N (&info) = GST_VIDEO_INFO_FPS_N (in_info);
+  GST_VIDEO_INFO_FPS_D (&info) = GST_VIDEO_INFO_FPS_D (in_info);
+  GST_VIDEO_INFO_PAR_N (&info) = GST_VIDEO_INFO_PAR_N (in_info);
+  GST_VIDEO_INFO_PAR_D (&info) = GST_VIDEO_INFO_PAR_D (in_info);
+
+  return gst_video_info_to_caps (&info);
+}
+
+typedef struct
+{
+  GstExtractColor *filt;
+  GstPad *pad;
+  guint comp;
+} GstExtractColorStickyData;
+
+static gboolean
+gst_extract_color_copy_sticky (GstPad * sinkpad, GstEvent ** event,
+    gpointer user_data)
+{
+  GstExtractColorStickyData *data = (GstExtractColorStickyData *) user_data;
+
+  if (GST_EVENT_TYPE (*event) == GST_EVENT_CAPS) {
+    GstCaps *caps = gst_extract_color_component_caps (data->filt, data->comp);
+    if (caps) {
+      GstEvent *caps_event = gst_event_new_caps (caps);
+      gst_pad_store_sticky_event (data->pad, caps_event);
+      gst_event_unref (caps_event);
+      gst_caps_unref (caps);
+    }
+  } else {
+    gst_pad_store_sticky_event (data->pad, *event);
+  }
+
+  return TRUE;
+}
+
+static GstPad *
+gst_extract_color_request_new_pad (GstElement * element,
+    GstPadTemplate * templ, const gchar * name, const GstCaps * caps)
+{
+  GstExtractColor *filt = GST_EXTRACT_COLOR (element);
+  GstExtractColorStickyData data;
+  GEnumClass *enum_class;
+  GEnumValue *value;
+  GstPad *pad;
+
+  if (name == NULL || !g_str_has_prefix (name, "src_")) {
+    GST_WARNING_OBJECT (filt, "request pads must be named src_<component>");
+    return NULL;
+  }
+
+  enum_class = g_type_class_ref (GST_TYPE_EXTRACT_COLOR_COMPONENT);
+  value = g_enum_get_value_by_nick (enum_class, name + 4);
+  g_type_class_unref (enum_class);
+  if (value == NULL) {
+    GST_WARNING_OBJECT (filt, "unknown component in pad name %s", name);
+    return NULL;
+  }
+
+  GST_OBJECT_LOCK (filt);
+  if (filt->srcpads[value->value]) {
+    GST_OBJECT_UNLOCK (filt);
+    GST_WARNING_OBJECT (filt, "pad %s already exists", name);
+    return NULL;
+  }
+  pad = gst_pad_new_from_template (templ, name);
+  filt->srcpads[value->value] = pad;
+  GST_OBJECT_UNLOCK (filt);
+
+  gst_pad_use_fixed_caps (pad);
+  gst_element_add_pad (element, pad);
+
+  /* join a running stream with its current events */
+  data.filt = filt;
+  data.pad = pad;
+  data.comp = value->value;
+  gst_pad_sticky_events_foreach (GST_BASE_TRANSFORM_SINK_PAD (filt),
+      gst_extract_color_copy_sticky, &data);
+
+  return pad;
+}
+
+static void
+gst_extract_color_release_pad (GstElement * element, GstPad * pad)
+{
+  GstExtractColor *filt = GST_EXTRACT_COLOR (element);
+  guint i;
+
+  GST_OBJECT_LOCK (filt);
+  for (i = 0; i < GST_EXTRACT_COLOR_N_COMPONENTS; i++) {
+    if (filt->srcpads[i] == pad)
+      filt->srcpads[i] = NULL;
+  }
+  GST_OBJECT_UNLOCK (filt);
+
+  gst_pad_set_active (pad, FALSE);
+  gst_element_remove_pad (element, pad);
+}
+
+/* take a ref on every request pad, so they can be used without the lock */
+static guint
+gst_extract_color_get_srcpads (GstExtractColor * filt, GstPad ** pads,
+    guint * comps)
+{
+  guint i, n = 0;
+
+  GST_OBJECT_LOCK (filt);
+  for (i = 0; i < GST_EXTRACT_COLOR_N_COMPONENTS; i++) {
+    if (filt->srcpads[i]) {
+      pads[n] = gst_object_ref (filt->srcpads[i]);
+      comps[n] = i;
+      n++;
+    }
+  }
+  GST_OBJECT_UNLOCK (filt);
+
+  return n;
+}
+
+/************************************************************************/
+/* GstBaseTransform vmethod implementations                             */
+/************************************************************************/
+
+/* scale a dimension by a component's subsampling, or back to every size
+ * subsampling to it */
+static void
+scale_dimension (GstStructure * s, const gchar * field, guint sub,
+    GstPadDirection direction)
+{
+  const GValue *value = gst_structure_get_value (s, field);
+  gint min, max;
+
+  if (value == NULL || sub == 0)
+    return;
+
+  if (G_VALUE_HOLDS_INT (value)) {
+    min = max = g_value_get_int (value);
+  } else if (GST_VALUE_HOLDS_INT_RANGE (value)) {
+    min = gst_value_get_int_range_min (value);
+    max = gst_value_get_int_range_max (value);
+  } else {
+    return;
+  }
+
+  if (direction == GST_PAD_SINK) {
+    min = GST_VIDEO_SUB_SCALE (sub, min);
+    max = GST_VIDEO_SUB_SCALE (sub, max);
+  } else {
+    min = MIN (((min - 1) << sub) + 1, G_MAXINT >> sub);
+    max = max > (G_MAXINT >> sub) ? G_MAXINT : max << sub;
+  }
+
+  if (min == max)
+    gst_structure_set (s, field, G_TYPE_INT, min, NULL);
+  else
+    gst_structure_set (s, field, GST_TYPE_INT_RANGE, min, max, NULL);
+}
+
 GstCaps *
 gst_extract_color_transform_caps (GstBaseTransform * trans,
     GstPadDirection direction, GstCaps * caps, GstCaps * filter_caps)
 {
   GstExtractColor *filt = GST_EXTRACT_COLOR (trans);
-  GstCaps *normalized_caps, *other_caps;
-  GstCaps *rgb8_caps, *rgb16_caps, *gray8_caps, *gray16_caps;
-  guint i, n;
+  GstCaps *normalized_caps, *other_caps, *color_caps;
+  GstCaps *gray8_caps, *gray16_caps;
+  guint comp = filt->component;
+  guint i, n, j, n_color;
 
   GST_LOG_OBJECT (filt, "transforming caps from %" GST_PTR_FORMAT, caps);
 
@@ -265,46 +539,65 @@ gst_extract_color_transform_caps (GstBaseTransform * trans,
   normalized_caps = gst_caps_normalize (gst_caps_ref (caps));
   gray8_caps = gst_caps_from_string (GST_VIDEO_CAPS_MAKE ("GRAY8"));
   gray16_caps = gst_caps_from_string (GST_VIDEO_CAPS_MAKE ("GRAY16_LE"));
-  rgb8_caps = gst_caps_from_string (GST_VIDEO_CAPS_MAKE (RGB8_FORMATS));
-  rgb16_caps = gst_caps_from_string (GST_VIDEO_CAPS_MAKE (RGB16_FORMATS));
+  /* every color format as its own structure */
+  color_caps = gst_caps_normalize (gst_static_pad_template_get_caps
+      (&gst_extract_color_sink_template));
+  n_color = gst_caps_get_size (color_caps);
 
   n = gst_caps_get_size (normalized_caps);
   for (i = 0; i < n; ++i) {
     GstCaps *c = gst_caps_copy_nth (normalized_caps, i);
-    GstCaps *tgt_caps = NULL;
-    const GValue *format_value;
-    if (i > 0 && gst_caps_is_subset (other_caps, c))
-      continue;
+    GstStructure *s = gst_caps_get_structure (c, 0);
 
     if (direction == GST_PAD_SRC) {
-      /* we're on gray side, return color caps */
-      if (gst_caps_is_subset (c, gray8_caps)) {
-        tgt_caps = rgb8_caps;
-      } else {
-        tgt_caps = rgb16_caps;
+      /* we're on gray side, return color caps with the component at this
+       * size and depth */
+      guint depth = gst_caps_is_subset (c, gray8_caps) ? 8 : 16;
+
+      for (j = 0; j < n_color; j++) {
+        GstStructure *color_s = gst_caps_get_structure (color_caps, j);
+        const GstVideoFormatInfo *finfo =
+            gst_video_format_get_info (gst_video_format_from_string
+            (gst_structure_get_string (color_s, "format")));
+        GstCaps *tgt;
+        GstStructure *tgt_s;
+
+        if (!finfo || comp >= GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo) ||
+            GST_VIDEO_FORMAT_INFO_DEPTH (finfo, comp) != depth)
+          continue;
+
+        tgt = gst_caps_copy (c);
+        tgt_s = gst_caps_get_structure (tgt, 0);
+        gst_structure_set_value (tgt_s, "format",
+            gst_structure_get_value (color_s, "format"));
+        scale_dimension (tgt_s, "width", finfo->w_sub[comp], direction);
+        scale_dimension (tgt_s, "height", finfo->h_sub[comp], direction);
+        gst_caps_merge (other_caps, tgt);
       }
+      gst_caps_unref (c);
     } else {
       /* we're on color side, return gray caps */
-      if (gst_caps_is_subset (c, rgb8_caps)) {
-        tgt_caps = gray8_caps;
-      } else {
-        tgt_caps = gray16_caps;
-      }
-    }
+      const GstVideoFormatInfo *finfo =
+          gst_video_format_get_info (gst_video_format_from_string
+          (gst_structure_get_string (s, "format")));
 
-    format_value =
-        gst_structure_get_value (gst_caps_get_structure (tgt_caps, 0),
-        "format");
-    gst_structure_set_value (gst_caps_get_structure (c, 0), "format",
-        format_value);
+      if (!finfo || comp >= GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo)) {
+        gst_caps_unref (c);
+        continue;
+      }
 
-    gst_caps_merge (other_caps, c);
+      gst_structure_set (s, "format", G_TYPE_STRING,
+          GST_VIDEO_FORMAT_INFO_DEPTH (finfo, comp) > 8 ? "GRAY16_LE" : "GRAY8",
+          NULL);
+      scale_dimension (s, "width", finfo->w_sub[comp], direction);
+      scale_dimension (s, "height", finfo->h_sub[comp], direction);
+      gst_caps_merge (other_caps, c);
+    }
   }
 
   gst_caps_unref (gray8_caps);
   gst_caps_unref (gray16_caps);
-  gst_caps_unref (rgb8_caps);
-  gst_caps_unref (rgb16_caps);
+  gst_caps_unref (color_caps);
   gst_caps_unref (normalized_caps);
 
   if (!gst_caps_is_empty (other_caps) && filter_caps) {
@@ -319,6 +612,45 @@ gst_extract_color_transform_caps (GstBaseTransform * trans,
   return other_caps;
 }
 
+static gboolean
+gst_extract_color_sink_event (GstBaseTransform * trans, GstEvent * event)
+{
+  GstExtractColor *filt = GST_EXTRACT_COLOR (trans);
+  GstPad *pads[GST_EXTRACT_COLOR_N_COMPONENTS];
+  guint comps[GST_EXTRACT_COLOR_N_COMPONENTS];
+  gboolean is_caps = GST_EVENT_TYPE (event) == GST_EVENT_CAPS;
+  gboolean ret;
+  guint i, n;
+
+  n = gst_extract_color_get_srcpads (filt, pads, comps);
+
+  /* like tee, request pads see every event except caps, which are made for
+   * each of them once the input caps are known */
+  if (!is_caps) {
+    for (i = 0; i < n; i++)
+      gst_pad_push_event (pads[i], gst_event_ref (event));
+  }
+
+  ret = GST_BASE_TRANSFORM_CLASS (gst_extract_color_parent_class)->sink_event
+      (trans, event);
+
+  for (i = 0; i < n; i++) {
+    if (is_caps && ret) {
+      GstCaps *caps = gst_extract_color_component_caps (filt, comps[i]);
+      if (caps) {
+        gst_pad_push_event (pads[i], gst_event_new_caps (caps));
+        gst_caps_unref (caps);
+      } else {
+        GST_WARNING_OBJECT (filt, "input has no component for pad %s",
+            GST_PAD_NAME (pads[i]));
+      }
+    }
+    gst_object_unref (pads[i]);
+  }
+
+  return ret;
+}
+
 static gboolean
 gst_extract_color_set_info (GstVideoFilter * filter, GstCaps * incaps,
     GstVideoInfo * in_info, GstCaps * outcaps, GstVideoInfo * out_info)
@@ -335,79 +667,380 @@ gst_extract_color_set_info (GstVideoFilter * filter, GstCaps * incaps,
   return res;
 }
 
+typedef void (*GstExtractColorCopy8) (guint8 * d1, int d1_stride,
+    const guint8 * s1, int s1_stride, int n, int m);
+typedef void (*GstExtractColorCopy16) (guint16 * d1, int d1_stride,
+    const guint16 * s1, int s1_stride, int n, int m);
+
+static const GstExtractColorCopy8 copy16_funcs[] = {
+  extractcolor_orc_copy16_0, extractcolor_orc_copy16_1
+};
+
+static const GstExtractColorCopy8 copy32_funcs[] = {
+  extractcolor_orc_copy32_0, extractcolor_orc_copy32_1,
+  extractcolor_orc_copy32_2, extractcolor_orc_copy32_3
+};
+
+static const GstExtractColorCopy16 copy64_funcs[] = {
+  extractcolor_orc_copy64_0, extractcolor_orc_copy64_1,
+  extractcolor_orc_copy64_2, extractcolor_orc_copy64_3
+};
+
+/* index of a component among the bytes or words of its pixel, in the order
+ * the ORC select opcodes number them */
+static guint
+gst_extract_color_word_index (GstVideoFrame * frame, guint comp)
+{
+  const guint bytes = GST_VIDEO_FRAME_COMP_DEPTH (frame, comp) > 8 ? 2 : 1;
+  const guint n_words = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, comp) / bytes;
+  guint idx = GST_VIDEO_FRAME_COMP_POFFSET (frame, comp) / bytes;
+
+  if (G_BYTE_ORDER == G_BIG_ENDIAN)
+    idx = n_words - 1 - idx;
+
+  return idx;
+}
+
+/* the rows of a component covering frame rows [row_start, row_end), which
+ * start on a multiple of the vertical subsampling */
+static gint
+gst_extract_color_comp_rows (GstVideoFrame * frame, guint comp,
+    gint row_start, gint row_end, gint * comp_start)
+{
+  const gint h_sub = GST_VIDEO_FORMAT_INFO_H_SUB (frame->info.finfo, comp);
+
+  *comp_start = GST_VIDEO_SUB_SCALE (h_sub, row_start);
+
+  return GST_VIDEO_SUB_SCALE (h_sub, row_end) - *comp_start;
+}
+
+static void
+gst_extract_color_copy_component (GstVideoFrame * in_frame, guint comp,
+    GstVideoFrame * out_frame, gint row_start, gint row_end)
+{
+  const gint plane = GST_VIDEO_FRAME_COMP_PLANE (in_frame, comp);
+  const gint pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (in_frame, comp);
+  const gint bytes = GST_VIDEO_FRAME_COMP_DEPTH (in_frame, comp) > 8 ? 2 : 1;
+  const gint width = GST_VIDEO_FRAME_COMP_WIDTH (in_frame, comp);
+  const gint src_stride = GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, plane);
+  const gint dst_stride = GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 0);
+  const guint idx = gst_extract_color_word_index (in_frame, comp);
+  guint8 *src, *dst;
+  gint x, y, y0, height;
+
+  height = gst_extract_color_comp_rows (in_frame, comp, row_start, row_end,
+      &y0);
+  src = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (in_frame, plane) +
+      y0 * src_stride;
+  dst = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0) + y0 * dst_stride;
+
+  if (pstride == bytes) {
+    /* planar, the plane is the component */
+    src += GST_VIDEO_FRAME_COMP_POFFSET (in_frame, comp);
+    for (y = 0; y < height; y++)
+      memcpy (dst + y * dst_stride, src + y * src_stride, width * bytes);
+  } else if (bytes == 1 && pstride == 2) {
+    copy16_funcs[idx] (dst, dst_stride, src, src_stride, width, height);
+  } else if (bytes == 1 && pstride == 4) {
+    copy32_funcs[idx] (dst, dst_stride, src, src_stride, width, height);
+  } else if (bytes == 2 && pstride == 8) {
+    copy64_funcs[idx] ((guint16 *) dst, dst_stride, (guint16 *) src,
+        src_stride, width, height);
+  } else if (bytes == 1) {
+    /* 24-bit packed formats */
+    src += GST_VIDEO_FRAME_COMP_POFFSET (in_frame, comp);
+    for (y = 0; y < height; y++) {
+      const guint8 *s = src + y * src_stride;
+      guint8 *d = dst + y * dst_stride;
+      for (x = 0; x < width; x++)
+        d[x] = s[x * pstride];
+    }
+  } else {
+    src += GST_VIDEO_FRAME_COMP_POFFSET (in_frame, comp);
+    for (y = 0; y < height; y++) {
+      const guint16 *s = (const guint16 *) (src + y * src_stride);
+      guint16 *d = (guint16 *) (dst + y * dst_stride);
+      for (x = 0; x < width; x++)
+        d[x] = s[x * pstride / 2];
+    }
+  }
+}
+
+typedef struct
+{
+  GstExtractColor *filt;
+  GstVideoFrame *in_frame;
+  guint n_out;
+  const guint *comps;
+  GstVideoFrame **out_frames;
+} GstExtractColorJob;
+
+/* Extract frame rows [row_start, row_end) of each requested component into
+ * its frame. Components sharing an interleaved plane are split out together
+ * so the plane is read once, with the unwanted outputs written over a scratch
+ * row of the band. */
+static void
+gst_extract_color_extract_rows (gpointer user_data, guint band,
+    gint row_start, gint row_end)
+{
+  GstExtractColorJob *job = (GstExtractColorJob *) user_data;
+  GstVideoFrame *in_frame = job->in_frame;
+  GstVideoFrame **out_frames = job->out_frames;
+  const guint *comps = job->comps;
+  guint8 *scratch = job->filt->scratch +
+      band * 4 * 2 * GST_VIDEO_FRAME_WIDTH (in_frame);
+  gboolean done[GST_EXTRACT_COLOR_N_COMPONENTS + 1] = { FALSE, };
+  guint i, j;
+
+  for (i = 0; i < job->n_out; i++) {
+    const guint plane = GST_VIDEO_FRAME_COMP_PLANE (in_frame, comps[i]);
+    const gint pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (in_frame, comps[i]);
+    const gint bytes =
+        GST_VIDEO_FRAME_COMP_DEPTH (in_frame, comps[i]) > 8 ? 2 : 1;
+    const gint width = GST_VIDEO_FRAME_COMP_WIDTH (in_frame, comps[i]);
+    guint8 *dst[4] = { NULL, };
+    gint dst_stride[4] = { 0, };
+    guint8 *src;
+    gint src_stride, y0, height;
+    guint n_found = 0;
+
+    if (done[i])
+      continue;
+
+    if (!((bytes == 1 && (pstride == 2 || pstride == 4)) ||
+            (bytes == 2 && pstride == 8))) {
+      gst_extract_color_copy_component (in_frame, comps[i], out_frames[i],
+          row_start, row_end);
+      done[i] = TRUE;
+      continue;
+    }
+
+    height = gst_extract_color_comp_rows (in_frame, comps[i], row_start,
+        row_end, &y0);
+
+    for (j = i; j < job->n_out; j++) {
+      guint idx;
+
+      if (done[j] || GST_VIDEO_FRAME_COMP_PLANE (in_frame, comps[j]) != plane)
+        continue;
+      idx = gst_extract_color_word_index (in_frame, comps[j]);
+      /* the same component twice is extracted on its own */
+      if (dst[idx])
+        continue;
+      dst_stride[idx] = GST_VIDEO_FRAME_PLANE_STRIDE (out_frames[j], 0);
+      dst[idx] = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (out_frames[j], 0) +
+          y0 * dst_stride[idx];
+      done[j] = TRUE;
+      n_found++;
+    }
+
+    if (n_found == 1) {
+      gst_extract_color_copy_component (in_frame, comps[i], out_frames[i],
+          row_start, row_end);
+      continue;
+    }
+
+    for (j = 0; j < 4; j++) {
+      if (dst[j] == NULL)
+        dst[j] = scratch + j * 2 * width;
+    }
+
+    src_stride = GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, plane);
+    src = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (in_frame, plane) +
+        y0 * src_stride;
+    if (pstride == 2) {
+      extractcolor_orc_split16 (dst[0], dst_stride[0], dst[1], dst_stride[1],
+          src, src_stride, width, height);
+    } else if (pstride == 4) {
+      extractcolor_orc_split32 (dst[0], dst_stride[0], dst[1], dst_stride[1],
+          dst[2], dst_stride[2], dst[3], dst_stride[3], src, src_stride, width,
+          height);
+    } else {
+      extractcolor_orc_split64 ((guint16 *) dst[0], dst_stride[0],
+          (guint16 *) dst[1], dst_stride[1], (guint16 *) dst[2],
+          dst_stride[2], (guint16 *) dst[3], dst_stride[3],
+          (guint16 *) src, src_stride, width, height);
+    }
+  }
+}
+
+static void
+gst_extract_color_extract (GstExtractColor * filt, GstVideoFrame * in_frame,
+    guint n_out, const guint * comps, GstVideoFrame ** out_frames)
+{
+  GstExtractColorJob job;
+  GstParallelRunner *runner;
+  gsize scratch_size;
+  gint align = 1;
+  guint i;
+
+  if (n_out == 0)
+    return;
+
+  runner = gst_parallel_runner_ensure (&filt->runner, filt->n_threads);
+
+  /* four rows of 16-bit samples per band, one for each output of a split
+   * kernel */
+  scratch_size = gst_parallel_runner_get_n_threads (runner) * 4 * 2 *
+      GST_VIDEO_FRAME_WIDTH (in_frame);
+  if (filt->scratch_size < scratch_size) {
+    g_free (filt->scratch);
+    filt->scratch = g_malloc (scratch_size);
+    filt->scratch_size = scratch_size;
+  }
+
+  /* bands start on a row shared by all subsampled components */
+  for (i = 0; i < GST_VIDEO_FRAME_N_COMPONENTS (in_frame); i++)
+    align = MAX (align,
+        1 << GST_VIDEO_FORMAT_INFO_H_SUB (in_frame->info.finfo, i));
+
+  job.filt = filt;
+  job.in_frame = in_frame;
+  job.n_out = n_out;
+  job.comps = comps;
+  job.out_frames = out_frames;
+  gst_parallel_runner_run_rows (runner, GST_VIDEO_FRAME_HEIGHT (in_frame),
+      align, gst_extract_color_extract_rows, &job);
+}
+
+/* Wrap the plane holding a component in a buffer sharing the input memory,
+ * or return NULL when the component is interleaved with others or its
+ * stride would need a video meta that isn't allowed. */
+static GstBuffer *
+gst_extract_color_share_component (GstExtractColor * filt, GstBuffer * inbuf,
+    guint comp, const GstVideoInfo * out_info, gboolean allow_meta)
+{
+  GstVideoInfo *in_info = &filt->info_in;
+  GstVideoMeta *meta;
+  GstBuffer *outbuf;
+  gsize offset[GST_VIDEO_MAX_PLANES] = { 0, };
+  gint stride[GST_VIDEO_MAX_PLANES] = { 0, };
+  gsize in_offset, size, buf_size;
+  gint plane, bytes, width, height;
+
+  if (comp >= GST_VIDEO_INFO_N_COMPONENTS (in_info))
+    return NULL;
+
+  bytes = GST_VIDEO_INFO_COMP_DEPTH (in_info, comp) > 8 ? 2 : 1;
+  if (GST_VIDEO_INFO_COMP_PSTRIDE (in_info, comp) != bytes)
+    return NULL;
+
+  plane = GST_VIDEO_INFO_COMP_PLANE (in_info, comp);
+  width = GST_VIDEO_INFO_COMP_WIDTH (in_info, comp);
+  height = GST_VIDEO_INFO_COMP_HEIGHT (in_info, comp);
+
+  meta = gst_buffer_get_video_meta (inbuf);
+  if (meta) {
+    in_offset = meta->offset[plane];
+    stride[0] = meta->stride[plane];
+  } else {
+    in_offset = GST_VIDEO_INFO_PLANE_OFFSET (in_info, plane);
+    stride[0] = GST_VIDEO_INFO_PLANE_STRIDE (in_info, plane);
+  }
+  in_offset += GST_VIDEO_INFO_COMP_POFFSET (in_info, comp);
+
+  if (!allow_meta && stride[0] != GST_VIDEO_INFO_PLANE_STRIDE (out_info, 0))
+    return NULL;
+
+  /* without a meta the buffer must have the full default size, with one the
+   * padding after the last row can be left out */
+  buf_size = gst_buffer_get_size (inbuf);
+  size = (gsize) stride[0] * height;
+  if (in_offset + size > buf_size) {
+    if (!allow_meta)
+      return NULL;
+    size = (gsize) stride[0] * (height - 1) + width * bytes;
+    if (in_offset + size > buf_size)
+      return NULL;
+  }
+
+  outbuf = gst_buffer_copy_region (inbuf, GST_BUFFER_COPY_FLAGS |
+      GST_BUFFER_COPY_TIMESTAMPS | GST_BUFFER_COPY_MEMORY, in_offset, size);
+  if (outbuf && allow_meta)
+    gst_buffer_add_video_meta_full (outbuf, GST_VIDEO_FRAME_FLAG_NONE,
+        GST_VIDEO_INFO_FORMAT (out_info), width, height, 1, offset, stride);
+
+  return outbuf;
+}
+
+/* Fill out_frame, unless it is NULL because the output shares the input,
+ * and push a buffer on every request pad. */
 static GstFlowReturn
-gst_extract_color_transform_frame (GstVideoFilter * filter,
-    GstVideoFrame * in_frame, GstVideoFrame * out_frame)
+gst_extract_color_process (GstExtractColor * filt, GstVideoFrame * in_frame,
+    GstVideoFrame * out_frame)
 {
-  GstExtractColor *filt = GST_EXTRACT_COLOR (filter);
   GTimer *timer = NULL;
-  guint comp = filt->component;
-
-  GST_LOG_OBJECT (filt, "Performing non-inplace transform");
+  GstPad *pads[GST_EXTRACT_COLOR_N_COMPONENTS];
+  GstBuffer *buffers[GST_EXTRACT_COLOR_N_COMPONENTS];
+  GstVideoFrame frames[GST_EXTRACT_COLOR_N_COMPONENTS + 1];
+  GstVideoFrame *out_frames[GST_EXTRACT_COLOR_N_COMPONENTS + 1];
+  guint comps[GST_EXTRACT_COLOR_N_COMPONENTS + 1];
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i, n_pads, n_out, n_mapped;
 
 #if 0
   timer = g_timer_new ();
 #endif
 
-  if (GST_VIDEO_FRAME_COMP_DEPTH (in_frame, comp) == 8) {
-    guint8 *src, *dst;
-
-    src = GST_VIDEO_FRAME_PLANE_DATA (in_frame, 0);
-    dst = GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0);
-
-    switch (GST_VIDEO_FRAME_COMP_OFFSET (in_frame, comp)) {
-      case 0:
-        extractcolor_orc_copy32_0 (dst, GST_VIDEO_FRAME_PLANE_STRIDE (out_frame,
-                0), src, GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 0),
-            GST_VIDEO_FRAME_WIDTH (in_frame),
-            GST_VIDEO_FRAME_HEIGHT (out_frame));
-        break;
-      case 1:
-        extractcolor_orc_copy32_1 (dst, GST_VIDEO_FRAME_PLANE_STRIDE (out_frame,
-                0), src, GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 0),
-            GST_VIDEO_FRAME_WIDTH (in_frame),
-            GST_VIDEO_FRAME_HEIGHT (out_frame));
-        break;
-      case 2:
-        extractcolor_orc_copy32_2 (dst, GST_VIDEO_FRAME_PLANE_STRIDE (out_frame,
-                0), src, GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 0),
-            GST_VIDEO_FRAME_WIDTH (in_frame),
-            GST_VIDEO_FRAME_HEIGHT (out_frame));
-        break;
-      case 3:
-        extractcolor_orc_copy32_3 (dst, GST_VIDEO_FRAME_PLANE_STRIDE (out_frame,
-                0), src, GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 0),
-            GST_VIDEO_FRAME_WIDTH (in_frame),
-            GST_VIDEO_FRAME_HEIGHT (out_frame));
-        break;
-      default:
-        g_assert_not_reached ();
+  /* the request pads come first, the always src pad last */
+  n_pads = gst_extract_color_get_srcpads (filt, pads, comps);
+  n_out = 0;
+  for (i = 0; i < n_pads; i++) {
+    GstVideoInfo info;
+    GstCaps *caps = gst_pad_get_current_caps (pads[i]);
+
+    buffers[i] = NULL;
+    if (caps == NULL)
+      continue;
+    if (comps[i] >= GST_VIDEO_FRAME_N_COMPONENTS (in_frame)) {
+      gst_caps_unref (caps);
+      continue;
     }
-#if 0
-    gint x, y;
-    const guint pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (in_frame, comp);
-    src = GST_VIDEO_FRAME_COMP_DATA (in_frame, comp);
-    dst = GST_VIDEO_FRAME_COMP_DATA (out_frame, 0);
-    for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (in_frame, comp); y++) {
-      for (x = 0; x < GST_VIDEO_FRAME_COMP_WIDTH (in_frame, comp); x++) {
-        dst[x] = src[x * pstride];
+    if (gst_video_info_from_caps (&info, caps)) {
+      /* downstream of a request pad never saw an allocation query, so only
+       * share planes laid out as it expects */
+      if (filt->zero_copy)
+        buffers[i] = gst_extract_color_share_component (filt,
+            in_frame->buffer, comps[i], &info, FALSE);
+      if (buffers[i] == NULL) {
+        buffers[i] = gst_buffer_new_allocate (NULL,
+            GST_VIDEO_INFO_SIZE (&info), NULL);
+        gst_buffer_copy_into (buffers[i], in_frame->buffer,
+            GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+        if (gst_video_frame_map (&frames[n_out], &info, buffers[i],
+                GST_MAP_WRITE)) {
+          out_frames[n_out] = &frames[n_out];
+          comps[n_out] = comps[i];
+          n_out++;
+        } else {
+          gst_buffer_unref (buffers[i]);
+          buffers[i] = NULL;
+        }
       }
-      src += GST_VIDEO_FRAME_COMP_STRIDE (in_frame, comp);
-      dst += GST_VIDEO_FRAME_COMP_STRIDE (out_frame, 0);
     }
-#endif
-  } else {
-    gint x, y;
-    guint16 *src = (guint16 *) GST_VIDEO_FRAME_COMP_DATA (in_frame, comp);
-    guint16 *dst = (guint16 *) GST_VIDEO_FRAME_COMP_DATA (out_frame, 0);
-    const guint pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (in_frame, comp) / 2;
-    for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (in_frame, comp); y++) {
-      for (x = 0; x < GST_VIDEO_FRAME_COMP_WIDTH (in_frame, comp); x++) {
-        dst[x] = src[x * pstride];
-      }
-      src += GST_VIDEO_FRAME_COMP_STRIDE (in_frame, comp) / 2;
-      dst += GST_VIDEO_FRAME_COMP_STRIDE (out_frame, 0) / 2;
+    gst_caps_unref (caps);
+  }
+  n_mapped = n_out;
+  if (out_frame) {
+    out_frames[n_out] = out_frame;
+    comps[n_out] = filt->component;
+    n_out++;
+  }
+
+  gst_extract_color_extract (filt, in_frame, n_out, comps, out_frames);
+
+  for (i = 0; i < n_mapped; i++)
+    gst_video_frame_unmap (&frames[i]);
+
+  for (i = 0; i < n_pads; i++) {
+    if (buffers[i]) {
+      GstFlowReturn pad_ret = gst_pad_push (pads[i], buffers[i]);
+
+      /* an unlinked or finished branch doesn't stop the others */
+      if (pad_ret == GST_FLOW_FLUSHING || pad_ret <= GST_FLOW_NOT_NEGOTIATED)
+        ret = pad_ret;
     }
+    gst_object_unref (pads[i]);
   }
 
 #if 0
@@ -416,9 +1049,85 @@ gst_extract_color_transform_frame (GstVideoFilter * filter,
   g_timer_destroy (timer);
 #endif
 
-  return GST_FLOW_OK;
+  return ret;
 }
 
+static GstFlowReturn
+gst_extract_color_transform_frame (GstVideoFilter * filter,
+    GstVideoFrame * in_frame, GstVideoFrame * out_frame)
+{
+  GstExtractColor *filt = GST_EXTRACT_COLOR (filter);
+
+  GST_LOG_OBJECT (filt, "Performing non-inplace transform");
+
+  return gst_extract_color_process (filt, in_frame, out_frame);
+}
+
+static gboolean
+gst_extract_color_decide_allocation (GstBaseTransform * trans,
+    GstQuery * query)
+{
+  GstExtractColor *filt = GST_EXTRACT_COLOR (trans);
+
+  filt->downstream_video_meta =
+      gst_query_find_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
+
+  return GST_BASE_TRANSFORM_CLASS (gst_extract_color_parent_class)->
+      decide_allocation (trans, query);
+}
+
+static GstFlowReturn
+gst_extract_color_prepare_output_buffer (GstBaseTransform * trans,
+    GstBuffer * input, GstBuffer ** outbuf)
+{
+  GstExtractColor *filt = GST_EXTRACT_COLOR (trans);
+
+  filt->shared_output = FALSE;
+  if (filt->zero_copy) {
+    *outbuf = gst_extract_color_share_component (filt, input,
+        filt->component, &filt->info_out, filt->downstream_video_meta);
+    if (*outbuf) {
+      GST_LOG_OBJECT (filt, "sharing input plane");
+      filt->shared_output = TRUE;
+      return GST_FLOW_OK;
+    }
+  }
+
+  return GST_BASE_TRANSFORM_CLASS (gst_extract_color_parent_class)->
+      prepare_output_buffer (trans, input, outbuf);
+}
+
+static GstFlowReturn
+gst_extract_color_transform (GstBaseTransform * trans, GstBuffer * inbuf,
+    GstBuffer * outbuf)
+{
+  GstExtractColor *filt = GST_EXTRACT_COLOR (trans);
+  GstVideoFrame in_frame;
+  GstFlowReturn ret;
+  guint i;
+  gboolean have_srcpads = FALSE;
+
+  if (!filt->shared_output)
+    return GST_BASE_TRANSFORM_CLASS (gst_extract_color_parent_class)->transform
+        (trans, inbuf, outbuf);
+
+  /* the output is already done, only the request pads may need work */
+  GST_OBJECT_LOCK (filt);
+  for (i = 0; i < GST_EXTRACT_COLOR_N_COMPONENTS; i++)
+    have_srcpads |= filt->srcpads[i] != NULL;
+  GST_OBJECT_UNLOCK (filt);
+  if (!have_srcpads)
+    return GST_FLOW_OK;
+
+  if (!gst_video_frame_map (&in_frame, &filt->info_in, inbuf, GST_MAP_READ)) {
+    GST_ELEMENT_ERROR (filt, STREAM, FAILED, ("Failed to map buffer"), (NULL));
+    return GST_FLOW_ERROR;
+  }
+  ret = gst_extract_color_process (filt, &in_frame, NULL);
+  gst_video_frame_unmap (&in_frame);
+
+  return ret;
+}
 
 static void
 gst_extract_color_reset (GstExtractColor * extract_color)
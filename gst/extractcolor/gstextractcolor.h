@@ -28,6 +28,8 @@
 #include <gst/video/gstvideofilter.h>
 #include <gst/video/video.h>
 
+#include "parallel.h"
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_EXTRACT_COLOR \
@@ -49,15 +51,20 @@ typedef struct _GstExtractColorClass GstExtractColorClass;
 * @GST_EXTRACT_COLOR_COMPONENT_RED: extract red component
 * @GST_EXTRACT_COLOR_COMPONENT_GREEN: extract green component
 * @GST_EXTRACT_COLOR_COMPONENT_BLUE: extract blue component
+* @GST_EXTRACT_COLOR_COMPONENT_ALPHA: extract alpha component
 *
-* Component to extract.
+* Component to extract. For YUV formats red, green and blue select the Y, U
+* and V components.
 */
 typedef enum {
   GST_EXTRACT_COLOR_COMPONENT_RED,
   GST_EXTRACT_COLOR_COMPONENT_GREEN,
-  GST_EXTRACT_COLOR_COMPONENT_BLUE
+  GST_EXTRACT_COLOR_COMPONENT_BLUE,
+  GST_EXTRACT_COLOR_COMPONENT_ALPHA
 } GstExtractColorComponent;
 
+#define GST_EXTRACT_COLOR_N_COMPONENTS 4
+
 /**
 * GstExtractColor:
 * @element: the parent element.
@@ -75,6 +82,23 @@ struct _GstExtractColor
 
   /* properties */
   GstExtractColorComponent component;
+  gboolean zero_copy;
+  guint n_threads;
+
+  /* whether downstream maps buffers through GstVideoMeta */
+  gboolean downstream_video_meta;
+  /* whether the current output buffer shares the input plane */
+  gboolean shared_output;
+
+  /* request pads extracting further components, indexed by component */
+  GstPad *srcpads[GST_EXTRACT_COLOR_N_COMPONENTS];
+
+  /* sink for the components a split kernel produces but nobody wants, one
+   * set of rows per band */
+  guint8 *scratch;
+  gsize scratch_size;
+
+  GstParallelRunner *runner;
 };
 
 struct _GstExtractColorClass
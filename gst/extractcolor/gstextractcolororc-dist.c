@@ -81,7 +81,15 @@ void extractcolor_orc_copy32_0 (guint8 * ORC_RESTRICT d1, int d1_stride, const g
 void extractcolor_orc_copy32_1 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m);
 void extractcolor_orc_copy32_2 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m);
 void extractcolor_orc_copy32_3 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m);
-
+void extractcolor_orc_copy64_0 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_copy64_1 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_copy64_2 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_copy64_3 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_copy16_0 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_copy16_1 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_split16 (guint8 * ORC_RESTRICT d1, int d1_stride, guint8 * ORC_RESTRICT d2, int d2_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_split32 (guint8 * ORC_RESTRICT d1, int d1_stride, guint8 * ORC_RESTRICT d2, int d2_stride, guint8 * ORC_RESTRICT d3, int d3_stride, guint8 * ORC_RESTRICT d4, int d4_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_split64 (guint16 * ORC_RESTRICT d1, int d1_stride, guint16 * ORC_RESTRICT d2, int d2_stride, guint16 * ORC_RESTRICT d3, int d3_stride, guint16 * ORC_RESTRICT d4, int d4_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m);
 
 /* begin Orc C target preamble */
 #define ORC_CLAMP(x,a,b) ((x)<(a) ? (a) : ((x)>(b) ? (b) : (x)))
@@ -675,3 +683,1405 @@ extractcolor_orc_copy32_3 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8
 #endif
 
 
+/* extractcolor_orc_copy64_0 */
+#ifdef DISABLE_ORC
+void
+extractcolor_orc_copy64_0 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m){
+  int i;
+  int j;
+  orc_union16 * ORC_RESTRICT ptr0;
+  const orc_union64 * ORC_RESTRICT ptr4;
+  orc_union64 var33;
+  orc_union16 var34;
+  orc_union32 var35;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(d1, d1_stride * j);
+    ptr4 = ORC_PTR_OFFSET(s1, s1_stride * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadq */
+      var33 = ptr4[i];
+      /* 1: select0ql */
+      {
+       orc_union64 _src;
+       _src.i = var33.i;
+       var35.i = _src.x2[0];
+    }
+      /* 2: select0lw */
+      {
+       orc_union32 _src;
+       _src.i = var35.i;
+       var34.i = _src.x2[0];
+    }
+      /* 3: storew */
+      ptr0[i] = var34;
+    }
+  }
+
+}
+
+#else
+static void
+_backup_extractcolor_orc_copy64_0 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int j;
+  int n = ex->n;
+  int m = ex->params[ORC_VAR_A1];
+  orc_union16 * ORC_RESTRICT ptr0;
+  const orc_union64 * ORC_RESTRICT ptr4;
+  orc_union64 var33;
+  orc_union16 var34;
+  orc_union32 var35;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(ex->arrays[0], ex->params[0] * j);
+    ptr4 = ORC_PTR_OFFSET(ex->arrays[4], ex->params[4] * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadq */
+      var33 = ptr4[i];
+      /* 1: select0ql */
+      {
+       orc_union64 _src;
+       _src.i = var33.i;
+       var35.i = _src.x2[0];
+    }
+      /* 2: select0lw */
+      {
+       orc_union32 _src;
+       _src.i = var35.i;
+       var34.i = _src.x2[0];
+    }
+      /* 3: storew */
+      ptr0[i] = var34;
+    }
+  }
+
+}
+
+void
+extractcolor_orc_copy64_0 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 7, 9, 25, 101, 120, 116, 114, 97, 99, 116, 99, 111, 108, 111, 114, 
+        95, 111, 114, 99, 95, 99, 111, 112, 121, 54, 52, 95, 48, 11, 2, 2, 
+        12, 8, 8, 20, 4, 192, 32, 4, 190, 0, 32, 2, 0, 
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_copy64_0);
+#else
+      p = orc_program_new ();
+      orc_program_set_2d (p);
+      orc_program_set_name (p, "extractcolor_orc_copy64_0");
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_copy64_0);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 8, "s1");
+      orc_program_add_temporary (p, 4, "t1");
+
+      orc_program_append_2 (p, "select0ql", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "select0lw", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ORC_EXECUTOR_M(ex) = m;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->params[ORC_VAR_D1] = d1_stride;
+  ex->arrays[ORC_VAR_S1] = (void *)s1;
+  ex->params[ORC_VAR_S1] = s1_stride;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* extractcolor_orc_copy64_1 */
+#ifdef DISABLE_ORC
+void
+extractcolor_orc_copy64_1 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m){
+  int i;
+  int j;
+  orc_union16 * ORC_RESTRICT ptr0;
+  const orc_union64 * ORC_RESTRICT ptr4;
+  orc_union64 var33;
+  orc_union16 var34;
+  orc_union32 var35;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(d1, d1_stride * j);
+    ptr4 = ORC_PTR_OFFSET(s1, s1_stride * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadq */
+      var33 = ptr4[i];
+      /* 1: select0ql */
+      {
+       orc_union64 _src;
+       _src.i = var33.i;
+       var35.i = _src.x2[0];
+    }
+      /* 2: select1lw */
+      {
+       orc_union32 _src;
+       _src.i = var35.i;
+       var34.i = _src.x2[1];
+    }
+      /* 3: storew */
+      ptr0[i] = var34;
+    }
+  }
+
+}
+
+#else
+static void
+_backup_extractcolor_orc_copy64_1 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int j;
+  int n = ex->n;
+  int m = ex->params[ORC_VAR_A1];
+  orc_union16 * ORC_RESTRICT ptr0;
+  const orc_union64 * ORC_RESTRICT ptr4;
+  orc_union64 var33;
+  orc_union16 var34;
+  orc_union32 var35;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(ex->arrays[0], ex->params[0] * j);
+    ptr4 = ORC_PTR_OFFSET(ex->arrays[4], ex->params[4] * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadq */
+      var33 = ptr4[i];
+      /* 1: select0ql */
+      {
+       orc_union64 _src;
+       _src.i = var33.i;
+       var35.i = _src.x2[0];
+    }
+      /* 2: select1lw */
+      {
+       orc_union32 _src;
+       _src.i = var35.i;
+       var34.i = _src.x2[1];
+    }
+      /* 3: storew */
+      ptr0[i] = var34;
+    }
+  }
+
+}
+
+void
+extractcolor_orc_copy64_1 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 7, 9, 25, 101, 120, 116, 114, 97, 99, 116, 99, 111, 108, 111, 114, 
+        95, 111, 114, 99, 95, 99, 111, 112, 121, 54, 52, 95, 49, 11, 2, 2, 
+        12, 8, 8, 20, 4, 192, 32, 4, 191, 0, 32, 2, 0, 
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_copy64_1);
+#else
+      p = orc_program_new ();
+      orc_program_set_2d (p);
+      orc_program_set_name (p, "extractcolor_orc_copy64_1");
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_copy64_1);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 8, "s1");
+      orc_program_add_temporary (p, 4, "t1");
+
+      orc_program_append_2 (p, "select0ql", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "select1lw", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ORC_EXECUTOR_M(ex) = m;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->params[ORC_VAR_D1] = d1_stride;
+  ex->arrays[ORC_VAR_S1] = (void *)s1;
+  ex->params[ORC_VAR_S1] = s1_stride;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* extractcolor_orc_copy64_2 */
+#ifdef DISABLE_ORC
+void
+extractcolor_orc_copy64_2 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m){
+  int i;
+  int j;
+  orc_union16 * ORC_RESTRICT ptr0;
+  const orc_union64 * ORC_RESTRICT ptr4;
+  orc_union64 var33;
+  orc_union16 var34;
+  orc_union32 var35;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(d1, d1_stride * j);
+    ptr4 = ORC_PTR_OFFSET(s1, s1_stride * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadq */
+      var33 = ptr4[i];
+      /* 1: select1ql */
+      {
+       orc_union64 _src;
+       _src.i = var33.i;
+       var35.i = _src.x2[1];
+    }
+      /* 2: select0lw */
+      {
+       orc_union32 _src;
+       _src.i = var35.i;
+       var34.i = _src.x2[0];
+    }
+      /* 3: storew */
+      ptr0[i] = var34;
+    }
+  }
+
+}
+
+#else
+static void
+_backup_extractcolor_orc_copy64_2 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int j;
+  int n = ex->n;
+  int m = ex->params[ORC_VAR_A1];
+  orc_union16 * ORC_RESTRICT ptr0;
+  const orc_union64 * ORC_RESTRICT ptr4;
+  orc_union64 var33;
+  orc_union16 var34;
+  orc_union32 var35;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(ex->arrays[0], ex->params[0] * j);
+    ptr4 = ORC_PTR_OFFSET(ex->arrays[4], ex->params[4] * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadq */
+      var33 = ptr4[i];
+      /* 1: select1ql */
+      {
+       orc_union64 _src;
+       _src.i = var33.i;
+       var35.i = _src.x2[1];
+    }
+      /* 2: select0lw */
+      {
+       orc_union32 _src;
+       _src.i = var35.i;
+       var34.i = _src.x2[0];
+    }
+      /* 3: storew */
+      ptr0[i] = var34;
+    }
+  }
+
+}
+
+void
+extractcolor_orc_copy64_2 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 7, 9, 25, 101, 120, 116, 114, 97, 99, 116, 99, 111, 108, 111, 114, 
+        95, 111, 114, 99, 95, 99, 111, 112, 121, 54, 52, 95, 50, 11, 2, 2, 
+        12, 8, 8, 20, 4, 193, 32, 4, 190, 0, 32, 2, 0, 
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_copy64_2);
+#else
+      p = orc_program_new ();
+      orc_program_set_2d (p);
+      orc_program_set_name (p, "extractcolor_orc_copy64_2");
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_copy64_2);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 8, "s1");
+      orc_program_add_temporary (p, 4, "t1");
+
+      orc_program_append_2 (p, "select1ql", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "select0lw", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ORC_EXECUTOR_M(ex) = m;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->params[ORC_VAR_D1] = d1_stride;
+  ex->arrays[ORC_VAR_S1] = (void *)s1;
+  ex->params[ORC_VAR_S1] = s1_stride;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* extractcolor_orc_copy64_3 */
+#ifdef DISABLE_ORC
+void
+extractcolor_orc_copy64_3 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m){
+  int i;
+  int j;
+  orc_union16 * ORC_RESTRICT ptr0;
+  const orc_union64 * ORC_RESTRICT ptr4;
+  orc_union64 var33;
+  orc_union16 var34;
+  orc_union32 var35;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(d1, d1_stride * j);
+    ptr4 = ORC_PTR_OFFSET(s1, s1_stride * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadq */
+      var33 = ptr4[i];
+      /* 1: select1ql */
+      {
+       orc_union64 _src;
+       _src.i = var33.i;
+       var35.i = _src.x2[1];
+    }
+      /* 2: select1lw */
+      {
+       orc_union32 _src;
+       _src.i = var35.i;
+       var34.i = _src.x2[1];
+    }
+      /* 3: storew */
+      ptr0[i] = var34;
+    }
+  }
+
+}
+
+#else
+static void
+_backup_extractcolor_orc_copy64_3 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int j;
+  int n = ex->n;
+  int m = ex->params[ORC_VAR_A1];
+  orc_union16 * ORC_RESTRICT ptr0;
+  const orc_union64 * ORC_RESTRICT ptr4;
+  orc_union64 var33;
+  orc_union16 var34;
+  orc_union32 var35;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(ex->arrays[0], ex->params[0] * j);
+    ptr4 = ORC_PTR_OFFSET(ex->arrays[4], ex->params[4] * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadq */
+      var33 = ptr4[i];
+      /* 1: select1ql */
+      {
+       orc_union64 _src;
+       _src.i = var33.i;
+       var35.i = _src.x2[1];
+    }
+      /* 2: select1lw */
+      {
+       orc_union32 _src;
+       _src.i = var35.i;
+       var34.i = _src.x2[1];
+    }
+      /* 3: storew */
+      ptr0[i] = var34;
+    }
+  }
+
+}
+
+void
+extractcolor_orc_copy64_3 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 7, 9, 25, 101, 120, 116, 114, 97, 99, 116, 99, 111, 108, 111, 114, 
+        95, 111, 114, 99, 95, 99, 111, 112, 121, 54, 52, 95, 51, 11, 2, 2, 
+        12, 8, 8, 20, 4, 193, 32, 4, 191, 0, 32, 2, 0, 
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_copy64_3);
+#else
+      p = orc_program_new ();
+      orc_program_set_2d (p);
+      orc_program_set_name (p, "extractcolor_orc_copy64_3");
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_copy64_3);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 8, "s1");
+      orc_program_add_temporary (p, 4, "t1");
+
+      orc_program_append_2 (p, "select1ql", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "select1lw", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ORC_EXECUTOR_M(ex) = m;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->params[ORC_VAR_D1] = d1_stride;
+  ex->arrays[ORC_VAR_S1] = (void *)s1;
+  ex->params[ORC_VAR_S1] = s1_stride;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* extractcolor_orc_copy16_0 */
+#ifdef DISABLE_ORC
+void
+extractcolor_orc_copy16_0 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m){
+  int i;
+  int j;
+  orc_int8 * ORC_RESTRICT ptr0;
+  const orc_union16 * ORC_RESTRICT ptr4;
+  orc_int8 var33;
+  orc_union16 var34;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(d1, d1_stride * j);
+    ptr4 = ORC_PTR_OFFSET(s1, s1_stride * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadw */
+      var34 = ptr4[i];
+      /* 1: select0wb */
+      {
+       orc_union16 _src;
+       _src.i = var34.i;
+       var33 = _src.x2[0];
+    }
+      /* 2: storeb */
+      ptr0[i] = var33;
+    }
+  }
+
+}
+
+#else
+static void
+_backup_extractcolor_orc_copy16_0 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int j;
+  int n = ex->n;
+  int m = ex->params[ORC_VAR_A1];
+  orc_int8 * ORC_RESTRICT ptr0;
+  const orc_union16 * ORC_RESTRICT ptr4;
+  orc_int8 var33;
+  orc_union16 var34;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(ex->arrays[0], ex->params[0] * j);
+    ptr4 = ORC_PTR_OFFSET(ex->arrays[4], ex->params[4] * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadw */
+      var34 = ptr4[i];
+      /* 1: select0wb */
+      {
+       orc_union16 _src;
+       _src.i = var34.i;
+       var33 = _src.x2[0];
+    }
+      /* 2: storeb */
+      ptr0[i] = var33;
+    }
+  }
+
+}
+
+void
+extractcolor_orc_copy16_0 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 7, 9, 25, 101, 120, 116, 114, 97, 99, 116, 99, 111, 108, 111, 114, 
+        95, 111, 114, 99, 95, 99, 111, 112, 121, 49, 54, 95, 48, 11, 1, 1, 
+        12, 2, 2, 188, 0, 4, 2, 0, 
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_copy16_0);
+#else
+      p = orc_program_new ();
+      orc_program_set_2d (p);
+      orc_program_set_name (p, "extractcolor_orc_copy16_0");
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_copy16_0);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 2, "s1");
+
+      orc_program_append_2 (p, "select0wb", 0, ORC_VAR_D1, ORC_VAR_S1, ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ORC_EXECUTOR_M(ex) = m;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->params[ORC_VAR_D1] = d1_stride;
+  ex->arrays[ORC_VAR_S1] = (void *)s1;
+  ex->params[ORC_VAR_S1] = s1_stride;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* extractcolor_orc_copy16_1 */
+#ifdef DISABLE_ORC
+void
+extractcolor_orc_copy16_1 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m){
+  int i;
+  int j;
+  orc_int8 * ORC_RESTRICT ptr0;
+  const orc_union16 * ORC_RESTRICT ptr4;
+  orc_int8 var33;
+  orc_union16 var34;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(d1, d1_stride * j);
+    ptr4 = ORC_PTR_OFFSET(s1, s1_stride * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadw */
+      var34 = ptr4[i];
+      /* 1: select1wb */
+      {
+       orc_union16 _src;
+       _src.i = var34.i;
+       var33 = _src.x2[1];
+    }
+      /* 2: storeb */
+      ptr0[i] = var33;
+    }
+  }
+
+}
+
+#else
+static void
+_backup_extractcolor_orc_copy16_1 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int j;
+  int n = ex->n;
+  int m = ex->params[ORC_VAR_A1];
+  orc_int8 * ORC_RESTRICT ptr0;
+  const orc_union16 * ORC_RESTRICT ptr4;
+  orc_int8 var33;
+  orc_union16 var34;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(ex->arrays[0], ex->params[0] * j);
+    ptr4 = ORC_PTR_OFFSET(ex->arrays[4], ex->params[4] * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadw */
+      var34 = ptr4[i];
+      /* 1: select1wb */
+      {
+       orc_union16 _src;
+       _src.i = var34.i;
+       var33 = _src.x2[1];
+    }
+      /* 2: storeb */
+      ptr0[i] = var33;
+    }
+  }
+
+}
+
+void
+extractcolor_orc_copy16_1 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 7, 9, 25, 101, 120, 116, 114, 97, 99, 116, 99, 111, 108, 111, 114, 
+        95, 111, 114, 99, 95, 99, 111, 112, 121, 49, 54, 95, 49, 11, 1, 1, 
+        12, 2, 2, 189, 0, 4, 2, 0, 
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_copy16_1);
+#else
+      p = orc_program_new ();
+      orc_program_set_2d (p);
+      orc_program_set_name (p, "extractcolor_orc_copy16_1");
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_copy16_1);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 2, "s1");
+
+      orc_program_append_2 (p, "select1wb", 0, ORC_VAR_D1, ORC_VAR_S1, ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ORC_EXECUTOR_M(ex) = m;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->params[ORC_VAR_D1] = d1_stride;
+  ex->arrays[ORC_VAR_S1] = (void *)s1;
+  ex->params[ORC_VAR_S1] = s1_stride;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* extractcolor_orc_split16 */
+#ifdef DISABLE_ORC
+void
+extractcolor_orc_split16 (guint8 * ORC_RESTRICT d1, int d1_stride, guint8 * ORC_RESTRICT d2, int d2_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m){
+  int i;
+  int j;
+  orc_int8 * ORC_RESTRICT ptr0;
+  orc_int8 * ORC_RESTRICT ptr1;
+  const orc_union16 * ORC_RESTRICT ptr4;
+  orc_int8 var33;
+  orc_union16 var34;
+  orc_int8 var35;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(d1, d1_stride * j);
+    ptr1 = ORC_PTR_OFFSET(d2, d2_stride * j);
+    ptr4 = ORC_PTR_OFFSET(s1, s1_stride * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadw */
+      var34 = ptr4[i];
+      /* 1: select0wb */
+      {
+       orc_union16 _src;
+       _src.i = var34.i;
+       var33 = _src.x2[0];
+    }
+      /* 2: select1wb */
+      {
+       orc_union16 _src;
+       _src.i = var34.i;
+       var35 = _src.x2[1];
+    }
+      /* 3: storeb */
+      ptr0[i] = var33;
+      /* 4: storeb */
+      ptr1[i] = var35;
+    }
+  }
+
+}
+
+#else
+static void
+_backup_extractcolor_orc_split16 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int j;
+  int n = ex->n;
+  int m = ex->params[ORC_VAR_A1];
+  orc_int8 * ORC_RESTRICT ptr0;
+  orc_int8 * ORC_RESTRICT ptr1;
+  const orc_union16 * ORC_RESTRICT ptr4;
+  orc_int8 var33;
+  orc_union16 var34;
+  orc_int8 var35;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(ex->arrays[0], ex->params[0] * j);
+    ptr1 = ORC_PTR_OFFSET(ex->arrays[1], ex->params[1] * j);
+    ptr4 = ORC_PTR_OFFSET(ex->arrays[4], ex->params[4] * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadw */
+      var34 = ptr4[i];
+      /* 1: select0wb */
+      {
+       orc_union16 _src;
+       _src.i = var34.i;
+       var33 = _src.x2[0];
+    }
+      /* 2: select1wb */
+      {
+       orc_union16 _src;
+       _src.i = var34.i;
+       var35 = _src.x2[1];
+    }
+      /* 3: storeb */
+      ptr0[i] = var33;
+      /* 4: storeb */
+      ptr1[i] = var35;
+    }
+  }
+
+}
+
+void
+extractcolor_orc_split16 (guint8 * ORC_RESTRICT d1, int d1_stride, guint8 * ORC_RESTRICT d2, int d2_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 7, 9, 24, 101, 120, 116, 114, 97, 99, 116, 99, 111, 108, 111, 114, 
+        95, 111, 114, 99, 95, 115, 112, 108, 105, 116, 49, 54, 11, 1, 1, 11, 
+        1, 1, 12, 2, 2, 188, 0, 4, 189, 1, 4, 2, 0, 
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_split16);
+#else
+      p = orc_program_new ();
+      orc_program_set_2d (p);
+      orc_program_set_name (p, "extractcolor_orc_split16");
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_split16);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_destination (p, 1, "d2");
+      orc_program_add_source (p, 2, "s1");
+
+      orc_program_append_2 (p, "select0wb", 0, ORC_VAR_D1, ORC_VAR_S1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "select1wb", 0, ORC_VAR_D2, ORC_VAR_S1, ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ORC_EXECUTOR_M(ex) = m;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->params[ORC_VAR_D1] = d1_stride;
+  ex->arrays[ORC_VAR_D2] = d2;
+  ex->params[ORC_VAR_D2] = d2_stride;
+  ex->arrays[ORC_VAR_S1] = (void *)s1;
+  ex->params[ORC_VAR_S1] = s1_stride;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* extractcolor_orc_split32 */
+#ifdef DISABLE_ORC
+void
+extractcolor_orc_split32 (guint8 * ORC_RESTRICT d1, int d1_stride, guint8 * ORC_RESTRICT d2, int d2_stride, guint8 * ORC_RESTRICT d3, int d3_stride, guint8 * ORC_RESTRICT d4, int d4_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m){
+  int i;
+  int j;
+  orc_int8 * ORC_RESTRICT ptr0;
+  orc_int8 * ORC_RESTRICT ptr1;
+  orc_int8 * ORC_RESTRICT ptr2;
+  orc_int8 * ORC_RESTRICT ptr3;
+  const orc_union32 * ORC_RESTRICT ptr4;
+  orc_union32 var33;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(d1, d1_stride * j);
+    ptr1 = ORC_PTR_OFFSET(d2, d2_stride * j);
+    ptr2 = ORC_PTR_OFFSET(d3, d3_stride * j);
+    ptr3 = ORC_PTR_OFFSET(d4, d4_stride * j);
+    ptr4 = ORC_PTR_OFFSET(s1, s1_stride * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadl */
+      var33 = ptr4[i];
+      /* 1: select0lw */
+      {
+       orc_union32 _src;
+       _src.i = var33.i;
+       var38.i = _src.x2[0];
+    }
+      /* 2: select1lw */
+      {
+       orc_union32 _src;
+       _src.i = var33.i;
+       var39.i = _src.x2[1];
+    }
+      /* 3: select0wb */
+      {
+       orc_union16 _src;
+       _src.i = var38.i;
+       var34 = _src.x2[0];
+    }
+      /* 4: select1wb */
+      {
+       orc_union16 _src;
+       _src.i = var38.i;
+       var35 = _src.x2[1];
+    }
+      /* 5: select0wb */
+      {
+       orc_union16 _src;
+       _src.i = var39.i;
+       var36 = _src.x2[0];
+    }
+      /* 6: select1wb */
+      {
+       orc_union16 _src;
+       _src.i = var39.i;
+       var37 = _src.x2[1];
+    }
+      /* 7: storeb */
+      ptr0[i] = var34;
+      /* 8: storeb */
+      ptr1[i] = var35;
+      /* 9: storeb */
+      ptr2[i] = var36;
+      /* 10: storeb */
+      ptr3[i] = var37;
+    }
+  }
+
+}
+
+#else
+static void
+_backup_extractcolor_orc_split32 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int j;
+  int n = ex->n;
+  int m = ex->params[ORC_VAR_A1];
+  orc_int8 * ORC_RESTRICT ptr0;
+  orc_int8 * ORC_RESTRICT ptr1;
+  orc_int8 * ORC_RESTRICT ptr2;
+  orc_int8 * ORC_RESTRICT ptr3;
+  const orc_union32 * ORC_RESTRICT ptr4;
+  orc_union32 var33;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(ex->arrays[0], ex->params[0] * j);
+    ptr1 = ORC_PTR_OFFSET(ex->arrays[1], ex->params[1] * j);
+    ptr2 = ORC_PTR_OFFSET(ex->arrays[2], ex->params[2] * j);
+    ptr3 = ORC_PTR_OFFSET(ex->arrays[3], ex->params[3] * j);
+    ptr4 = ORC_PTR_OFFSET(ex->arrays[4], ex->params[4] * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadl */
+      var33 = ptr4[i];
+      /* 1: select0lw */
+      {
+       orc_union32 _src;
+       _src.i = var33.i;
+       var38.i = _src.x2[0];
+    }
+      /* 2: select1lw */
+      {
+       orc_union32 _src;
+       _src.i = var33.i;
+       var39.i = _src.x2[1];
+    }
+      /* 3: select0wb */
+      {
+       orc_union16 _src;
+       _src.i = var38.i;
+       var34 = _src.x2[0];
+    }
+      /* 4: select1wb */
+      {
+       orc_union16 _src;
+       _src.i = var38.i;
+       var35 = _src.x2[1];
+    }
+      /* 5: select0wb */
+      {
+       orc_union16 _src;
+       _src.i = var39.i;
+       var36 = _src.x2[0];
+    }
+      /* 6: select1wb */
+      {
+       orc_union16 _src;
+       _src.i = var39.i;
+       var37 = _src.x2[1];
+    }
+      /* 7: storeb */
+      ptr0[i] = var34;
+      /* 8: storeb */
+      ptr1[i] = var35;
+      /* 9: storeb */
+      ptr2[i] = var36;
+      /* 10: storeb */
+      ptr3[i] = var37;
+    }
+  }
+
+}
+
+void
+extractcolor_orc_split32 (guint8 * ORC_RESTRICT d1, int d1_stride, guint8 * ORC_RESTRICT d2, int d2_stride, guint8 * ORC_RESTRICT d3, int d3_stride, guint8 * ORC_RESTRICT d4, int d4_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 7, 9, 24, 101, 120, 116, 114, 97, 99, 116, 99, 111, 108, 111, 114, 
+        95, 111, 114, 99, 95, 115, 112, 108, 105, 116, 51, 50, 11, 1, 1, 11, 
+        1, 1, 11, 1, 1, 11, 1, 1, 12, 4, 4, 20, 2, 20, 2, 190, 
+        32, 4, 191, 33, 4, 188, 0, 32, 189, 1, 32, 188, 2, 33, 189, 3, 
+        33, 2, 0, 
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_split32);
+#else
+      p = orc_program_new ();
+      orc_program_set_2d (p);
+      orc_program_set_name (p, "extractcolor_orc_split32");
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_split32);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_destination (p, 1, "d2");
+      orc_program_add_destination (p, 1, "d3");
+      orc_program_add_destination (p, 1, "d4");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+
+      orc_program_append_2 (p, "select0lw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "select1lw", 0, ORC_VAR_T2, ORC_VAR_S1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "select0wb", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "select1wb", 0, ORC_VAR_D2, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "select0wb", 0, ORC_VAR_D3, ORC_VAR_T2, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "select1wb", 0, ORC_VAR_D4, ORC_VAR_T2, ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ORC_EXECUTOR_M(ex) = m;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->params[ORC_VAR_D1] = d1_stride;
+  ex->arrays[ORC_VAR_D2] = d2;
+  ex->params[ORC_VAR_D2] = d2_stride;
+  ex->arrays[ORC_VAR_D3] = d3;
+  ex->params[ORC_VAR_D3] = d3_stride;
+  ex->arrays[ORC_VAR_D4] = d4;
+  ex->params[ORC_VAR_D4] = d4_stride;
+  ex->arrays[ORC_VAR_S1] = (void *)s1;
+  ex->params[ORC_VAR_S1] = s1_stride;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* extractcolor_orc_split64 */
+#ifdef DISABLE_ORC
+void
+extractcolor_orc_split64 (guint16 * ORC_RESTRICT d1, int d1_stride, guint16 * ORC_RESTRICT d2, int d2_stride, guint16 * ORC_RESTRICT d3, int d3_stride, guint16 * ORC_RESTRICT d4, int d4_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m){
+  int i;
+  int j;
+  orc_union16 * ORC_RESTRICT ptr0;
+  orc_union16 * ORC_RESTRICT ptr1;
+  orc_union16 * ORC_RESTRICT ptr2;
+  orc_union16 * ORC_RESTRICT ptr3;
+  const orc_union64 * ORC_RESTRICT ptr4;
+  orc_union64 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(d1, d1_stride * j);
+    ptr1 = ORC_PTR_OFFSET(d2, d2_stride * j);
+    ptr2 = ORC_PTR_OFFSET(d3, d3_stride * j);
+    ptr3 = ORC_PTR_OFFSET(d4, d4_stride * j);
+    ptr4 = ORC_PTR_OFFSET(s1, s1_stride * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadq */
+      var33 = ptr4[i];
+      /* 1: select0ql */
+      {
+       orc_union64 _src;
+       _src.i = var33.i;
+       var38.i = _src.x2[0];
+    }
+      /* 2: select1ql */
+      {
+       orc_union64 _src;
+       _src.i = var33.i;
+       var39.i = _src.x2[1];
+    }
+      /* 3: select0lw */
+      {
+       orc_union32 _src;
+       _src.i = var38.i;
+       var34.i = _src.x2[0];
+    }
+      /* 4: select1lw */
+      {
+       orc_union32 _src;
+       _src.i = var38.i;
+       var35.i = _src.x2[1];
+    }
+      /* 5: select0lw */
+      {
+       orc_union32 _src;
+       _src.i = var39.i;
+       var36.i = _src.x2[0];
+    }
+      /* 6: select1lw */
+      {
+       orc_union32 _src;
+       _src.i = var39.i;
+       var37.i = _src.x2[1];
+    }
+      /* 7: storew */
+      ptr0[i] = var34;
+      /* 8: storew */
+      ptr1[i] = var35;
+      /* 9: storew */
+      ptr2[i] = var36;
+      /* 10: storew */
+      ptr3[i] = var37;
+    }
+  }
+
+}
+
+#else
+static void
+_backup_extractcolor_orc_split64 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int j;
+  int n = ex->n;
+  int m = ex->params[ORC_VAR_A1];
+  orc_union16 * ORC_RESTRICT ptr0;
+  orc_union16 * ORC_RESTRICT ptr1;
+  orc_union16 * ORC_RESTRICT ptr2;
+  orc_union16 * ORC_RESTRICT ptr3;
+  const orc_union64 * ORC_RESTRICT ptr4;
+  orc_union64 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(ex->arrays[0], ex->params[0] * j);
+    ptr1 = ORC_PTR_OFFSET(ex->arrays[1], ex->params[1] * j);
+    ptr2 = ORC_PTR_OFFSET(ex->arrays[2], ex->params[2] * j);
+    ptr3 = ORC_PTR_OFFSET(ex->arrays[3], ex->params[3] * j);
+    ptr4 = ORC_PTR_OFFSET(ex->arrays[4], ex->params[4] * j);
+
+
+    for (i = 0; i < n; i++) {
+      /* 0: loadq */
+      var33 = ptr4[i];
+      /* 1: select0ql */
+      {
+       orc_union64 _src;
+       _src.i = var33.i;
+       var38.i = _src.x2[0];
+    }
+      /* 2: select1ql */
+      {
+       orc_union64 _src;
+       _src.i = var33.i;
+       var39.i = _src.x2[1];
+    }
+      /* 3: select0lw */
+      {
+       orc_union32 _src;
+       _src.i = var38.i;
+       var34.i = _src.x2[0];
+    }
+      /* 4: select1lw */
+      {
+       orc_union32 _src;
+       _src.i = var38.i;
+       var35.i = _src.x2[1];
+    }
+      /* 5: select0lw */
+      {
+       orc_union32 _src;
+       _src.i = var39.i;
+       var36.i = _src.x2[0];
+    }
+      /* 6: select1lw */
+      {
+       orc_union32 _src;
+       _src.i = var39.i;
+       var37.i = _src.x2[1];
+    }
+      /* 7: storew */
+      ptr0[i] = var34;
+      /* 8: storew */
+      ptr1[i] = var35;
+      /* 9: storew */
+      ptr2[i] = var36;
+      /* 10: storew */
+      ptr3[i] = var37;
+    }
+  }
+
+}
+
+void
+extractcolor_orc_split64 (guint16 * ORC_RESTRICT d1, int d1_stride, guint16 * ORC_RESTRICT d2, int d2_stride, guint16 * ORC_RESTRICT d3, int d3_stride, guint16 * ORC_RESTRICT d4, int d4_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 7, 9, 24, 101, 120, 116, 114, 97, 99, 116, 99, 111, 108, 111, 114, 
+        95, 111, 114, 99, 95, 115, 112, 108, 105, 116, 54, 52, 11, 2, 2, 11, 
+        2, 2, 11, 2, 2, 11, 2, 2, 12, 8, 8, 20, 4, 20, 4, 192, 
+        32, 4, 193, 33, 4, 190, 0, 32, 191, 1, 32, 190, 2, 33, 191, 3, 
+        33, 2, 0, 
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_split64);
+#else
+      p = orc_program_new ();
+      orc_program_set_2d (p);
+      orc_program_set_name (p, "extractcolor_orc_split64");
+      orc_program_set_backup_function (p, _backup_extractcolor_orc_split64);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_destination (p, 2, "d2");
+      orc_program_add_destination (p, 2, "d3");
+      orc_program_add_destination (p, 2, "d4");
+      orc_program_add_source (p, 8, "s1");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "select0ql", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "select1ql", 0, ORC_VAR_T2, ORC_VAR_S1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "select0lw", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "select1lw", 0, ORC_VAR_D2, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "select0lw", 0, ORC_VAR_D3, ORC_VAR_T2, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "select1lw", 0, ORC_VAR_D4, ORC_VAR_T2, ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ORC_EXECUTOR_M(ex) = m;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->params[ORC_VAR_D1] = d1_stride;
+  ex->arrays[ORC_VAR_D2] = d2;
+  ex->params[ORC_VAR_D2] = d2_stride;
+  ex->arrays[ORC_VAR_D3] = d3;
+  ex->params[ORC_VAR_D3] = d3_stride;
+  ex->arrays[ORC_VAR_D4] = d4;
+  ex->params[ORC_VAR_D4] = d4_stride;
+  ex->arrays[ORC_VAR_S1] = (void *)s1;
+  ex->params[ORC_VAR_S1] = s1_stride;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
@@ -83,6 +83,15 @@ void extractcolor_orc_copy32_0 (guint8 * ORC_RESTRICT d1, int d1_stride, const g
 void extractcolor_orc_copy32_1 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m);
 void extractcolor_orc_copy32_2 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m);
 void extractcolor_orc_copy32_3 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_copy64_0 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_copy64_1 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_copy64_2 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_copy64_3 (guint16 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_copy16_0 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_copy16_1 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_split16 (guint8 * ORC_RESTRICT d1, int d1_stride, guint8 * ORC_RESTRICT d2, int d2_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_split32 (guint8 * ORC_RESTRICT d1, int d1_stride, guint8 * ORC_RESTRICT d2, int d2_stride, guint8 * ORC_RESTRICT d3, int d3_stride, guint8 * ORC_RESTRICT d4, int d4_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int n, int m);
+void extractcolor_orc_split64 (guint16 * ORC_RESTRICT d1, int d1_stride, guint16 * ORC_RESTRICT d2, int d2_stride, guint16 * ORC_RESTRICT d3, int d3_stride, guint16 * ORC_RESTRICT d4, int d4_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int n, int m);
 
 #ifdef __cplusplus
 }
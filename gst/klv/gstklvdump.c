@@ -0,0 +1,435 @@
+/* GStreamer
+ * Copyright (C) 2026 gst-plugins-vision authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+/* Writes KLV packets to disk from a thread of its own, so a slow disk never
+ * blocks the streaming thread. Packets are queued as references to the
+ * GBytes of their meta in a bounded ring; when the ring is full new packets
+ * are dropped rather than waited for. Files can be rotated by size or age,
+ * and each data file can get an index file next to it. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <glib/gstdio.h>
+#ifdef G_OS_WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "gstklvdump.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_klv_dump_debug_category);
+#define GST_CAT_DEFAULT gst_klv_dump_debug_category
+
+typedef struct
+{
+  GBytes *bytes;
+  guint64 frame;
+  GstClockTime pts;
+} GstKlvDumpRecord;
+
+struct _GstKlvDump
+{
+  /* settings */
+  gchar *location;
+  guint64 max_size;
+  guint max_time;
+  GstKlvDumpFsync fsync;
+  gboolean index;
+
+  GThread *thread;
+  GMutex lock;
+  GCond cond;
+  gboolean quit;
+
+  /* ring of queued records, protected by lock */
+  GstKlvDumpRecord *ring;
+  guint capacity;
+  guint head;
+  guint count;
+  guint64 dropped;
+
+  /* first write error, set by the writer thread, protected by lock */
+  GError *error;
+
+  /* only used by the writer thread */
+  FILE *file;
+  FILE *index_file;
+  guint file_index;
+  guint64 file_size;
+  gint64 file_start;
+  gboolean failed;
+};
+
+GType
+gst_klv_dump_fsync_get_type (void)
+{
+  static GType type = 0;
+  static const GEnumValue values[] = {
+    {GST_KLV_DUMP_FSYNC_NONE, "Leave syncing to the operating system",
+        "none"},
+    {GST_KLV_DUMP_FSYNC_ROTATE, "Sync each file when it is closed", "rotate"},
+    {GST_KLV_DUMP_FSYNC_BATCH, "Sync after writing each batch of packets",
+        "batch"},
+    {0, NULL, NULL}
+  };
+
+  if (!type)
+    type = g_enum_register_static ("GstKlvDumpFsync", values);
+
+  return type;
+}
+
+static void
+gst_klv_dump_sync_file (FILE * file)
+{
+  fflush (file);
+#ifdef G_OS_WIN32
+  _commit (_fileno (file));
+#else
+  fsync (fileno (file));
+#endif
+}
+
+static void
+gst_klv_dump_close (GstKlvDump * dump)
+{
+  if (dump->file) {
+    if (dump->fsync != GST_KLV_DUMP_FSYNC_NONE)
+      gst_klv_dump_sync_file (dump->file);
+    fclose (dump->file);
+    dump->file = NULL;
+  }
+  if (dump->index_file) {
+    if (dump->fsync != GST_KLV_DUMP_FSYNC_NONE)
+      gst_klv_dump_sync_file (dump->index_file);
+    fclose (dump->index_file);
+    dump->index_file = NULL;
+  }
+}
+
+/* The first file is the location itself, unless it holds a printf pattern
+ * for the file number as in multifilesink. */
+static gchar *
+gst_klv_dump_get_filename (GstKlvDump * dump)
+{
+  if (strchr (dump->location, '%'))
+    return g_strdup_printf (dump->location, dump->file_index);
+  else if (dump->file_index == 0)
+    return g_strdup (dump->location);
+  else
+    return g_strdup_printf ("%s.%u", dump->location, dump->file_index);
+}
+
+/* Records the error for gst_klv_dump_get_error() and stops writing, so a
+ * full disk or a missing directory isn't retried for every packet. */
+static void
+gst_klv_dump_fail (GstKlvDump * dump, GstResourceError code,
+    const gchar * format, ...)
+{
+  va_list args;
+  gchar *message;
+
+  va_start (args, format);
+  message = g_strdup_vprintf (format, args);
+  va_end (args);
+
+  GST_WARNING ("%s", message);
+
+  g_mutex_lock (&dump->lock);
+  if (!dump->error)
+    dump->error = g_error_new_literal (GST_RESOURCE_ERROR, code, message);
+  g_mutex_unlock (&dump->lock);
+  g_free (message);
+
+  gst_klv_dump_close (dump);
+  dump->failed = TRUE;
+}
+
+static gboolean
+gst_klv_dump_open (GstKlvDump * dump)
+{
+  gchar *filename = gst_klv_dump_get_filename (dump);
+
+  GST_DEBUG ("Opening file '%s' to dump KLV data", filename);
+  dump->file = g_fopen (filename, "wb");
+  if (!dump->file) {
+    gst_klv_dump_fail (dump, GST_RESOURCE_ERROR_OPEN_WRITE,
+        "Could not open KLV dump file \"%s\" for writing: %s", filename,
+        g_strerror (errno));
+    g_free (filename);
+    return FALSE;
+  }
+
+  if (dump->index) {
+    gchar *index_filename = g_strconcat (filename, ".idx", NULL);
+
+    dump->index_file = g_fopen (index_filename, "wb");
+    if (!dump->index_file) {
+      gst_klv_dump_fail (dump, GST_RESOURCE_ERROR_OPEN_WRITE,
+          "Could not open KLV index file \"%s\" for writing: %s",
+          index_filename, g_strerror (errno));
+      g_free (index_filename);
+      g_free (filename);
+      return FALSE;
+    }
+    g_free (index_filename);
+  }
+  g_free (filename);
+
+  dump->file_index++;
+  dump->file_size = 0;
+  dump->file_start = g_get_monotonic_time ();
+
+  return TRUE;
+}
+
+static void
+gst_klv_dump_write (GstKlvDump * dump, GstKlvDumpRecord * record)
+{
+  gconstpointer data;
+  gsize size;
+
+  data = g_bytes_get_data (record->bytes, &size);
+
+  if (dump->file && dump->file_size > 0 &&
+      ((dump->max_size && dump->file_size + size > dump->max_size) ||
+          (dump->max_time && g_get_monotonic_time () - dump->file_start >=
+              (gint64) dump->max_time * G_USEC_PER_SEC)))
+    gst_klv_dump_close (dump);
+
+  if (dump->failed)
+    return;
+  if (!dump->file && !gst_klv_dump_open (dump))
+    return;
+
+  if (dump->index_file) {
+    /* frame, PTS, offset and size of the packet, as 64-bit little endian */
+    guint8 entry[32];
+
+    GST_WRITE_UINT64_LE (entry, record->frame);
+    GST_WRITE_UINT64_LE (entry + 8, record->pts);
+    GST_WRITE_UINT64_LE (entry + 16, dump->file_size);
+    GST_WRITE_UINT64_LE (entry + 24, size);
+    if (fwrite (entry, sizeof (entry), 1, dump->index_file) != 1) {
+      gst_klv_dump_fail (dump, GST_RESOURCE_ERROR_WRITE,
+          "Failed to write KLV index file: %s", g_strerror (errno));
+      return;
+    }
+  }
+
+  if (fwrite (data, size, 1, dump->file) != 1) {
+    gst_klv_dump_fail (dump, GST_RESOURCE_ERROR_WRITE,
+        "Failed to write KLV dump file: %s", g_strerror (errno));
+    return;
+  }
+  dump->file_size += size;
+}
+
+static gpointer
+gst_klv_dump_thread_func (gpointer data)
+{
+  GstKlvDump *dump = (GstKlvDump *) data;
+  GstKlvDumpRecord record;
+
+  g_mutex_lock (&dump->lock);
+  while (TRUE) {
+    while (!dump->quit && dump->count == 0)
+      g_cond_wait (&dump->cond, &dump->lock);
+
+    /* whatever is queued is still written when quitting */
+    if (dump->count == 0)
+      break;
+
+    while (dump->count > 0) {
+      record = dump->ring[dump->head];
+      dump->head = (dump->head + 1) % dump->capacity;
+      dump->count--;
+
+      g_mutex_unlock (&dump->lock);
+      gst_klv_dump_write (dump, &record);
+      g_bytes_unref (record.bytes);
+      g_mutex_lock (&dump->lock);
+    }
+
+    g_mutex_unlock (&dump->lock);
+    if (dump->file) {
+      if (dump->fsync == GST_KLV_DUMP_FSYNC_BATCH) {
+        gst_klv_dump_sync_file (dump->file);
+        if (dump->index_file)
+          gst_klv_dump_sync_file (dump->index_file);
+      } else {
+        fflush (dump->file);
+        if (dump->index_file)
+          fflush (dump->index_file);
+      }
+    }
+    g_mutex_lock (&dump->lock);
+  }
+  g_mutex_unlock (&dump->lock);
+
+  gst_klv_dump_close (dump);
+
+  return NULL;
+}
+
+/**
+ * gst_klv_dump_new:
+ * @location: file to write to, or a printf pattern for the file number
+ * @queue_size: number of packets that can wait to be written
+ * @max_size: size in bytes after which a new file is started, or 0
+ * @max_time: age in seconds after which a new file is started, or 0
+ * @fsync: when to sync written data to disk
+ * @index: whether to write an index file next to each data file
+ *
+ * Starts a writer thread. Files are opened by the thread when the first
+ * packet arrives.
+ *
+ * Returns: a new #GstKlvDump, free with gst_klv_dump_free()
+ */
+GstKlvDump *
+gst_klv_dump_new (const gchar * location, guint queue_size, guint64 max_size,
+    guint max_time, GstKlvDumpFsync fsync, gboolean index)
+{
+  GstKlvDump *dump;
+
+  g_return_val_if_fail (location != NULL, NULL);
+  g_return_val_if_fail (queue_size > 0, NULL);
+
+  if (g_once_init_enter (&gst_klv_dump_debug_category)) {
+    GstDebugCategory *cat = NULL;
+
+    GST_DEBUG_CATEGORY_INIT (cat, "klvdump", 0, "KLV dump writer");
+    g_once_init_leave (&gst_klv_dump_debug_category, cat);
+  }
+
+  dump = g_new0 (GstKlvDump, 1);
+  dump->location = g_strdup (location);
+  dump->max_size = max_size;
+  dump->max_time = max_time;
+  dump->fsync = fsync;
+  dump->index = index;
+  dump->capacity = queue_size;
+  dump->ring = g_new0 (GstKlvDumpRecord, queue_size);
+  g_mutex_init (&dump->lock);
+  g_cond_init (&dump->cond);
+
+  dump->thread = g_thread_new ("klv-dump", gst_klv_dump_thread_func, dump);
+
+  return dump;
+}
+
+/**
+ * gst_klv_dump_push:
+ * @dump: a #GstKlvDump
+ * @bytes: (transfer none): a KLV packet
+ * @frame: number of the buffer carrying the packet
+ * @pts: timestamp of the buffer carrying the packet
+ *
+ * Queues @bytes for writing without blocking.
+ *
+ * Returns: %FALSE if the queue was full and the packet was dropped
+ */
+gboolean
+gst_klv_dump_push (GstKlvDump * dump, GBytes * bytes, guint64 frame,
+    GstClockTime pts)
+{
+  GstKlvDumpRecord *record;
+
+  g_return_val_if_fail (dump != NULL, FALSE);
+  g_return_val_if_fail (bytes != NULL, FALSE);
+
+  g_mutex_lock (&dump->lock);
+  if (dump->count == dump->capacity) {
+    dump->dropped++;
+    g_mutex_unlock (&dump->lock);
+    return FALSE;
+  }
+
+  record = &dump->ring[(dump->head + dump->count) % dump->capacity];
+  record->bytes = g_bytes_ref (bytes);
+  record->frame = frame;
+  record->pts = pts;
+  dump->count++;
+  g_cond_signal (&dump->cond);
+  g_mutex_unlock (&dump->lock);
+
+  return TRUE;
+}
+
+/**
+ * gst_klv_dump_get_error:
+ * @dump: a #GstKlvDump
+ * @error: (out) (optional): location for a copy of the error
+ *
+ * Checks whether the writer thread failed to open or write a file, in which
+ * case it has stopped writing and packets pushed since are discarded. The
+ * error is in the #GST_RESOURCE_ERROR domain.
+ *
+ * Returns: %TRUE if writing failed
+ */
+gboolean
+gst_klv_dump_get_error (GstKlvDump * dump, GError ** error)
+{
+  gboolean failed;
+
+  g_return_val_if_fail (dump != NULL, FALSE);
+
+  g_mutex_lock (&dump->lock);
+  failed = dump->error != NULL;
+  if (failed && error)
+    *error = g_error_copy (dump->error);
+  g_mutex_unlock (&dump->lock);
+
+  return failed;
+}
+
+/**
+ * gst_klv_dump_free:
+ * @dump: a #GstKlvDump
+ *
+ * Writes out the packets still queued, closes the files and frees @dump.
+ */
+void
+gst_klv_dump_free (GstKlvDump * dump)
+{
+  g_return_if_fail (dump != NULL);
+
+  g_mutex_lock (&dump->lock);
+  dump->quit = TRUE;
+  g_cond_signal (&dump->cond);
+  g_mutex_unlock (&dump->lock);
+
+  g_thread_join (dump->thread);
+
+  if (dump->dropped)
+    GST_WARNING ("Dropped %" G_GUINT64_FORMAT " KLV packets", dump->dropped);
+
+  g_clear_error (&dump->error);
+  g_mutex_clear (&dump->lock);
+  g_cond_clear (&dump->cond);
+  g_free (dump->ring);
+  g_free (dump->location);
+  g_free (dump);
+}
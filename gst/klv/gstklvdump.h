@@ -0,0 +1,51 @@
+/* GStreamer
+ * Copyright (C) 2026 gst-plugins-vision authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifndef _GST_KLV_DUMP_H_
+#define _GST_KLV_DUMP_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+  GST_KLV_DUMP_FSYNC_NONE,
+  GST_KLV_DUMP_FSYNC_ROTATE,
+  GST_KLV_DUMP_FSYNC_BATCH
+} GstKlvDumpFsync;
+
+#define GST_TYPE_KLV_DUMP_FSYNC (gst_klv_dump_fsync_get_type ())
+GType gst_klv_dump_fsync_get_type (void);
+
+typedef struct _GstKlvDump GstKlvDump;
+
+GstKlvDump * gst_klv_dump_new (const gchar * location, guint queue_size,
+    guint64 max_size, guint max_time, GstKlvDumpFsync fsync, gboolean index);
+
+gboolean     gst_klv_dump_push (GstKlvDump * dump, GBytes * bytes,
+    guint64 frame, GstClockTime pts);
+
+gboolean     gst_klv_dump_get_error (GstKlvDump * dump, GError ** error);
+
+void         gst_klv_dump_free (GstKlvDump * dump);
+
+G_END_DECLS
+
+#endif /* _GST_KLV_DUMP_H_ */
@@ -19,14 +19,31 @@
 /**
  * SECTION:element-gstklvinject
  *
- * The klvinject element injects KLV metadata on passing buffers.
+ * The klvinject element injects a MISB ST 0601 KLV packet on passing buffers.
+ *
+ * The packet is described by a template with one item per line (or per ';'
+ * in the template property), each made of a tag, a type and a value:
+ * |[
+ * 2 u64 @timestamp
+ * 12 string Geodetic WGS84
+ * 13 lat @latitude
+ * ]|
+ * Integer types are u8, u16, u32, u64, i8, i16, i32 and i64, string and
+ * bytes (hexadecimal) hold literal data, and lat, lon, alt, heading, pitch
+ * and roll map degrees or meters as ST 0601 tags 13, 14, 15, 5, 6 and 7 do.
+ * A value is either a literal or one of @timestamp, @frame, @latitude,
+ * @longitude, @altitude, @heading, @pitch and @roll, which are filled in
+ * for every buffer. The checksum is always appended.
+ *
+ * The template is compiled once into the bytes of the packet plus the
+ * offsets of its dynamic fields, so each buffer only costs a copy of the
+ * packet and a few stores.
  *
  * <refsect2>
  * <title>Example launch line</title>
  * |[
- * gst-launch -v fakesrc ! klvinject ! fakesink
+ * gst-launch -v videotestsrc ! klvinject template-location=uas.txt ! fakesink
  * ]|
- * FIXME Describe what the pipeline does.
  * </refsect2>
  */
 
@@ -34,6 +51,10 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
 #include <gst/gst.h>
 #include <gst/base/gstbasetransform.h>
 #include <gst/base/gstbytewriter.h>
@@ -44,6 +65,13 @@ GST_DEBUG_CATEGORY_STATIC (gst_klvinject_debug_category);
 #define GST_CAT_DEFAULT gst_klvinject_debug_category
 
 /* prototypes */
+static void gst_klvinject_dispose (GObject * object);
+static void gst_klvinject_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_klvinject_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
+static gboolean gst_klvinject_start (GstBaseTransform * trans);
 static GstFlowReturn gst_klvinject_transform_ip (GstBaseTransform * trans,
     GstBuffer * inbuf);
 
@@ -52,9 +80,111 @@ static GstFlowReturn gst_klvinject_prepare_output_buffer (GstBaseTransform *
 
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_TEMPLATE,
+  PROP_TEMPLATE_LOCATION,
+  PROP_LATITUDE,
+  PROP_LONGITUDE,
+  PROP_ALTITUDE,
+  PROP_HEADING,
+  PROP_PITCH,
+  PROP_ROLL
 };
 
+/* the packet previously hardcoded for testing, here: Motion Imagery
+ * Standards Board (MISB) Engineering Guideline MISB EG 0902 - MISB Minimum
+ * Metadata Set */
+#define DEFAULT_PROP_TEMPLATE "2 u64 @timestamp; 12 string Geodetic WGS84; " \
+    "13 lat @latitude; 14 lon @longitude; 15 alt @altitude"
+#define DEFAULT_PROP_TEMPLATE_LOCATION NULL
+#define DEFAULT_PROP_LATITUDE 51.449825
+#define DEFAULT_PROP_LONGITUDE -2.600439
+#define DEFAULT_PROP_ALTITUDE 10.0
+#define DEFAULT_PROP_HEADING 0.0
+#define DEFAULT_PROP_PITCH 0.0
+#define DEFAULT_PROP_ROLL 0.0
+
+typedef enum
+{
+  GST_KLVINJECT_TYPE_U8,
+  GST_KLVINJECT_TYPE_U16,
+  GST_KLVINJECT_TYPE_U32,
+  GST_KLVINJECT_TYPE_U64,
+  GST_KLVINJECT_TYPE_I8,
+  GST_KLVINJECT_TYPE_I16,
+  GST_KLVINJECT_TYPE_I32,
+  GST_KLVINJECT_TYPE_I64,
+  GST_KLVINJECT_TYPE_LAT,
+  GST_KLVINJECT_TYPE_LON,
+  GST_KLVINJECT_TYPE_ALT,
+  GST_KLVINJECT_TYPE_HEADING,
+  GST_KLVINJECT_TYPE_PITCH,
+  GST_KLVINJECT_TYPE_ROLL,
+  GST_KLVINJECT_TYPE_STRING,
+  GST_KLVINJECT_TYPE_BYTES
+} GstKlvInjectType;
+
+typedef enum
+{
+  GST_KLVINJECT_SOURCE_LITERAL,
+  GST_KLVINJECT_SOURCE_TIMESTAMP,
+  GST_KLVINJECT_SOURCE_FRAME,
+  GST_KLVINJECT_SOURCE_LATITUDE,
+  GST_KLVINJECT_SOURCE_LONGITUDE,
+  GST_KLVINJECT_SOURCE_ALTITUDE,
+  GST_KLVINJECT_SOURCE_HEADING,
+  GST_KLVINJECT_SOURCE_PITCH,
+  GST_KLVINJECT_SOURCE_ROLL
+} GstKlvInjectSource;
+
+static const struct
+{
+  const gchar *name;
+  GstKlvInjectType type;
+  guint size;
+} klvinject_types[] = {
+  {"u8", GST_KLVINJECT_TYPE_U8, 1},
+  {"u16", GST_KLVINJECT_TYPE_U16, 2},
+  {"u32", GST_KLVINJECT_TYPE_U32, 4},
+  {"u64", GST_KLVINJECT_TYPE_U64, 8},
+  {"i8", GST_KLVINJECT_TYPE_I8, 1},
+  {"i16", GST_KLVINJECT_TYPE_I16, 2},
+  {"i32", GST_KLVINJECT_TYPE_I32, 4},
+  {"i64", GST_KLVINJECT_TYPE_I64, 8},
+  {"lat", GST_KLVINJECT_TYPE_LAT, 4},
+  {"lon", GST_KLVINJECT_TYPE_LON, 4},
+  {"alt", GST_KLVINJECT_TYPE_ALT, 2},
+  {"heading", GST_KLVINJECT_TYPE_HEADING, 2},
+  {"pitch", GST_KLVINJECT_TYPE_PITCH, 2},
+  {"roll", GST_KLVINJECT_TYPE_ROLL, 2},
+  {"string", GST_KLVINJECT_TYPE_STRING, 0},
+  {"bytes", GST_KLVINJECT_TYPE_BYTES, 0}
+};
+
+static const struct
+{
+  const gchar *name;
+  GstKlvInjectSource source;
+} klvinject_sources[] = {
+  {"@timestamp", GST_KLVINJECT_SOURCE_TIMESTAMP},
+  {"@frame", GST_KLVINJECT_SOURCE_FRAME},
+  {"@latitude", GST_KLVINJECT_SOURCE_LATITUDE},
+  {"@longitude", GST_KLVINJECT_SOURCE_LONGITUDE},
+  {"@altitude", GST_KLVINJECT_SOURCE_ALTITUDE},
+  {"@heading", GST_KLVINJECT_SOURCE_HEADING},
+  {"@pitch", GST_KLVINJECT_SOURCE_PITCH},
+  {"@roll", GST_KLVINJECT_SOURCE_ROLL}
+};
+
+/* a value patched into the packet for every buffer */
+typedef struct
+{
+  gsize offset;
+  GstKlvInjectType type;
+  guint size;
+  GstKlvInjectSource source;
+} GstKlvInjectField;
+
 /* pad templates */
 
 #define SRC_CAPS "ANY"
@@ -72,6 +202,61 @@ gst_klvinject_class_init (GstKlvInjectClass * klass)
 {
   GstBaseTransformClass *base_transform_class =
       GST_BASE_TRANSFORM_CLASS (klass);
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+
+  /* register GObject vmethods */
+  gobject_class->set_property = gst_klvinject_set_property;
+  gobject_class->get_property = gst_klvinject_get_property;
+  gobject_class->dispose = gst_klvinject_dispose;
+
+  g_object_class_install_property (gobject_class, PROP_TEMPLATE,
+      g_param_spec_string ("template", "Template",
+          "Items of the KLV packet, used unless template-location is set",
+          DEFAULT_PROP_TEMPLATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_TEMPLATE_LOCATION,
+      g_param_spec_string ("template-location", "Template filename",
+          "Location of a file holding the items of the KLV packet",
+          DEFAULT_PROP_TEMPLATE_LOCATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_LATITUDE,
+      g_param_spec_double ("latitude", "Latitude",
+          "Value of @latitude in the template, in degrees", -90.0, 90.0,
+          DEFAULT_PROP_LATITUDE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_CONTROLLABLE | GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_LONGITUDE,
+      g_param_spec_double ("longitude", "Longitude",
+          "Value of @longitude in the template, in degrees", -180.0, 180.0,
+          DEFAULT_PROP_LONGITUDE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_CONTROLLABLE | GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_ALTITUDE,
+      g_param_spec_double ("altitude", "Altitude",
+          "Value of @altitude in the template, in meters", -900.0, 19000.0,
+          DEFAULT_PROP_ALTITUDE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_CONTROLLABLE | GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_HEADING,
+      g_param_spec_double ("heading", "Heading",
+          "Value of @heading in the template, in degrees", 0.0, 360.0,
+          DEFAULT_PROP_HEADING,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_CONTROLLABLE | GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_PITCH,
+      g_param_spec_double ("pitch", "Pitch",
+          "Value of @pitch in the template, in degrees", -20.0, 20.0,
+          DEFAULT_PROP_PITCH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_CONTROLLABLE | GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_ROLL,
+      g_param_spec_double ("roll", "Roll",
+          "Value of @roll in the template, in degrees", -50.0, 50.0,
+          DEFAULT_PROP_ROLL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_CONTROLLABLE | GST_PARAM_MUTABLE_PLAYING));
 
   /* Setting up pads and setting metadata should be moved to
      base_class_init if you intend to subclass this class. */
@@ -86,6 +271,7 @@ gst_klvinject_class_init (GstKlvInjectClass * klass)
       "Inject KLV", "Filter", "Inject KLV metadata",
       "Joshua M. Doe <oss@nvl.army.mil>");
 
+  base_transform_class->start = GST_DEBUG_FUNCPTR (gst_klvinject_start);
   base_transform_class->transform_ip =
       GST_DEBUG_FUNCPTR (gst_klvinject_transform_ip);
   base_transform_class->prepare_output_buffer =
@@ -95,27 +281,477 @@ gst_klvinject_class_init (GstKlvInjectClass * klass)
 static void
 gst_klvinject_init (GstKlvInject * filt)
 {
+  filt->template_str = g_strdup (DEFAULT_PROP_TEMPLATE);
+  filt->template_location = g_strdup (DEFAULT_PROP_TEMPLATE_LOCATION);
+  filt->latitude = DEFAULT_PROP_LATITUDE;
+  filt->longitude = DEFAULT_PROP_LONGITUDE;
+  filt->altitude = DEFAULT_PROP_ALTITUDE;
+  filt->heading = DEFAULT_PROP_HEADING;
+  filt->pitch = DEFAULT_PROP_PITCH;
+  filt->roll = DEFAULT_PROP_ROLL;
+
+  filt->template_dirty = TRUE;
+  filt->fields = g_array_new (FALSE, FALSE, sizeof (GstKlvInjectField));
 }
 
 static void
-gst_klvinject_dispose (GstKlvInject * filt)
+gst_klvinject_dispose (GObject * object)
 {
+  GstKlvInject *filt = GST_KLVINJECT (object);
+
+  GST_DEBUG_OBJECT (filt, "disposing");
+
+  g_free (filt->template_str);
+  filt->template_str = NULL;
+  g_free (filt->template_location);
+  filt->template_location = NULL;
+  g_free (filt->image);
+  filt->image = NULL;
+  if (filt->fields) {
+    g_array_free (filt->fields, TRUE);
+    filt->fields = NULL;
+  }
+
+  /* chain up to the parent class */
+  G_OBJECT_CLASS (gst_klvinject_parent_class)->dispose (object);
 }
 
-static GstStaticCaps unix_reference = GST_STATIC_CAPS ("timestamp/x-unix");
+static void
+gst_klvinject_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstKlvInject *filt = GST_KLVINJECT (object);
+
+  GST_OBJECT_LOCK (filt);
+  switch (prop_id) {
+    case PROP_TEMPLATE:
+      g_free (filt->template_str);
+      filt->template_str = g_value_dup_string (value);
+      filt->template_dirty = TRUE;
+      break;
+    case PROP_TEMPLATE_LOCATION:
+      g_free (filt->template_location);
+      filt->template_location = g_value_dup_string (value);
+      filt->template_dirty = TRUE;
+      break;
+    case PROP_LATITUDE:
+      filt->latitude = g_value_get_double (value);
+      break;
+    case PROP_LONGITUDE:
+      filt->longitude = g_value_get_double (value);
+      break;
+    case PROP_ALTITUDE:
+      filt->altitude = g_value_get_double (value);
+      break;
+    case PROP_HEADING:
+      filt->heading = g_value_get_double (value);
+      break;
+    case PROP_PITCH:
+      filt->pitch = g_value_get_double (value);
+      break;
+    case PROP_ROLL:
+      filt->roll = g_value_get_double (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (filt);
+}
 
 static void
-gst_klvinject_add_test_meta (GstKlvInject * filt, GstBuffer * buf)
+gst_klvinject_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
 {
-/* Add KLV meta for testing, here: Motion Imagery Standards Board (MISB)
- * Engineering Guideline MISB EG 0902 - MISB Minimum Metadata Set.
+  GstKlvInject *filt = GST_KLVINJECT (object);
+
+  GST_OBJECT_LOCK (filt);
+  switch (prop_id) {
+    case PROP_TEMPLATE:
+      g_value_set_string (value, filt->template_str);
+      break;
+    case PROP_TEMPLATE_LOCATION:
+      g_value_set_string (value, filt->template_location);
+      break;
+    case PROP_LATITUDE:
+      g_value_set_double (value, filt->latitude);
+      break;
+    case PROP_LONGITUDE:
+      g_value_set_double (value, filt->longitude);
+      break;
+    case PROP_ALTITUDE:
+      g_value_set_double (value, filt->altitude);
+      break;
+    case PROP_HEADING:
+      g_value_set_double (value, filt->heading);
+      break;
+    case PROP_PITCH:
+      g_value_set_double (value, filt->pitch);
+      break;
+    case PROP_ROLL:
+      g_value_set_double (value, filt->roll);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (filt);
+}
+
+static GstStaticCaps unix_reference = GST_STATIC_CAPS ("timestamp/x-unix");
+
+/* MISB ST 0601 UAS Datalink Local Set.
  * Also see: SMPTE S336M for KLV specification, also ITU-R BT.1563-1 */
-  const guint8 klv_header[16] = { 0x06, 0x0e, 0x2b, 0x34, 0x02, 0x0b, 0x01,
-    0x01, 0x0e, 0x01, 0x03, 0x01, 0x01, 0x00, 0x00, 0x00
-  };
-  GstByteWriter bw;
+static const guint8 klv_header[16] = { 0x06, 0x0e, 0x2b, 0x34, 0x02, 0x0b,
+  0x01, 0x01, 0x0e, 0x01, 0x03, 0x01, 0x01, 0x00, 0x00, 0x00
+};
+
+static void
+gst_klvinject_put_ber_length (GstByteWriter * bw, gsize length)
+{
+  guint n = 0;
+  gsize l;
+
+  if (length < 128) {
+    gst_byte_writer_put_uint8 (bw, length);
+    return;
+  }
+
+  for (l = length; l; l >>= 8)
+    n++;
+  gst_byte_writer_put_uint8 (bw, 0x80 | n);
+  while (n--)
+    gst_byte_writer_put_uint8 (bw, (length >> (8 * n)) & 0xff);
+}
+
+static void
+gst_klvinject_put_ber_oid (GstByteWriter * bw, guint32 tag)
+{
+  guint n = 1;
+
+  while (n < 5 && (tag >> (7 * n)))
+    n++;
+  while (--n)
+    gst_byte_writer_put_uint8 (bw, 0x80 | ((tag >> (7 * n)) & 0x7f));
+  gst_byte_writer_put_uint8 (bw, tag & 0x7f);
+}
+
+/* Stores a value in the big-endian representation of @type. Integer types
+ * take @ival, the mapped ST 0601 types @dval. */
+static void
+gst_klvinject_store (guint8 * dst, GstKlvInjectType type, guint64 ival,
+    gdouble dval)
+{
+  switch (type) {
+    case GST_KLVINJECT_TYPE_U8:
+    case GST_KLVINJECT_TYPE_I8:
+      GST_WRITE_UINT8 (dst, ival);
+      break;
+    case GST_KLVINJECT_TYPE_U16:
+    case GST_KLVINJECT_TYPE_I16:
+      GST_WRITE_UINT16_BE (dst, ival);
+      break;
+    case GST_KLVINJECT_TYPE_U32:
+    case GST_KLVINJECT_TYPE_I32:
+      GST_WRITE_UINT32_BE (dst, ival);
+      break;
+    case GST_KLVINJECT_TYPE_U64:
+    case GST_KLVINJECT_TYPE_I64:
+      GST_WRITE_UINT64_BE (dst, ival);
+      break;
+    case GST_KLVINJECT_TYPE_LAT:
+      /* Map -(2^31-1)..(2^31-1) to +/-90 with 0x80000000 = error */
+      GST_WRITE_UINT32_BE (dst, (gint32) ((dval / 90.0) * 2147483647.0));
+      break;
+    case GST_KLVINJECT_TYPE_LON:
+      /* Map -(2^31-1)..(2^31-1) to +/-180 with 0x80000000 = error */
+      GST_WRITE_UINT32_BE (dst, (gint32) ((dval / 180.0) * 2147483647.0));
+      break;
+    case GST_KLVINJECT_TYPE_ALT:
+      /* Map 0..(2^16-1) to -900..19000 meters, so resolution 0.303654536m */
+      GST_WRITE_UINT16_BE (dst,
+          (guint16) (((dval + 900.0 + 0.151827268) / 19900.0) * 65535.0));
+      break;
+    case GST_KLVINJECT_TYPE_HEADING:
+      /* Map 0..(2^16-1) to 0..360 degrees */
+      GST_WRITE_UINT16_BE (dst, (guint16) floor (dval / 360.0 * 65535.0 +
+              0.5));
+      break;
+    case GST_KLVINJECT_TYPE_PITCH:
+      /* Map -(2^15-1)..(2^15-1) to +/-20 degrees */
+      GST_WRITE_UINT16_BE (dst, (gint16) floor (dval / 20.0 * 32767.0 + 0.5));
+      break;
+    case GST_KLVINJECT_TYPE_ROLL:
+      /* Map -(2^15-1)..(2^15-1) to +/-50 degrees */
+      GST_WRITE_UINT16_BE (dst, (gint16) floor (dval / 50.0 * 32767.0 + 0.5));
+      break;
+    default:
+      g_assert_not_reached ();
+  }
+}
+
+static gboolean
+gst_klvinject_type_is_integer (GstKlvInjectType type)
+{
+  return type <= GST_KLVINJECT_TYPE_I64;
+}
+
+/* the ST 0601 checksum of @size bytes starting at byte @offset of a packet */
+static guint16
+gst_klvinject_checksum (const guint8 * data, gsize offset, gsize size)
+{
+  guint16 sum = 0;
+  gsize i;
+
+  for (i = 0; i < size; i++)
+    sum += data[i] << (((offset + i) & 1) ? 0 : 8);
+
+  return sum;
+}
+
+/* Parses one "tag type value" item and appends it to @bw, recording where
+ * a dynamic value goes, relative to @bw, in @fields. */
+static gboolean
+gst_klvinject_compile_item (GstKlvInject * filt, const gchar * item,
+    GstByteWriter * bw, GArray * fields)
+{
+  gchar **tokens;
+  gchar *end;
+  guint64 tag;
+  guint i;
+  gboolean ret = FALSE;
+
+  tokens = g_strsplit_set (item, " \t", 3);
+  if (g_strv_length (tokens) < 3)
+    goto invalid;
+
+  tag = g_ascii_strtoull (tokens[0], &end, 10);
+  if (*end != '\0' || tag == 0 || tag > 0x0fffffff)
+    goto invalid;
+  g_strstrip (tokens[2]);
+
+  for (i = 0; i < G_N_ELEMENTS (klvinject_types); i++) {
+    if (g_str_equal (tokens[1], klvinject_types[i].name))
+      break;
+  }
+  if (i == G_N_ELEMENTS (klvinject_types))
+    goto invalid;
+
+  gst_klvinject_put_ber_oid (bw, tag);
+
+  if (klvinject_types[i].type == GST_KLVINJECT_TYPE_STRING) {
+    gsize len = strlen (tokens[2]);
+
+    gst_klvinject_put_ber_length (bw, len);
+    gst_byte_writer_put_data (bw, (const guint8 *) tokens[2], len);
+  } else if (klvinject_types[i].type == GST_KLVINJECT_TYPE_BYTES) {
+    gsize j, len = strlen (tokens[2]);
+
+    if (len % 2)
+      goto invalid;
+    for (j = 0; j < len; j++) {
+      if (!g_ascii_isxdigit (tokens[2][j]))
+        goto invalid;
+    }
+    gst_klvinject_put_ber_length (bw, len / 2);
+    for (j = 0; j < len; j += 2)
+      gst_byte_writer_put_uint8 (bw,
+          (g_ascii_xdigit_value (tokens[2][j]) << 4) |
+          g_ascii_xdigit_value (tokens[2][j + 1]));
+  } else {
+    GstKlvInjectField field;
+    guint8 value[8];
+    guint j;
+
+    field.type = klvinject_types[i].type;
+    field.size = klvinject_types[i].size;
+    field.source = GST_KLVINJECT_SOURCE_LITERAL;
+    for (j = 0; j < G_N_ELEMENTS (klvinject_sources); j++) {
+      if (g_str_equal (tokens[2], klvinject_sources[j].name))
+        field.source = klvinject_sources[j].source;
+    }
+
+    gst_klvinject_put_ber_length (bw, field.size);
+
+    if (field.source == GST_KLVINJECT_SOURCE_LITERAL) {
+      if (gst_klvinject_type_is_integer (field.type)) {
+        guint64 ival;
+
+        if (field.type >= GST_KLVINJECT_TYPE_I8)
+          ival = g_ascii_strtoll (tokens[2], &end, 0);
+        else
+          ival = g_ascii_strtoull (tokens[2], &end, 0);
+        if (*end != '\0')
+          goto invalid;
+        gst_klvinject_store (value, field.type, ival, 0.0);
+      } else {
+        gdouble dval = g_ascii_strtod (tokens[2], &end);
+
+        if (*end != '\0')
+          goto invalid;
+        gst_klvinject_store (value, field.type, 0, dval);
+      }
+    } else {
+      /* zero in the image, so the checksum only needs what's patched in */
+      memset (value, 0, sizeof (value));
+      field.offset = gst_byte_writer_get_pos (bw);
+      g_array_append_val (fields, field);
+    }
+    gst_byte_writer_put_data (bw, value, field.size);
+  }
+
+  ret = TRUE;
+
+invalid:
+  if (!ret)
+    GST_WARNING_OBJECT (filt, "Invalid template item '%s'", item);
+  g_strfreev (tokens);
+  return ret;
+}
+
+/* Builds the packet image from a copy of the template properties. Called
+ * without the object lock, since failures post an error message. */
+static gboolean
+gst_klvinject_compile_template (GstKlvInject * filt, const gchar * template_str,
+    const gchar * template_location, guint8 ** image, gsize * image_size,
+    GArray ** image_fields, guint16 * base_checksum)
+{
+  GstByteWriter items, bw;
+  guint8 *items_data;
+  gsize items_size;
+  gchar *contents = NULL;
+  gchar **lines;
+  GArray *fields;
+  GError *err = NULL;
+  gsize header_size, i;
+  gboolean ret = TRUE;
+
+  if (template_location) {
+    if (!g_file_get_contents (template_location, &contents, NULL,
+            &err)) {
+      GST_ELEMENT_ERROR (filt, RESOURCE, READ,
+          ("Failed to read KLV template"), ("%s", err->message));
+      g_error_free (err);
+      return FALSE;
+    }
+    lines = g_strsplit (contents, "\n", -1);
+  } else {
+    lines = g_strsplit_set (template_str ? template_str : "", ";\n", -1);
+  }
+
+  fields = g_array_new (FALSE, FALSE, sizeof (GstKlvInjectField));
+  gst_byte_writer_init (&items);
+  for (i = 0; lines[i]; i++) {
+    gchar *item = g_strstrip (lines[i]);
+
+    if (item[0] == '\0' || item[0] == '#')
+      continue;
+    if (!gst_klvinject_compile_item (filt, item, &items, fields)) {
+      GST_ELEMENT_ERROR (filt, LIBRARY, SETTINGS,
+          ("Invalid KLV template item '%s'", item), (NULL));
+      ret = FALSE;
+      break;
+    }
+  }
+  g_strfreev (lines);
+  g_free (contents);
+
+  if (!ret) {
+    gst_byte_writer_reset (&items);
+    g_array_free (fields, TRUE);
+    return FALSE;
+  }
+
+  /* key, length, items, then the checksum item */
+  gst_byte_writer_init (&bw);
+  gst_byte_writer_put_data (&bw, klv_header, sizeof (klv_header));
+  gst_klvinject_put_ber_length (&bw, gst_byte_writer_get_size (&items) + 4);
+  header_size = gst_byte_writer_get_size (&bw);
+  items_size = gst_byte_writer_get_size (&items);
+  items_data = gst_byte_writer_reset_and_get_data (&items);
+  gst_byte_writer_put_data (&bw, items_data, items_size);
+  g_free (items_data);
+  gst_byte_writer_put_uint8 (&bw, 1);
+  gst_byte_writer_put_uint8 (&bw, 2);
+  gst_byte_writer_put_uint16_be (&bw, 0);
+
+  for (i = 0; i < fields->len; i++)
+    g_array_index (fields, GstKlvInjectField, i).offset += header_size;
+
+  *image_size = gst_byte_writer_get_size (&bw);
+  *image = gst_byte_writer_reset_and_get_data (&bw);
+  *base_checksum = gst_klvinject_checksum (*image, 0, *image_size - 2);
+  *image_fields = fields;
+
+  GST_DEBUG_OBJECT (filt, "Compiled KLV template of %" G_GSIZE_FORMAT
+      " bytes with %u dynamic fields", *image_size, fields->len);
+
+  return TRUE;
+}
+
+/* Recompiles the template if a template property changed. Only copying the
+ * properties and swapping in the result happen under the object lock. */
+static gboolean
+gst_klvinject_update_template (GstKlvInject * filt)
+{
+  gchar *template_str, *template_location;
+  guint8 *image;
+  gsize image_size;
+  GArray *fields;
+  guint16 base_checksum;
+  gboolean ret;
+
+  GST_OBJECT_LOCK (filt);
+  if (!filt->template_dirty) {
+    GST_OBJECT_UNLOCK (filt);
+    return TRUE;
+  }
+  template_str = g_strdup (filt->template_str);
+  template_location = g_strdup (filt->template_location);
+  filt->template_dirty = FALSE;
+  GST_OBJECT_UNLOCK (filt);
+
+  ret = gst_klvinject_compile_template (filt, template_str, template_location,
+      &image, &image_size, &fields, &base_checksum);
+  g_free (template_str);
+  g_free (template_location);
+
+  GST_OBJECT_LOCK (filt);
+  if (ret) {
+    g_free (filt->image);
+    filt->image = image;
+    filt->image_size = image_size;
+    g_array_free (filt->fields, TRUE);
+    filt->fields = fields;
+    filt->base_checksum = base_checksum;
+  } else {
+    /* try again on the next buffer instead of using a stale packet */
+    filt->template_dirty = TRUE;
+  }
+  GST_OBJECT_UNLOCK (filt);
+
+  return ret;
+}
+
+static gboolean
+gst_klvinject_start (GstBaseTransform * trans)
+{
+  GstKlvInject *filt = GST_KLVINJECT (trans);
+
+  filt->frame_number = 0;
+
+  return TRUE;
+}
+
+static gboolean
+gst_klvinject_add_meta (GstKlvInject * filt, GstBuffer * buf)
+{
   /* NOTE: MISB defines MISP time, which is NOT UTC, but use UTC for now */
   guint64 utc_us = -1;
+  guint8 *klv_data;
+  gsize klv_size;
+  guint16 checksum;
+  guint i;
 
 #if GST_CHECK_VERSION(1,14,0)
   GstReferenceTimestampMeta *time_meta;
@@ -138,61 +774,68 @@ gst_klvinject_add_test_meta (GstKlvInject * filt, GstBuffer * buf)
         utc_us % 1000000);
   }
 
-  gst_byte_writer_init (&bw);
-
-  /* KLV header */
-  gst_byte_writer_put_data (&bw, klv_header, 16);
-
-  /* Total length in BER long form (verbatim as long as <= 127) */
-  gst_byte_writer_put_uint8 (&bw,
-      (1 + 1 + 8) + (1 + 1 + 14) + (1 + 1 + 4) + (1 + 1 + 4) + (1 + 1 + 2));
-
-  /* Tag 1: unix timestamp */
-  gst_byte_writer_put_uint8 (&bw, 2);   /* local tag: unix timestamp    */
-  gst_byte_writer_put_uint8 (&bw, 8);   /* data length (BER short form) */
-  gst_byte_writer_put_uint64_be (&bw, utc_us);
-
-  /* Tag 2: Image Coordinate System */
-  gst_byte_writer_put_uint8 (&bw, 12);  /* local tag: unix timestamp    */
-  gst_byte_writer_put_uint8 (&bw, 14);  /* data length (BER short form) */
-  gst_byte_writer_put_data (&bw, (guint8 *) "Geodetic WGS84", 14);
-
-  /* Tag 3: Sensor Latitude */
-  gst_byte_writer_put_uint8 (&bw, 13);  /* local tag: latitude */
-  gst_byte_writer_put_uint8 (&bw, 4);   /* data length (BER short form) */
-  {
-    /* Map -(2^31-1)..(2^31-1) to +/-90 with 0x80000000 = error */
-    gdouble latitude = 51.449825;
-    gint32 val = (gint) ((latitude / 90.0) * 2147483647.0);
-    gst_byte_writer_put_int32_be (&bw, val);
+  if (!gst_klvinject_update_template (filt))
+    return FALSE;
+
+  GST_OBJECT_LOCK (filt);
+  klv_size = filt->image_size;
+  klv_data = g_malloc (klv_size);
+  memcpy (klv_data, filt->image, klv_size);
+
+  /* dynamic fields are zero in the image, so their bytes simply add to the
+   * checksum */
+  checksum = filt->base_checksum;
+  for (i = 0; i < filt->fields->len; i++) {
+    const GstKlvInjectField *field =
+        &g_array_index (filt->fields, GstKlvInjectField, i);
+    guint64 ival = 0;
+    gdouble dval = 0.0;
+
+    switch (field->source) {
+      case GST_KLVINJECT_SOURCE_TIMESTAMP:
+        ival = utc_us;
+        dval = utc_us;
+        break;
+      case GST_KLVINJECT_SOURCE_FRAME:
+        ival = filt->frame_number;
+        dval = filt->frame_number;
+        break;
+      case GST_KLVINJECT_SOURCE_LATITUDE:
+        dval = filt->latitude;
+        break;
+      case GST_KLVINJECT_SOURCE_LONGITUDE:
+        dval = filt->longitude;
+        break;
+      case GST_KLVINJECT_SOURCE_ALTITUDE:
+        dval = filt->altitude;
+        break;
+      case GST_KLVINJECT_SOURCE_HEADING:
+        dval = filt->heading;
+        break;
+      case GST_KLVINJECT_SOURCE_PITCH:
+        dval = filt->pitch;
+        break;
+      case GST_KLVINJECT_SOURCE_ROLL:
+        dval = filt->roll;
+        break;
+      default:
+        g_assert_not_reached ();
+    }
+    if (field->source > GST_KLVINJECT_SOURCE_FRAME)
+      ival = (gint64) floor (dval + 0.5);
+
+    gst_klvinject_store (klv_data + field->offset, field->type, ival, dval);
+    checksum += gst_klvinject_checksum (klv_data + field->offset,
+        field->offset, field->size);
   }
+  GST_OBJECT_UNLOCK (filt);
 
-  /* Tag 4: Sensor Longitude */
-  gst_byte_writer_put_uint8 (&bw, 14);  /* local tag: longitude */
-  gst_byte_writer_put_uint8 (&bw, 4);   /* data length (BER short form) */
-  {
-    /* Map -(2^31-1)..(2^31-1) to +/-180 with 0x80000000 = error */
-    gdouble longitude = -2.600439;
-    gint32 val = (gint) ((longitude / 180.0) * 2147483647.0);
-    gst_byte_writer_put_int32_be (&bw, val);
-  }
+  GST_WRITE_UINT16_BE (klv_data + klv_size - 2, checksum);
+  filt->frame_number++;
 
-  /* Tag 5: Sensor True Altitude (MSL) (elevation) */
-  gst_byte_writer_put_uint8 (&bw, 15);  /* local tag: elevation */
-  gst_byte_writer_put_uint8 (&bw, 2);   /* data length (BER short form) */
-  {
-    /* Map 0..(2^16-1) to -900..19000 meters, so resolution 0.303654536m */
-    gdouble elevation = 10.0;
-    guint16 val = ((elevation + 900.0 + 0.151827268) / 19900.0) * 65535.0;
-    gst_byte_writer_put_int16_be (&bw, val);
-  }
+  gst_buffer_add_klv_meta_take_data (buf, klv_data, klv_size);
 
-  {
-    gsize klv_size = gst_byte_writer_get_size (&bw);
-    guint8 *klv_data = gst_byte_writer_reset_and_get_data (&bw);
-
-    gst_buffer_add_klv_meta_take_data (buf, klv_data, klv_size);
-  }
+  return TRUE;
 }
 
 static GstFlowReturn
@@ -212,8 +855,9 @@ gst_klvinject_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
 {
   GstKlvInject *filt = GST_KLVINJECT (trans);
 
-  GST_LOG_OBJECT (filt, "Injecting test KLV metadata");
-  gst_klvinject_add_test_meta (filt, buf);
+  GST_LOG_OBJECT (filt, "Injecting KLV metadata");
+  if (!gst_klvinject_add_meta (filt, buf))
+    return GST_FLOW_ERROR;
 
   return GST_FLOW_OK;
 }
@@ -36,6 +36,26 @@ typedef struct _GstKlvInjectClass GstKlvInjectClass;
 struct _GstKlvInject
 {
   GstBaseTransform base_klvinject;
+
+  /* properties */
+  gchar *template_str;
+  gchar *template_location;
+  gdouble latitude;
+  gdouble longitude;
+  gdouble altitude;
+  gdouble heading;
+  gdouble pitch;
+  gdouble roll;
+
+  /* compiled template: the packet with every dynamic field zeroed, where
+   * each field is stored, and the checksum of that packet */
+  gboolean template_dirty;
+  guint8 *image;
+  gsize image_size;
+  GArray *fields;
+  guint16 base_checksum;
+
+  guint64 frame_number;
 };
 
 struct _GstKlvInjectClass
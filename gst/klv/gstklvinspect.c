@@ -49,15 +49,28 @@ static void gst_klvinspect_set_property (GObject * object, guint prop_id,
 static void gst_klvinspect_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 
+static gboolean gst_klvinspect_stop (GstBaseTransform * trans);
 static GstFlowReturn gst_klvinspect_transform_ip (GstBaseTransform * trans,
     GstBuffer * buf);
 
 enum
 {
   PROP_0,
-  PROP_DUMP_LOCATION
+  PROP_DUMP_LOCATION,
+  PROP_DUMP_QUEUE_SIZE,
+  PROP_DUMP_MAX_SIZE,
+  PROP_DUMP_MAX_TIME,
+  PROP_DUMP_FSYNC,
+  PROP_DUMP_INDEX
 };
 
+#define DEFAULT_PROP_DUMP_QUEUE_SIZE 256
+#define MAX_DUMP_QUEUE_SIZE 4096
+#define DEFAULT_PROP_DUMP_MAX_SIZE 0
+#define DEFAULT_PROP_DUMP_MAX_TIME 0
+#define DEFAULT_PROP_DUMP_FSYNC GST_KLV_DUMP_FSYNC_NONE
+#define DEFAULT_PROP_DUMP_INDEX FALSE
+
 /* pad templates */
 
 #define SRC_CAPS "ANY"
@@ -84,7 +97,33 @@ gst_klvinspect_class_init (GstKlvInspectClass * klass)
 
   g_object_class_install_property (gobject_class, PROP_DUMP_LOCATION,
       g_param_spec_string ("dump-location", "Dump filename",
-          "Location to dump KLV metadata", NULL,
+          "Location to dump KLV metadata, or a printf pattern for the file "
+          "number when rotating", NULL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_DUMP_QUEUE_SIZE,
+      g_param_spec_uint ("dump-queue-size", "Dump queue size",
+          "Number of KLV packets waiting to be dumped before new ones are "
+          "dropped", 1, MAX_DUMP_QUEUE_SIZE, DEFAULT_PROP_DUMP_QUEUE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_DUMP_MAX_SIZE,
+      g_param_spec_uint64 ("dump-max-size", "Dump maximum file size",
+          "Size in bytes after which a new dump file is started (0 = unlimited)",
+          0, G_MAXUINT64, DEFAULT_PROP_DUMP_MAX_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_DUMP_MAX_TIME,
+      g_param_spec_uint ("dump-max-time", "Dump maximum file duration",
+          "Seconds after which a new dump file is started (0 = unlimited)",
+          0, G_MAXUINT, DEFAULT_PROP_DUMP_MAX_TIME,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_DUMP_FSYNC,
+      g_param_spec_enum ("dump-fsync", "Dump fsync policy",
+          "When to sync dumped KLV data to disk", GST_TYPE_KLV_DUMP_FSYNC,
+          DEFAULT_PROP_DUMP_FSYNC,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_DUMP_INDEX,
+      g_param_spec_boolean ("dump-index", "Dump index",
+          "Write an index of frame number, PTS, byte offset and size of each "
+          "packet to a .idx file next to each dump file", DEFAULT_PROP_DUMP_INDEX,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   /* Setting up pads and setting metadata should be moved to
@@ -100,6 +139,7 @@ gst_klvinspect_class_init (GstKlvInspectClass * klass)
       "Inspect KLV", "Filter", "Inspect KLV metadata",
       "Joshua M. Doe <oss@nvl.army.mil>");
 
+  base_transform_class->stop = GST_DEBUG_FUNCPTR (gst_klvinspect_stop);
   base_transform_class->transform_ip =
       GST_DEBUG_FUNCPTR (gst_klvinspect_transform_ip);
 
@@ -111,7 +151,12 @@ static void
 gst_klvinspect_init (GstKlvInspect * filt)
 {
   filt->dump_location = NULL;
-  filt->dump_file = NULL;
+  filt->dump_queue_size = DEFAULT_PROP_DUMP_QUEUE_SIZE;
+  filt->dump_max_size = DEFAULT_PROP_DUMP_MAX_SIZE;
+  filt->dump_max_time = DEFAULT_PROP_DUMP_MAX_TIME;
+  filt->dump_fsync = DEFAULT_PROP_DUMP_FSYNC;
+  filt->dump_index = DEFAULT_PROP_DUMP_INDEX;
+  filt->dump = NULL;
 }
 
 static void
@@ -124,8 +169,11 @@ gst_klvinspect_dispose (GstKlvInspect * object)
   /* release all resources */
   if (filt->dump_location)
     g_free (filt->dump_location);
-  if (filt->dump_file)
-    fclose (filt->dump_file);
+  filt->dump_location = NULL;
+  if (filt->dump) {
+    gst_klv_dump_free (filt->dump);
+    filt->dump = NULL;
+  }
 
   /* chain up to the parent class */
   G_OBJECT_CLASS (gst_klvinspect_parent_class)->dispose (object);
@@ -143,6 +191,21 @@ gst_klvinspect_set_property (GObject * object, guint prop_id,
         g_free (filt->dump_location);
       filt->dump_location = g_strdup (g_value_get_string (value));
       break;
+    case PROP_DUMP_QUEUE_SIZE:
+      filt->dump_queue_size = g_value_get_uint (value);
+      break;
+    case PROP_DUMP_MAX_SIZE:
+      filt->dump_max_size = g_value_get_uint64 (value);
+      break;
+    case PROP_DUMP_MAX_TIME:
+      filt->dump_max_time = g_value_get_uint (value);
+      break;
+    case PROP_DUMP_FSYNC:
+      filt->dump_fsync = g_value_get_enum (value);
+      break;
+    case PROP_DUMP_INDEX:
+      filt->dump_index = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -159,12 +222,42 @@ gst_klvinspect_get_property (GObject * object, guint prop_id,
     case PROP_DUMP_LOCATION:
       g_value_set_string (value, filt->dump_location);
       break;
+    case PROP_DUMP_QUEUE_SIZE:
+      g_value_set_uint (value, filt->dump_queue_size);
+      break;
+    case PROP_DUMP_MAX_SIZE:
+      g_value_set_uint64 (value, filt->dump_max_size);
+      break;
+    case PROP_DUMP_MAX_TIME:
+      g_value_set_uint (value, filt->dump_max_time);
+      break;
+    case PROP_DUMP_FSYNC:
+      g_value_set_enum (value, filt->dump_fsync);
+      break;
+    case PROP_DUMP_INDEX:
+      g_value_set_boolean (value, filt->dump_index);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static gboolean
+gst_klvinspect_stop (GstBaseTransform * trans)
+{
+  GstKlvInspect *filt = GST_KLVINSPECT (trans);
+
+  /* writes out whatever is still queued */
+  if (filt->dump) {
+    gst_klv_dump_free (filt->dump);
+    filt->dump = NULL;
+  }
+  filt->frame_number = 0;
+
+  return TRUE;
+}
+
 static GstFlowReturn
 gst_klvinspect_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
 {
@@ -172,13 +265,26 @@ gst_klvinspect_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
   GstKLVMeta *klv_meta;
   gpointer iter = NULL;
   gint n_klv_meta_found = 0;
+  GError *err = NULL;
+
+  if (filt->dump_location && !filt->dump) {
+    GST_DEBUG_OBJECT (filt, "Dumping KLV data to '%s'", filt->dump_location);
+    filt->dump = gst_klv_dump_new (filt->dump_location, filt->dump_queue_size,
+        filt->dump_max_size, filt->dump_max_time, filt->dump_fsync,
+        filt->dump_index);
+  }
 
-  if (filt->dump_location && !filt->dump_file) {
-    GST_DEBUG_OBJECT (filt, "Opening file '%s' to dump KLV data",
-        filt->dump_location);
-    filt->dump_file = g_fopen (filt->dump_location, "wb");
-    if (!filt->dump_file)
-      GST_WARNING_OBJECT (filt, "Unable to open KLV dump file");
+  /* files are written from the dump thread, so a failure shows up here on
+   * one of the following buffers */
+  if (filt->dump && gst_klv_dump_get_error (filt->dump, &err)) {
+    if (err->code == GST_RESOURCE_ERROR_OPEN_WRITE)
+      GST_ELEMENT_ERROR (filt, RESOURCE, OPEN_WRITE,
+          ("Could not open KLV dump file for writing."), ("%s", err->message));
+    else
+      GST_ELEMENT_ERROR (filt, RESOURCE, WRITE,
+          ("Error while writing KLV dump file."), ("%s", err->message));
+    g_error_free (err);
+    return GST_FLOW_ERROR;
   }
 
   while ((klv_meta = (GstKLVMeta *) gst_buffer_iterate_meta_filtered (buf,
@@ -190,11 +296,14 @@ gst_klvinspect_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
       GST_MEMDUMP_OBJECT (filt, "KLV data", klv_data, (guint) klv_size);
       ++n_klv_meta_found;
 
-      if (filt->dump_file) {
-        fwrite (klv_data, klv_size, 1, filt->dump_file);
-      }
+      /* queued by reference, written from the dump thread */
+      if (filt->dump && !gst_klv_dump_push (filt->dump,
+              gst_klv_meta_get_bytes (klv_meta), filt->frame_number,
+              GST_BUFFER_PTS (buf)))
+        GST_WARNING_OBJECT (filt, "KLV dump queue full, dropping packet");
     }
   }
+  filt->frame_number++;
 
   GST_LOG_OBJECT (filt, "Found %d KLV meta", n_klv_meta_found);
 
@@ -20,10 +20,10 @@
 #ifndef _GST_KLVINSPECT_H_
 #define _GST_KLVINSPECT_H_
 
-#include <stdio.h>
-
 #include <gst/base/gstbasetransform.h>
 
+#include "gstklvdump.h"
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_KLVINSPECT   (gst_klvinspect_get_type())
@@ -41,8 +41,14 @@ struct _GstKlvInspect
 
   /* properties */
   gchar* dump_location;
-
-  FILE* dump_file;
+  guint dump_queue_size;
+  guint64 dump_max_size;
+  guint dump_max_time;
+  GstKlvDumpFsync dump_fsync;
+  gboolean dump_index;
+
+  GstKlvDump* dump;
+  guint64 frame_number;
 };
 
 struct _GstKlvInspectClass
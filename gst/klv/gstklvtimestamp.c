@@ -36,9 +36,9 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstbasetransform.h>
-#include <gst/base/gstbytewriter.h>
 #include "gstklvtimestamp.h"
 #include "klv.h"
+#include "klvlocalset.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_klvtimestamp_debug_category);
 #define GST_CAT_DEFAULT gst_klvtimestamp_debug_category
@@ -106,18 +106,14 @@ static GstStaticCaps unix_reference = GST_STATIC_CAPS ("timestamp/x-unix");
 static void
 gst_klvtimestamp_parse_klv_timestamp (GstKlvTimestamp * filt, GstBuffer * buf)
 {
-  /* Add KLV meta for testing, here: Motion Imagery Standards Board (MISB)
-   * Engineering Guideline MISB EG 0902 - MISB Minimum Metadata Set.
+  /* Motion Imagery Standards Board (MISB) ST 0601 UAS Datalink Local Set.
    * Also see: SMPTE S336M for KLV specification, also ITU-R BT.1563-1 */
-  const guint8 klv_header[16] = { 0x06, 0x0e, 0x2b, 0x34, 0x02, 0x0b, 0x01,
-    0x01, 0x0e, 0x01, 0x03, 0x01, 0x01, 0x00, 0x00, 0x00
-  };
-
   GstKLVMeta *klv_meta;
   gsize klv_size;
   const guint8 *klv_data;
-  GstByteReader br;
-  guint8 *header_data;
+  GstKLVLocalSet set;
+  const guint8 *checksum;
+  gsize checksum_size;
 
   /* FIXME: MISB defines MISP time, which is NOT UTC, but use UTC for now */
   guint64 utc_us = -1;
@@ -136,44 +132,34 @@ gst_klvtimestamp_parse_klv_timestamp (GstKlvTimestamp * filt, GstBuffer * buf)
     return;
   }
 
-  gst_byte_reader_init (&br, klv_data, (guint) klv_size);
-
-  if (!gst_byte_reader_get_data (&br, sizeof (klv_header), &header_data)) {
-    GST_WARNING_OBJECT (filt, "KLV data too small to contain header");
+  if (!gst_klv_local_set_parse (&set, klv_data, klv_size)) {
+    GST_WARNING_OBJECT (filt, "Failed to parse KLV local set");
+    GST_MEMDUMP_OBJECT (filt, "KLV data", klv_data, (guint) klv_size);
     return;
   }
 
-  if (memcmp (header_data, klv_header, sizeof (klv_header)) != 0) {
+  if (!gst_klv_local_set_is_uas_datalink (&set)) {
     GST_WARNING_OBJECT (filt, "KLV header doesn't match");
-    GST_MEMDUMP_OBJECT (filt, "KLV header found", header_data,
-        (guint) sizeof (klv_header));
+    GST_MEMDUMP_OBJECT (filt, "KLV header found", klv_data, 16);
     return;
   }
 
-  guint8 klv_len;
-  if (!gst_byte_reader_get_uint8 (&br, &klv_len))
-    goto not_enough_data;
-
-  guint8 tag;
-  if (!gst_byte_reader_get_uint8 (&br, &tag))
-    goto not_enough_data;
-  if (tag != 2) {
-    GST_WARNING_OBJECT (filt,
-        "First tag is %d, not 2 as expected for timestamp", tag);
-    return;
+  if (gst_klv_local_set_get (&set, GST_KLV_UAS_DATALINK_TAG_CHECKSUM,
+          &checksum, &checksum_size)) {
+    if (!gst_klv_local_set_verify_checksum (&set)) {
+      GST_WARNING_OBJECT (filt, "KLV checksum doesn't match");
+      return;
+    }
+  } else {
+    GST_DEBUG_OBJECT (filt, "KLV has no checksum");
   }
 
-  guint8 data_len;
-  if (!gst_byte_reader_get_uint8 (&br, &data_len))
-    goto not_enough_data;
-  if (data_len != 8) {
-    GST_WARNING_OBJECT (filt,
-        "Data length for time tag is %d, not 8 as expected", data_len);
+  if (!gst_klv_local_set_get_uint (&set, GST_KLV_UAS_DATALINK_TAG_TIMESTAMP,
+          &utc_us)) {
+    GST_WARNING_OBJECT (filt, "KLV has no valid timestamp tag");
+    return;
   }
 
-  if (!gst_byte_reader_get_uint64_be (&br, &utc_us))
-    goto not_enough_data;
-
   GST_LOG_OBJECT (filt, "Found timestamp of %d.%06d s", utc_us / 1000000,
       utc_us % 1000000);
 
@@ -185,12 +171,6 @@ gst_klvtimestamp_parse_klv_timestamp (GstKlvTimestamp * filt, GstBuffer * buf)
   if (!time_meta) {
     GST_WARNING_OBJECT (filt, "Failed to generate or attach timestamp meta");
   }
-
-  return;
-
-not_enough_data:
-  GST_WARNING_OBJECT (filt, "Not enough data to continue parsing KLV");
-  return;
 }
 
 static GstFlowReturn
@@ -38,12 +38,13 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include "gstmisbirpack.h"
+#include "gstmisbirpackrow.h"
 
 #include <gst/video/video.h>
 
-//#include "gstextractcolororc-dist.h"
-
 /* GstMisbIrPack signals and args */
 enum
 {
@@ -55,10 +56,12 @@ enum
 {
   PROP_0,
   PROP_OFFSET,
+  PROP_N_THREADS,
   PROP_LAST
 };
 
 #define DEFAULT_PROP_OFFSET 64
+#define DEFAULT_PROP_N_THREADS 0
 
 /* the capabilities of the inputs and outputs */
 static GstStaticPadTemplate gst_misb_ir_pack_sink_template =
@@ -121,6 +124,11 @@ gst_misb_ir_pack_dispose (GObject * object)
 
   gst_misb_ir_pack_reset (misb_ir_pack);
 
+  if (misb_ir_pack->runner) {
+    gst_parallel_runner_free (misb_ir_pack->runner);
+    misb_ir_pack->runner = NULL;
+  }
+
   /* chain up to the parent class */
   G_OBJECT_CLASS (gst_misb_ir_pack_parent_class)->dispose (object);
 }
@@ -154,6 +162,8 @@ gst_misb_ir_pack_class_init (GstMisbIrPackClass * klass)
           "Offset value",
           "Offset value to apply during packing", 0, 1023,
           DEFAULT_PROP_OFFSET, G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE));
+  g_object_class_install_property (G_OBJECT_CLASS (klass),
+      PROP_N_THREADS, gst_parallel_param_spec_n_threads ());
 
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&gst_misb_ir_pack_sink_template));
@@ -181,6 +191,7 @@ gst_misb_ir_pack_init (GstMisbIrPack * filt)
   GST_DEBUG_OBJECT (filt, "init class instance");
 
   filt->offset_value = DEFAULT_PROP_OFFSET;
+  filt->n_threads = DEFAULT_PROP_N_THREADS;
   gst_base_transform_set_in_place (GST_BASE_TRANSFORM (filt), FALSE);
 
   gst_misb_ir_pack_reset (filt);
@@ -198,6 +209,9 @@ gst_misb_ir_pack_set_property (GObject * object, guint prop_id,
     case PROP_OFFSET:
       filt->offset_value = g_value_get_int (value);
       break;
+    case PROP_N_THREADS:
+      filt->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -216,6 +230,9 @@ gst_misb_ir_pack_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_OFFSET:
       g_value_set_int (value, filt->offset_value);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, filt->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -283,19 +300,40 @@ gst_misb_ir_pack_set_info (GstVideoFilter * filter, GstCaps * incaps,
   return res;
 }
 
+typedef struct
+{
+  GstVideoFrame *in_frame;
+  GstVideoFrame *out_frame;
+  guint offset;
+} GstMisbIrPackFrames;
+
+static void
+gst_misb_ir_pack_rows (gpointer user_data, guint band, gint row_start,
+    gint row_end)
+{
+  GstMisbIrPackFrames *frames = (GstMisbIrPackFrames *) user_data;
+  gint y;
+
+  for (y = row_start; y < row_end; y++) {
+    const guint16 *src =
+        (const guint16 *) (GST_VIDEO_FRAME_COMP_DATA (frames->in_frame, 0) +
+        y * GST_VIDEO_FRAME_COMP_STRIDE (frames->in_frame, 0));
+    guint32 *dst = (guint32 *) (GST_VIDEO_FRAME_COMP_DATA (frames->out_frame,
+            0) + y * GST_VIDEO_FRAME_COMP_STRIDE (frames->out_frame, 0));
+
+    gst_misb_ir_pack_row (src, dst,
+        GST_VIDEO_FRAME_COMP_WIDTH (frames->in_frame, 0), frames->offset);
+  }
+}
+
 static GstFlowReturn
 gst_misb_ir_pack_transform_frame (GstVideoFilter * filter,
     GstVideoFrame * in_frame, GstVideoFrame * out_frame)
 {
   GstMisbIrPack *filt = GST_MISB_IR_PACK (filter);
   GTimer *timer = NULL;
-  guint offset = filt->offset_value;
-  gint y;
-  guint16 *src, *src_end;
-  guint32 *dst;
-  guint32 word0;
-  guint32 word1;
-  guint16 luma0, chroma0, luma1, chroma1, luma2, chroma2;
+  GstParallelRunner *runner;
+  GstMisbIrPackFrames frames;
 
   GST_LOG_OBJECT (filt, "Performing non-inplace transform");
 
@@ -303,81 +341,13 @@ gst_misb_ir_pack_transform_frame (GstVideoFilter * filter,
   timer = g_timer_new ();
 #endif
 
-  for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (in_frame, 0); y++) {
-    src = (guint16 *) (GST_VIDEO_FRAME_COMP_DATA (in_frame, 0) +
-        y * GST_VIDEO_FRAME_COMP_STRIDE (in_frame, 0));
-    src_end = src + GST_VIDEO_FRAME_COMP_WIDTH (in_frame, 0);
-    dst = (guint32 *) (GST_VIDEO_FRAME_COMP_DATA (out_frame, 0) +
-        y * GST_VIDEO_FRAME_COMP_STRIDE (out_frame, 0));
-
-    while (src + 2 < src_end) {
-      chroma0 = (*src & 0xff) + offset;
-      luma0 = ((*src & 0xff00) >> 8) + offset;
-      src++;
-      chroma1 = (*src & 0xff) + offset;
-      luma1 = ((*src & 0xff00) >> 8) + offset;
-      src++;
-      chroma2 = (*src & 0xff) + offset;
-      luma2 = ((*src & 0xff00) >> 8) + offset;
-      src++;
-
-      word0 = chroma0 | luma0 << 10 | chroma1 << 20;
-      word1 = luma1 | chroma2 << 10 | luma2 << 20;
-
-      *dst++ = word0;
-      *dst++ = word1;
-    }
-
-    /* handle the last one or two pixels if they exist */
-    if (src_end - src) {
-      chroma0 = (*src & 0xff) + offset;
-      luma0 = ((*src & 0xff00) >> 8) + offset;
-      src++;
-      if (src_end - src) {
-        chroma1 = (*src & 0xff) + offset;
-        luma1 = ((*src & 0xff00) >> 8) + offset;
-      } else {
-        chroma1 = luma1 = 0;
-      }
-      chroma2 = luma2 = 0;
-
-      word0 = chroma0 | luma0 << 10 | chroma1 << 20;
-      word1 = luma1 | chroma2 << 10 | luma2 << 20;
-
-      *dst++ = word0;
-      *dst++ = word1;
-    }
-  }
-
-  //for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (in_frame, 0); y++) {
-  //    src = (guint16 *) (GST_VIDEO_FRAME_COMP_DATA (in_frame, 0) + 
-  //        y * GST_VIDEO_FRAME_COMP_STRIDE (in_frame, 0));
-  //    dst = (guint32 *) (GST_VIDEO_FRAME_COMP_DATA (out_frame, 0) + 
-  //        y * GST_VIDEO_FRAME_COMP_STRIDE (out_frame, 0));
-  //    for (x = 0; x < GST_VIDEO_FRAME_COMP_WIDTH (in_frame, 0); ) {
-  //        guint32 word0;
-  //        guint32 word1;
-  //        guint16 luma0, chroma0, luma1, chroma1, luma2, chroma2;
-
-  //        chroma0 = *src & 0xff + offset;
-  //        luma0 = (*src & 0xff00) >> 8 + offset;
-  //        src++;
-  //        chroma1 = *src & 0xff + offset;
-  //        luma1 = (*src & 0xff00) >> 8 + offset;
-  //        src++;
-  //        chroma2 = *src & 0xff + offset;
-  //        luma2 = (*src & 0xff00) >> 8 + offset;
-  //        src++;
-
-  //        word0 = 0;
-  //        word0 = chroma0 | luma0 << 10 | chroma1 << 20;
-  //        word1 = 0;
-  //        word1 = luma1 | chroma2 << 10 | luma2 << 20;
-
-  //        dst[x++] = word0;
-  //        dst[x++] = word1;
-  //    }
-  //}
+  frames.in_frame = in_frame;
+  frames.out_frame = out_frame;
+  frames.offset = filt->offset_value;
+  runner = gst_parallel_runner_ensure (&filt->runner, filt->n_threads);
+  gst_parallel_runner_run_rows (runner,
+      GST_VIDEO_FRAME_COMP_HEIGHT (in_frame, 0), 1, gst_misb_ir_pack_rows,
+      &frames);
 
 #if 0
   GST_LOG_OBJECT (filt, "Processing took %.3f ms", g_timer_elapsed (timer,
@@ -388,7 +358,6 @@ gst_misb_ir_pack_transform_frame (GstVideoFilter * filter,
   return GST_FLOW_OK;
 }
 
-
 static void
 gst_misb_ir_pack_reset (GstMisbIrPack * misb_ir_pack)
 {
@@ -28,6 +28,8 @@
 #include <gst/video/gstvideofilter.h>
 #include <gst/video/video.h>
 
+#include "parallel.h"
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_MISB_IR_PACK \
@@ -61,6 +63,9 @@ struct _GstMisbIrPack
 
   /* properties */
   guint offset_value;
+  guint n_threads;
+
+  GstParallelRunner *runner;
 };
 
 struct _GstMisbIrPackClass
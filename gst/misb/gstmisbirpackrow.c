@@ -0,0 +1,109 @@
+/* GStreamer
+ * Copyright (C) 2018 United States Government, Joshua M. Doe <oss@nvl.army.mil>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "gstmisbirpackrow.h"
+
+/* Each GRAY16 pixel becomes a chroma and a luma v210 sample, from its low
+ * and high byte plus the offset, and every three pixels fill a pair of 32-bit
+ * words. Twelve pixels are read as three 64-bit words, split into low and high
+ * bytes in 16-bit lanes with the offset added to all lanes at once, then
+ * shifted into eight output words. Sums past 10 bits are OR'ed into the next
+ * field, just as the per-pixel code below does. */
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+#define LANE(v,k) ((guint32) ((v) >> (16 * (k))) & 0xffff)
+#else
+#define LANE(v,k) ((guint32) ((v) >> (16 * (3 - (k)))) & 0xffff)
+#endif
+
+void
+gst_misb_ir_pack_row (const guint16 * src, guint32 * dst, gint width,
+    guint offset)
+{
+  const guint64 offsets = offset * G_GUINT64_CONSTANT (0x0001000100010001);
+  const guint64 mask = G_GUINT64_CONSTANT (0x00ff00ff00ff00ff);
+  const guint16 *src_end = src + width;
+  guint16 luma0, chroma0, luma1, chroma1, luma2, chroma2;
+  gint i, n = width / 12;
+
+  for (i = 0; i < n; i++) {
+    guint64 a, b, c;
+    guint64 ca, la, cb, lb, cc, lc;
+    guint32 *d = dst + 8 * i;
+
+    memcpy (&a, src + 12 * i, 8);
+    memcpy (&b, src + 12 * i + 4, 8);
+    memcpy (&c, src + 12 * i + 8, 8);
+    ca = (a & mask) + offsets;
+    la = ((a >> 8) & mask) + offsets;
+    cb = (b & mask) + offsets;
+    lb = ((b >> 8) & mask) + offsets;
+    cc = (c & mask) + offsets;
+    lc = ((c >> 8) & mask) + offsets;
+
+    d[0] = LANE (ca, 0) | LANE (la, 0) << 10 | LANE (ca, 1) << 20;
+    d[1] = LANE (la, 1) | LANE (ca, 2) << 10 | LANE (la, 2) << 20;
+    d[2] = LANE (ca, 3) | LANE (la, 3) << 10 | LANE (cb, 0) << 20;
+    d[3] = LANE (lb, 0) | LANE (cb, 1) << 10 | LANE (lb, 1) << 20;
+    d[4] = LANE (cb, 2) | LANE (lb, 2) << 10 | LANE (cb, 3) << 20;
+    d[5] = LANE (lb, 3) | LANE (cc, 0) << 10 | LANE (lc, 0) << 20;
+    d[6] = LANE (cc, 1) | LANE (lc, 1) << 10 | LANE (cc, 2) << 20;
+    d[7] = LANE (lc, 2) | LANE (cc, 3) << 10 | LANE (lc, 3) << 20;
+  }
+  src += 12 * n;
+  dst += 8 * n;
+
+  while (src + 2 < src_end) {
+    chroma0 = (*src & 0xff) + offset;
+    luma0 = ((*src & 0xff00) >> 8) + offset;
+    src++;
+    chroma1 = (*src & 0xff) + offset;
+    luma1 = ((*src & 0xff00) >> 8) + offset;
+    src++;
+    chroma2 = (*src & 0xff) + offset;
+    luma2 = ((*src & 0xff00) >> 8) + offset;
+    src++;
+
+    *dst++ = chroma0 | luma0 << 10 | chroma1 << 20;
+    *dst++ = luma1 | chroma2 << 10 | luma2 << 20;
+  }
+
+  /* handle the last one or two pixels if they exist */
+  if (src_end - src) {
+    chroma0 = (*src & 0xff) + offset;
+    luma0 = ((*src & 0xff00) >> 8) + offset;
+    src++;
+    if (src_end - src) {
+      chroma1 = (*src & 0xff) + offset;
+      luma1 = ((*src & 0xff00) >> 8) + offset;
+    } else {
+      chroma1 = luma1 = 0;
+    }
+
+    *dst++ = chroma0 | luma0 << 10 | chroma1 << 20;
+    *dst++ = luma1;
+  }
+}
+
+#undef LANE
@@ -0,0 +1,35 @@
+/* GStreamer
+ * Copyright (C) 2018 United States Government, Joshua M. Doe <oss@nvl.army.mil>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_MISB_IR_PACK_ROW_H__
+#define __GST_MISB_IR_PACK_ROW_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Packs one row of width GRAY16 pixels into (width + 2) / 3 * 2 v210 words,
+ * adding offset to every sample. Kept apart from the element so the packer
+ * can be tested on its own. */
+void gst_misb_ir_pack_row (const guint16 * src, guint32 * dst, gint width,
+    guint offset);
+
+G_END_DECLS
+
+#endif /* __GST_MISB_IR_PACK_ROW_H__ */
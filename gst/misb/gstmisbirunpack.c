@@ -38,12 +38,12 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include "gstmisbirunpack.h"
 
 #include <gst/video/video.h>
 
-//#include "gstextractcolororc-dist.h"
-
 /* GstMisbIrUnpack signals and args */
 enum
 {
@@ -59,6 +59,7 @@ enum
   PROP_SWAP,
   PROP_LUMA_MASK,
   PROP_CHROMA_MASK,
+  PROP_N_THREADS,
   PROP_LAST
 };
 
@@ -67,6 +68,7 @@ enum
 #define DEFAULT_PROP_SWAP FALSE
 #define DEFAULT_PROP_LUMA_MASK 0xff
 #define DEFAULT_PROP_CHROMA_MASK 0xff
+#define DEFAULT_PROP_N_THREADS 0
 
 /* the capabilities of the inputs and outputs */
 static GstStaticPadTemplate gst_misb_ir_unpack_sink_template =
@@ -104,6 +106,7 @@ static GstFlowReturn gst_misb_ir_unpack_transform_frame (GstVideoFilter *
 
 /* GstMisbIrUnpack method declarations */
 static void gst_misb_ir_unpack_reset (GstMisbIrUnpack * filter);
+static void gst_misb_ir_unpack_update_luts (GstMisbIrUnpack * filt);
 
 /* setup debug */
 GST_DEBUG_CATEGORY_STATIC (misb_ir_unpack_debug);
@@ -129,6 +132,11 @@ gst_misb_ir_unpack_dispose (GObject * object)
 
   gst_misb_ir_unpack_reset (misb_ir_unpack);
 
+  if (misb_ir_unpack->runner) {
+    gst_parallel_runner_free (misb_ir_unpack->runner);
+    misb_ir_unpack->runner = NULL;
+  }
+
   /* chain up to the parent class */
   G_OBJECT_CLASS (gst_misb_ir_unpack_parent_class)->dispose (object);
 }
@@ -181,6 +189,8 @@ gst_misb_ir_unpack_class_init (GstMisbIrUnpackClass * klass)
           "Chroma mask",
           "Mask to bitwise AND with chroma after applying offset", 0, 0xffff,
           DEFAULT_PROP_LUMA_MASK, G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE));
+  g_object_class_install_property (G_OBJECT_CLASS (klass),
+      PROP_N_THREADS, gst_parallel_param_spec_n_threads ());
 
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&gst_misb_ir_unpack_sink_template));
@@ -212,6 +222,8 @@ gst_misb_ir_unpack_init (GstMisbIrUnpack * filt)
   filt->swap = DEFAULT_PROP_SWAP;
   filt->luma_mask = DEFAULT_PROP_LUMA_MASK;
   filt->chroma_mask = DEFAULT_PROP_CHROMA_MASK;
+  filt->n_threads = DEFAULT_PROP_N_THREADS;
+  gst_misb_ir_unpack_update_luts (filt);
 
   gst_base_transform_set_in_place (GST_BASE_TRANSFORM (filt), FALSE);
 
@@ -226,6 +238,7 @@ gst_misb_ir_unpack_set_property (GObject * object, guint prop_id,
 
   GST_DEBUG_OBJECT (filt, "setting property %s", pspec->name);
 
+  GST_OBJECT_LOCK (filt);
   switch (prop_id) {
     case PROP_OFFSET:
       filt->offset_value = g_value_get_int (value);
@@ -242,10 +255,15 @@ gst_misb_ir_unpack_set_property (GObject * object, guint prop_id,
     case PROP_CHROMA_MASK:
       filt->chroma_mask = g_value_get_uint (value);
       break;
+    case PROP_N_THREADS:
+      filt->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
+  gst_misb_ir_unpack_update_luts (filt);
+  GST_OBJECT_UNLOCK (filt);
 }
 
 static void
@@ -272,6 +290,9 @@ gst_misb_ir_unpack_get_property (GObject * object, guint prop_id,
     case PROP_CHROMA_MASK:
       g_value_set_uint (value, filt->chroma_mask);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, filt->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -340,16 +361,131 @@ gst_misb_ir_unpack_set_info (GstVideoFilter * filter, GstCaps * incaps,
   return res;
 }
 
+/* Offset, masks, shift and swap only depend on the sample value, so they are
+ * folded into one table per sample position whenever a property changes.
+ * Each output pixel is then two lookups OR'ed together. The tables cover
+ * the 10-bit v210 range, UYVY only uses the first 256 entries. */
+static void
+gst_misb_ir_unpack_update_luts (GstMisbIrUnpack * filt)
+{
+  gint16 offset = filt->offset_value;
+  guint16 chroma, luma;
+  gint v;
+
+  for (v = 0; v < G_N_ELEMENTS (filt->chroma_lut); v++) {
+    chroma = (v + offset) & filt->chroma_mask;
+    luma = ((v + offset) & filt->luma_mask) << filt->shift_value;
+    if (filt->swap) {
+      filt->chroma_lut[v] = luma;
+      filt->luma_lut[v] = chroma;
+    } else {
+      filt->chroma_lut[v] = chroma;
+      filt->luma_lut[v] = luma;
+    }
+  }
+}
+
+#define V210_SAMPLE(word, n) (((word) >> (10 * (n))) & 0x3ff)
+
+static void
+gst_misb_ir_unpack_v210_row (const guint16 * clut, const guint16 * llut,
+    const guint32 * src, guint16 * dst, gint width)
+{
+  guint32 word0, word1, word2, word3;
+  gint x;
+
+  /* six pixels per four words */
+  for (x = 0; x + 6 <= width; x += 6) {
+    word0 = GUINT32_FROM_LE (src[0]);
+    word1 = GUINT32_FROM_LE (src[1]);
+    word2 = GUINT32_FROM_LE (src[2]);
+    word3 = GUINT32_FROM_LE (src[3]);
+    src += 4;
+
+    dst[x] = clut[V210_SAMPLE (word0, 0)] | llut[V210_SAMPLE (word0, 1)];
+    dst[x + 1] = clut[V210_SAMPLE (word0, 2)] | llut[V210_SAMPLE (word1, 0)];
+    dst[x + 2] = clut[V210_SAMPLE (word1, 1)] | llut[V210_SAMPLE (word1, 2)];
+    dst[x + 3] = clut[V210_SAMPLE (word2, 0)] | llut[V210_SAMPLE (word2, 1)];
+    dst[x + 4] = clut[V210_SAMPLE (word2, 2)] | llut[V210_SAMPLE (word3, 0)];
+    dst[x + 5] = clut[V210_SAMPLE (word3, 1)] | llut[V210_SAMPLE (word3, 2)];
+  }
+
+  /* remaining pixels, without writing past the end of the row */
+  if (x < width) {
+    guint16 tail[6];
+    gint i;
+
+    word0 = GUINT32_FROM_LE (src[0]);
+    word1 = GUINT32_FROM_LE (src[1]);
+    word2 = GUINT32_FROM_LE (src[2]);
+    word3 = GUINT32_FROM_LE (src[3]);
+    tail[0] = clut[V210_SAMPLE (word0, 0)] | llut[V210_SAMPLE (word0, 1)];
+    tail[1] = clut[V210_SAMPLE (word0, 2)] | llut[V210_SAMPLE (word1, 0)];
+    tail[2] = clut[V210_SAMPLE (word1, 1)] | llut[V210_SAMPLE (word1, 2)];
+    tail[3] = clut[V210_SAMPLE (word2, 0)] | llut[V210_SAMPLE (word2, 1)];
+    tail[4] = clut[V210_SAMPLE (word2, 2)] | llut[V210_SAMPLE (word3, 0)];
+    for (i = 0; x < width; i++)
+      dst[x++] = tail[i];
+  }
+}
+
+#undef V210_SAMPLE
+
+static void
+gst_misb_ir_unpack_uyvy_row (const guint16 * clut, const guint16 * llut,
+    const guint8 * src, guint16 * dst, gint width)
+{
+  gint x;
+
+  for (x = 0; x < width; x++) {
+    dst[x] = clut[src[0]] | llut[src[1]];
+    src += 2;
+  }
+}
+
+typedef struct
+{
+  GstVideoFrame *in_frame;
+  GstVideoFrame *out_frame;
+  guint16 chroma_lut[1024];
+  guint16 luma_lut[1024];
+} GstMisbIrUnpackFrames;
+
+static void
+gst_misb_ir_unpack_rows (gpointer user_data, guint band, gint row_start,
+    gint row_end)
+{
+  GstMisbIrUnpackFrames *frames = (GstMisbIrUnpackFrames *) user_data;
+  GstVideoFrame *in_frame = frames->in_frame;
+  GstVideoFrame *out_frame = frames->out_frame;
+  gint y;
+  guint8 *src;
+  guint16 *dst;
+
+  for (y = row_start; y < row_end; y++) {
+    src = GST_VIDEO_FRAME_COMP_DATA (in_frame, 0) +
+        y * GST_VIDEO_FRAME_COMP_STRIDE (in_frame, 0);
+    dst = (guint16 *) (GST_VIDEO_FRAME_COMP_DATA (out_frame, 0) +
+        y * GST_VIDEO_FRAME_COMP_STRIDE (out_frame, 0));
+
+    if (GST_VIDEO_FRAME_FORMAT (in_frame) == GST_VIDEO_FORMAT_v210)
+      gst_misb_ir_unpack_v210_row (frames->chroma_lut, frames->luma_lut,
+          (const guint32 *) src, dst, GST_VIDEO_FRAME_WIDTH (in_frame));
+    else
+      gst_misb_ir_unpack_uyvy_row (frames->chroma_lut, frames->luma_lut,
+          src, dst, GST_VIDEO_FRAME_WIDTH (in_frame));
+  }
+}
+
 static GstFlowReturn
 gst_misb_ir_unpack_transform_frame (GstVideoFilter * filter,
     GstVideoFrame * in_frame, GstVideoFrame * out_frame)
 {
   GstMisbIrUnpack *filt = GST_MISB_IR_UNPACK (filter);
   GTimer *timer = NULL;
-  gint16 offset = filt->offset_value;
-  guint shift = filt->shift_value;
-  gint x, y;
-  guint16 *dst;
+  GstParallelRunner *runner;
+  GstMisbIrUnpackFrames frames;
+  guint n_threads;
 
   GST_LOG_OBJECT (filt, "Performing non-inplace transform");
 
@@ -357,73 +493,22 @@ gst_misb_ir_unpack_transform_frame (GstVideoFilter * filter,
   timer = g_timer_new ();
 #endif
 
-  if (filt->info_in.finfo->format == GST_VIDEO_FORMAT_v210) {
-    for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (in_frame, 0); y++) {
-      guint32 *src = (guint32 *) (GST_VIDEO_FRAME_COMP_DATA (in_frame, 0) +
-          y * GST_VIDEO_FRAME_COMP_STRIDE (in_frame, 0));
-      dst = (guint16 *) (GST_VIDEO_FRAME_COMP_DATA (out_frame, 0) +
-          y * GST_VIDEO_FRAME_COMP_STRIDE (out_frame, 0));
-      for (x = 0; x < GST_VIDEO_FRAME_COMP_WIDTH (in_frame, 0);) {
-        guint32 word0 = *src++;
-        guint32 word1 = *src++;
-        guint16 luma, chroma, temp;
-
-        chroma = word0 & 0x3ff;
-        luma = (word0 & 0xffc00) >> 10;
-        if (filt->swap) {
-          temp = chroma;
-          chroma = luma;
-          luma = temp;
-        }
-        dst[x++] =
-            ((chroma + offset) & filt->chroma_mask) | (((luma +
-                    offset) & filt->luma_mask) << shift);
-
-        chroma = (word0 & 0x3ff00000) >> 20;
-        luma = word1 & 0x3ff;
-        if (filt->swap) {
-          temp = chroma;
-          chroma = luma;
-          luma = temp;
-        }
-        dst[x++] =
-            (chroma + offset) & filt->chroma_mask | ((luma +
-                offset) & filt->luma_mask) << shift;
-
-        chroma = (word1 & 0xffc00) >> 10;
-        luma = (word1 & 0x3ff00000) >> 20;
-        if (filt->swap) {
-          temp = chroma;
-          chroma = luma;
-          luma = temp;
-        }
-        dst[x++] =
-            (chroma + offset) & filt->chroma_mask | ((luma +
-                offset) & filt->luma_mask) << shift;
-      }
-    }
-  } else if (filt->info_in.finfo->format == GST_VIDEO_FORMAT_UYVY) {
-    for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (in_frame, 0); y++) {
-      guint8 *src = (guint8 *) (GST_VIDEO_FRAME_COMP_DATA (in_frame, 0) +
-          y * GST_VIDEO_FRAME_COMP_STRIDE (in_frame, 0));
-      dst = (guint16 *) (GST_VIDEO_FRAME_COMP_DATA (out_frame, 0) +
-          y * GST_VIDEO_FRAME_COMP_STRIDE (out_frame, 0));
-      for (x = 0; x < GST_VIDEO_FRAME_COMP_WIDTH (in_frame, 0);) {
-        guint8 chroma = *src++;
-        guint8 luma = *src++;
-        guint8 temp;
-
-        if (filt->swap) {
-          temp = chroma;
-          chroma = luma;
-          luma = temp;
-        }
-        dst[x++] =
-            ((chroma + offset) & filt->chroma_mask) | (((luma +
-                    offset) & filt->luma_mask) << shift);
-      }
-    }
-  }
+  frames.in_frame = in_frame;
+  frames.out_frame = out_frame;
+
+  /* the workers use a copy of the tables, so property changes neither wait
+   * for the frame nor show up halfway through it */
+  GST_OBJECT_LOCK (filt);
+  memcpy (frames.chroma_lut, filt->chroma_lut, sizeof (frames.chroma_lut));
+  memcpy (frames.luma_lut, filt->luma_lut, sizeof (frames.luma_lut));
+  n_threads = filt->n_threads;
+  GST_OBJECT_UNLOCK (filt);
+
+  runner = gst_parallel_runner_ensure (&filt->runner, n_threads);
+  gst_parallel_runner_run_rows (runner,
+      GST_VIDEO_FRAME_COMP_HEIGHT (in_frame, 0), 1, gst_misb_ir_unpack_rows,
+      &frames);
+
 #if 0
   GST_LOG_OBJECT (filt, "Processing took %.3f ms", g_timer_elapsed (timer,
           NULL) * 1000);
@@ -433,7 +518,6 @@ gst_misb_ir_unpack_transform_frame (GstVideoFilter * filter,
   return GST_FLOW_OK;
 }
 
-
 static void
 gst_misb_ir_unpack_reset (GstMisbIrUnpack * misb_ir_unpack)
 {
@@ -28,6 +28,8 @@
 #include <gst/video/gstvideofilter.h>
 #include <gst/video/video.h>
 
+#include "parallel.h"
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_MISB_IR_UNPACK \
@@ -65,6 +67,13 @@ struct _GstMisbIrUnpack
   gboolean swap;
   guint luma_mask;
   guint chroma_mask;
+  guint n_threads;
+
+  /* per-sample contributions, rebuilt when a property changes */
+  guint16 chroma_lut[1024];
+  guint16 luma_lut[1024];
+
+  GstParallelRunner *runner;
 };
 
 struct _GstMisbIrUnpackClass
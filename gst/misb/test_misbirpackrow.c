@@ -0,0 +1,176 @@
+/* GStreamer
+ * Copyright (C) 2018 United States Government, Joshua M. Doe <oss@nvl.army.mil>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Checks gst_misb_ir_pack_row against the per-pixel loop misbirpack used
+ * before the row packer, byte for byte. */
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "gstmisbirpackrow.h"
+
+#define MAX_WIDTH 61
+#define GUARD_WORDS 4
+#define GUARD_VALUE 0xdeadbeef
+
+static void
+reference_pack_row (const guint16 * src, guint32 * dst, gint width,
+    guint offset)
+{
+  const guint16 *src_end = src + width;
+  guint32 word0;
+  guint32 word1;
+  guint16 luma0, chroma0, luma1, chroma1, luma2, chroma2;
+
+  while (src + 2 < src_end) {
+    chroma0 = (*src & 0xff) + offset;
+    luma0 = ((*src & 0xff00) >> 8) + offset;
+    src++;
+    chroma1 = (*src & 0xff) + offset;
+    luma1 = ((*src & 0xff00) >> 8) + offset;
+    src++;
+    chroma2 = (*src & 0xff) + offset;
+    luma2 = ((*src & 0xff00) >> 8) + offset;
+    src++;
+
+    word0 = chroma0 | luma0 << 10 | chroma1 << 20;
+    word1 = luma1 | chroma2 << 10 | luma2 << 20;
+
+    *dst++ = word0;
+    *dst++ = word1;
+  }
+
+  /* handle the last one or two pixels if they exist */
+  if (src_end - src) {
+    chroma0 = (*src & 0xff) + offset;
+    luma0 = ((*src & 0xff00) >> 8) + offset;
+    src++;
+    if (src_end - src) {
+      chroma1 = (*src & 0xff) + offset;
+      luma1 = ((*src & 0xff00) >> 8) + offset;
+    } else {
+      chroma1 = luma1 = 0;
+    }
+    chroma2 = luma2 = 0;
+
+    word0 = chroma0 | luma0 << 10 | chroma1 << 20;
+    word1 = luma1 | chroma2 << 10 | luma2 << 20;
+
+    *dst++ = word0;
+    *dst++ = word1;
+  }
+}
+
+static void
+check_row (const guint16 * src, gint width, guint offset)
+{
+  guint32 expected[(MAX_WIDTH + 2) / 3 * 2 + GUARD_WORDS];
+  guint32 actual[(MAX_WIDTH + 2) / 3 * 2 + GUARD_WORDS];
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (expected); i++)
+    expected[i] = actual[i] = GUARD_VALUE;
+
+  reference_pack_row (src, expected, width, offset);
+  gst_misb_ir_pack_row (src, actual, width, offset);
+
+  if (memcmp (expected, actual, sizeof (expected)) != 0) {
+    for (i = 0; i < G_N_ELEMENTS (expected); i++) {
+      if (expected[i] != actual[i])
+        g_error ("width %d offset %u: word %d is 0x%08x, expected 0x%08x",
+            width, offset, i, actual[i], expected[i]);
+    }
+  }
+}
+
+static void
+test_pack_row_edge_values (void)
+{
+  static const guint16 values[] = { 0x0000, 0x00ff, 0xff00, 0xffff, 0x0101,
+    0x8080, 0x7f7f, 0x00fe
+  };
+  static const guint offsets[] = { 0, 1, 64, 255, 256, 768, 769, 1023 };
+  guint16 src[MAX_WIDTH];
+  gint width, i, v, o;
+
+  for (o = 0; o < G_N_ELEMENTS (offsets); o++) {
+    for (width = 1; width <= MAX_WIDTH; width++) {
+      /* constant rows of each edge value */
+      for (v = 0; v < G_N_ELEMENTS (values); v++) {
+        for (i = 0; i < width; i++)
+          src[i] = values[v];
+        check_row (src, width, offsets[o]);
+      }
+
+      /* edge values cycled so every lane of a block sees each of them */
+      for (v = 0; v < G_N_ELEMENTS (values); v++) {
+        for (i = 0; i < width; i++)
+          src[i] = values[(i + v) % G_N_ELEMENTS (values)];
+        check_row (src, width, offsets[o]);
+      }
+    }
+  }
+}
+
+static void
+test_pack_row_random (void)
+{
+  GRand *rand = g_rand_new_with_seed (0x4d495342);
+  guint16 src[MAX_WIDTH];
+  gint n, width, i;
+
+  for (n = 0; n < 20000; n++) {
+    width = g_rand_int_range (rand, 1, MAX_WIDTH + 1);
+    for (i = 0; i < width; i++)
+      src[i] = g_rand_int_range (rand, 0, 0x10000);
+    check_row (src, width, g_rand_int_range (rand, 0, 1024));
+  }
+
+  g_rand_free (rand);
+}
+
+static void
+test_pack_row_unaligned (void)
+{
+  GRand *rand = g_rand_new_with_seed (0x56323130);
+  guint16 buf[MAX_WIDTH + 1];
+  gint width, i;
+
+  /* rows may start on any 2-byte boundary within a frame */
+  for (width = 1; width <= MAX_WIDTH; width++) {
+    for (i = 0; i < G_N_ELEMENTS (buf); i++)
+      buf[i] = g_rand_int_range (rand, 0, 0x10000);
+    check_row (buf + 1, width, g_rand_int_range (rand, 0, 1024));
+  }
+
+  g_rand_free (rand);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/misbirpack/row/edge-values", test_pack_row_edge_values);
+  g_test_add_func ("/misbirpack/row/random", test_pack_row_random);
+  g_test_add_func ("/misbirpack/row/unaligned", test_pack_row_unaligned);
+
+  return g_test_run ();
+}
@@ -0,0 +1,481 @@
+/* GStreamer
+ * Copyright (C) 2026 gst-plugins-vision authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+* SECTION:element-multiselect
+*
+* Fans one stream out to several src pads, each selecting its own buffers
+* with the offset, skip, framerate and phase properties of select. This
+* replaces a tee with a queue and select per branch: buffers are pushed by
+* reference from the single chain function, and only to the pads that want
+* them, so dropped buffers cost no queue or thread wakeup.
+*
+* The properties are set on the request pads, see select for their meaning.
+*
+* <refsect2>
+* <title>Example launch line</title>
+* |[
+* gst-launch videotestsrc ! multiselect name=s src_1::skip=9 src_2::framerate=1/1 \
+*     s.src_0 ! queue ! fakesink s.src_1 ! queue ! fakesink s.src_2 ! queue ! fakesink
+* ]|
+* </refsect2>
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+
+#include "gstmultiselect.h"
+
+enum
+{
+  PROP_0,
+  PROP_OFFSET,
+  PROP_SKIP,
+  PROP_FRAMERATE,
+  PROP_PHASE,
+  PROP_LAST
+};
+
+static GstStaticPadTemplate gst_multi_select_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("ANY")
+    );
+
+static GstStaticPadTemplate gst_multi_select_src_template =
+GST_STATIC_PAD_TEMPLATE ("src_%u",
+    GST_PAD_SRC,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS ("ANY")
+    );
+
+/* GObject vmethod declarations */
+static void gst_multi_select_pad_set_property (GObject * object,
+    guint prop_id, const GValue * value, GParamSpec * pspec);
+static void gst_multi_select_pad_get_property (GObject * object,
+    guint prop_id, GValue * value, GParamSpec * pspec);
+
+/* GstElement vmethod declarations */
+static GstPad *gst_multi_select_request_new_pad (GstElement * element,
+    GstPadTemplate * templ, const gchar * name, const GstCaps * caps);
+static void gst_multi_select_release_pad (GstElement * element, GstPad * pad);
+static GstStateChangeReturn gst_multi_select_change_state (GstElement *
+    element, GstStateChange transition);
+
+/* GstMultiSelect method declarations */
+static GstFlowReturn gst_multi_select_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buf);
+static gboolean gst_multi_select_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event);
+static gboolean gst_multi_select_sink_query (GstPad * pad, GstObject * parent,
+    GstQuery * query);
+static void gst_multi_select_reset (GstMultiSelect * filt);
+static void gst_multi_select_finalize (GObject * object);
+static void gst_multi_select_child_proxy_init (gpointer g_iface,
+    gpointer iface_data);
+
+GST_DEBUG_CATEGORY_EXTERN (select_debug);
+#define GST_CAT_DEFAULT select_debug
+
+G_DEFINE_TYPE (GstMultiSelectPad, gst_multi_select_pad, GST_TYPE_PAD);
+G_DEFINE_TYPE_WITH_CODE (GstMultiSelect, gst_multi_select, GST_TYPE_ELEMENT,
+    G_IMPLEMENT_INTERFACE (GST_TYPE_CHILD_PROXY,
+        gst_multi_select_child_proxy_init));
+
+/************************************************************************/
+/* GstMultiSelectPad                                                    */
+/************************************************************************/
+
+static void
+gst_multi_select_pad_class_init (GstMultiSelectPadClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->set_property = gst_multi_select_pad_set_property;
+  gobject_class->get_property = gst_multi_select_pad_get_property;
+
+  g_object_class_install_property (gobject_class, PROP_OFFSET,
+      g_param_spec_int ("offset", "Buffer offset",
+          "First buffer offset to pass", 0, G_MAXINT, DEFAULT_PROP_OFFSET,
+          G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE |
+          GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_SKIP,
+      g_param_spec_int ("skip", "Buffers to skip", "Number of buffers to skip",
+          0, G_MAXINT, DEFAULT_PROP_SKIP,
+          G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE |
+          GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_FRAMERATE,
+      gst_param_spec_fraction ("framerate", "Framerate",
+          "Framerate to decimate to by buffer timestamps, overrides offset and "
+          "skip (0/1 = disabled)", 0, 1, G_MAXINT, 1,
+          DEFAULT_PROP_FRAMERATE_N, DEFAULT_PROP_FRAMERATE_D,
+          G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE |
+          GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_PHASE,
+      g_param_spec_uint64 ("phase", "Phase",
+          "Timestamp of the first output slot when decimating by framerate",
+          0, G_MAXUINT64, DEFAULT_PROP_PHASE,
+          G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE |
+          GST_PARAM_MUTABLE_PLAYING));
+}
+
+static void
+gst_multi_select_pad_init (GstMultiSelectPad * pad)
+{
+  gst_select_decimator_init (&pad->decimator);
+}
+
+static void
+gst_multi_select_pad_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstMultiSelectPad *pad = GST_MULTI_SELECT_PAD (object);
+
+  GST_OBJECT_LOCK (pad);
+  switch (prop_id) {
+    case PROP_OFFSET:
+      pad->decimator.offset = g_value_get_int (value);
+      break;
+    case PROP_SKIP:
+      pad->decimator.skip = g_value_get_int (value);
+      break;
+    case PROP_FRAMERATE:
+      pad->decimator.framerate_n = gst_value_get_fraction_numerator (value);
+      pad->decimator.framerate_d = gst_value_get_fraction_denominator (value);
+      pad->decimator.last_slot = -1;
+      break;
+    case PROP_PHASE:
+      pad->decimator.phase = g_value_get_uint64 (value);
+      pad->decimator.last_slot = -1;
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (pad);
+}
+
+static void
+gst_multi_select_pad_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstMultiSelectPad *pad = GST_MULTI_SELECT_PAD (object);
+
+  GST_OBJECT_LOCK (pad);
+  switch (prop_id) {
+    case PROP_OFFSET:
+      g_value_set_int (value, pad->decimator.offset);
+      break;
+    case PROP_SKIP:
+      g_value_set_int (value, pad->decimator.skip);
+      break;
+    case PROP_FRAMERATE:
+      gst_value_set_fraction (value, pad->decimator.framerate_n,
+          pad->decimator.framerate_d);
+      break;
+    case PROP_PHASE:
+      g_value_set_uint64 (value, pad->decimator.phase);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (pad);
+}
+
+/************************************************************************/
+/* GstMultiSelect                                                       */
+/************************************************************************/
+
+static void
+gst_multi_select_class_init (GstMultiSelectClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+
+  gobject_class->finalize = gst_multi_select_finalize;
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&gst_multi_select_sink_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&gst_multi_select_src_template));
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "Multiple output select buffer filter", "Generic",
+      "Sends each buffer to the src pads selecting it by offset or timestamp",
+      "Joshua M. Doe <oss@nvl.army.mil>");
+
+  gstelement_class->request_new_pad =
+      GST_DEBUG_FUNCPTR (gst_multi_select_request_new_pad);
+  gstelement_class->release_pad =
+      GST_DEBUG_FUNCPTR (gst_multi_select_release_pad);
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_multi_select_change_state);
+}
+
+static void
+gst_multi_select_init (GstMultiSelect * filt)
+{
+  filt->sinkpad =
+      gst_pad_new_from_static_template (&gst_multi_select_sink_template,
+      "sink");
+  gst_pad_set_chain_function (filt->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_multi_select_chain));
+  gst_pad_set_event_function (filt->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_multi_select_sink_event));
+  gst_pad_set_query_function (filt->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_multi_select_sink_query));
+  GST_PAD_SET_PROXY_CAPS (filt->sinkpad);
+  gst_element_add_pad (GST_ELEMENT (filt), filt->sinkpad);
+
+  filt->next_pad_index = 0;
+  filt->flow_combiner = gst_flow_combiner_new ();
+}
+
+static void
+gst_multi_select_finalize (GObject * object)
+{
+  GstMultiSelect *filt = GST_MULTI_SELECT (object);
+
+  gst_flow_combiner_free (filt->flow_combiner);
+
+  G_OBJECT_CLASS (gst_multi_select_parent_class)->finalize (object);
+}
+
+static GObject *
+gst_multi_select_child_proxy_get_child_by_index (GstChildProxy * child_proxy,
+    guint index)
+{
+  GstElement *element = GST_ELEMENT_CAST (child_proxy);
+  GObject *obj;
+
+  GST_OBJECT_LOCK (element);
+  obj = g_list_nth_data (element->srcpads, index);
+  if (obj)
+    gst_object_ref (obj);
+  GST_OBJECT_UNLOCK (element);
+
+  return obj;
+}
+
+static guint
+gst_multi_select_child_proxy_get_children_count (GstChildProxy * child_proxy)
+{
+  GstElement *element = GST_ELEMENT_CAST (child_proxy);
+  guint count;
+
+  GST_OBJECT_LOCK (element);
+  count = element->numsrcpads;
+  GST_OBJECT_UNLOCK (element);
+
+  return count;
+}
+
+/* so the properties of the src pads can be set as src_N::skip=... */
+static void
+gst_multi_select_child_proxy_init (gpointer g_iface, gpointer iface_data)
+{
+  GstChildProxyInterface *iface = g_iface;
+
+  iface->get_child_by_index = gst_multi_select_child_proxy_get_child_by_index;
+  iface->get_children_count = gst_multi_select_child_proxy_get_children_count;
+}
+
+static gboolean
+gst_multi_select_copy_sticky (GstPad * sinkpad, GstEvent ** event,
+    gpointer user_data)
+{
+  GstPad *pad = GST_PAD (user_data);
+
+  gst_pad_store_sticky_event (pad, *event);
+
+  return TRUE;
+}
+
+static GstPad *
+gst_multi_select_request_new_pad (GstElement * element,
+    GstPadTemplate * templ, const gchar * name, const GstCaps * caps)
+{
+  GstMultiSelect *filt = GST_MULTI_SELECT (element);
+  gchar *pad_name;
+  GstPad *pad;
+  guint index;
+
+  GST_OBJECT_LOCK (filt);
+  if (name && sscanf (name, "src_%u", &index) == 1) {
+    if (index >= filt->next_pad_index)
+      filt->next_pad_index = index + 1;
+  } else {
+    index = filt->next_pad_index++;
+  }
+  GST_OBJECT_UNLOCK (filt);
+
+  pad_name = g_strdup_printf ("src_%u", index);
+  pad = g_object_new (GST_TYPE_MULTI_SELECT_PAD, "name", pad_name,
+      "direction", templ->direction, "template", templ, NULL);
+  g_free (pad_name);
+
+  GST_PAD_SET_PROXY_CAPS (pad);
+
+  /* join a running stream with its current events, before the chain
+   * function can see the pad */
+  if (GST_STATE (element) > GST_STATE_READY ||
+      GST_STATE_PENDING (element) == GST_STATE_PAUSED)
+    gst_pad_set_active (pad, TRUE);
+  gst_pad_sticky_events_foreach (filt->sinkpad, gst_multi_select_copy_sticky,
+      pad);
+
+  if (!gst_element_add_pad (element, pad)) {
+    GST_WARNING_OBJECT (filt, "pad %s already exists", GST_PAD_NAME (pad));
+    gst_pad_set_active (pad, FALSE);
+    gst_object_unref (pad);
+    return NULL;
+  }
+
+  GST_OBJECT_LOCK (filt);
+  gst_flow_combiner_add_pad (filt->flow_combiner, pad);
+  GST_OBJECT_UNLOCK (filt);
+
+  gst_child_proxy_child_added (GST_CHILD_PROXY (element), G_OBJECT (pad),
+      GST_OBJECT_NAME (pad));
+
+  return pad;
+}
+
+static void
+gst_multi_select_release_pad (GstElement * element, GstPad * pad)
+{
+  GstMultiSelect *filt = GST_MULTI_SELECT (element);
+
+  GST_OBJECT_LOCK (filt);
+  gst_flow_combiner_remove_pad (filt->flow_combiner, pad);
+  GST_OBJECT_UNLOCK (filt);
+
+  gst_child_proxy_child_removed (GST_CHILD_PROXY (element), G_OBJECT (pad),
+      GST_OBJECT_NAME (pad));
+
+  gst_pad_set_active (pad, FALSE);
+  gst_element_remove_pad (element, pad);
+}
+
+static GstStateChangeReturn
+gst_multi_select_change_state (GstElement * element, GstStateChange transition)
+{
+  GstMultiSelect *filt = GST_MULTI_SELECT (element);
+
+  if (transition == GST_STATE_CHANGE_READY_TO_PAUSED)
+    gst_multi_select_reset (filt);
+
+  return GST_ELEMENT_CLASS (gst_multi_select_parent_class)->change_state
+      (element, transition);
+}
+
+static GstFlowReturn
+gst_multi_select_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  GstMultiSelect *filt = GST_MULTI_SELECT (parent);
+  GstFlowReturn ret;
+  GstFlowReturn *pad_rets;
+  GstPad **pads;
+  GList *l;
+  guint i, n_pads = 0;
+
+  /* decide for every pad first, then push without holding any lock */
+  GST_OBJECT_LOCK (filt);
+  pads = g_newa (GstPad *, GST_ELEMENT (filt)->numsrcpads);
+  for (l = GST_ELEMENT (filt)->srcpads; l != NULL; l = l->next) {
+    GstMultiSelectPad *srcpad = GST_MULTI_SELECT_PAD (l->data);
+    gboolean pass;
+
+    GST_OBJECT_LOCK (srcpad);
+    pass = gst_select_decimator_pass (&srcpad->decimator,
+        GST_OBJECT (srcpad), buf);
+    GST_OBJECT_UNLOCK (srcpad);
+
+    if (pass)
+      pads[n_pads++] = gst_object_ref (srcpad);
+  }
+  GST_OBJECT_UNLOCK (filt);
+
+  pad_rets = g_newa (GstFlowReturn, n_pads);
+  for (i = 0; i < n_pads; i++)
+    pad_rets[i] = gst_pad_push (pads[i], gst_buffer_ref (buf));
+  gst_buffer_unref (buf);
+
+  /* an unlinked or finished branch doesn't stop the others, but upstream
+   * sees not-linked or EOS once every branch is, including the branches
+   * that didn't select this buffer */
+  GST_OBJECT_LOCK (filt);
+  if (n_pads == 0)
+    ret = gst_flow_combiner_update_flow (filt->flow_combiner, GST_FLOW_OK);
+  for (i = 0; i < n_pads; i++) {
+    ret = gst_flow_combiner_update_pad_flow (filt->flow_combiner, pads[i],
+        pad_rets[i]);
+    gst_object_unref (pads[i]);
+  }
+  GST_OBJECT_UNLOCK (filt);
+
+  return ret;
+}
+
+static gboolean
+gst_multi_select_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GstMultiSelect *filt = GST_MULTI_SELECT (parent);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP)
+    gst_multi_select_reset (filt);
+
+  /* forwarded to every src pad */
+  return gst_pad_event_default (pad, parent, event);
+}
+
+static gboolean
+gst_multi_select_sink_query (GstPad * pad, GstObject * parent,
+    GstQuery * query)
+{
+  /* buffers are shared by all branches, so none of them gets to pick the
+   * allocator */
+  if (GST_QUERY_TYPE (query) == GST_QUERY_ALLOCATION)
+    return FALSE;
+
+  return gst_pad_query_default (pad, parent, query);
+}
+
+static void
+gst_multi_select_reset (GstMultiSelect * filt)
+{
+  GList *l;
+
+  GST_OBJECT_LOCK (filt);
+  for (l = GST_ELEMENT (filt)->srcpads; l != NULL; l = l->next) {
+    GstMultiSelectPad *srcpad = GST_MULTI_SELECT_PAD (l->data);
+
+    GST_OBJECT_LOCK (srcpad);
+    gst_select_decimator_reset (&srcpad->decimator);
+    GST_OBJECT_UNLOCK (srcpad);
+  }
+  gst_flow_combiner_reset (filt->flow_combiner);
+  GST_OBJECT_UNLOCK (filt);
+}
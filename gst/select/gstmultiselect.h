@@ -0,0 +1,99 @@
+/* GStreamer
+ * Copyright (C) 2026 gst-plugins-vision authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_MULTI_SELECT_H__
+#define __GST_MULTI_SELECT_H__
+
+#include <gst/gst.h>
+#include <gst/base/gstflowcombiner.h>
+
+#include "gstselectdecimator.h"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_MULTI_SELECT_PAD \
+  (gst_multi_select_pad_get_type())
+#define GST_MULTI_SELECT_PAD(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_MULTI_SELECT_PAD,GstMultiSelectPad))
+#define GST_IS_MULTI_SELECT_PAD(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_MULTI_SELECT_PAD))
+
+#define GST_TYPE_MULTI_SELECT \
+  (gst_multi_select_get_type())
+#define GST_MULTI_SELECT(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_MULTI_SELECT,GstMultiSelect))
+#define GST_MULTI_SELECT_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_MULTI_SELECT,GstMultiSelectClass))
+#define GST_IS_MULTI_SELECT(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_MULTI_SELECT))
+#define GST_IS_MULTI_SELECT_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_MULTI_SELECT))
+
+typedef struct _GstMultiSelectPad GstMultiSelectPad;
+typedef struct _GstMultiSelectPadClass GstMultiSelectPadClass;
+typedef struct _GstMultiSelect GstMultiSelect;
+typedef struct _GstMultiSelectClass GstMultiSelectClass;
+
+/**
+* GstMultiSelectPad:
+*
+* A src pad of multiselect, with the decimation of its branch. The settings
+* are protected by the object lock of the pad.
+*/
+struct _GstMultiSelectPad
+{
+  GstPad pad;
+
+  GstSelectDecimator decimator;
+};
+
+struct _GstMultiSelectPadClass
+{
+  GstPadClass parent_class;
+};
+
+/**
+* GstMultiSelect:
+* @element: the parent element.
+*
+*
+* The opaque GstMultiSelect data structure.
+*/
+struct _GstMultiSelect
+{
+  GstElement element;
+
+  GstPad *sinkpad;
+  guint next_pad_index;
+
+  /* last flow of every src pad, protected by the object lock */
+  GstFlowCombiner *flow_combiner;
+};
+
+struct _GstMultiSelectClass
+{
+  GstElementClass parent_class;
+};
+
+GType gst_multi_select_pad_get_type(void);
+GType gst_multi_select_get_type(void);
+
+G_END_DECLS
+
+#endif /* __GST_MULTI_SELECT_H__ */
@@ -24,12 +24,26 @@
 /**
 * SECTION:element-select
 *
-* Selects buffers from offset and skip.
+* Selects buffers from offset and skip, or decimates them to a framerate by
+* their timestamps.
+*
+* Buffers without an offset are counted by the element. When framerate is
+* set, output slots start at phase and follow every 1/framerate, and the
+* first buffer of each slot is passed. Timestamps or offsets going back are
+* taken as the source restarting, which resends the upstream hint.
+*
+* Decimating after capture wastes the acquisition of the dropped frames, so
+* upstream-hint can forward the decimation to sources able to capture less:
+* as a custom upstream event named GstSelectDecimation with framerate,
+* phase, offset and skip fields, or by preferring caps at the target
+* framerate. pylonsrc applies the event framerate as its fps, and gentlsrc
+* writes it to its frame-rate-address register.
 *
 * <refsect2>
 * <title>Example launch line</title>
 * |[
 * gst-launch videotestsrc ! select ! autovideosink
+* gst-launch videotestsrc ! select framerate=5/1 upstream-hint=caps ! autovideosink
 * ]|
 * </refsect2>
 */
@@ -39,17 +53,39 @@
 #endif
 
 #include "gstselect.h"
+#include "gstmultiselect.h"
 
 enum
 {
   PROP_0,
   PROP_OFFSET,
   PROP_SKIP,
+  PROP_FRAMERATE,
+  PROP_PHASE,
+  PROP_UPSTREAM_HINT,
   PROP_LAST
 };
 
-#define DEFAULT_PROP_OFFSET 0
-#define DEFAULT_PROP_SKIP 0
+#define DEFAULT_PROP_UPSTREAM_HINT GST_SELECT_UPSTREAM_HINT_NONE
+
+#define GST_TYPE_SELECT_UPSTREAM_HINT (gst_select_upstream_hint_get_type())
+static GType
+gst_select_upstream_hint_get_type (void)
+{
+  static GType select_upstream_hint_type = 0;
+  static const GEnumValue select_upstream_hint[] = {
+    {GST_SELECT_UPSTREAM_HINT_NONE, "none", "none"},
+    {GST_SELECT_UPSTREAM_HINT_EVENT, "event", "event"},
+    {GST_SELECT_UPSTREAM_HINT_CAPS, "caps", "caps"},
+    {0, NULL, NULL},
+  };
+
+  if (!select_upstream_hint_type) {
+    select_upstream_hint_type =
+        g_enum_register_static ("GstSelectUpstreamHint", select_upstream_hint);
+  }
+  return select_upstream_hint_type;
+}
 
 /* the capabilities of the inputs and outputs */
 static GstStaticPadTemplate gst_select_sink_template =
@@ -75,6 +111,9 @@ static void gst_select_get_property (GObject * object, guint prop_id,
 static void gst_select_dispose (GObject * object);
 
 /* GstBaseTransform vmethod declarations */
+static GstCaps *gst_select_transform_caps (GstBaseTransform * trans,
+    GstPadDirection direction, GstCaps * caps, GstCaps * filter);
+static gboolean gst_select_start (GstBaseTransform * trans);
 static GstFlowReturn gst_select_transform_ip (GstBaseTransform * trans,
     GstBuffer * buf);
 
@@ -82,7 +121,7 @@ static GstFlowReturn gst_select_transform_ip (GstBaseTransform * trans,
 static void gst_select_reset (GstSelect * filter);
 
 /* setup debug */
-GST_DEBUG_CATEGORY_STATIC (select_debug);
+GST_DEBUG_CATEGORY (select_debug);
 #define GST_CAT_DEFAULT select_debug
 
 G_DEFINE_TYPE (GstSelect, gst_select, GST_TYPE_BASE_TRANSFORM);
@@ -142,6 +181,26 @@ gst_select_class_init (GstSelectClass * klass)
           0, G_MAXINT, DEFAULT_PROP_OFFSET,
           G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE |
           GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_FRAMERATE,
+      gst_param_spec_fraction ("framerate", "Framerate",
+          "Framerate to decimate to by buffer timestamps, overrides offset and "
+          "skip (0/1 = disabled)", 0, 1, G_MAXINT, 1,
+          DEFAULT_PROP_FRAMERATE_N, DEFAULT_PROP_FRAMERATE_D,
+          G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE |
+          GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_PHASE,
+      g_param_spec_uint64 ("phase", "Phase",
+          "Timestamp of the first output slot when decimating by framerate",
+          0, G_MAXUINT64, DEFAULT_PROP_PHASE,
+          G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE |
+          GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_UPSTREAM_HINT,
+      g_param_spec_enum ("upstream-hint", "Upstream hint",
+          "How to tell upstream about the decimation, so sources can capture "
+          "fewer frames", GST_TYPE_SELECT_UPSTREAM_HINT,
+          DEFAULT_PROP_UPSTREAM_HINT,
+          G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE |
+          GST_PARAM_MUTABLE_PLAYING));
 
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&gst_select_sink_template));
@@ -150,10 +209,13 @@ gst_select_class_init (GstSelectClass * klass)
 
   gst_element_class_set_static_metadata (gstelement_class,
       "Select buffer filter", "Filter/Effect",
-      "Selects buffers based on buffer offset",
+      "Selects buffers based on buffer offset or timestamp",
       "Joshua M. Doe <oss@nvl.army.mil>");
 
   /* Register GstBaseTransform vmethods */
+  gstbasetransform_class->transform_caps =
+      GST_DEBUG_FUNCPTR (gst_select_transform_caps);
+  gstbasetransform_class->start = GST_DEBUG_FUNCPTR (gst_select_start);
   gstbasetransform_class->transform_ip =
       GST_DEBUG_FUNCPTR (gst_select_transform_ip);
 }
@@ -163,8 +225,8 @@ gst_select_init (GstSelect * trans)
 {
   GST_DEBUG_OBJECT (trans, "init class instance");
 
-  trans->offset = DEFAULT_PROP_OFFSET;
-  trans->skip = DEFAULT_PROP_SKIP;
+  gst_select_decimator_init (&trans->decimator);
+  trans->upstream_hint = DEFAULT_PROP_UPSTREAM_HINT;
 
   gst_base_transform_set_in_place (GST_BASE_TRANSFORM (trans), TRUE);
 
@@ -176,20 +238,44 @@ gst_select_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
 {
   GstSelect *filt = GST_SELECT (object);
+  gboolean reconfigure;
 
   GST_DEBUG_OBJECT (filt, "setting property %s", pspec->name);
 
+  GST_OBJECT_LOCK (filt);
   switch (prop_id) {
     case PROP_OFFSET:
-      filt->offset = g_value_get_int (value);
+      filt->decimator.offset = g_value_get_int (value);
       break;
     case PROP_SKIP:
-      filt->skip = g_value_get_int (value);
+      filt->decimator.skip = g_value_get_int (value);
+      break;
+    case PROP_FRAMERATE:
+      filt->decimator.framerate_n = gst_value_get_fraction_numerator (value);
+      filt->decimator.framerate_d =
+          gst_value_get_fraction_denominator (value);
+      filt->decimator.last_slot = -1;
+      break;
+    case PROP_PHASE:
+      filt->decimator.phase = g_value_get_uint64 (value);
+      filt->decimator.last_slot = -1;
+      break;
+    case PROP_UPSTREAM_HINT:
+      filt->upstream_hint = g_value_get_enum (value);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
+  filt->hint_pending = TRUE;
+  reconfigure = filt->upstream_hint == GST_SELECT_UPSTREAM_HINT_CAPS &&
+      (prop_id == PROP_FRAMERATE || prop_id == PROP_UPSTREAM_HINT);
+  GST_OBJECT_UNLOCK (filt);
+
+  /* let upstream renegotiate to the new preferred framerate */
+  if (reconfigure)
+    gst_pad_push_event (GST_BASE_TRANSFORM_SINK_PAD (filt),
+        gst_event_new_reconfigure ());
 }
 
 static void
@@ -202,10 +288,20 @@ gst_select_get_property (GObject * object, guint prop_id, GValue * value,
 
   switch (prop_id) {
     case PROP_OFFSET:
-      g_value_set_int (value, filt->offset);
+      g_value_set_int (value, filt->decimator.offset);
       break;
     case PROP_SKIP:
-      g_value_set_int (value, filt->skip);
+      g_value_set_int (value, filt->decimator.skip);
+      break;
+    case PROP_FRAMERATE:
+      gst_value_set_fraction (value, filt->decimator.framerate_n,
+          filt->decimator.framerate_d);
+      break;
+    case PROP_PHASE:
+      g_value_set_uint64 (value, filt->decimator.phase);
+      break;
+    case PROP_UPSTREAM_HINT:
+      g_value_set_enum (value, filt->upstream_hint);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -213,32 +309,119 @@ gst_select_get_property (GObject * object, guint prop_id, GValue * value,
   }
 }
 
+/* Prefers the target framerate upstream, while still accepting any
+ * framerate from sources that can't change theirs. */
+static GstCaps *
+gst_select_transform_caps (GstBaseTransform * trans,
+    GstPadDirection direction, GstCaps * caps, GstCaps * filter)
+{
+  GstSelect *filt = GST_SELECT (trans);
+  GstCaps *ret, *preferred, *target;
+  gint framerate_n, framerate_d;
+  gboolean hint;
+  guint i;
+
+  GST_OBJECT_LOCK (filt);
+  framerate_n = filt->decimator.framerate_n;
+  framerate_d = filt->decimator.framerate_d;
+  hint = filt->upstream_hint == GST_SELECT_UPSTREAM_HINT_CAPS &&
+      framerate_n > 0;
+  GST_OBJECT_UNLOCK (filt);
+
+  /* prefer the target framerate where downstream allows it, followed by
+   * the caps downstream asked for */
+  if (direction == GST_PAD_SRC && hint && !gst_caps_is_any (caps)) {
+    target = gst_caps_copy (caps);
+    for (i = 0; i < gst_caps_get_size (target); i++)
+      gst_structure_set (gst_caps_get_structure (target, i), "framerate",
+          GST_TYPE_FRACTION, framerate_n, framerate_d, NULL);
+    preferred = gst_caps_intersect (caps, target);
+    gst_caps_unref (target);
+    ret = gst_caps_merge (preferred, gst_caps_ref (caps));
+  } else {
+    ret = gst_caps_ref (caps);
+  }
+
+  if (filter) {
+    GstCaps *intersection;
+
+    intersection =
+        gst_caps_intersect_full (filter, ret, GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref (ret);
+    ret = intersection;
+  }
+
+  GST_DEBUG_OBJECT (filt, "transformed %" GST_PTR_FORMAT " into %"
+      GST_PTR_FORMAT, caps, ret);
+
+  return ret;
+}
+
+static gboolean
+gst_select_start (GstBaseTransform * trans)
+{
+  GstSelect *filt = GST_SELECT (trans);
+
+  GST_OBJECT_LOCK (filt);
+  gst_select_reset (filt);
+  GST_OBJECT_UNLOCK (filt);
+
+  return TRUE;
+}
+
+static void
+gst_select_send_hint (GstSelect * filt)
+{
+  GstStructure *s;
+
+  GST_OBJECT_LOCK (filt);
+  filt->hint_pending = FALSE;
+  if (filt->upstream_hint != GST_SELECT_UPSTREAM_HINT_EVENT) {
+    GST_OBJECT_UNLOCK (filt);
+    return;
+  }
+  s = gst_structure_new ("GstSelectDecimation",
+      "framerate", GST_TYPE_FRACTION, filt->decimator.framerate_n,
+      filt->decimator.framerate_d,
+      "phase", G_TYPE_UINT64, filt->decimator.phase,
+      "offset", G_TYPE_INT, filt->decimator.offset,
+      "skip", G_TYPE_INT, filt->decimator.skip, NULL);
+  GST_OBJECT_UNLOCK (filt);
+
+  GST_DEBUG_OBJECT (filt, "Sending decimation hint upstream: %" GST_PTR_FORMAT,
+      s);
+  if (!gst_pad_push_event (GST_BASE_TRANSFORM_SINK_PAD (filt),
+          gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM, s)))
+    GST_DEBUG_OBJECT (filt, "Decimation hint not handled upstream");
+}
+
 static GstFlowReturn
 gst_select_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
 {
   GstSelect *filt = GST_SELECT (trans);
-  guint64 buf_offset = GST_BUFFER_OFFSET (buf);
+  gboolean pass;
 
-  if (buf_offset < filt->offset) {
-    GST_LOG_OBJECT (filt,
-        "Dropping buffer %d since it's before the chosen offset %d",
-        buf_offset, filt->offset);
-    return GST_BASE_TRANSFORM_FLOW_DROPPED;
-  }
+  if (filt->hint_pending)
+    gst_select_send_hint (filt);
 
-  if ((filt->offset - buf_offset) % (filt->skip + 1)) {
-    GST_LOG_OBJECT (filt,
-        "Dropping buffer %d since it's been chosen to be skipped", buf_offset);
-    return GST_BASE_TRANSFORM_FLOW_DROPPED;
+  GST_OBJECT_LOCK (filt);
+  pass = gst_select_decimator_pass (&filt->decimator, GST_OBJECT (filt), buf);
+  /* a restarted source may have lost the rate it was hinted */
+  if (filt->decimator.restarted) {
+    filt->decimator.restarted = FALSE;
+    filt->hint_pending = TRUE;
   }
+  GST_OBJECT_UNLOCK (filt);
 
-  return GST_FLOW_OK;
+  return pass ? GST_FLOW_OK : GST_BASE_TRANSFORM_FLOW_DROPPED;
 }
 
 
 static void
 gst_select_reset (GstSelect * filt)
 {
+  gst_select_decimator_reset (&filt->decimator);
+  filt->hint_pending = TRUE;
 }
 
 static gboolean
@@ -254,6 +437,11 @@ plugin_init (GstPlugin * plugin)
     return FALSE;
   }
 
+  if (!gst_element_register (plugin, "multiselect", GST_RANK_NONE,
+          GST_TYPE_MULTI_SELECT)) {
+    return FALSE;
+  }
+
   return TRUE;
 }
 
@@ -27,6 +27,8 @@
 
 #include <gst/base/gstbasetransform.h>
 
+#include "gstselectdecimator.h"
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_SELECT \
@@ -40,6 +42,13 @@ G_BEGIN_DECLS
 #define GST_IS_SELECT_CLASS(klass) \
   (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_SELECT))
 
+typedef enum
+{
+  GST_SELECT_UPSTREAM_HINT_NONE,
+  GST_SELECT_UPSTREAM_HINT_EVENT,
+  GST_SELECT_UPSTREAM_HINT_CAPS
+} GstSelectUpstreamHint;
+
 typedef struct _GstSelect GstSelect;
 typedef struct _GstSelectClass GstSelectClass;
 
@@ -54,9 +63,11 @@ struct _GstSelect
 {
   GstBaseTransform element;
 
-  /* properties */
-  gint offset;
-  gint skip;
+  /* properties, decimation settings are in decimator */
+  GstSelectDecimator decimator;
+  GstSelectUpstreamHint upstream_hint;
+
+  gboolean hint_pending;
 };
 
 struct _GstSelectClass
@@ -0,0 +1,137 @@
+/* GStreamer
+ * Copyright (C) 2026 gst-plugins-vision authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstselectdecimator.h"
+
+GST_DEBUG_CATEGORY_EXTERN (select_debug);
+#define GST_CAT_DEFAULT select_debug
+
+void
+gst_select_decimator_init (GstSelectDecimator * dec)
+{
+  dec->offset = DEFAULT_PROP_OFFSET;
+  dec->skip = DEFAULT_PROP_SKIP;
+  dec->framerate_n = DEFAULT_PROP_FRAMERATE_N;
+  dec->framerate_d = DEFAULT_PROP_FRAMERATE_D;
+  dec->phase = DEFAULT_PROP_PHASE;
+
+  gst_select_decimator_reset (dec);
+}
+
+void
+gst_select_decimator_reset (GstSelectDecimator * dec)
+{
+  dec->count = 0;
+  dec->prev_offset = 0;
+  dec->prev_pts = GST_CLOCK_TIME_NONE;
+  dec->last_slot = -1;
+  dec->restarted = FALSE;
+}
+
+static gboolean
+gst_select_decimator_by_offset (GstSelectDecimator * dec, GstObject * obj,
+    guint64 buf_offset)
+{
+  if (buf_offset < dec->offset) {
+    GST_LOG_OBJECT (obj,
+        "Dropping buffer %" G_GUINT64_FORMAT
+        " since it's before the chosen offset %d", buf_offset, dec->offset);
+    return FALSE;
+  }
+
+  if ((buf_offset - dec->offset) % ((guint64) dec->skip + 1)) {
+    GST_LOG_OBJECT (obj,
+        "Dropping buffer %" G_GUINT64_FORMAT
+        " since it's been chosen to be skipped", buf_offset);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gst_select_decimator_by_pts (GstSelectDecimator * dec, GstObject * obj,
+    GstClockTime pts)
+{
+  GstClockTime period, tolerance = 0;
+  gint64 slot;
+
+  period = gst_util_uint64_scale_int (GST_SECOND, dec->framerate_d,
+      dec->framerate_n);
+
+  if (GST_CLOCK_TIME_IS_VALID (dec->prev_pts)) {
+    if (pts < dec->prev_pts) {
+      GST_DEBUG_OBJECT (obj, "Timestamps went back to %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (pts));
+      dec->last_slot = -1;
+      dec->restarted = TRUE;
+    } else {
+      /* so the buffer nearest to the start of a slot is passed even when it
+       * is a little early */
+      tolerance = MIN ((pts - dec->prev_pts) / 2, period / 2);
+    }
+  }
+  dec->prev_pts = pts;
+
+  if (period == 0 || pts + tolerance < dec->phase) {
+    GST_LOG_OBJECT (obj, "Dropping buffer %" GST_TIME_FORMAT
+        " since it's before the chosen phase", GST_TIME_ARGS (pts));
+    return FALSE;
+  }
+
+  slot = (pts + tolerance - dec->phase) / period;
+  if (slot <= dec->last_slot) {
+    GST_LOG_OBJECT (obj, "Dropping buffer %" GST_TIME_FORMAT
+        " since slot %" G_GINT64_FORMAT " was already output",
+        GST_TIME_ARGS (pts), slot);
+    return FALSE;
+  }
+  dec->last_slot = slot;
+
+  return TRUE;
+}
+
+/* Callers hold whatever lock protects the settings of @dec. */
+gboolean
+gst_select_decimator_pass (GstSelectDecimator * dec, GstObject * obj,
+    GstBuffer * buf)
+{
+  guint64 buf_offset = GST_BUFFER_OFFSET (buf);
+  GstClockTime pts = GST_BUFFER_PTS (buf);
+
+  /* not every source numbers its buffers */
+  if (buf_offset == GST_BUFFER_OFFSET_NONE)
+    buf_offset = dec->count;
+  else if (dec->count > 0 && buf_offset < dec->prev_offset) {
+    GST_DEBUG_OBJECT (obj, "Buffer offsets restarted at %" G_GUINT64_FORMAT,
+        buf_offset);
+    dec->restarted = TRUE;
+  }
+  dec->prev_offset = buf_offset;
+  dec->count++;
+
+  if (dec->framerate_n > 0 && GST_CLOCK_TIME_IS_VALID (pts))
+    return gst_select_decimator_by_pts (dec, obj, pts);
+  else
+    return gst_select_decimator_by_offset (dec, obj, buf_offset);
+}
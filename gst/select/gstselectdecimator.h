@@ -0,0 +1,61 @@
+/* GStreamer
+ * Copyright (C) 2026 gst-plugins-vision authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_SELECT_DECIMATOR_H__
+#define __GST_SELECT_DECIMATOR_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define DEFAULT_PROP_OFFSET 0
+#define DEFAULT_PROP_SKIP 0
+#define DEFAULT_PROP_FRAMERATE_N 0
+#define DEFAULT_PROP_FRAMERATE_D 1
+#define DEFAULT_PROP_PHASE 0
+
+/* Decides which buffers of a stream to pass, by offset and skip or by
+ * timestamp and framerate, for select and each src pad of multiselect. */
+typedef struct
+{
+  /* settings */
+  gint offset;
+  gint skip;
+  gint framerate_n;
+  gint framerate_d;
+  GstClockTime phase;
+
+  /* buffers seen, stands in for unset buffer offsets */
+  guint64 count;
+  guint64 prev_offset;
+  GstClockTime prev_pts;
+  /* output slot of the last buffer passed by framerate, -1 if none */
+  gint64 last_slot;
+  /* set when offsets or timestamps went back, cleared by the caller */
+  gboolean restarted;
+} GstSelectDecimator;
+
+void     gst_select_decimator_init (GstSelectDecimator * dec);
+void     gst_select_decimator_reset (GstSelectDecimator * dec);
+gboolean gst_select_decimator_pass (GstSelectDecimator * dec, GstObject * obj,
+    GstBuffer * buf);
+
+G_END_DECLS
+
+#endif /* __GST_SELECT_DECIMATOR_H__ */
@@ -45,16 +45,22 @@
 #  include <config.h>
 #endif
 
+#include <stdio.h>
+#include <string.h>
+
 #include <gst/gst.h>
 #include <gst/video/video.h>
+#include <glib/gstdio.h>
+#ifdef G_OS_WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
-#include "gstopencvutils.h"
 #include "gstsensorfx3dnoise.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_sfx3dnoise_debug);
 #define GST_CAT_DEFAULT gst_sfx3dnoise_debug
-#define DEBUG_INIT(bla) \
-  GST_DEBUG_CATEGORY_INIT (gst_sfx3dnoise_debug, "sfx3dnoise", 0, "ARF 3D-noise sensor effects");
 
 /* Filter signals and args */
 enum
@@ -71,7 +77,9 @@ enum
   PROP_SIGMA_TV,
   PROP_SIGMA_TH,
   PROP_SIGMA_VH,
-  PROP_SIGMA_TVH
+  PROP_SIGMA_TVH,
+  PROP_NOISE_BANK_FRAMES,
+  PROP_NOISE_BANK_LOCATION
 };
 
 #define DEFAULT_SIGMA_T 0.0
@@ -81,31 +89,52 @@ enum
 #define DEFAULT_SIGMA_TH 0.0
 #define DEFAULT_SIGMA_VH 0.0
 #define DEFAULT_SIGMA_TVH 0.0
-
-GST_BOILERPLATE_FULL (GstSfx3DNoise, gst_sfx3dnoise, GstOpencvBaseTransform,
-    GST_TYPE_OPENCV_BASE_TRANSFORM, DEBUG_INIT);
+#define DEFAULT_NOISE_BANK_FRAMES 0
+#define DEFAULT_NOISE_BANK_LOCATION NULL
+
+/* header of a noise bank file: the magic, then a byte order mark and 1.0 as
+ * a native guint32 and float, then the frame size and count as little endian
+ * guint32, followed by the samples as native floats */
+#define NOISE_BANK_MAGIC "SFX3DNB2"
+#define NOISE_BANK_BYTE_ORDER_MARK 0x01020304
+#define NOISE_BANK_HEADER_SIZE 28
+
+/* sigmas are given as a fraction of the 16-bit range */
+#define SIGMA_SCALE (G_MAXUINT16 - 1)
+
+/* the capabilities of the inputs and outputs */
+static GstStaticPadTemplate gst_sfx3dnoise_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("GRAY16_LE"))
+    );
+
+static GstStaticPadTemplate gst_sfx3dnoise_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("GRAY16_LE"))
+    );
+
+G_DEFINE_TYPE (GstSfx3DNoise, gst_sfx3dnoise, GST_TYPE_VIDEO_FILTER);
 
 static void gst_sfx3dnoise_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_sfx3dnoise_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 
-static GstFlowReturn gst_sfx3dnoise_cv_transform (GstOpencvBaseTransform *
-    filter, GstBuffer * buf, IplImage * img, GstBuffer * outbuf,
-    IplImage * outimg);
-static gboolean gst_sfx3dnoise_cv_set_caps (GstOpencvBaseTransform * trans,
-    gint in_width, gint in_height, gint in_depth, gint in_channels,
-    gint out_width, gint out_height, gint out_depth, gint out_channels);
-
-void gst_sfx3dnoise_create_fixed_noise (GstSfx3DNoise * filter, CvMat * arr);
-void gst_sfx3dnoise_add_sigma_t (GstSfx3DNoise * filter, CvMat * arr,
-    double sigma);
-void gst_sfx3dnoise_add_sigma_tv (GstSfx3DNoise * filter, CvMat * arr,
-    double sigma);
-void gst_sfx3dnoise_add_sigma_th (GstSfx3DNoise * filter, CvMat * arr,
-    double sigma);
-void gst_sfx3dnoise_add_sigma_tvh (GstSfx3DNoise * filter, CvMat * arr,
-    double sigma);
+static GstFlowReturn gst_sfx3dnoise_transform_frame_ip (GstVideoFilter *
+    vfilter, GstVideoFrame * frame);
+static gboolean gst_sfx3dnoise_set_info (GstVideoFilter * vfilter,
+    GstCaps * incaps, GstVideoInfo * in_info, GstCaps * outcaps,
+    GstVideoInfo * out_info);
+
+static void gst_sfx3dnoise_create_fixed_noise (GstSfx3DNoise * filter,
+    gdouble sigma_v, gdouble sigma_h, gdouble sigma_vh);
+static gboolean gst_sfx3dnoise_create_noise_bank (GstSfx3DNoise * filter,
+    guint frames, const gchar * location);
+static void gst_sfx3dnoise_free_noise_bank (GstSfx3DNoise * filter);
 
 /* Clean up */
 static void
@@ -113,61 +142,56 @@ gst_sfx3dnoise_finalize (GObject * obj)
 {
   GstSfx3DNoise *filter = GST_SFX3DNOISE (obj);
 
-  if (filter->fixed_noise)
-    cvReleaseMat (&filter->fixed_noise);
+  g_free (filter->fixed_noise);
   filter->fixed_noise = NULL;
 
-  if (filter->intermediary)
-    cvReleaseMat (&filter->intermediary);
-  filter->intermediary = NULL;
+  g_free (filter->row_noise);
+  filter->row_noise = NULL;
+  g_free (filter->tv_noise);
+  filter->tv_noise = NULL;
+  g_free (filter->th_noise);
+  filter->th_noise = NULL;
+
+  gst_sfx3dnoise_free_noise_bank (filter);
+  g_free (filter->noise_bank_location);
+  filter->noise_bank_location = NULL;
 
-  G_OBJECT_CLASS (parent_class)->finalize (obj);
+  G_OBJECT_CLASS (gst_sfx3dnoise_parent_class)->finalize (obj);
 }
 
 /* GObject vmethod implementations */
 
-static void
-gst_sfx3dnoise_base_init (gpointer gclass)
-{
-  GstElementClass *element_class = GST_ELEMENT_CLASS (gclass);
-  GstCaps *caps;
-  GstPadTemplate *templ;
-
-  /* add sink and source pad templates */
-  caps = gst_caps_from_string (GST_VIDEO_CAPS_GRAY16 ("1234"));
-  templ = gst_pad_template_new ("sink", GST_PAD_SINK, GST_PAD_ALWAYS,
-      gst_caps_ref (caps));
-  gst_element_class_add_pad_template (element_class, templ);
-  templ = gst_pad_template_new ("src", GST_PAD_SRC, GST_PAD_ALWAYS, caps);
-  gst_element_class_add_pad_template (element_class, templ);
-
-  gst_element_class_set_details_simple (element_class,
-      "sfx3dnoise",
-      "Transform/Effect/Video",
-      "Add 3D noise to video", "Joshua M. Doe <oss@nvl.army.mil>");
-}
-
 static void
 gst_sfx3dnoise_class_init (GstSfx3DNoiseClass * klass)
 {
   GObjectClass *gobject_class;
-  GstBaseTransformClass *gstbasetransform_class;
-  GstOpencvBaseTransformClass *gstopencvbasefilter_class;
   GstElementClass *gstelement_class;
+  GstVideoFilterClass *gstvideofilter_class;
 
   gobject_class = (GObjectClass *) klass;
   gstelement_class = (GstElementClass *) klass;
-  gstbasetransform_class = (GstBaseTransformClass *) klass;
-  gstopencvbasefilter_class = (GstOpencvBaseTransformClass *) klass;
+  gstvideofilter_class = (GstVideoFilterClass *) klass;
 
-  parent_class = g_type_class_peek_parent (klass);
+  GST_DEBUG_CATEGORY_INIT (gst_sfx3dnoise_debug, "sfx3dnoise", 0,
+      "ARF 3D-noise sensor effects");
 
   gobject_class->finalize = GST_DEBUG_FUNCPTR (gst_sfx3dnoise_finalize);
   gobject_class->set_property = gst_sfx3dnoise_set_property;
   gobject_class->get_property = gst_sfx3dnoise_get_property;
 
-  gstopencvbasefilter_class->cv_trans_func = gst_sfx3dnoise_cv_transform;
-  gstopencvbasefilter_class->cv_set_caps = gst_sfx3dnoise_cv_set_caps;
+  gstvideofilter_class->set_info = GST_DEBUG_FUNCPTR (gst_sfx3dnoise_set_info);
+  gstvideofilter_class->transform_frame_ip =
+      GST_DEBUG_FUNCPTR (gst_sfx3dnoise_transform_frame_ip);
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&gst_sfx3dnoise_sink_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&gst_sfx3dnoise_src_template));
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "sfx3dnoise",
+      "Transform/Effect/Video",
+      "Add 3D noise to video", "Joshua M. Doe <oss@nvl.army.mil>");
 
   g_object_class_install_property (gobject_class, PROP_SIGMA_T,
       g_param_spec_double ("sigma-t", "sigma-t",
@@ -210,10 +234,27 @@ gst_sfx3dnoise_class_init (GstSfx3DNoiseClass * klass)
           "Adds random spatio-temporal noise",
           0.0, 1.0, DEFAULT_SIGMA_T, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)
       );
+
+  g_object_class_install_property (gobject_class, PROP_NOISE_BANK_FRAMES,
+      g_param_spec_uint ("noise-bank-frames", "noise-bank-frames",
+          "Frames of spatio-temporal noise generated once when caps are set, "
+          "one of them randomly picked and rotated each frame "
+          "(0 = generate every frame)",
+          0, G_MAXINT, DEFAULT_NOISE_BANK_FRAMES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)
+      );
+
+  g_object_class_install_property (gobject_class, PROP_NOISE_BANK_LOCATION,
+      g_param_spec_string ("noise-bank-location", "noise-bank-location",
+          "File the noise bank is memory mapped from, written first if it "
+          "doesn't match the frame size and noise-bank-frames",
+          DEFAULT_NOISE_BANK_LOCATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)
+      );
 }
 
 static void
-gst_sfx3dnoise_init (GstSfx3DNoise * filter, GstSfx3DNoiseClass * gclass)
+gst_sfx3dnoise_init (GstSfx3DNoise * filter)
 {
   GST_DEBUG ("Initializing");
 
@@ -225,9 +266,17 @@ gst_sfx3dnoise_init (GstSfx3DNoise * filter, GstSfx3DNoiseClass * gclass)
   filter->sigma_vh = filter->sigma_vh_old = DEFAULT_SIGMA_VH;
   filter->sigma_tvh = DEFAULT_SIGMA_TVH;
 
-  filter->rng = cvRNG (-1);
+  gst_sfx_random_init (&filter->rng, 0);
   filter->fixed_noise = NULL;
-  filter->intermediary = NULL;
+  filter->row_noise = NULL;
+  filter->tv_noise = NULL;
+  filter->th_noise = NULL;
+
+  filter->noise_bank_frames = DEFAULT_NOISE_BANK_FRAMES;
+  filter->noise_bank_location = g_strdup (DEFAULT_NOISE_BANK_LOCATION);
+  filter->noise_bank = NULL;
+  filter->noise_bank_size = 0;
+  filter->noise_bank_file = NULL;
 
   filter->width = 0;
   filter->height = 0;
@@ -241,6 +290,7 @@ gst_sfx3dnoise_set_property (GObject * object, guint prop_id,
 {
   GstSfx3DNoise *filter = GST_SFX3DNOISE (object);
 
+  GST_OBJECT_LOCK (filter);
   switch (prop_id) {
     case PROP_SIGMA_T:
       filter->sigma_t = g_value_get_double (value);
@@ -263,10 +313,18 @@ gst_sfx3dnoise_set_property (GObject * object, guint prop_id,
     case PROP_SIGMA_TVH:
       filter->sigma_tvh = g_value_get_double (value);
       break;
+    case PROP_NOISE_BANK_FRAMES:
+      filter->noise_bank_frames = g_value_get_uint (value);
+      break;
+    case PROP_NOISE_BANK_LOCATION:
+      g_free (filter->noise_bank_location);
+      filter->noise_bank_location = g_value_dup_string (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
+  GST_OBJECT_UNLOCK (filter);
 }
 
 static void
@@ -297,200 +355,346 @@ gst_sfx3dnoise_get_property (GObject * object, guint prop_id,
     case PROP_SIGMA_TVH:
       g_value_set_double (value, filter->sigma_tvh);
       break;
+    case PROP_NOISE_BANK_FRAMES:
+      g_value_set_uint (value, filter->noise_bank_frames);
+      break;
+    case PROP_NOISE_BANK_LOCATION:
+      g_value_set_string (value, filter->noise_bank_location);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+/* All terms are summed in a single pass over the mapped frame, in place.
+ * The per-pixel terms of a row are gathered in row_noise, then added with
+ * the per-row and per-frame terms straight into the 16-bit pixels. */
 static GstFlowReturn
-gst_sfx3dnoise_cv_transform (GstOpencvBaseTransform * base, GstBuffer * buf,
-    IplImage * img, GstBuffer * outbuf, IplImage * outimg)
+gst_sfx3dnoise_transform_frame_ip (GstVideoFilter * vfilter,
+    GstVideoFrame * frame)
 {
-  GstSfx3DNoise *filter = GST_SFX3DNOISE (base);
+  GstSfx3DNoise *filter = GST_SFX3DNOISE (vfilter);
+  guint8 *data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
+  gint stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+  gfloat *row = filter->row_noise;
+  gfloat offset = 0.0f;
+  gdouble sigma_t, sigma_v, sigma_h, sigma_tv, sigma_th, sigma_vh, sigma_tvh;
+  gboolean has_fixed, has_tv, has_th, has_tvh;
+  const gfloat *bank_frame = NULL;
+  gint bank_dx = 0, bank_dy = 0;
+  gint x, y;
 
   GST_DEBUG ("Transforming");
 
-  cvConvert (img, filter->intermediary);
-
-  if (filter->sigma_h != filter->sigma_h_old ||
-      filter->sigma_v != filter->sigma_v_old ||
-      filter->sigma_vh != filter->sigma_vh_old) {
+  /* the noise and scratch buffers belong to the streaming thread, only the
+   * properties need the lock */
+  GST_OBJECT_LOCK (filter);
+  sigma_t = filter->sigma_t;
+  sigma_v = filter->sigma_v;
+  sigma_h = filter->sigma_h;
+  sigma_tv = filter->sigma_tv;
+  sigma_th = filter->sigma_th;
+  sigma_vh = filter->sigma_vh;
+  sigma_tvh = filter->sigma_tvh;
+  GST_OBJECT_UNLOCK (filter);
+
+  if (sigma_h != filter->sigma_h_old || sigma_v != filter->sigma_v_old ||
+      sigma_vh != filter->sigma_vh_old) {
     GST_DEBUG ("Creating new fixed pattern noise image");
-    gst_sfx3dnoise_create_fixed_noise (filter, filter->fixed_noise);
-
-    filter->sigma_h_old = filter->sigma_h;
-    filter->sigma_v_old = filter->sigma_v;
-    filter->sigma_vh_old = filter->sigma_vh;
+    gst_sfx3dnoise_create_fixed_noise (filter, sigma_v, sigma_h, sigma_vh);
   }
 
-  if (filter->sigma_h != 0.0 || filter->sigma_v != 0.0
-      || filter->sigma_vh != 0.0) {
-    cvAdd (filter->intermediary, filter->fixed_noise, filter->intermediary, 0);
+  has_fixed = sigma_h != 0.0 || sigma_v != 0.0 || sigma_vh != 0.0;
+  has_tv = sigma_tv > 0.0;
+  has_th = sigma_th > 0.0;
+  has_tvh = sigma_tvh > 0.0;
+
+  /* sigma-t, a flashing effect */
+  if (sigma_t > 0.0)
+    offset = gst_sfx_random_normal (&filter->rng) *
+        (gfloat) (sigma_t * SIGMA_SCALE);
+
+  /* sigma-tv, random horizontal lines */
+  if (has_tv)
+    gst_sfx_random_fill_normal (&filter->rng, filter->tv_noise,
+        filter->height, (gfloat) (sigma_tv * SIGMA_SCALE));
+
+  /* sigma-th, random vertical lines */
+  if (has_th)
+    gst_sfx_random_fill_normal (&filter->rng, filter->th_noise,
+        filter->width, (gfloat) (sigma_th * SIGMA_SCALE));
+
+  /* pick a random frame of the bank and rotate it by a random offset in
+   * both directions, wrapping around at its edges */
+  if (has_tvh && filter->noise_bank) {
+    gsize frame_size = (gsize) filter->width * filter->height;
+
+    bank_frame = filter->noise_bank + frame_size *
+        (gst_sfx_random_int (&filter->rng) %
+        (filter->noise_bank_size / frame_size));
+    bank_dx = gst_sfx_random_int (&filter->rng) % filter->width;
+    bank_dy = gst_sfx_random_int (&filter->rng) % filter->height;
   }
 
-  if (filter->sigma_tvh > 0.0) {
-    gst_sfx3dnoise_add_sigma_tvh (filter, filter->intermediary,
-        filter->sigma_tvh);
-  }
+  for (y = 0; y < filter->height; y++) {
+    guint16 *pixels = (guint16 *) (data + y * stride);
+    gfloat row_offset = offset + (has_tv ? filter->tv_noise[y] : 0.0f);
+
+    /* sigma-tvh, random spatio-temporal noise */
+    if (bank_frame) {
+      const gfloat sigma = (gfloat) (sigma_tvh * SIGMA_SCALE);
+      const gfloat *bank_row = bank_frame +
+          (gsize) ((y + bank_dy) % filter->height) * filter->width;
+      gint n = filter->width - bank_dx;
+
+      for (x = 0; x < n; x++)
+        row[x] = bank_row[bank_dx + x] * sigma;
+      for (; x < filter->width; x++)
+        row[x] = bank_row[x - n] * sigma;
+    } else if (has_tvh)
+      gst_sfx_random_fill_normal (&filter->rng, row, filter->width,
+          (gfloat) (sigma_tvh * SIGMA_SCALE));
+    else
+      memset (row, 0, filter->width * sizeof (gfloat));
+
+    if (has_fixed) {
+      const gfloat *fixed_row = filter->fixed_noise + y * filter->width;
+
+      for (x = 0; x < filter->width; x++)
+        row[x] += fixed_row[x];
+    }
 
-  if (filter->sigma_tv > 0.0) {
-    gst_sfx3dnoise_add_sigma_tv (filter, filter->intermediary,
-        filter->sigma_tv);
-  }
+    if (has_th) {
+      for (x = 0; x < filter->width; x++)
+        row[x] += filter->th_noise[x];
+    }
 
-  if (filter->sigma_th > 0.0) {
-    gst_sfx3dnoise_add_sigma_th (filter, filter->intermediary,
-        filter->sigma_th);
-  }
+    for (x = 0; x < filter->width; x++) {
+      gfloat v = GUINT16_FROM_LE (pixels[x]) + row_offset + row[x];
 
-  if (filter->sigma_t > 0.0) {
-    gst_sfx3dnoise_add_sigma_t (filter, filter->intermediary, filter->sigma_t);
+      v = CLAMP (v, 0.0f, (gfloat) G_MAXUINT16);
+      pixels[x] = GUINT16_TO_LE ((guint16) (v + 0.5f));
+    }
   }
 
-  cvConvert (filter->intermediary, outimg);
-
   return GST_FLOW_OK;
 }
 
 static gboolean
-gst_sfx3dnoise_cv_set_caps (GstOpencvBaseTransform * trans, gint in_width,
-    gint in_height, gint in_depth, gint in_channels, gint out_width,
-    gint out_height, gint out_depth, gint out_channels)
+gst_sfx3dnoise_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
+    GstVideoInfo * in_info, GstCaps * outcaps, GstVideoInfo * out_info)
 {
-  GstSfx3DNoise *filter = GST_SFX3DNOISE (trans);
+  GstSfx3DNoise *filter = GST_SFX3DNOISE (vfilter);
+  gdouble sigma_v, sigma_h, sigma_vh;
+  guint noise_bank_frames;
+  gchar *noise_bank_location;
+  gboolean ret = TRUE;
 
   GST_DEBUG ("Caps have been set");
 
-  filter->width = in_width;
-  filter->height = in_height;
-
-  if (filter->intermediary) {
-    cvReleaseMat (&filter->intermediary);
-    filter->intermediary = NULL;
-  }
-
-  if (out_depth != IPL_DEPTH_32F) {
-    filter->intermediary = cvCreateMat (out_height, out_width, CV_32FC1);
-  }
+  GST_OBJECT_LOCK (filter);
+  sigma_v = filter->sigma_v;
+  sigma_h = filter->sigma_h;
+  sigma_vh = filter->sigma_vh;
+  noise_bank_frames = filter->noise_bank_frames;
+  noise_bank_location = g_strdup (filter->noise_bank_location);
+  GST_OBJECT_UNLOCK (filter);
+
+  filter->width = GST_VIDEO_INFO_WIDTH (in_info);
+  filter->height = GST_VIDEO_INFO_HEIGHT (in_info);
+
+  g_free (filter->row_noise);
+  filter->row_noise = g_new (gfloat, filter->width);
+  g_free (filter->th_noise);
+  filter->th_noise = g_new (gfloat, filter->width);
+  g_free (filter->tv_noise);
+  filter->tv_noise = g_new (gfloat, filter->height);
+
+  g_free (filter->fixed_noise);
+  filter->fixed_noise = g_new (gfloat, (gsize) filter->width * filter->height);
+  gst_sfx3dnoise_create_fixed_noise (filter, sigma_v, sigma_h, sigma_vh);
+
+  gst_sfx3dnoise_free_noise_bank (filter);
+  if (noise_bank_frames > 0 && !gst_sfx3dnoise_create_noise_bank (filter,
+          noise_bank_frames, noise_bank_location))
+    ret = FALSE;
+  g_free (noise_bank_location);
+
+  return ret;
+}
 
-  if (filter->fixed_noise) {
-    cvReleaseMat (&filter->fixed_noise);
-    filter->fixed_noise = NULL;
-  }
-  filter->fixed_noise = cvCreateMat (out_height, out_width, CV_32FC1);
-  gst_sfx3dnoise_create_fixed_noise (filter, filter->fixed_noise);
+/* The sum of sigma-vh, sigma-h and sigma-v noise, which doesn't change from
+ * frame to frame. The tv and th scratch rows are borrowed to build it. */
+static void
+gst_sfx3dnoise_create_fixed_noise (GstSfx3DNoise * filter, gdouble sigma_v,
+    gdouble sigma_h, gdouble sigma_vh)
+{
+  gint x, y;
 
+  gst_sfx_random_fill_normal (&filter->rng, filter->tv_noise, filter->height,
+      (gfloat) (sigma_v * SIGMA_SCALE));
+  gst_sfx_random_fill_normal (&filter->rng, filter->th_noise, filter->width,
+      (gfloat) (sigma_h * SIGMA_SCALE));
 
+  for (y = 0; y < filter->height; y++) {
+    gfloat *row = filter->fixed_noise + y * filter->width;
 
-  /* TODO create fixed noise here */
+    gst_sfx_random_fill_normal (&filter->rng, row, filter->width,
+        (gfloat) (sigma_vh * SIGMA_SCALE));
+    for (x = 0; x < filter->width; x++)
+      row[x] += filter->tv_noise[y] + filter->th_noise[x];
+  }
 
-  return TRUE;
+  filter->sigma_v_old = sigma_v;
+  filter->sigma_h_old = sigma_h;
+  filter->sigma_vh_old = sigma_vh;
 }
 
-gboolean
-gst_sfx3dnoise_plugin_init (GstPlugin * plugin)
+static void
+gst_sfx3dnoise_free_noise_bank (GstSfx3DNoise * filter)
 {
-  GST_DEBUG ("Initializing plugin sfx3dnoise");
-
-  return gst_element_register (plugin, "sfx3dnoise", GST_RANK_NONE,
-      GST_TYPE_SFX3DNOISE);
+  if (filter->noise_bank_file)
+    g_mapped_file_unref (filter->noise_bank_file);
+  else
+    g_free (filter->noise_bank);
+  filter->noise_bank_file = NULL;
+  filter->noise_bank = NULL;
+  filter->noise_bank_size = 0;
 }
 
-void
-gst_sfx3dnoise_create_fixed_noise (GstSfx3DNoise * filter, CvMat * arr)
+static void
+gst_sfx3dnoise_write_noise_bank_header (GstSfx3DNoise * filter, guint frames,
+    guint8 * header)
 {
-  cvZero (arr);
-  gst_sfx3dnoise_add_sigma_tvh (filter, arr, filter->sigma_vh);
-  gst_sfx3dnoise_add_sigma_th (filter, arr, filter->sigma_h);
-  gst_sfx3dnoise_add_sigma_tv (filter, arr, filter->sigma_v);
+  const guint32 byte_order_mark = NOISE_BANK_BYTE_ORDER_MARK;
+  const gfloat one = 1.0f;
+
+  memcpy (header, NOISE_BANK_MAGIC, 8);
+  memcpy (header + 8, &byte_order_mark, 4);
+  memcpy (header + 12, &one, 4);
+  GST_WRITE_UINT32_LE (header + 16, filter->width);
+  GST_WRITE_UINT32_LE (header + 20, filter->height);
+  GST_WRITE_UINT32_LE (header + 24, frames);
 }
 
-/* Add sigma-vh or sigma-tvh noise, which adds random noise to every pixel */
-void
-gst_sfx3dnoise_add_sigma_tvh (GstSfx3DNoise * filter, CvMat * arr, double sigma)
+/* Maps the bank at location, which is shared with every other stream
+ * mapping it, if it was made for this frame size and count. */
+static gboolean
+gst_sfx3dnoise_map_noise_bank (GstSfx3DNoise * filter, guint frames,
+    const gchar * location)
 {
-  CvMat *noise = cvCreateMat (filter->height, filter->width, CV_32F);
+  guint8 header[NOISE_BANK_HEADER_SIZE];
+  GMappedFile *file;
+  GError *err = NULL;
+  const gchar *contents;
+  gsize length;
+
+  file = g_mapped_file_new (location, FALSE, &err);
+  if (!file) {
+    GST_DEBUG ("Can't map noise bank: %s", err->message);
+    g_error_free (err);
+    return FALSE;
+  }
 
-  /* TODO move scaling of sigma somewhere else? */
-  cvRandArr (&filter->rng, noise, CV_RAND_NORMAL, cvScalarAll (0),
-      cvScalarAll (sigma * (G_MAXUINT16 - 1)));
+  gst_sfx3dnoise_write_noise_bank_header (filter, frames, header);
+  contents = g_mapped_file_get_contents (file);
+  length = g_mapped_file_get_length (file);
+  if (length < NOISE_BANK_HEADER_SIZE || memcmp (contents, header, 8) != 0) {
+    GST_DEBUG ("'%s' is not a noise bank, replacing it",
+        location);
+    goto mismatch;
+  }
+  if (memcmp (contents + 8, header + 8, 8) != 0) {
+    GST_DEBUG ("Noise bank '%s' has another byte order or float format, "
+        "replacing it", location);
+    goto mismatch;
+  }
+  if (length != NOISE_BANK_HEADER_SIZE +
+      filter->noise_bank_size * sizeof (gfloat) ||
+      memcmp (contents + 16, header + 16, NOISE_BANK_HEADER_SIZE - 16) != 0) {
+    GST_DEBUG ("Noise bank '%s' doesn't match, replacing it",
+        location);
+    goto mismatch;
+  }
 
-  cvAdd (arr, noise, arr, 0);
+  filter->noise_bank_file = file;
+  filter->noise_bank = (gfloat *) (contents + NOISE_BANK_HEADER_SIZE);
 
-  cvReleaseMat (&noise);
-}
+  return TRUE;
 
+mismatch:
+  g_mapped_file_unref (file);
+  return FALSE;
+}
 
-/* Add sigma-v or sigma-tv noise, which adds random horizontal lines */
-void
-gst_sfx3dnoise_add_sigma_tv (GstSfx3DNoise * filter, CvMat * arr, double sigma)
+/* written next to the final location then renamed, so streams starting
+ * together never map a partly written bank */
+static void
+gst_sfx3dnoise_save_noise_bank (GstSfx3DNoise * filter, guint frames,
+    const gchar * location)
 {
-  CvMat *noise = cvCreateMat (1, filter->height, CV_32F);
-  gfloat *data;
-  gfloat *noisedata;
-  int step, x, y;
-
-  /* TODO move scaling of sigma somewhere else? */
-  cvRandArr (&filter->rng, noise, CV_RAND_NORMAL, cvScalarAll (0),
-      cvScalarAll (sigma * (G_MAXUINT16 - 1)));
-
-  cvGetRawData (arr, (uchar **) & data, &step, NULL);
-  cvGetRawData (noise, (uchar **) & noisedata, NULL, NULL);
-
-  step /= sizeof (gfloat);
-
-  for (y = 0; y < filter->height; y++) {
-    for (x = 0; x < filter->width; x++) {
-      data[y * step + x] += noisedata[y];
+  guint8 header[NOISE_BANK_HEADER_SIZE];
+  gchar *tmp_location;
+  gboolean ok;
+  FILE *file;
+  gint fd;
+
+  tmp_location = g_strconcat (location, ".XXXXXX", NULL);
+  fd = g_mkstemp (tmp_location);
+  file = fd != -1 ? fdopen (fd, "wb") : NULL;
+  if (!file) {
+    GST_WARNING ("Can't write noise bank '%s'", location);
+    if (fd != -1) {
+      close (fd);
+      g_unlink (tmp_location);
     }
+    g_free (tmp_location);
+    return;
   }
 
-  cvReleaseMat (&noise);
-}
-
-
-/* Add sigma-h and sigma-th noise, which adds random vertical lines */
-void
-gst_sfx3dnoise_add_sigma_th (GstSfx3DNoise * filter, CvMat * arr, double sigma)
-{
-  CvMat *noise = cvCreateMat (1, filter->width, CV_32F);
-  gfloat *data;
-  gfloat *noisedata;
-  int step, x, y;
-
-  /* TODO move scaling of sigma somewhere else? */
-  cvRandArr (&filter->rng, noise, CV_RAND_NORMAL, cvScalarAll (0),
-      cvScalarAll (sigma * (G_MAXUINT16 - 1)));
-
-  cvGetRawData (arr, (uchar **) & data, &step, NULL);
-  cvGetRawData (noise, (uchar **) & noisedata, NULL, NULL);
+  gst_sfx3dnoise_write_noise_bank_header (filter, frames, header);
+  ok = fwrite (header, sizeof (header), 1, file) == 1 &&
+      fwrite (filter->noise_bank, sizeof (gfloat), filter->noise_bank_size,
+      file) == filter->noise_bank_size;
+  ok &= fclose (file) == 0;
 
-  step /= sizeof (gfloat);
-
-  for (y = 0; y < filter->height; y++) {
-    for (x = 0; x < filter->width; x++) {
-      data[y * step + x] += noisedata[x];
-    }
+  if (!ok || g_rename (tmp_location, location) != 0) {
+    GST_WARNING ("Failed to write noise bank '%s'", location);
+    g_unlink (tmp_location);
   }
-
-  cvReleaseMat (&noise);
+  g_free (tmp_location);
 }
 
-/* Add Sigma_T noise, which creates a flashing effect */
-void
-gst_sfx3dnoise_add_sigma_t (GstSfx3DNoise * filter, CvMat * arr, double sigma)
+/* The spatio-temporal noise of noise-bank-frames frames, as unit normal
+ * samples scaled by sigma-tvh when used. */
+static gboolean
+gst_sfx3dnoise_create_noise_bank (GstSfx3DNoise * filter, guint frames,
+    const gchar * location)
 {
-  CvMat *noise = cvCreateMat (1, 1, CV_32F);
-  float *data;
+  gsize frame_size = (gsize) filter->width * filter->height;
 
-  /* TODO move scaling of sigma somewhere else? */
-  cvRandArr (&filter->rng, noise, CV_RAND_NORMAL, cvScalarAll (0),
-      cvScalarAll (sigma * (G_MAXUINT16 - 1)));
+  if (frame_size == 0 || frames > G_MAXSIZE / frame_size / sizeof (gfloat)) {
+    GST_WARNING ("Noise bank of %u frames is too large", frames);
+    return FALSE;
+  }
+  filter->noise_bank_size = frame_size * frames;
 
-  cvGetRawData (noise, (uchar **) & data, NULL, NULL);
+  if (location && gst_sfx3dnoise_map_noise_bank (filter, frames, location))
+    return TRUE;
 
-  cvAddS (arr, cvScalarAll (*data), arr, 0);
+  GST_DEBUG ("Generating noise bank of %u frames", frames);
+  filter->noise_bank = g_try_new (gfloat, filter->noise_bank_size);
+  if (!filter->noise_bank) {
+    GST_WARNING ("Can't allocate noise bank of %u frames", frames);
+    filter->noise_bank_size = 0;
+    return FALSE;
+  }
+  gst_sfx_random_fill_normal (&filter->rng, filter->noise_bank,
+      filter->noise_bank_size, 1.0f);
 
-  cvReleaseMat (&noise);
+  if (location)
+    gst_sfx3dnoise_save_noise_bank (filter, frames, location);
+
+  return TRUE;
 }
@@ -45,8 +45,9 @@
 #define __GST_SFX3DNOISE_H__
 
 #include <gst/gst.h>
-#include <cv.h>
-#include <gstopencvbasetrans.h>
+#include <gst/video/gstvideofilter.h>
+
+#include "gstsensorfxrandom.h"
 
 G_BEGIN_DECLS
 
@@ -67,7 +68,7 @@ typedef struct _GstSfx3DNoiseClass GstSfx3DNoiseClass;
 
 struct _GstSfx3DNoise
 {
-  GstOpencvBaseTransform element;
+  GstVideoFilter element;
 
   gdouble sigma_t;
   gdouble sigma_v;
@@ -76,7 +77,11 @@ struct _GstSfx3DNoise
   gdouble sigma_th;
   gdouble sigma_vh;
   gdouble sigma_tvh;
+  guint noise_bank_frames;
+  gchar * noise_bank_location;
 
+  /* the rest is owned by the streaming thread, which only takes the object
+   * lock to read the properties above */
   gdouble sigma_v_old;
   gdouble sigma_h_old;
   gdouble sigma_vh_old;
@@ -84,20 +89,28 @@ struct _GstSfx3DNoise
   gint width;
   gint height;
 
-  CvRNG rng;
-  CvMat * fixed_noise;
-  CvMat * intermediary;
+  GstSfxRandom rng;
+  gfloat * fixed_noise;
+
+  /* scratch sized at caps time, so transforming allocates nothing */
+  gfloat * row_noise;
+  gfloat * tv_noise;
+  gfloat * th_noise;
+
+  /* unit normal samples the sigma-tvh term is drawn from, either owned or
+   * pointing into noise_bank_file */
+  gfloat * noise_bank;
+  gsize noise_bank_size;
+  GMappedFile * noise_bank_file;
 };
 
 struct _GstSfx3DNoiseClass 
 {
-  GstOpencvBaseTransformClass parent_class;
+  GstVideoFilterClass parent_class;
 };
 
 GType gst_sfx3dnoise_get_type (void);
 
-gboolean gst_sfx3dnoise_plugin_init (GstPlugin * plugin);
-
 G_END_DECLS
 
 #endif /* __GST_SFX3DNOISE_H__ */
@@ -24,12 +24,20 @@
 /**
 * SECTION:element-sfxblur
 *
-* Convert grayscale video from one bpp/depth combination to another.
+* Blurs grayscale video with the modulation transfer function of simple
+* optics: a Gaussian, a box (pixel aperture or motion) or a diffraction
+* limited circular aperture. Kernels are separable, applied to rows then
+* columns, and frames are processed in bands of rows on several threads.
+*
+* The diffraction kernel is the line spread function of a circular aperture,
+* the inverse transform of its 1-D MTF, with cutoff the spatial frequency
+* 1 / (wavelength * f-number) in cycles per pixel. Applying it to rows and
+* columns approximates the Airy disk, which isn't separable.
 *
 * <refsect2>
 * <title>Example launch line</title>
 * |[
-* gst-launch videotestsrc ! sfxblur ! ffmpegcolorspace ! autovideosink
+* gst-launch videotestsrc ! video/x-raw,format=GRAY8 ! sfxblur kernel=diffraction cutoff=0.25 ! videoconvert ! autovideosink
 * ]|
 * </refsect2>
 */
@@ -43,9 +51,6 @@
 
 #include <gst/video/video.h>
 
-#include <cv.h>
-
-#include "gstopencvutils.h"
 #include "gstsensorfxblur.h"
 
 /* GstSensorFxBlur signals and args */
@@ -58,56 +63,56 @@ enum
 enum
 {
   PROP_0,
-  PROP_LOWIN,
+  PROP_KERNEL,
+  PROP_SIGMA,
+  PROP_SIZE,
+  PROP_CUTOFF,
+  PROP_N_THREADS,
+  PROP_LAST
 };
 
-#define DEFAULT_PROP_LOWIN  0.0
+#define DEFAULT_PROP_KERNEL GST_SENSORFXBLUR_KERNEL_GAUSSIAN
+#define DEFAULT_PROP_SIGMA 1.0
+#define DEFAULT_PROP_SIZE 3
+#define DEFAULT_PROP_CUTOFF 0.5
+#define DEFAULT_PROP_N_THREADS 0
 
-static const GstElementDetails sfxblur_details =
-GST_ELEMENT_DETAILS ("Blurs video",
-    "Filter/Effect/Video",
-    "Applies a blur kernel to video",
-    "Joshua Doe <oss@nvl.army.mil");
+/* keeps the taps and the row ring of a band reasonably sized */
+#define MAX_RADIUS 255
+
+#define GST_TYPE_SENSORFXBLUR_KERNEL (gst_sfxblur_kernel_get_type())
+static GType
+gst_sfxblur_kernel_get_type (void)
+{
+  static GType sfxblur_kernel_type = 0;
+  static const GEnumValue sfxblur_kernel[] = {
+    {GST_SENSORFXBLUR_KERNEL_GAUSSIAN, "Gaussian", "gaussian"},
+    {GST_SENSORFXBLUR_KERNEL_BOX, "Box", "box"},
+    {GST_SENSORFXBLUR_KERNEL_DIFFRACTION, "Diffraction limited circular "
+          "aperture", "diffraction"},
+    {0, NULL, NULL},
+  };
+
+  if (!sfxblur_kernel_type) {
+    sfxblur_kernel_type =
+        g_enum_register_static ("GstSensorFxBlurKernel", sfxblur_kernel);
+  }
+  return sfxblur_kernel_type;
+}
 
 /* the capabilities of the inputs and outputs */
-static GstStaticPadTemplate gst_sfxblur_src_template =
-    GST_STATIC_PAD_TEMPLATE ("sink",
+static GstStaticPadTemplate gst_sfxblur_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
-    GST_STATIC_CAPS ("video/x-raw-gray, "
-        "bpp = (int) 16, "
-        "depth = (int) 16, "
-        "endianness = (int) BYTE_ORDER, "
-        "width = " GST_VIDEO_SIZE_RANGE ", "
-        "height = " GST_VIDEO_SIZE_RANGE ", "
-        "framerate = " GST_VIDEO_FPS_RANGE ";"
-        "video/x-raw-gray-float, "
-        "bpp = (int) 32, "
-        "depth = (int) 32, "
-        "endianness = (int) BYTE_ORDER, "
-        "width = " GST_VIDEO_SIZE_RANGE ", "
-        "height = " GST_VIDEO_SIZE_RANGE ", "
-        "framerate = " GST_VIDEO_FPS_RANGE)
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("{ GRAY8, GRAY16_LE, GRAY16_BE }"))
     );
 
-static GstStaticPadTemplate gst_sfxblur_sink_template =
-    GST_STATIC_PAD_TEMPLATE ("src",
+static GstStaticPadTemplate gst_sfxblur_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
-    GST_STATIC_CAPS ("video/x-raw-gray, "
-        "bpp = (int) 16, "
-        "depth = (int) 16, "
-        "endianness = (int) BYTE_ORDER, "
-        "width = " GST_VIDEO_SIZE_RANGE ", "
-        "height = " GST_VIDEO_SIZE_RANGE ", "
-        "framerate = " GST_VIDEO_FPS_RANGE ";"
-        "video/x-raw-gray-float, "
-        "bpp = (int) 32, "
-        "depth = (int) 32, "
-        "endianness = (int) BYTE_ORDER, "
-        "width = " GST_VIDEO_SIZE_RANGE ", "
-        "height = " GST_VIDEO_SIZE_RANGE ", "
-        "framerate = " GST_VIDEO_FPS_RANGE)
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("{ GRAY8, GRAY16_LE, GRAY16_BE }"))
     );
 
 /* GObject vmethod declarations */
@@ -115,68 +120,50 @@ static void gst_sfxblur_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_sfxblur_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
-static void gst_sfxblur_finalize (GObject * object);
+static void gst_sfxblur_dispose (GObject * object);
 
-/* GstBaseTransform vmethod declarations */
-static gboolean gst_sfxblur_set_caps (GstBaseTransform * base,
-    GstCaps * incaps, GstCaps * outcaps);
-static GstFlowReturn gst_sfxblur_transform_ip (GstBaseTransform * base,
-    GstBuffer * buf);
+/* GstVideoFilter vmethod declarations */
+static GstFlowReturn gst_sfxblur_transform_frame (GstVideoFilter * filter,
+    GstVideoFrame * in_frame, GstVideoFrame * out_frame);
 
 /* GstSensorFxBlur method declarations */
 static void gst_sfxblur_reset (GstSensorFxBlur * filter);
+static void gst_sfxblur_update_kernel (GstSensorFxBlur * filter);
 
 /* setup debug */
 GST_DEBUG_CATEGORY_STATIC (sfxblur_debug);
 #define GST_CAT_DEFAULT sfxblur_debug
-#define DEBUG_INIT(bla) \
-    GST_DEBUG_CATEGORY_INIT (sfxblur_debug, "sfxblur", 0, \
-    "sfxblur");
-
-GST_BOILERPLATE_FULL (GstSensorFxBlur, gst_sfxblur, GstVideoFilter,
-    GST_TYPE_VIDEO_FILTER, DEBUG_INIT);
 
+G_DEFINE_TYPE (GstSensorFxBlur, gst_sfxblur, GST_TYPE_VIDEO_FILTER);
 
 /************************************************************************/
 /* GObject vmethod implementations                                      */
 /************************************************************************/
 
 /**
- * gst_sfxblur_base_init:
- * @klass: #GstElementClass.
- *
- */
-static void
-gst_sfxblur_base_init (gpointer klass)
-{
-  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
-
-  GST_DEBUG ("base init");
-
-  gst_element_class_set_details (element_class, &sfxblur_details);
-
-  gst_element_class_add_pad_template (element_class,
-      gst_static_pad_template_get (&gst_sfxblur_sink_template));
-  gst_element_class_add_pad_template (element_class,
-      gst_static_pad_template_get (&gst_sfxblur_src_template));
-}
-
-/**
- * gst_sfxblur_finalize:
+ * gst_sfxblur_dispose:
  * @object: #GObject.
  *
  */
 static void
-gst_sfxblur_finalize (GObject * object)
+gst_sfxblur_dispose (GObject * object)
 {
   GstSensorFxBlur *sfxblur = GST_SENSORFXBLUR (object);
 
-  GST_DEBUG ("finalize");
+  GST_DEBUG ("dispose");
 
   gst_sfxblur_reset (sfxblur);
 
+  g_free (sfxblur->taps);
+  sfxblur->taps = NULL;
+
+  if (sfxblur->runner) {
+    gst_parallel_runner_free (sfxblur->runner);
+    sfxblur->runner = NULL;
+  }
+
   /* chain up to the parent class */
-  G_OBJECT_CLASS (parent_class)->finalize (object);
+  G_OBJECT_CLASS (gst_sfxblur_parent_class)->dispose (object);
 }
 
 /**
@@ -185,44 +172,88 @@ gst_sfxblur_finalize (GObject * object)
  *
  */
 static void
-gst_sfxblur_class_init (GstSensorFxBlurClass * object)
+gst_sfxblur_class_init (GstSensorFxBlurClass * klass)
 {
-  GObjectClass *obj_class = G_OBJECT_CLASS (object);
-  GstBaseTransformClass *trans_class = GST_BASE_TRANSFORM_CLASS (object);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+  GstVideoFilterClass *gstvideofilter_class = GST_VIDEO_FILTER_CLASS (klass);
 
-  GST_DEBUG ("class init");
+  GST_DEBUG_CATEGORY_INIT (sfxblur_debug, "sfxblur", 0, "sfxblur");
 
+  GST_DEBUG ("class init");
 
   /* Register GObject vmethods */
-  obj_class->finalize = GST_DEBUG_FUNCPTR (gst_sfxblur_finalize);
-  obj_class->set_property = GST_DEBUG_FUNCPTR (gst_sfxblur_set_property);
-  obj_class->get_property = GST_DEBUG_FUNCPTR (gst_sfxblur_get_property);
+  gobject_class->dispose = GST_DEBUG_FUNCPTR (gst_sfxblur_dispose);
+  gobject_class->set_property = GST_DEBUG_FUNCPTR (gst_sfxblur_set_property);
+  gobject_class->get_property = GST_DEBUG_FUNCPTR (gst_sfxblur_get_property);
 
   /* Install GObject properties */
-  g_object_class_install_property (obj_class, PROP_LOWIN,
-      g_param_spec_double ("lower-input-level", "Lower Input Level",
-          "Lower Input Level", 0.0, 1.0, DEFAULT_PROP_LOWIN,
-          G_PARAM_READWRITE));
-
-  /* Register GstBaseTransform vmethods */
-  trans_class->set_caps = GST_DEBUG_FUNCPTR (gst_sfxblur_set_caps);
-  trans_class->transform_ip = GST_DEBUG_FUNCPTR (gst_sfxblur_transform_ip);
+  g_object_class_install_property (gobject_class, PROP_KERNEL,
+      g_param_spec_enum ("kernel", "Kernel", "Blur kernel",
+          GST_TYPE_SENSORFXBLUR_KERNEL, DEFAULT_PROP_KERNEL,
+          G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE |
+          GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_SIGMA,
+      g_param_spec_double ("sigma", "Sigma",
+          "Standard deviation of the Gaussian kernel in pixels", 0.0, 64.0,
+          DEFAULT_PROP_SIGMA,
+          G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE |
+          GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_SIZE,
+      g_param_spec_uint ("size", "Size",
+          "Width of the box kernel in pixels, even widths get half weight "
+          "taps at both ends", 1, 2 * MAX_RADIUS, DEFAULT_PROP_SIZE,
+          G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE |
+          GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_CUTOFF,
+      g_param_spec_double ("cutoff", "Cutoff",
+          "Cutoff frequency of the diffraction kernel in cycles per pixel, "
+          "1 / (wavelength * f-number) in pixel units", 0.01, 2.0,
+          DEFAULT_PROP_CUTOFF,
+          G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE |
+          GST_PARAM_MUTABLE_PLAYING));
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      gst_parallel_param_spec_n_threads ());
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&gst_sfxblur_sink_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&gst_sfxblur_src_template));
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "Blurs video", "Filter/Effect/Video",
+      "Applies a separable optical blur kernel to grayscale video",
+      "Joshua M. Doe <oss@nvl.army.mil>");
+
+  /* Register GstVideoFilter vmethods */
+  gstvideofilter_class->transform_frame =
+      GST_DEBUG_FUNCPTR (gst_sfxblur_transform_frame);
 }
 
 /**
 * gst_sfxblur_init:
 * @sfxblur: GstSensorFxBlur
-* @g_class: GstSensorFxBlurClass
 *
 * Initialize the new element
 */
 static void
-gst_sfxblur_init (GstSensorFxBlur * sfxblur, GstSensorFxBlurClass * g_class)
+gst_sfxblur_init (GstSensorFxBlur * sfxblur)
 {
   GST_DEBUG_OBJECT (sfxblur, "init class instance");
 
-  gst_sfxblur_reset (sfxblur);
+  sfxblur->kernel = DEFAULT_PROP_KERNEL;
+  sfxblur->sigma = DEFAULT_PROP_SIGMA;
+  sfxblur->size = DEFAULT_PROP_SIZE;
+  sfxblur->cutoff = DEFAULT_PROP_CUTOFF;
+  sfxblur->n_threads = DEFAULT_PROP_N_THREADS;
 
+  sfxblur->taps = NULL;
+  sfxblur->radius = 0;
+  sfxblur->kernel_dirty = TRUE;
+  sfxblur->runner = NULL;
+  sfxblur->scratch = NULL;
+
+  gst_sfxblur_reset (sfxblur);
 }
 
 /**
@@ -241,11 +272,29 @@ gst_sfxblur_set_property (GObject * object, guint prop_id,
 
   GST_DEBUG ("setting property %s", pspec->name);
 
+  GST_OBJECT_LOCK (sfxblur);
   switch (prop_id) {
+    case PROP_KERNEL:
+      sfxblur->kernel = g_value_get_enum (value);
+      break;
+    case PROP_SIGMA:
+      sfxblur->sigma = g_value_get_double (value);
+      break;
+    case PROP_SIZE:
+      sfxblur->size = g_value_get_uint (value);
+      break;
+    case PROP_CUTOFF:
+      sfxblur->cutoff = g_value_get_double (value);
+      break;
+    case PROP_N_THREADS:
+      sfxblur->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
+  sfxblur->kernel_dirty = TRUE;
+  GST_OBJECT_UNLOCK (sfxblur);
 }
 
 /**
@@ -265,6 +314,21 @@ gst_sfxblur_get_property (GObject * object, guint prop_id, GValue * value,
   GST_DEBUG ("getting property %s", pspec->name);
 
   switch (prop_id) {
+    case PROP_KERNEL:
+      g_value_set_enum (value, sfxblur->kernel);
+      break;
+    case PROP_SIGMA:
+      g_value_set_double (value, sfxblur->sigma);
+      break;
+    case PROP_SIZE:
+      g_value_set_uint (value, sfxblur->size);
+      break;
+    case PROP_CUTOFF:
+      g_value_set_double (value, sfxblur->cutoff);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, sfxblur->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -272,59 +336,189 @@ gst_sfxblur_get_property (GObject * object, guint prop_id, GValue * value,
 }
 
 /************************************************************************/
-/* GstBaseTransform vmethod implementations                             */
+/* GstVideoFilter vmethod implementations                               */
 /************************************************************************/
 
-/**
- * gst_sfxblur_set_caps:
- * base: #GstBaseTransform
- * incaps: #GstCaps
- * outcaps: #GstCaps
- * 
- * Notification of the actual caps set.
- *
- * Returns: TRUE on acceptance of caps
- */
-static gboolean
-gst_sfxblur_set_caps (GstBaseTransform * base, GstCaps * incaps,
-    GstCaps * outcaps)
+typedef struct
 {
-  GstSensorFxBlur *levels;
-  GstStructure *structure;
-  gboolean res;
-
-  levels = GST_SENSORFXBLUR (base);
-
-  GST_DEBUG_OBJECT (levels,
-      "set_caps: in %" GST_PTR_FORMAT " out %" GST_PTR_FORMAT, incaps, outcaps);
+  GstVideoFrame *in_frame;
+  GstVideoFrame *out_frame;
+  /* the kernel, copied under the object lock */
+  gfloat taps[2 * MAX_RADIUS + 1];
+  gint radius;
+  gfloat *scratch;
+  /* floats of scratch per band */
+  gsize band_size;
+} GstSensorFxBlurJob;
+
+/* Read row y, clamped to the frame, into dest with radius samples of the
+ * edge repeated on both sides. */
+static void
+gst_sfxblur_load_row (const GstVideoFrame * frame, gint y, gint radius,
+    gfloat * dest)
+{
+  const gint width = GST_VIDEO_FRAME_WIDTH (frame);
+  const guint8 *src;
+  gint x;
+
+  y = CLAMP (y, 0, GST_VIDEO_FRAME_HEIGHT (frame) - 1);
+  src = (const guint8 *) GST_VIDEO_FRAME_PLANE_DATA (frame, 0) +
+      y * GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+  dest += radius;
+
+  switch (GST_VIDEO_FRAME_FORMAT (frame)) {
+    case GST_VIDEO_FORMAT_GRAY8:
+      for (x = 0; x < width; x++)
+        dest[x] = src[x];
+      break;
+    case GST_VIDEO_FORMAT_GRAY16_LE:
+      for (x = 0; x < width; x++)
+        dest[x] = GUINT16_FROM_LE (((const guint16 *) src)[x]);
+      break;
+    case GST_VIDEO_FORMAT_GRAY16_BE:
+      for (x = 0; x < width; x++)
+        dest[x] = GUINT16_FROM_BE (((const guint16 *) src)[x]);
+      break;
+    default:
+      g_assert_not_reached ();
+  }
 
-  GST_DEBUG_OBJECT (incaps, "incaps");
-  GST_DEBUG_OBJECT (outcaps, "outcaps");
+  for (x = 1; x <= radius; x++) {
+    dest[-x] = dest[0];
+    dest[width - 1 + x] = dest[width - 1];
+  }
+}
 
-  /* retrieve input caps info */
-  structure = gst_caps_get_structure (incaps, 0);
+static void
+gst_sfxblur_store_row (GstVideoFrame * frame, gint y, const gfloat * src)
+{
+  const gint width = GST_VIDEO_FRAME_WIDTH (frame);
+  guint8 *dest = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (frame, 0) +
+      y * GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+  gint x;
+
+  switch (GST_VIDEO_FRAME_FORMAT (frame)) {
+    case GST_VIDEO_FORMAT_GRAY8:
+      for (x = 0; x < width; x++)
+        dest[x] = (guint8) CLAMP (src[x] + 0.5f, 0.0f, 255.0f);
+      break;
+    case GST_VIDEO_FORMAT_GRAY16_LE:
+      for (x = 0; x < width; x++)
+        ((guint16 *) dest)[x] =
+            GUINT16_TO_LE ((guint16) CLAMP (src[x] + 0.5f, 0.0f, 65535.0f));
+      break;
+    case GST_VIDEO_FORMAT_GRAY16_BE:
+      for (x = 0; x < width; x++)
+        ((guint16 *) dest)[x] =
+            GUINT16_TO_BE ((guint16) CLAMP (src[x] + 0.5f, 0.0f, 65535.0f));
+      break;
+    default:
+      g_assert_not_reached ();
+  }
+}
 
-  //mime = gst_structure_get_name (structure);
-  //if (g_strcmp0 ("video/x-raw-gray", mime) == 0)
-  //  levels->
+/* One tap at a time over the whole row, so the inner loop is a contiguous
+ * multiply-add the compiler vectorizes. */
+static void
+gst_sfxblur_filter_row (const gfloat * padded, gint width,
+    const gfloat * taps, gint n_taps, gfloat * dest)
+{
+  gint x, k;
 
-  res = gst_structure_get (structure,
-      "width", G_TYPE_INT, &levels->width,
-      "height", G_TYPE_INT, &levels->height,
-      "bpp", G_TYPE_INT, &levels->bpp,
-      "depth", G_TYPE_INT, &levels->depth,
-      "endianness", G_TYPE_INT, &levels->endianness, NULL);
-  if (!res)
-    return FALSE;
+  for (x = 0; x < width; x++)
+    dest[x] = taps[0] * padded[x];
+  for (k = 1; k < n_taps; k++) {
+    const gfloat tap = taps[k];
+    const gfloat *src = padded + k;
 
-  levels->stride = GST_ROUND_UP_4 (levels->width * levels->depth / 8);
+    for (x = 0; x < width; x++)
+      dest[x] += tap * src[x];
+  }
+}
 
-  return res;
+/* Blurs rows [row_start, row_end). The rows filtered horizontally are kept
+ * in a ring of n_taps rows, so each input row is filtered once per band and
+ * the column pass reads whole rows, vectorizing along x like the row pass
+ * without transposing the frame. */
+static void
+gst_sfxblur_blur_rows (gpointer user_data, guint band, gint row_start,
+    gint row_end)
+{
+  GstSensorFxBlurJob *job = (GstSensorFxBlurJob *) user_data;
+  const gint width = GST_VIDEO_FRAME_WIDTH (job->in_frame);
+  const gint radius = job->radius;
+  const gint n_taps = 2 * radius + 1;
+  gfloat *padded = job->scratch + band * job->band_size;
+  gfloat *acc = padded + width + 2 * radius;
+  gfloat *ring = acc + width;
+  gint y, k, x, next;
+
+  next = row_start - radius;
+  for (y = row_start; y < row_end; y++) {
+    /* rows are stored at (row + n_taps) % n_taps, row >= -radius */
+    for (; next <= y + radius; next++) {
+      gst_sfxblur_load_row (job->in_frame, next, radius, padded);
+      gst_sfxblur_filter_row (padded, width, job->taps, n_taps,
+          ring + ((next + n_taps) % n_taps) * width);
+    }
+
+    for (x = 0; x < width; x++)
+      acc[x] = 0.0f;
+    for (k = 0; k < n_taps; k++) {
+      const gfloat tap = job->taps[k];
+      const gfloat *src = ring + ((y - radius + k + n_taps) % n_taps) * width;
+
+      for (x = 0; x < width; x++)
+        acc[x] += tap * src[x];
+    }
+
+    gst_sfxblur_store_row (job->out_frame, y, acc);
+  }
 }
 
-GstFlowReturn
-gst_sfxblur_transform_ip (GstBaseTransform * base, GstBuffer * buf)
+static GstFlowReturn
+gst_sfxblur_transform_frame (GstVideoFilter * filter,
+    GstVideoFrame * in_frame, GstVideoFrame * out_frame)
 {
+  GstSensorFxBlur *filt = GST_SENSORFXBLUR (filter);
+  GstSensorFxBlurJob job;
+  GstParallelRunner *runner;
+  gsize scratch_size;
+  gint width = GST_VIDEO_FRAME_WIDTH (in_frame);
+  guint n_threads;
+
+  GST_OBJECT_LOCK (filt);
+  if (filt->kernel_dirty) {
+    gst_sfxblur_update_kernel (filt);
+    filt->kernel_dirty = FALSE;
+  }
+  job.radius = filt->radius;
+  memcpy (job.taps, filt->taps, (2 * filt->radius + 1) * sizeof (gfloat));
+  n_threads = filt->n_threads;
+  GST_OBJECT_UNLOCK (filt);
+
+  if (job.radius == 0) {
+    gst_video_frame_copy (out_frame, in_frame);
+    return GST_FLOW_OK;
+  }
+
+  runner = gst_parallel_runner_ensure (&filt->runner, n_threads);
+
+  /* per band: a padded input row, an accumulator row and the ring */
+  job.band_size = (width + 2 * job.radius) + width +
+      (gsize) (2 * job.radius + 1) * width;
+  scratch_size = gst_parallel_runner_get_n_threads (runner) * job.band_size;
+  if (filt->scratch_size < scratch_size) {
+    g_free (filt->scratch);
+    filt->scratch = g_new (gfloat, scratch_size);
+    filt->scratch_size = scratch_size;
+  }
+
+  job.in_frame = in_frame;
+  job.out_frame = out_frame;
+  job.scratch = filt->scratch;
+  gst_parallel_runner_run_rows (runner, GST_VIDEO_FRAME_HEIGHT (in_frame), 1,
+      gst_sfxblur_blur_rows, &job);
 
   return GST_FLOW_OK;
 }
@@ -333,6 +527,89 @@ gst_sfxblur_transform_ip (GstBaseTransform * base, GstBuffer * buf)
 /* GstSensorFxBlur method implementations                                */
 /************************************************************************/
 
+/* 1-D MTF of a diffraction limited circular aperture, u = f / cutoff */
+static gdouble
+gst_sfxblur_diffraction_mtf (gdouble u)
+{
+  if (u >= 1.0)
+    return 0.0;
+
+  return 2.0 / G_PI * (acos (u) - u * sqrt (1.0 - u * u));
+}
+
+/* Line spread function at x pixels, the inverse transform of the MTF,
+ * integrated with Simpson's rule. */
+static gdouble
+gst_sfxblur_diffraction_lsf (gdouble cutoff, gint x)
+{
+  const gint n = 256;
+  gdouble sum = 0.0;
+  gint i;
+
+  for (i = 0; i <= n; i++) {
+    gdouble u = (gdouble) i / n;
+    gdouble v = gst_sfxblur_diffraction_mtf (u) *
+        cos (2.0 * G_PI * cutoff * u * x);
+
+    sum += v * (i == 0 || i == n ? 1 : (i % 2 ? 4 : 2));
+  }
+
+  return sum / (3 * n);
+}
+
+/* Called with the object lock held. */
+static void
+gst_sfxblur_update_kernel (GstSensorFxBlur * filt)
+{
+  gdouble sum = 0.0;
+  gint i, radius;
+
+  switch (filt->kernel) {
+    case GST_SENSORFXBLUR_KERNEL_GAUSSIAN:
+      radius = (gint) ceil (3.0 * filt->sigma);
+      break;
+    case GST_SENSORFXBLUR_KERNEL_BOX:
+      radius = filt->size / 2;
+      break;
+    case GST_SENSORFXBLUR_KERNEL_DIFFRACTION:
+      /* the line spread function falls off as the cube of the distance */
+      radius = (gint) ceil (4.0 / filt->cutoff);
+      break;
+    default:
+      g_assert_not_reached ();
+  }
+  radius = MIN (radius, MAX_RADIUS);
+
+  g_free (filt->taps);
+  filt->taps = g_new (gfloat, 2 * radius + 1);
+  filt->radius = radius;
+
+  for (i = -radius; i <= radius; i++) {
+    gdouble w;
+
+    switch (filt->kernel) {
+      case GST_SENSORFXBLUR_KERNEL_GAUSSIAN:
+        w = exp (-0.5 * i * i / (filt->sigma * filt->sigma));
+        break;
+      case GST_SENSORFXBLUR_KERNEL_BOX:
+        w = (filt->size % 2 == 0 && ABS (i) == radius) ? 0.5 : 1.0;
+        break;
+      case GST_SENSORFXBLUR_KERNEL_DIFFRACTION:
+        w = gst_sfxblur_diffraction_lsf (filt->cutoff, i);
+        break;
+      default:
+        g_assert_not_reached ();
+    }
+    filt->taps[i + radius] = (gfloat) w;
+    sum += w;
+  }
+
+  for (i = 0; i < 2 * radius + 1; i++)
+    filt->taps[i] = (gfloat) (filt->taps[i] / sum);
+
+  GST_DEBUG_OBJECT (filt, "Kernel has %d taps", 2 * radius + 1);
+}
+
 /**
  * gst_sfxblur_reset:
  * @sfxblur: #GstSensorFxBlur
@@ -342,12 +619,9 @@ gst_sfxblur_transform_ip (GstBaseTransform * base, GstBuffer * buf)
 static void
 gst_sfxblur_reset (GstSensorFxBlur * sfxblur)
 {
-  sfxblur->width = 0;
-  sfxblur->height = 0;
-  sfxblur->stride = 0;
-  sfxblur->bpp = 0;
-  sfxblur->depth = 0;
-  sfxblur->endianness = 0;
+  g_free (sfxblur->scratch);
+  sfxblur->scratch = NULL;
+  sfxblur->scratch_size = 0;
 }
 
 gboolean
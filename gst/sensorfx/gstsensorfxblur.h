@@ -27,6 +27,8 @@
 
 #include <gst/video/gstvideofilter.h>
 
+#include "parallel.h"
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_SENSORFXBLUR \
@@ -40,6 +42,12 @@ G_BEGIN_DECLS
 #define GST_IS_SENSORFXBLUR_CLASS(klass) \
   (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_SENSORFXBLUR))
 
+typedef enum {
+  GST_SENSORFXBLUR_KERNEL_GAUSSIAN,
+  GST_SENSORFXBLUR_KERNEL_BOX,
+  GST_SENSORFXBLUR_KERNEL_DIFFRACTION
+} GstSensorFxBlurKernel;
+
 typedef struct _GstSensorFxBlur GstSensorFxBlur;
 typedef struct _GstSensorFxBlurClass GstSensorFxBlurClass;
 
@@ -54,16 +62,21 @@ struct _GstSensorFxBlur
 {
   GstVideoFilter element;
 
-  /* format */
-  gint width;
-  gint height;
-  guint stride;
-  gint bpp;
-  gint depth;
-  gint endianness;
-
   /* properties */
+  GstSensorFxBlurKernel kernel;
+  gdouble sigma;
+  guint size;
+  gdouble cutoff;
+  guint n_threads;
+
+  /* taps of the 1-D kernel applied to rows then columns */
+  gfloat *taps;
+  gint radius;
+  gboolean kernel_dirty;
 
+  GstParallelRunner *runner;
+  gfloat *scratch;
+  gsize scratch_size;
 };
 
 struct _GstSensorFxBlurClass
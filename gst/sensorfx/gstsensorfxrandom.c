@@ -0,0 +1,199 @@
+/* GStreamer
+ * Copyright (C) 2026 gst-plugins-vision authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Gaussian noise for the sensor effects. Uniform numbers come from
+ * xoshiro128**, turned into normal ones by the 128-layer Ziggurat method of
+ * Marsaglia and Tsang, "The Ziggurat Method for Generating Random
+ * Variables" (2000). About 99% of the samples take one uniform number, a
+ * multiply and a compare, with no transcendental function. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+
+#include "gstsensorfxrandom.h"
+
+#define ZIGGURAT_R 3.442619855899
+
+static guint32 zig_k[128];
+static gfloat zig_w[128];
+static gfloat zig_f[128];
+
+static gpointer
+gst_sfx_random_init_tables (gpointer data)
+{
+  const gdouble m = 2147483648.0;
+  const gdouble v = 9.91256303526217e-3;
+  gdouble d = ZIGGURAT_R, t = ZIGGURAT_R;
+  gdouble q;
+  gint i;
+
+  q = v / exp (-0.5 * d * d);
+  zig_k[0] = (guint32) ((d / q) * m);
+  zig_k[1] = 0;
+  zig_w[0] = (gfloat) (q / m);
+  zig_w[127] = (gfloat) (d / m);
+  zig_f[0] = 1.0f;
+  zig_f[127] = (gfloat) exp (-0.5 * d * d);
+
+  for (i = 126; i >= 1; i--) {
+    d = sqrt (-2.0 * log (v / d + exp (-0.5 * d * d)));
+    zig_k[i + 1] = (guint32) ((d / t) * m);
+    t = d;
+    zig_f[i] = (gfloat) exp (-0.5 * d * d);
+    zig_w[i] = (gfloat) (d / m);
+  }
+
+  return NULL;
+}
+
+static inline guint32
+rotl (guint32 x, gint k)
+{
+  return (x << k) | (x >> (32 - k));
+}
+
+static inline guint32
+gst_sfx_random_next (GstSfxRandom * rand)
+{
+  guint32 *s = rand->s;
+  const guint32 result = rotl (s[1] * 5, 7) * 9;
+  const guint32 t = s[1] << 9;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl (s[3], 11);
+
+  return result;
+}
+
+/* uniform in (0, 1], safe to take the log of */
+static inline gdouble
+gst_sfx_random_uniform (GstSfxRandom * rand)
+{
+  return ((gst_sfx_random_next (rand) >> 8) + 1) * (1.0 / 16777216.0);
+}
+
+/**
+ * gst_sfx_random_init:
+ * @rand: generator to seed
+ * @seed: seed, expanded to the full state with splitmix64
+ *
+ * Seeds @rand. Generators seeded alike produce the same sequence.
+ */
+void
+gst_sfx_random_init (GstSfxRandom * rand, guint64 seed)
+{
+  static GOnce tables_once = G_ONCE_INIT;
+  gint i;
+
+  g_once (&tables_once, gst_sfx_random_init_tables, NULL);
+
+  for (i = 0; i < 4; i += 2) {
+    guint64 z = (seed += G_GUINT64_CONSTANT (0x9e3779b97f4a7c15));
+
+    z = (z ^ (z >> 30)) * G_GUINT64_CONSTANT (0xbf58476d1ce4e5b9);
+    z = (z ^ (z >> 27)) * G_GUINT64_CONSTANT (0x94d049bb133111eb);
+    z ^= z >> 31;
+    rand->s[i] = (guint32) z;
+    rand->s[i + 1] = (guint32) (z >> 32);
+  }
+}
+
+/**
+ * gst_sfx_random_int:
+ * @rand: a seeded generator
+ *
+ * Returns: a uniformly distributed 32-bit number
+ */
+guint32
+gst_sfx_random_int (GstSfxRandom * rand)
+{
+  return gst_sfx_random_next (rand);
+}
+
+/* the rare case of a sample outside the rectangle of its layer */
+static gfloat
+gst_sfx_random_normal_tail (GstSfxRandom * rand, gint32 h, guint i)
+{
+  gdouble x, y;
+
+  for (;;) {
+    x = h * (gdouble) zig_w[i];
+
+    if (i == 0) {
+      do {
+        x = -log (gst_sfx_random_uniform (rand)) / ZIGGURAT_R;
+        y = -log (gst_sfx_random_uniform (rand));
+      } while (y + y < x * x);
+      return (gfloat) (h > 0 ? ZIGGURAT_R + x : -ZIGGURAT_R - x);
+    }
+
+    if (zig_f[i] + gst_sfx_random_uniform (rand) * (zig_f[i - 1] - zig_f[i])
+        < exp (-0.5 * x * x))
+      return (gfloat) x;
+
+    h = (gint32) gst_sfx_random_next (rand);
+    i = h & 127;
+    if ((guint32) ABS ((gint64) h) < zig_k[i])
+      return h * zig_w[i];
+  }
+}
+
+/**
+ * gst_sfx_random_normal:
+ * @rand: a seeded generator
+ *
+ * Returns: a sample of the standard normal distribution
+ */
+gfloat
+gst_sfx_random_normal (GstSfxRandom * rand)
+{
+  gint32 h = (gint32) gst_sfx_random_next (rand);
+  guint i = h & 127;
+
+  if ((guint32) ABS ((gint64) h) < zig_k[i])
+    return h * zig_w[i];
+
+  return gst_sfx_random_normal_tail (rand, h, i);
+}
+
+/**
+ * gst_sfx_random_fill_normal:
+ * @rand: a seeded generator
+ * @dest: (array length=n): where to store the samples
+ * @n: number of samples
+ * @sigma: standard deviation of the samples
+ *
+ * Fills @dest with samples of a zero mean normal distribution.
+ */
+void
+gst_sfx_random_fill_normal (GstSfxRandom * rand, gfloat * dest, gsize n,
+    gfloat sigma)
+{
+  gsize i;
+
+  for (i = 0; i < n; i++)
+    dest[i] = gst_sfx_random_normal (rand) * sigma;
+}
@@ -0,0 +1,41 @@
+/* GStreamer
+ * Copyright (C) 2026 gst-plugins-vision authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_SENSORFX_RANDOM_H__
+#define __GST_SENSORFX_RANDOM_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* xoshiro128** state, see https://prng.di.unimi.it/ */
+typedef struct
+{
+  guint32 s[4];
+} GstSfxRandom;
+
+void   gst_sfx_random_init (GstSfxRandom * rand, guint64 seed);
+guint32 gst_sfx_random_int (GstSfxRandom * rand);
+gfloat gst_sfx_random_normal (GstSfxRandom * rand);
+void   gst_sfx_random_fill_normal (GstSfxRandom * rand, gfloat * dest,
+    gsize n, gfloat sigma);
+
+G_END_DECLS
+
+#endif /* __GST_SENSORFX_RANDOM_H__ */
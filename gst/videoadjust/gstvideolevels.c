@@ -39,12 +39,15 @@
 #endif
 
 #include <string.h>
+#include <math.h>
 
 #include "gstvideolevels.h"
 #include "genicampixelformat.h"
 
 #include <gst/video/video.h>
 
+#include "gstvideolevelsorc-dist.h"
+
 /* GstVideoLevels signals and args */
 enum
 {
@@ -67,6 +70,15 @@ enum
   PROP_ROI_Y,
   PROP_ROI_WIDTH,
   PROP_ROI_HEIGHT,
+  PROP_CURVE,
+  PROP_GAMMA,
+  PROP_CLIP_LIMIT,
+  PROP_TILES_X,
+  PROP_TILES_Y,
+  PROP_HISTOGRAM_STEP,
+  PROP_SMOOTHING,
+  PROP_SINGLE_PASS,
+  PROP_N_THREADS,
   PROP_LAST
 };
 
@@ -84,6 +96,15 @@ static GParamSpec *properties[PROP_LAST];
 #define DEFAULT_PROP_ROI_Y -1
 #define DEFAULT_PROP_ROI_WIDTH 0
 #define DEFAULT_PROP_ROI_HEIGHT 0
+#define DEFAULT_PROP_CURVE GST_VIDEOLEVELS_CURVE_LINEAR
+#define DEFAULT_PROP_GAMMA 1.0
+#define DEFAULT_PROP_CLIP_LIMIT 4.0
+#define DEFAULT_PROP_TILES_X 8
+#define DEFAULT_PROP_TILES_Y 8
+#define DEFAULT_PROP_HISTOGRAM_STEP 1
+#define DEFAULT_PROP_SMOOTHING 0.0
+#define DEFAULT_PROP_SINGLE_PASS FALSE
+#define DEFAULT_PROP_N_THREADS 0
 
 /* the capabilities of the inputs and outputs */
 static GstStaticPadTemplate gst_videolevels_src_template =
@@ -125,6 +146,27 @@ gst_videolevels_auto_get_type (void)
   return videolevels_auto_type;
 }
 
+#define GST_TYPE_VIDEOLEVELS_CURVE (gst_videolevels_curve_get_type())
+static GType
+gst_videolevels_curve_get_type (void)
+{
+  static GType videolevels_curve_type = 0;
+  static const GEnumValue videolevels_curve[] = {
+    {GST_VIDEOLEVELS_CURVE_LINEAR, "linear", "linear"},
+    {GST_VIDEOLEVELS_CURVE_GAMMA, "gamma", "gamma"},
+    {GST_VIDEOLEVELS_CURVE_LOG, "log", "log"},
+    {GST_VIDEOLEVELS_CURVE_EQUALIZE, "equalize", "equalize"},
+    {GST_VIDEOLEVELS_CURVE_CLAHE, "clahe", "clahe"},
+    {0, NULL, NULL},
+  };
+
+  if (!videolevels_curve_type) {
+    videolevels_curve_type =
+        g_enum_register_static ("GstVideoLevelsCurve", videolevels_curve);
+  }
+  return videolevels_curve_type;
+}
+
 /* GObject vmethod declarations */
 static void gst_videolevels_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
@@ -143,10 +185,24 @@ static GstFlowReturn gst_videolevels_transform (GstBaseTransform * trans,
 /* GstVideoLevels method declarations */
 static void gst_videolevels_reset (GstVideoLevels * filter);
 static gboolean gst_videolevels_calculate_lut (GstVideoLevels * videolevels);
+static void gst_videolevels_histogram_reset (GstVideoLevels * videolevels,
+    GstParallelRunner * runner);
+static void gst_videolevels_histogram_row (GstVideoLevels * videolevels,
+    gint * hist, const guint8 * row);
+static void gst_videolevels_histogram_merge (GstVideoLevels * videolevels,
+    GstParallelRunner * runner);
 static gboolean gst_videolevels_calculate_histogram (GstVideoLevels *
     videolevels, guint16 * data);
+static void gst_videolevels_check_roi (GstVideoLevels * filt);
+static gboolean gst_videolevels_find_levels (GstVideoLevels * filt);
 static gboolean gst_videolevels_auto_adjust (GstVideoLevels * videolevels,
     guint16 * data);
+static void gst_videolevels_clahe_free (GstVideoLevels * videolevels);
+static void gst_videolevels_clahe_setup (GstVideoLevels * videolevels);
+static void gst_videolevels_clahe_calculate (GstVideoLevels * videolevels,
+    const guint8 * data);
+static void gst_videolevels_clahe_rows (GstVideoLevels * videolevels,
+    const guint8 * in_data, guint8 * out_data, gint row_start, gint row_end);
 static void gst_videolevels_check_passthrough (GstVideoLevels * videolevels);
 
 /* setup debug */
@@ -172,6 +228,12 @@ gst_videolevels_dispose (GObject * object)
   GST_DEBUG ("dispose");
 
   g_free (videolevels->lookup_table);
+  videolevels->lookup_table = NULL;
+
+  if (videolevels->runner) {
+    gst_parallel_runner_free (videolevels->runner);
+    videolevels->runner = NULL;
+  }
 
   gst_videolevels_reset (videolevels);
 
@@ -260,6 +322,42 @@ gst_videolevels_class_init (GstVideoLevelsClass * klass)
       g_param_spec_int ("roi-height", "ROI height",
           "Height of the ROI when auto is enabled (0 uses 1/2 of the image height)",
           0, G_MAXINT, DEFAULT_PROP_ROI_HEIGHT, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_CURVE,
+      g_param_spec_enum ("curve", "Curve",
+          "Tone curve applied between the input and output levels",
+          GST_TYPE_VIDEOLEVELS_CURVE, DEFAULT_PROP_CURVE, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_GAMMA,
+      g_param_spec_double ("gamma", "Gamma",
+          "Exponent of the gamma curve, values below 1 brighten dark areas",
+          0.01, 100.0, DEFAULT_PROP_GAMMA, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_CLIP_LIMIT,
+      g_param_spec_double ("clip-limit", "Clip limit",
+          "Limit of each CLAHE histogram bin, as a multiple of the mean bin count",
+          1.0, 1000.0, DEFAULT_PROP_CLIP_LIMIT, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_TILES_X,
+      g_param_spec_int ("tiles-x", "Tiles x",
+          "Number of CLAHE tiles across the image", 1, 64,
+          DEFAULT_PROP_TILES_X, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_TILES_Y,
+      g_param_spec_int ("tiles-y", "Tiles y",
+          "Number of CLAHE tiles down the image", 1, 64,
+          DEFAULT_PROP_TILES_Y, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_HISTOGRAM_STEP,
+      g_param_spec_int ("histogram-step", "Histogram step",
+          "Sample every Nth row and column of the ROI when auto is enabled",
+          1, G_MAXINT, DEFAULT_PROP_HISTOGRAM_STEP, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_SMOOTHING,
+      g_param_spec_double ("smoothing", "Smoothing",
+          "Weight of the previous histogram in a moving average when auto is "
+          "enabled (0 uses only the current frame)",
+          0, 0.999, DEFAULT_PROP_SMOOTHING, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_SINGLE_PASS,
+      g_param_spec_boolean ("single-pass", "Single pass",
+          "Compute the auto histogram while applying the current levels, so "
+          "new levels take effect on the following frame",
+          DEFAULT_PROP_SINGLE_PASS, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      gst_parallel_param_spec_n_threads ());
 
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&gst_videolevels_sink_template));
@@ -294,8 +392,7 @@ gst_videolevels_init (GstVideoLevels * videolevels)
   GST_DEBUG_OBJECT (videolevels, "init class instance");
 
   videolevels->passthrough = FALSE;
-
-  videolevels->lookup_table = g_new (guint8, G_MAXUINT16 + 1);
+  videolevels->n_threads = DEFAULT_PROP_N_THREADS;
 
   gst_videolevels_reset (videolevels);
 }
@@ -319,19 +416,25 @@ gst_videolevels_set_property (GObject * object, guint prop_id,
   switch (prop_id) {
     case PROP_LOWIN:
       videolevels->lower_input = g_value_get_int (value);
-      gst_videolevels_calculate_lut (videolevels);
+      videolevels->lut_dirty = TRUE;
+      gst_videolevels_check_passthrough (videolevels);
       break;
     case PROP_HIGHIN:
       videolevels->upper_input = g_value_get_int (value);
-      gst_videolevels_calculate_lut (videolevels);
+      videolevels->lut_dirty = TRUE;
+      gst_videolevels_check_passthrough (videolevels);
       break;
     case PROP_LOWOUT:
       videolevels->lower_output = g_value_get_int (value);
-      gst_videolevels_calculate_lut (videolevels);
+      videolevels->lut_dirty = TRUE;
+      videolevels->tiles_valid = FALSE;
+      gst_videolevels_check_passthrough (videolevels);
       break;
     case PROP_HIGHOUT:
       videolevels->upper_output = g_value_get_int (value);
-      gst_videolevels_calculate_lut (videolevels);
+      videolevels->lut_dirty = TRUE;
+      videolevels->tiles_valid = FALSE;
+      gst_videolevels_check_passthrough (videolevels);
       break;
     case PROP_AUTO:{
       videolevels->auto_adjust = g_value_get_enum (value);
@@ -343,11 +446,9 @@ gst_videolevels_set_property (GObject * object, guint prop_id,
       break;
     case PROP_LOWER_SATURATION:
       videolevels->lower_pix_sat = g_value_get_double (value);
-      gst_videolevels_calculate_lut (videolevels);
       break;
     case PROP_UPPER_SATURATION:
       videolevels->upper_pix_sat = g_value_get_double (value);
-      gst_videolevels_calculate_lut (videolevels);
       break;
     case PROP_ROI_X:
       videolevels->roi_x = g_value_get_int (value);
@@ -365,6 +466,41 @@ gst_videolevels_set_property (GObject * object, guint prop_id,
       videolevels->roi_height = g_value_get_int (value);
       videolevels->check_roi = TRUE;
       break;
+    case PROP_CURVE:
+      videolevels->curve = g_value_get_enum (value);
+      videolevels->lut_dirty = TRUE;
+      gst_videolevels_check_passthrough (videolevels);
+      break;
+    case PROP_GAMMA:
+      videolevels->gamma = g_value_get_double (value);
+      videolevels->lut_dirty = TRUE;
+      break;
+    case PROP_CLIP_LIMIT:
+      videolevels->clip_limit = g_value_get_double (value);
+      videolevels->tiles_valid = FALSE;
+      break;
+    case PROP_TILES_X:
+      videolevels->tiles_x = g_value_get_int (value);
+      videolevels->tiles_valid = FALSE;
+      break;
+    case PROP_TILES_Y:
+      videolevels->tiles_y = g_value_get_int (value);
+      videolevels->tiles_valid = FALSE;
+      break;
+    case PROP_HISTOGRAM_STEP:
+      videolevels->histogram_step = g_value_get_int (value);
+      videolevels->histogram_avg_valid = FALSE;
+      break;
+    case PROP_SMOOTHING:
+      videolevels->smoothing = g_value_get_double (value);
+      videolevels->histogram_avg_valid = FALSE;
+      break;
+    case PROP_SINGLE_PASS:
+      videolevels->single_pass = g_value_get_boolean (value);
+      break;
+    case PROP_N_THREADS:
+      videolevels->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -424,6 +560,33 @@ gst_videolevels_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_ROI_HEIGHT:
       g_value_set_int (value, videolevels->roi_height);
       break;
+    case PROP_CURVE:
+      g_value_set_enum (value, videolevels->curve);
+      break;
+    case PROP_GAMMA:
+      g_value_set_double (value, videolevels->gamma);
+      break;
+    case PROP_CLIP_LIMIT:
+      g_value_set_double (value, videolevels->clip_limit);
+      break;
+    case PROP_TILES_X:
+      g_value_set_int (value, videolevels->tiles_x);
+      break;
+    case PROP_TILES_Y:
+      g_value_set_int (value, videolevels->tiles_y);
+      break;
+    case PROP_HISTOGRAM_STEP:
+      g_value_set_int (value, videolevels->histogram_step);
+      break;
+    case PROP_SMOOTHING:
+      g_value_set_double (value, videolevels->smoothing);
+      break;
+    case PROP_SINGLE_PASS:
+      g_value_set_boolean (value, videolevels->single_pass);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, videolevels->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -619,6 +782,7 @@ gst_videolevels_set_caps (GstBaseTransform * trans, GstCaps * incaps,
   levels->stride_in = GST_VIDEO_INFO_COMP_STRIDE (&invinfo, 0);
   levels->stride_out = GST_VIDEO_INFO_COMP_STRIDE (&outvinfo, 0);
   levels->bpp_in = invinfo.finfo->bits;
+  levels->endianness_in = G_BYTE_ORDER;
 
   st = gst_caps_get_structure (incaps, 0);
 
@@ -648,14 +812,153 @@ gst_videolevels_set_caps (GstBaseTransform * trans, GstCaps * incaps,
   g_assert (levels->bpp_in >= 1 && levels->bpp_in <= 16);
 
   levels->nbins = MIN (4096, 1 << levels->bpp_in);
+  if ((levels->nbins & (levels->nbins - 1)) == 0)
+    levels->histogram_shift =
+        levels->bpp_in - (g_bit_storage (levels->nbins) - 1);
+  else
+    levels->histogram_shift = -1;
+
+  g_free (levels->histogram_avg);
+  levels->histogram_avg = g_new (gfloat, levels->nbins);
+  levels->histogram_avg_valid = FALSE;
+  levels->histogram_valid = FALSE;
+  levels->tiles_valid = FALSE;
 
   levels->check_roi = TRUE;
 
+  /* the table only needs an entry per possible input value */
+  g_free (levels->lookup_table);
+  levels->lookup_table = g_new (guint8, 1 << levels->bpp_in);
+  levels->lut_dirty = TRUE;
+
   res = gst_videolevels_calculate_lut (levels);
 
   return res;
 }
 
+typedef struct
+{
+  GstVideoLevels *levels;
+  guint8 *in_data;
+  guint8 *out_data;
+  gboolean histogram;
+} GstVideoLevelsRows;
+
+/* (re)create the worker pool if the number of threads changed */
+static GstParallelRunner *
+gst_videolevels_get_runner (GstVideoLevels * videolevels)
+{
+  GstParallelRunner *runner = videolevels->runner;
+
+  gst_parallel_runner_ensure (&videolevels->runner, videolevels->n_threads);
+  if (videolevels->runner != runner)
+    GST_DEBUG_OBJECT (videolevels, "Using %d threads",
+        gst_parallel_runner_get_n_threads (videolevels->runner));
+
+  return videolevels->runner;
+}
+
+static void
+gst_videolevels_map_rows (GstVideoLevels * videolevels, guint8 * in_data,
+    guint8 * out_data, gint height)
+{
+  const guint8 *lut = videolevels->lookup_table;
+  gint r, c;
+
+  if (videolevels->linear) {
+    const gint low_in = videolevels->lower_input;
+    const gint range = videolevels->upper_input - videolevels->lower_input;
+    const gint low_out = videolevels->lower_output;
+
+    if (videolevels->bpp_in > 8) {
+      if (videolevels->endianness_in == G_BYTE_ORDER)
+        videolevels_orc_linear_u16 (out_data, videolevels->stride_out,
+            (guint16 *) in_data, videolevels->stride_in, low_in, range,
+            videolevels->scale, low_out, videolevels->width, height);
+      else
+        videolevels_orc_linear_u16_swap (out_data, videolevels->stride_out,
+            (guint16 *) in_data, videolevels->stride_in, low_in, range,
+            videolevels->scale, low_out, videolevels->width, height);
+    } else {
+      videolevels_orc_linear_u8 (out_data, videolevels->stride_out, in_data,
+          videolevels->stride_in, low_in, range, videolevels->scale, low_out,
+          videolevels->width, height);
+    }
+  } else if (videolevels->bpp_in > 8) {
+    const gboolean swap = videolevels->endianness_in != G_BYTE_ORDER;
+    /* the table has 1 << bpp_in entries, clamp samples with stray high bits */
+    const guint16 max_in = (1 << videolevels->bpp_in) - 1;
+
+    for (r = 0; r < height; r++) {
+      guint16 *src = (guint16 *) in_data;
+      guint8 *dst = out_data;
+
+      if (swap) {
+        for (c = 0; c < videolevels->width; c++)
+          dst[c] = lut[MIN (GUINT16_SWAP_LE_BE (src[c]), max_in)];
+      } else {
+        for (c = 0; c < videolevels->width; c++)
+          dst[c] = lut[MIN (src[c], max_in)];
+      }
+
+      in_data += videolevels->stride_in;
+      out_data += videolevels->stride_out;
+    }
+  } else {
+    for (r = 0; r < height; r++) {
+      guint8 *src = (guint8 *) in_data;
+      guint8 *dst = out_data;
+
+      for (c = 0; c < videolevels->width; c++) {
+        //GST_LOG_OBJECT (videolevels, "Converting pixel (%d, %d), %d->%d", c, r, *src, lut[*src]);
+        *dst++ = lut[*src++];
+      }
+
+      in_data += videolevels->stride_in;
+      out_data += videolevels->stride_out;
+    }
+  }
+}
+
+static void
+gst_videolevels_transform_rows (gpointer user_data, guint band,
+    gint row_start, gint row_end)
+{
+  GstVideoLevelsRows *rows = (GstVideoLevelsRows *) user_data;
+  GstVideoLevels *videolevels = rows->levels;
+  guint8 *in_data = rows->in_data + row_start * videolevels->stride_in;
+  guint8 *out_data = rows->out_data + row_start * videolevels->stride_out;
+  gint *hist;
+  gint r, roi_end;
+
+  if (videolevels->curve == GST_VIDEOLEVELS_CURVE_CLAHE) {
+    gst_videolevels_clahe_rows (videolevels, rows->in_data, rows->out_data,
+        row_start, row_end);
+    return;
+  }
+
+  if (!rows->histogram) {
+    gst_videolevels_map_rows (videolevels, in_data, out_data,
+        row_end - row_start);
+    return;
+  }
+
+  /* count each sampled ROI row right before mapping it, so the frame is only
+   * read from memory once */
+  hist = videolevels->histogram + band * videolevels->nbins;
+  roi_end = videolevels->roi_y + videolevels->roi_height;
+  for (r = row_start; r < row_end; r++) {
+    if (r >= videolevels->roi_y && r < roi_end &&
+        (r - videolevels->roi_y) % videolevels->histogram_step == 0)
+      gst_videolevels_histogram_row (videolevels, hist, in_data);
+
+    gst_videolevels_map_rows (videolevels, in_data, out_data, 1);
+
+    in_data += videolevels->stride_in;
+    out_data += videolevels->stride_out;
+  }
+}
+
 /**
  * gst_videolevels_transform:
  * @base: #GstBaseTransform
@@ -674,10 +977,11 @@ gst_videolevels_transform (GstBaseTransform * trans, GstBuffer * inbuf,
   GstClockTimeDiff elapsed;
   GstClockTime start =
       gst_clock_get_time (gst_element_get_clock (GST_ELEMENT (videolevels)));
-  gint r, c;
   guint8 *in_data, *out_data;
-  guint8 *lut;
+  GstVideoLevelsRows rows;
   GstMapInfo inminfo, outminfo;
+  GstParallelRunner *runner;
+  gboolean adjust = FALSE;
 
   GST_LOG_OBJECT (videolevels, "Performing non-inplace transform");
 
@@ -692,9 +996,13 @@ gst_videolevels_transform (GstBaseTransform * trans, GstBuffer * inbuf,
   in_data = inminfo.data;
   out_data = outminfo.data;
 
+  /* the whole frame uses this runner, as the band histograms are sized for
+   * its number of threads */
+  runner = gst_videolevels_get_runner (videolevels);
+
   if (videolevels->auto_adjust == 1) {
     GST_DEBUG_OBJECT (videolevels, "Auto adjusting levels (once)");
-    gst_videolevels_auto_adjust (videolevels, (guint16 *) in_data);
+    adjust = TRUE;
     videolevels->auto_adjust = 0;
     g_object_notify (G_OBJECT (videolevels), "auto");
   } else if (videolevels->auto_adjust == 2) {
@@ -705,38 +1013,60 @@ gst_videolevels_transform (GstBaseTransform * trans, GstBuffer * inbuf,
         || elapsed >= (GstClockTimeDiff) videolevels->interval || elapsed < 0) {
       GST_LOG_OBJECT (videolevels, "Auto adjusting levels (%d ns since last)",
           elapsed);
-      gst_videolevels_auto_adjust (videolevels, (guint16 *) in_data);
+      adjust = TRUE;
       videolevels->last_auto_timestamp = GST_BUFFER_TIMESTAMP (inbuf);
     }
   }
 
-  lut = videolevels->lookup_table;
-  if (videolevels->bpp_in > 8) {
-    for (r = 0; r < videolevels->height; r++) {
-      guint16 *src = (guint16 *) in_data;
-      guint8 *dst = out_data;
-
-      for (c = 0; c < videolevels->width; c++) {
-        //GST_LOG_OBJECT (videolevels, "Converting pixel (%d, %d), %d->%d", c, r, *src, lut[*src]);
-        *dst++ = lut[*src++];
-      }
+  /* adaptive curves have nothing to apply until they have seen a frame, but
+   * with auto off the input levels are left alone */
+  if (videolevels->curve == GST_VIDEOLEVELS_CURVE_EQUALIZE &&
+      !videolevels->histogram_valid && !adjust) {
+    if (videolevels->check_roi) {
+      gst_videolevels_check_roi (videolevels);
+      videolevels->check_roi = FALSE;
+    }
+    gst_videolevels_calculate_histogram (videolevels, (guint16 *) in_data);
+    videolevels->histogram_valid = TRUE;
+    videolevels->lut_dirty = TRUE;
+  }
 
-      in_data += videolevels->stride_in;
-      out_data += videolevels->stride_out;
+  if (videolevels->curve == GST_VIDEOLEVELS_CURVE_CLAHE) {
+    if (!videolevels->tiles_valid) {
+      gst_videolevels_clahe_setup (videolevels);
+      adjust = TRUE;
     }
-  } else {
-    for (r = 0; r < videolevels->height; r++) {
-      guint8 *src = (guint8 *) in_data;
-      guint8 *dst = out_data;
+    if (adjust)
+      gst_videolevels_clahe_calculate (videolevels, in_data);
+    adjust = FALSE;
+  }
 
-      for (c = 0; c < videolevels->width; c++) {
-        //GST_LOG_OBJECT (videolevels, "Converting pixel (%d, %d), %d->%d", c, r, *src, lut[*src]);
-        *dst++ = lut[*src++];
-      }
+  if (adjust && !videolevels->single_pass)
+    gst_videolevels_auto_adjust (videolevels, (guint16 *) in_data);
 
-      in_data += videolevels->stride_in;
-      out_data += videolevels->stride_out;
+  rows.levels = videolevels;
+  rows.in_data = in_data;
+  rows.out_data = out_data;
+  rows.histogram = adjust && videolevels->single_pass;
+
+  if (rows.histogram) {
+    if (videolevels->check_roi) {
+      gst_videolevels_check_roi (videolevels);
+      videolevels->check_roi = FALSE;
     }
+    gst_videolevels_histogram_reset (videolevels, runner);
+  }
+
+  if (videolevels->lut_dirty)
+    gst_videolevels_calculate_lut (videolevels);
+
+  gst_parallel_runner_run_rows (runner, videolevels->height, 1,
+      gst_videolevels_transform_rows, &rows);
+
+  /* in single pass mode the levels found here apply from the next frame */
+  if (rows.histogram) {
+    gst_videolevels_histogram_merge (videolevels, runner);
+    gst_videolevels_find_levels (videolevels);
   }
 
   gst_buffer_unmap (inbuf, &inminfo);
@@ -775,6 +1105,14 @@ gst_videolevels_reset (GstVideoLevels * videolevels)
   videolevels->roi_y = DEFAULT_PROP_ROI_Y;
   videolevels->roi_width = DEFAULT_PROP_ROI_WIDTH;
   videolevels->roi_height = DEFAULT_PROP_ROI_HEIGHT;
+  videolevels->curve = DEFAULT_PROP_CURVE;
+  videolevels->gamma = DEFAULT_PROP_GAMMA;
+  videolevels->clip_limit = DEFAULT_PROP_CLIP_LIMIT;
+  videolevels->tiles_x = DEFAULT_PROP_TILES_X;
+  videolevels->tiles_y = DEFAULT_PROP_TILES_Y;
+  videolevels->histogram_step = DEFAULT_PROP_HISTOGRAM_STEP;
+  videolevels->smoothing = DEFAULT_PROP_SMOOTHING;
+  videolevels->single_pass = DEFAULT_PROP_SINGLE_PASS;
 
   videolevels->auto_adjust = DEFAULT_PROP_AUTO;
   videolevels->interval = DEFAULT_PROP_INTERVAL;
@@ -784,34 +1122,146 @@ gst_videolevels_reset (GstVideoLevels * videolevels)
 
   /* if GRAY8, this will be set in set_info */
   videolevels->nbins = 4096;
+  videolevels->histogram_shift = 4;
 
   g_free (videolevels->histogram);
   videolevels->histogram = NULL;
+  videolevels->histogram_size = 0;
+
+  g_free (videolevels->histogram_avg);
+  videolevels->histogram_avg = NULL;
+  videolevels->histogram_avg_valid = FALSE;
+  videolevels->histogram_valid = FALSE;
+
+  gst_videolevels_clahe_free (videolevels);
 }
 
 #define GINT_CLAMP(x, low, high) ((gint)(CLAMP((x),(low),(high))))
 #define GUINT8_CLAMP(x, low, high) ((guint8)(CLAMP((x),(low),(high))))
 
+/* histogram bin of a native endian sample */
+static inline gint
+gst_videolevels_bin (GstVideoLevels * videolevels, gint value)
+{
+  const gint nbins = videolevels->nbins;
+
+  if (videolevels->histogram_shift >= 0)
+    return MIN (value >> videolevels->histogram_shift, nbins - 1);
+  else
+    return GINT_CLAMP (value * (nbins - 1.0) /
+        ((1 << videolevels->bpp_in) - 1), 0, nbins - 1);
+}
+
+/**
+ * gst_videolevels_calculate_curve:
+ * @videolevels: #GstVideoLevels
+ * @lut: table of 1 << bpp_in entries
+ *
+ * Fill the table for the gamma, log and equalize curves. Inputs are
+ * normalized to [0, 1] between the input levels, and the curve output is
+ * scaled between the output levels.
+ */
+static void
+gst_videolevels_calculate_curve (GstVideoLevels * videolevels, guint8 * lut)
+{
+  const gint max_in = (1 << videolevels->bpp_in) - 1;
+  const gint low_in = videolevels->lower_input;
+  const gint high_in = videolevels->upper_input;
+  const gint low_out = videolevels->lower_output;
+  const gint high_out = videolevels->upper_output;
+  const gint lo = MIN (low_in, high_in);
+  const gint hi = MAX (low_in, high_in);
+  gdouble *cdf = NULL;
+  gint i;
+
+  GST_LOG_OBJECT (videolevels, "Make %s LUT mapping (%d, %d) -> (%d, %d)",
+      videolevels->curve == GST_VIDEOLEVELS_CURVE_GAMMA ? "gamma" :
+      videolevels->curve == GST_VIDEOLEVELS_CURVE_LOG ? "log" : "equalized",
+      low_in, high_in, low_out, high_out);
+
+  if (videolevels->curve == GST_VIDEOLEVELS_CURVE_EQUALIZE) {
+    const gint *hist = videolevels->histogram;
+    const gfloat *avg = NULL;
+    const gint bin_lo = gst_videolevels_bin (videolevels, lo);
+    const gint bin_hi = gst_videolevels_bin (videolevels, hi);
+    gdouble sum = 0;
+
+    if (videolevels->smoothing > 0 && videolevels->histogram_avg_valid)
+      avg = videolevels->histogram_avg;
+
+    /* cumulative distribution of the bins between the input levels */
+    cdf = g_new0 (gdouble, videolevels->nbins);
+    for (i = bin_lo; i <= bin_hi; i++) {
+      sum += avg ? avg[i] : hist[i];
+      cdf[i] = sum;
+    }
+    for (i = bin_lo; i <= bin_hi; i++)
+      cdf[i] = sum > 0 ? cdf[i] / sum : (gdouble) (i - bin_lo + 1) /
+          (bin_hi - bin_lo + 1);
+  }
+
+  for (i = 0; i <= max_in; i++) {
+    gdouble t;
+
+    if (i <= lo)
+      t = 0.0;
+    else if (i >= hi)
+      t = 1.0;
+    else
+      t = (i - lo) / (gdouble) (hi - lo);
+
+    switch (videolevels->curve) {
+      case GST_VIDEOLEVELS_CURVE_GAMMA:
+        t = pow (t, videolevels->gamma);
+        break;
+      case GST_VIDEOLEVELS_CURVE_LOG:
+        t = log1p (t * (hi - lo)) / log1p (MAX (hi - lo, 1));
+        break;
+      case GST_VIDEOLEVELS_CURVE_EQUALIZE:
+        if (i > lo && i < hi)
+          t = cdf[gst_videolevels_bin (videolevels, i)];
+        break;
+      default:
+        break;
+    }
+
+    /* inverted input levels invert the curve */
+    if (low_in > high_in)
+      t = 1.0 - t;
+
+    lut[i] = (guint8) (low_out + (high_out - low_out) * t + 0.5);
+  }
+
+  g_free (cdf);
+}
+
+/**
+ * gst_videolevels_calculate_lut:
+ * @videolevels: #GstVideoLevels
+ *
+ * Validate the levels and update the mapping. The table is only rebuilt
+ * when the levels differ from the ones it was last built for.
+ *
+ * Returns: TRUE on success
+ */
 static gboolean
 gst_videolevels_calculate_lut (GstVideoLevels * videolevels)
 {
   gint i;
-  gdouble m;
-  gdouble b;
+  gint64 slope, acc;
   guint8 *lut = (guint8 *) videolevels->lookup_table;
   const guint16 max_in = (1 << videolevels->bpp_in) - 1;
   guint16 low_in;
   guint16 high_in;
-  const guint8 max_out = (1 << videolevels->bpp_out) - 1;
   const guint8 low_out = videolevels->lower_output;
   const guint8 high_out = videolevels->upper_output;
+  const gint min_out = MIN (low_out, high_out);
+  const gint max_out = MAX (low_out, high_out);
 
   if (videolevels->bpp_in == 0) {
     return FALSE;
   }
 
-  GST_LOG_OBJECT (videolevels, "Calculating lookup table");
-
   if (videolevels->lower_input < 0 || videolevels->lower_input > max_in) {
     videolevels->lower_input = 0;
     g_object_notify_by_pspec (G_OBJECT (videolevels), properties[PROP_LOWIN]);
@@ -823,41 +1273,195 @@ gst_videolevels_calculate_lut (GstVideoLevels * videolevels)
 
   gst_videolevels_check_passthrough (videolevels);
 
-  if (!videolevels->passthrough) {
-    low_in = videolevels->lower_input;
-    high_in = videolevels->upper_input;
+  if (videolevels->passthrough)
+    return TRUE;
+
+  low_in = videolevels->lower_input;
+  high_in = videolevels->upper_input;
+
+  if (!videolevels->lut_dirty && low_in == videolevels->lut_low_in &&
+      high_in == videolevels->lut_high_in &&
+      low_out == videolevels->lut_low_out &&
+      high_out == videolevels->lut_high_out &&
+      videolevels->curve == videolevels->lut_curve &&
+      videolevels->gamma == videolevels->lut_gamma)
+    return TRUE;
+
+  videolevels->lut_low_in = low_in;
+  videolevels->lut_high_in = high_in;
+  videolevels->lut_low_out = low_out;
+  videolevels->lut_high_out = high_out;
+  videolevels->lut_curve = videolevels->curve;
+  videolevels->lut_gamma = videolevels->gamma;
+  videolevels->lut_dirty = FALSE;
+
+  /* CLAHE uses per tile tables instead */
+  if (videolevels->curve == GST_VIDEOLEVELS_CURVE_CLAHE) {
+    videolevels->linear = FALSE;
+    return TRUE;
+  }
 
-    GST_LOG_OBJECT (videolevels, "Make linear LUT mapping (%d, %d) -> (%d, %d)",
+  if (videolevels->curve != GST_VIDEOLEVELS_CURVE_LINEAR &&
+      (videolevels->curve != GST_VIDEOLEVELS_CURVE_EQUALIZE ||
+          videolevels->histogram_valid)) {
+    videolevels->linear = FALSE;
+    gst_videolevels_calculate_curve (videolevels, lut);
+    return TRUE;
+  }
+
+  /* increasing mappings are computed directly in 8.24 fixed point, rounding
+   * the slope up so that high_in still maps to high_out */
+  videolevels->linear = low_in <= high_in && low_out <= high_out;
+  if (videolevels->linear) {
+    GST_LOG_OBJECT (videolevels, "Use linear mapping (%d, %d) -> (%d, %d)",
         low_in, high_in, low_out, high_out);
 
     if (low_in == high_in)
-      m = 0.0;
+      videolevels->scale = 0;
     else
-      m = (high_out - low_out) / (gdouble) (high_in - low_in);
-
-    b = low_out - m * low_in;
+      videolevels->scale =
+          (guint32) ((((guint64) (high_out - low_out) << 24) + high_in -
+              low_in - 1) / (high_in - low_in));
 
-    if (videolevels->endianness_in == G_LITTLE_ENDIAN)
-      for (i = 0; i < G_MAXUINT16; i++)
-        lut[i] = GUINT8_CLAMP (m * GUINT16_FROM_LE (i) + b, low_out, high_out);
-    else if (videolevels->endianness_in == G_BIG_ENDIAN)
-      for (i = 0; i < G_MAXUINT16; i++)
-        lut[i] = GUINT8_CLAMP (m * GUINT16_FROM_BE (i) + b, low_out, high_out);
-    else
-      for (i = 0; i < G_MAXUINT16; i++)
-        lut[i] = GUINT8_CLAMP (m * i + b, low_out, high_out);
+    return TRUE;
   }
 
+  GST_LOG_OBJECT (videolevels, "Make linear LUT mapping (%d, %d) -> (%d, %d)",
+      low_in, high_in, low_out, high_out);
+
+  /* 16.16 fixed point, stepping the output along from the value at zero */
+  if (low_in == high_in)
+    slope = 0;
+  else
+    slope = ((gint64) (high_out - low_out) << 16) / (high_in - low_in);
+
+  acc = ((gint64) low_out << 16) - slope * low_in;
+
+  /* the table is indexed by native endian values, byte swapping is done
+   * while applying it */
+  for (i = 0; i <= max_in; i++, acc += slope)
+    lut[i] = GUINT8_CLAMP (acc >> 16, min_out, max_out);
+
   return TRUE;
 }
 
 
+/* count every histogram-step sample of the ROI columns of one row */
+static void
+gst_videolevels_histogram_row (GstVideoLevels * videolevels, gint * hist,
+    const guint8 * row)
+{
+  const gint nbins = videolevels->nbins;
+  const gint step = videolevels->histogram_step;
+  const gint shift = videolevels->histogram_shift;
+  const gint maxVal = (1 << videolevels->bpp_in) - 1;
+  const gfloat factor = (gfloat) ((nbins - 1.0) / maxVal);
+  const gint c0 = videolevels->roi_x;
+  const gint c1 = videolevels->roi_x + videolevels->roi_width;
+  gint c;
+
+  if (videolevels->bpp_in > 8) {
+    const guint16 *data = (const guint16 *) row;
+    const gboolean swap = videolevels->endianness_in != G_BYTE_ORDER;
+
+    if (shift >= 0) {
+      /* samples may hold more than bpp_in bits, so still clamp */
+      if (swap) {
+        for (c = c0; c < c1; c += step)
+          hist[MIN (GUINT16_SWAP_LE_BE (data[c]) >> shift, nbins - 1)]++;
+      } else {
+        for (c = c0; c < c1; c += step)
+          hist[MIN (data[c] >> shift, nbins - 1)]++;
+      }
+    } else if (swap) {
+      for (c = c0; c < c1; c += step)
+        hist[GINT_CLAMP (GUINT16_SWAP_LE_BE (data[c]) * factor, 0,
+                nbins - 1)]++;
+    } else {
+      for (c = c0; c < c1; c += step)
+        hist[GINT_CLAMP (data[c] * factor, 0, nbins - 1)]++;
+    }
+  } else {
+    if (shift >= 0) {
+      for (c = c0; c < c1; c += step)
+        hist[MIN (row[c] >> shift, nbins - 1)]++;
+    } else {
+      for (c = c0; c < c1; c += step)
+        hist[GINT_CLAMP (row[c] * factor, 0, nbins - 1)]++;
+    }
+  }
+}
+
+typedef struct
+{
+  GstVideoLevels *levels;
+  const guint8 *data;
+} GstVideoLevelsHistogramRows;
+
+static void
+gst_videolevels_histogram_rows (gpointer user_data, guint band,
+    gint row_start, gint row_end)
+{
+  GstVideoLevelsHistogramRows *rows = (GstVideoLevelsHistogramRows *) user_data;
+  GstVideoLevels *videolevels = rows->levels;
+  gint *hist = videolevels->histogram + band * videolevels->nbins;
+  const gint row_stride = videolevels->stride_in * videolevels->histogram_step;
+  const guint8 *row;
+  gint r;
+
+  /* rows are sampled rows of the ROI */
+  row = rows->data + (videolevels->roi_y +
+      row_start * videolevels->histogram_step) * videolevels->stride_in;
+
+  for (r = row_start; r < row_end; r++, row += row_stride)
+    gst_videolevels_histogram_row (videolevels, hist, row);
+}
+
+/* allocate and clear one histogram per band of runner */
+static void
+gst_videolevels_histogram_reset (GstVideoLevels * videolevels,
+    GstParallelRunner * runner)
+{
+  gint nbins = videolevels->nbins;
+  gint nbands = gst_parallel_runner_get_n_threads (runner);
+
+  if (videolevels->histogram_size < nbins * nbands) {
+    GST_DEBUG_OBJECT (videolevels,
+        "Allocate memory for histogram (%d bands of %d bins)", nbands, nbins);
+    g_free (videolevels->histogram);
+    videolevels->histogram = g_new (gint, nbins * nbands);
+    videolevels->histogram_size = nbins * nbands;
+  }
+
+  /* bands which get no rows stay empty */
+  memset (videolevels->histogram, 0, sizeof (gint) * nbins * nbands);
+}
+
+/* sum the band histograms of runner into the first one */
+static void
+gst_videolevels_histogram_merge (GstVideoLevels * videolevels,
+    GstParallelRunner * runner)
+{
+  gint *hist = videolevels->histogram;
+  gint nbins = videolevels->nbins;
+  gint nbands = gst_parallel_runner_get_n_threads (runner);
+  gint band, i;
+
+  for (band = 1; band < nbands; band++) {
+    const gint *band_hist = hist + band * nbins;
+    for (i = 0; i < nbins; i++)
+      hist[i] += band_hist[i];
+  }
+}
+
 /**
 * gst_videolevels_calculate_histogram
 * @videolevels: #GstVideoLevels
 * @data: input frame data
 *
-* Calculate histogram of input frame
+* Calculate histogram of every histogram-step row and column of the ROI. Each
+* band of rows is counted into its own histogram, which are then summed into
+* the first nbins entries.
 *
 * Returns: TRUE on success
 */
@@ -865,58 +1469,18 @@ gboolean
 gst_videolevels_calculate_histogram (GstVideoLevels * videolevels,
     guint16 * data)
 {
-  gint *hist;
-  gint nbins = videolevels->nbins;
-  gint r;
-  gint c;
-  gfloat factor;
-  gint stride = videolevels->stride_in;
-  gint endianness = videolevels->endianness_in;
-  gint maxVal = (1 << videolevels->bpp_in) - 1;
-
-  factor = (gfloat) ((nbins - 1.0) / maxVal);
+  GstVideoLevelsHistogramRows rows;
 
-  if (videolevels->histogram == NULL) {
-    GST_DEBUG_OBJECT (videolevels,
-        "First call, allocate memory for histogram (%d bins)", nbins);
-    videolevels->histogram = g_new (gint, nbins);
-  }
-
-  hist = videolevels->histogram;
-
-  /* reset histogram */
-  memset (hist, 0, sizeof (gint) * nbins);
+  gst_videolevels_histogram_reset (videolevels, videolevels->runner);
 
   GST_LOG_OBJECT (videolevels, "Calculating histogram");
-  if (videolevels->bpp_in > 8) {
-    if (endianness == G_BYTE_ORDER) {
-      for (r = videolevels->roi_y;
-          r < videolevels->roi_y + videolevels->roi_height; r++) {
-        for (c = videolevels->roi_x;
-            c < videolevels->roi_x + videolevels->roi_width; c++) {
-          hist[GINT_CLAMP (data[c + r * stride / 2] * factor, 0, nbins - 1)]++;
-        }
-      }
-    } else {
-      for (r = videolevels->roi_y;
-          r < videolevels->roi_y + videolevels->roi_height; r++) {
-        for (c = videolevels->roi_x;
-            c < videolevels->roi_x + videolevels->roi_width; c++) {
-          hist[GINT_CLAMP (GUINT16_FROM_BE (data[c + r * stride / 2]) * factor,
-                  0, nbins - 1)]++;
-        }
-      }
-    }
-  } else {
-    guint8 *data8 = (guint8 *) data;
-    for (r = videolevels->roi_y;
-        r < videolevels->roi_y + videolevels->roi_height; r++) {
-      for (c = videolevels->roi_x;
-          c < videolevels->roi_x + videolevels->roi_width; c++) {
-        hist[GINT_CLAMP (data8[c + r * stride / 2] * factor, 0, nbins - 1)]++;
-      }
-    }
-  }
+  rows.levels = videolevels;
+  rows.data = (const guint8 *) data;
+  gst_parallel_runner_run_rows (videolevels->runner,
+      (videolevels->roi_height + videolevels->histogram_step - 1) /
+      videolevels->histogram_step, 1, gst_videolevels_histogram_rows, &rows);
+
+  gst_videolevels_histogram_merge (videolevels, videolevels->runner);
 
   return TRUE;
 }
@@ -954,39 +1518,50 @@ gst_videolevels_check_roi (GstVideoLevels * filt)
 }
 
 /**
-* gst_videolevels_auto_adjust
+* gst_videolevels_find_levels
 * @videolevels: #GstVideoLevels
-* @data: input frame data
 *
-* Calculate lower and upper levels based on the histogram of the frame
+* Calculate lower and upper levels from the merged histogram
 *
 * Returns: TRUE on success
 */
-gboolean
-gst_videolevels_auto_adjust (GstVideoLevels * filt, guint16 * data)
+static gboolean
+gst_videolevels_find_levels (GstVideoLevels * filt)
 {
-  guint npixsat;
-  guint sum;
+  gdouble npixsat;
+  gdouble sum;
   gint i;
   gint pixel_count;
   gint minVal = 0;
   gint maxVal = (1 << filt->bpp_in) - 1;
   float factor = maxVal / (filt->nbins - 1.0f);
-
-  if (filt->check_roi) {
-    gst_videolevels_check_roi (filt);
-    filt->check_roi = FALSE;
+  const gint step = filt->histogram_step;
+  const gint *hist = filt->histogram;
+  gfloat *avg = NULL;
+
+  pixel_count = ((filt->roi_width + step - 1) / step) *
+      ((filt->roi_height + step - 1) / step);
+
+  /* blend into the moving average, which then replaces the histogram */
+  if (filt->smoothing > 0 && filt->histogram_avg) {
+    const gfloat alpha = (gfloat) filt->smoothing;
+
+    avg = filt->histogram_avg;
+    if (!filt->histogram_avg_valid) {
+      for (i = 0; i < filt->nbins; i++)
+        avg[i] = (gfloat) hist[i];
+      filt->histogram_avg_valid = TRUE;
+    } else {
+      for (i = 0; i < filt->nbins; i++)
+        avg[i] = alpha * avg[i] + (1.0f - alpha) * hist[i];
+    }
   }
 
-  gst_videolevels_calculate_histogram (filt, data);
-
-  pixel_count = filt->roi_width * filt->roi_height;
-
   /* pixels to saturate on low end */
-  npixsat = (guint) (filt->lower_pix_sat * pixel_count);
+  npixsat = filt->lower_pix_sat * pixel_count;
   sum = 0;
   for (i = 0; i < filt->nbins; i++) {
-    sum += filt->histogram[i];
+    sum += avg ? avg[i] : hist[i];
     if (sum > npixsat) {
       filt->lower_input = (gint) CLAMP (i * factor, minVal, maxVal);
       break;
@@ -994,19 +1569,25 @@ gst_videolevels_auto_adjust (GstVideoLevels * filt, guint16 * data)
   }
 
   /* pixels to saturate on high end */
-  npixsat = (guint) (filt->upper_pix_sat * pixel_count);
+  npixsat = filt->upper_pix_sat * pixel_count;
   sum = 0;
   for (i = filt->nbins - 1; i >= 0; i--) {
-    sum += filt->histogram[i];
+    sum += avg ? avg[i] : hist[i];
     if (sum > npixsat) {
       filt->upper_input = (gint) CLAMP (i * factor, minVal, maxVal);
       break;
     }
   }
 
+  /* the equalized table depends on the histogram itself, not only on the
+   * levels found from it */
+  filt->histogram_valid = TRUE;
+  if (filt->curve == GST_VIDEOLEVELS_CURVE_EQUALIZE)
+    filt->lut_dirty = TRUE;
+
   gst_videolevels_calculate_lut (filt);
 
-  GST_LOG_OBJECT (filt, "Contrast stretch with npixsat=%d, (%d, %d)",
+  GST_LOG_OBJECT (filt, "Contrast stretch with npixsat=%.0f, (%d, %d)",
       npixsat, filt->lower_input, filt->upper_input);
 
   g_object_notify_by_pspec (G_OBJECT (filt), properties[PROP_LOWIN]);
@@ -1015,12 +1596,244 @@ gst_videolevels_auto_adjust (GstVideoLevels * filt, guint16 * data)
   return TRUE;
 }
 
+/**
+* gst_videolevels_auto_adjust
+* @videolevels: #GstVideoLevels
+* @data: input frame data
+*
+* Calculate lower and upper levels based on the histogram of the frame
+*
+* Returns: TRUE on success
+*/
+gboolean
+gst_videolevels_auto_adjust (GstVideoLevels * filt, guint16 * data)
+{
+  if (filt->check_roi) {
+    gst_videolevels_check_roi (filt);
+    filt->check_roi = FALSE;
+  }
+
+  gst_videolevels_calculate_histogram (filt, data);
+
+  return gst_videolevels_find_levels (filt);
+}
+
+static void
+gst_videolevels_clahe_free (GstVideoLevels * videolevels)
+{
+  g_free (videolevels->tile_histograms);
+  g_free (videolevels->tile_luts);
+  g_free (videolevels->tile_col_offset);
+  g_free (videolevels->tile_col_weight);
+  g_free (videolevels->tile_row_index);
+  g_free (videolevels->tile_row_weight);
+  videolevels->tile_histograms = NULL;
+  videolevels->tile_luts = NULL;
+  videolevels->tile_col_offset = NULL;
+  videolevels->tile_col_weight = NULL;
+  videolevels->tile_row_index = NULL;
+  videolevels->tile_row_weight = NULL;
+  videolevels->tile_size = 0;
+  videolevels->tiles_valid = FALSE;
+}
+
+/* find the two tiles whose centers surround the center of each of n pixels,
+ * and the 8 bit weight of the second one */
+static void
+gst_videolevels_clahe_weights (gint n, gint ntiles, gint tile_stride,
+    gint * offset, gint * weight)
+{
+  gint i;
+
+  for (i = 0; i < n; i++) {
+    gdouble f = (i + 0.5) * ntiles / n - 0.5;
+    gint t0 = (gint) floor (f);
+    gdouble w = f - t0;
+
+    if (t0 < 0) {
+      t0 = 0;
+      w = 0.0;
+    } else if (t0 >= ntiles - 1) {
+      t0 = ntiles - 1;
+      w = 0.0;
+    }
+
+    offset[2 * i] = t0 * tile_stride;
+    offset[2 * i + 1] = MIN (t0 + 1, ntiles - 1) * tile_stride;
+    weight[i] = (gint) (w * 256 + 0.5);
+  }
+}
+
+static void
+gst_videolevels_clahe_setup (GstVideoLevels * videolevels)
+{
+  const gint tiles_x = MIN (videolevels->tiles_x, videolevels->width);
+  const gint tiles_y = MIN (videolevels->tiles_y, videolevels->height);
+  const gint nbins = videolevels->nbins;
+
+  GST_DEBUG_OBJECT (videolevels, "Setting up %dx%d CLAHE tiles", tiles_x,
+      tiles_y);
+
+  gst_videolevels_clahe_free (videolevels);
+
+  videolevels->tile_size = tiles_x * tiles_y * nbins;
+  videolevels->tile_histograms = g_new (gint, videolevels->tile_size);
+  videolevels->tile_luts = g_new (guint8, videolevels->tile_size);
+  videolevels->tile_col_offset = g_new (gint, 2 * videolevels->width);
+  videolevels->tile_col_weight = g_new (gint, videolevels->width);
+  videolevels->tile_row_index = g_new (gint, 2 * videolevels->height);
+  videolevels->tile_row_weight = g_new (gint, videolevels->height);
+
+  gst_videolevels_clahe_weights (videolevels->width, tiles_x, nbins,
+      videolevels->tile_col_offset, videolevels->tile_col_weight);
+  gst_videolevels_clahe_weights (videolevels->height, tiles_y,
+      tiles_x * nbins, videolevels->tile_row_index,
+      videolevels->tile_row_weight);
+
+  videolevels->tiles_valid = TRUE;
+}
+
+/* native endian sample x of a row */
+static inline gint
+gst_videolevels_sample (GstVideoLevels * videolevels, const guint8 * row,
+    gint x)
+{
+  if (videolevels->bpp_in > 8) {
+    guint16 v = ((const guint16 *) row)[x];
+    return videolevels->endianness_in != G_BYTE_ORDER ?
+        GUINT16_SWAP_LE_BE (v) : v;
+  }
+  return row[x];
+}
+
+typedef struct
+{
+  GstVideoLevels *levels;
+  const guint8 *data;
+} GstVideoLevelsTileRows;
+
+/* build the clipped histogram and table of every tile in a row of tiles */
+static void
+gst_videolevels_clahe_tile_rows (gpointer user_data, guint band,
+    gint row_start, gint row_end)
+{
+  GstVideoLevelsTileRows *rows = (GstVideoLevelsTileRows *) user_data;
+  GstVideoLevels *videolevels = rows->levels;
+  const gint tiles_x = MIN (videolevels->tiles_x, videolevels->width);
+  const gint tiles_y = MIN (videolevels->tiles_y, videolevels->height);
+  const gint nbins = videolevels->nbins;
+  const gint step = videolevels->histogram_step;
+  const gint low_out = videolevels->lower_output;
+  const gint high_out = videolevels->upper_output;
+  gint ti, tj, x, y, b;
+
+  for (ti = row_start; ti < row_end; ti++) {
+    const gint y0 = ti * videolevels->height / tiles_y;
+    const gint y1 = (ti + 1) * videolevels->height / tiles_y;
+
+    for (tj = 0; tj < tiles_x; tj++) {
+      const gint x0 = tj * videolevels->width / tiles_x;
+      const gint x1 = (tj + 1) * videolevels->width / tiles_x;
+      gint *hist = videolevels->tile_histograms + (ti * tiles_x + tj) * nbins;
+      guint8 *lut = videolevels->tile_luts + (ti * tiles_x + tj) * nbins;
+      gint total = 0, limit, excess = 0;
+      gint64 sum = 0;
+
+      memset (hist, 0, sizeof (gint) * nbins);
+      for (y = y0; y < y1; y += step) {
+        const guint8 *row = rows->data + y * videolevels->stride_in;
+        for (x = x0; x < x1; x += step) {
+          hist[gst_videolevels_bin (videolevels,
+                  gst_videolevels_sample (videolevels, row, x))]++;
+          total++;
+        }
+      }
+
+      /* clip each bin and spread what was clipped over all bins */
+      limit = MAX (1, (gint) (videolevels->clip_limit * total / nbins));
+      for (b = 0; b < nbins; b++) {
+        if (hist[b] > limit) {
+          excess += hist[b] - limit;
+          hist[b] = limit;
+        }
+      }
+      for (b = 0; b < nbins; b++)
+        hist[b] += excess / nbins + (b < excess % nbins ? 1 : 0);
+
+      for (b = 0; b < nbins; b++) {
+        sum += hist[b];
+        if (total > 0)
+          lut[b] = low_out + (high_out - low_out) * sum / total;
+        else
+          lut[b] = low_out + (high_out - low_out) * b / (nbins - 1);
+      }
+    }
+  }
+}
+
+/**
+* gst_videolevels_clahe_calculate
+* @videolevels: #GstVideoLevels
+* @data: input frame data
+*
+* Calculate the contrast limited, equalized table of each tile. Each band
+* handles whole rows of tiles so no histograms need merging.
+*/
+static void
+gst_videolevels_clahe_calculate (GstVideoLevels * videolevels,
+    const guint8 * data)
+{
+  GstVideoLevelsTileRows rows;
+
+  GST_LOG_OBJECT (videolevels, "Calculating CLAHE tiles");
+
+  rows.levels = videolevels;
+  rows.data = data;
+  gst_parallel_runner_run_rows (videolevels->runner,
+      MIN (videolevels->tiles_y, videolevels->height), 1,
+      gst_videolevels_clahe_tile_rows, &rows);
+}
+
+/* map rows by bilinearly blending the tables of the four nearest tiles, with
+ * 8 bit weights looked up per column and per row */
+static void
+gst_videolevels_clahe_rows (GstVideoLevels * videolevels,
+    const guint8 * in_data, guint8 * out_data, gint row_start, gint row_end)
+{
+  const gint *col_offset = videolevels->tile_col_offset;
+  const gint *col_weight = videolevels->tile_col_weight;
+  gint x, y;
+
+  for (y = row_start; y < row_end; y++) {
+    const guint8 *src = in_data + y * videolevels->stride_in;
+    guint8 *dst = out_data + y * videolevels->stride_out;
+    const guint8 *lut0 =
+        videolevels->tile_luts + videolevels->tile_row_index[2 * y];
+    const guint8 *lut1 =
+        videolevels->tile_luts + videolevels->tile_row_index[2 * y + 1];
+    const gint wy = videolevels->tile_row_weight[y];
+
+    for (x = 0; x < videolevels->width; x++) {
+      const gint b = gst_videolevels_bin (videolevels,
+          gst_videolevels_sample (videolevels, src, x));
+      const gint o0 = col_offset[2 * x] + b;
+      const gint o1 = col_offset[2 * x + 1] + b;
+      const gint wx = col_weight[x];
+      const gint top = lut0[o0] * (256 - wx) + lut0[o1] * wx;
+      const gint bottom = lut1[o0] * (256 - wx) + lut1[o1] * wx;
+
+      dst[x] = (top * (256 - wy) + bottom * wy + (1 << 15)) >> 16;
+    }
+  }
+}
+
 static void
 gst_videolevels_check_passthrough (GstVideoLevels * levels)
 {
   gboolean passthrough;
   if (levels->bpp_in == 8 &&
       levels->auto_adjust == GST_VIDEOLEVELS_AUTO_OFF &&
+      levels->curve == GST_VIDEOLEVELS_CURVE_LINEAR &&
       levels->lower_input == levels->lower_output &&
       levels->upper_input == levels->upper_output) {
     passthrough = TRUE;
@@ -28,6 +28,8 @@
 #include <gst/base/gstbasetransform.h>
 #include <gst/video/video.h>
 
+#include "parallel.h"
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_VIDEOLEVELS \
@@ -58,6 +60,24 @@ typedef enum {
   GST_VIDEOLEVELS_AUTO_CONTINUOUS
 } GstVideoLevelsAuto;
 
+/**
+* GstVideoLevelsCurve:
+* @GST_VIDEOLEVELS_CURVE_LINEAR: linear stretch between the input and output levels
+* @GST_VIDEOLEVELS_CURVE_GAMMA: power law stretch, see the "gamma" property
+* @GST_VIDEOLEVELS_CURVE_LOG: logarithmic stretch
+* @GST_VIDEOLEVELS_CURVE_EQUALIZE: histogram equalization between the input levels
+* @GST_VIDEOLEVELS_CURVE_CLAHE: contrast limited adaptive histogram equalization
+*
+* Tone curve applied between the input and output levels.
+*/
+typedef enum {
+  GST_VIDEOLEVELS_CURVE_LINEAR,
+  GST_VIDEOLEVELS_CURVE_GAMMA,
+  GST_VIDEOLEVELS_CURVE_LOG,
+  GST_VIDEOLEVELS_CURVE_EQUALIZE,
+  GST_VIDEOLEVELS_CURVE_CLAHE
+} GstVideoLevelsCurve;
+
 /**
 * GstVideoLevels:
 * @element: the parent element.
@@ -89,15 +109,58 @@ struct _GstVideoLevels
   gint roi_y;
   gint roi_width;
   gint roi_height;
-
-  /* tables */
+  GstVideoLevelsCurve curve;
+  gdouble gamma;
+  gdouble clip_limit;
+  gint tiles_x;
+  gint tiles_y;
+  gint histogram_step;
+  gdouble smoothing;
+  gboolean single_pass;
+  guint n_threads;
+
+  /* row bands of the transform and histogram run on this pool */
+  GstParallelRunner *runner;
+
+  /* tables, with the levels the table was last built for */
   gpointer lookup_table;
+  gboolean lut_dirty;
+  gint lut_low_in;
+  gint lut_high_in;
+  gint lut_low_out;
+  gint lut_high_out;
+  GstVideoLevelsCurve lut_curve;
+  gdouble lut_gamma;
+
+  /* increasing linear mappings skip the table, see gstvideolevelsorc.orc */
+  gboolean linear;
+  guint32 scale;
 
   GstVideoLevelsAuto auto_adjust;
   guint64 interval;
   gboolean check_roi;
   gint nbins;
+  /* one histogram per band, merged into the first one */
   gint * histogram;
+  gint histogram_size;
+  /* bin = value >> histogram_shift when nbins is a power of two, else -1 */
+  gint histogram_shift;
+  /* moving average of the histogram when smoothing is enabled */
+  gfloat * histogram_avg;
+  gboolean histogram_avg_valid;
+  /* the equalize curve needs a histogram before it can build the table */
+  gboolean histogram_valid;
+
+  /* CLAHE per tile histograms and tables of nbins entries, with the
+   * neighbouring tiles and weight of each column and row */
+  gint * tile_histograms;
+  guint8 * tile_luts;
+  gint tile_size;
+  gint * tile_col_offset;
+  gint * tile_col_weight;
+  gint * tile_row_index;
+  gint * tile_row_weight;
+  gboolean tiles_valid;
 
   guint64 last_auto_timestamp;
 
@@ -0,0 +1,724 @@
+#include "gstvideolevelsorc-dist.h"
+/* autogenerated from gstvideolevelsorc.orc */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifndef _ORC_INTEGER_TYPEDEFS_
+#define _ORC_INTEGER_TYPEDEFS_
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#include <stdint.h>
+typedef int8_t orc_int8;
+typedef int16_t orc_int16;
+typedef int32_t orc_int32;
+typedef int64_t orc_int64;
+typedef uint8_t orc_uint8;
+typedef uint16_t orc_uint16;
+typedef uint32_t orc_uint32;
+typedef uint64_t orc_uint64;
+#define ORC_UINT64_C(x) UINT64_C(x)
+#elif defined(_MSC_VER)
+typedef signed __int8 orc_int8;
+typedef signed __int16 orc_int16;
+typedef signed __int32 orc_int32;
+typedef signed __int64 orc_int64;
+typedef unsigned __int8 orc_uint8;
+typedef unsigned __int16 orc_uint16;
+typedef unsigned __int32 orc_uint32;
+typedef unsigned __int64 orc_uint64;
+#define ORC_UINT64_C(x) (x##Ui64)
+#define inline __inline
+#else
+#include <limits.h>
+typedef signed char orc_int8;
+typedef short orc_int16;
+typedef int orc_int32;
+typedef unsigned char orc_uint8;
+typedef unsigned short orc_uint16;
+typedef unsigned int orc_uint32;
+#if INT_MAX == LONG_MAX
+typedef long long orc_int64;
+typedef unsigned long long orc_uint64;
+#define ORC_UINT64_C(x) (x##ULL)
+#else
+typedef long orc_int64;
+typedef unsigned long orc_uint64;
+#define ORC_UINT64_C(x) (x##UL)
+#endif
+#endif
+typedef union { orc_int16 i; orc_int8 x2[2]; } orc_union16;
+typedef union { orc_int32 i; float f; orc_int16 x2[2]; orc_int8 x4[4]; } orc_union32;
+typedef union { orc_int64 i; double f; orc_int32 x2[2]; float x2f[2]; orc_int16 x4[4]; } orc_union64;
+#endif
+#ifndef ORC_RESTRICT
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define ORC_RESTRICT restrict
+#elif defined(__GNUC__) && __GNUC__ >= 4
+#define ORC_RESTRICT __restrict__
+#else
+#define ORC_RESTRICT
+#endif
+#endif
+
+#ifndef ORC_INTERNAL
+#if defined(__SUNPRO_C) && (__SUNPRO_C >= 0x590)
+#define ORC_INTERNAL __attribute__((visibility("hidden")))
+#elif defined(__SUNPRO_C) && (__SUNPRO_C >= 0x550)
+#define ORC_INTERNAL __hidden
+#elif defined (__GNUC__)
+#define ORC_INTERNAL __attribute__((visibility("hidden")))
+#else
+#define ORC_INTERNAL
+#endif
+#endif
+
+
+#ifndef DISABLE_ORC
+#include <orc/orc.h>
+#endif
+void videolevels_orc_linear_u8 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int p1, int p2, int p3, int p4, int n, int m);
+void videolevels_orc_linear_u16 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int p1, int p2, int p3, int p4, int n, int m);
+void videolevels_orc_linear_u16_swap (guint8 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int p1, int p2, int p3, int p4, int n, int m);
+
+/* begin Orc C target preamble */
+#define ORC_CLAMP(x,a,b) ((x)<(a) ? (a) : ((x)>(b) ? (b) : (x)))
+#define ORC_ABS(a) ((a)<0 ? -(a) : (a))
+#define ORC_MIN(a,b) ((a)<(b) ? (a) : (b))
+#define ORC_MAX(a,b) ((a)>(b) ? (a) : (b))
+#define ORC_SB_MAX 127
+#define ORC_SB_MIN (-1-ORC_SB_MAX)
+#define ORC_UB_MAX 255
+#define ORC_UB_MIN 0
+#define ORC_SW_MAX 32767
+#define ORC_SW_MIN (-1-ORC_SW_MAX)
+#define ORC_UW_MAX 65535
+#define ORC_UW_MIN 0
+#define ORC_SL_MAX 2147483647
+#define ORC_SL_MIN (-1-ORC_SL_MAX)
+#define ORC_UL_MAX 4294967295U
+#define ORC_UL_MIN 0
+#define ORC_CLAMP_SB(x) ORC_CLAMP(x,ORC_SB_MIN,ORC_SB_MAX)
+#define ORC_CLAMP_UB(x) ORC_CLAMP(x,ORC_UB_MIN,ORC_UB_MAX)
+#define ORC_CLAMP_SW(x) ORC_CLAMP(x,ORC_SW_MIN,ORC_SW_MAX)
+#define ORC_CLAMP_UW(x) ORC_CLAMP(x,ORC_UW_MIN,ORC_UW_MAX)
+#define ORC_CLAMP_SL(x) ORC_CLAMP(x,ORC_SL_MIN,ORC_SL_MAX)
+#define ORC_CLAMP_UL(x) ORC_CLAMP(x,ORC_UL_MIN,ORC_UL_MAX)
+#define ORC_SWAP_W(x) ((((x)&0xffU)<<8) | (((x)&0xff00U)>>8))
+#define ORC_SWAP_L(x) ((((x)&0xffU)<<24) | (((x)&0xff00U)<<8) | (((x)&0xff0000U)>>8) | (((x)&0xff000000U)>>24))
+#define ORC_SWAP_Q(x) ((((x)&ORC_UINT64_C(0xff))<<56) | (((x)&ORC_UINT64_C(0xff00))<<40) | (((x)&ORC_UINT64_C(0xff0000))<<24) | (((x)&ORC_UINT64_C(0xff000000))<<8) | (((x)&ORC_UINT64_C(0xff00000000))>>8) | (((x)&ORC_UINT64_C(0xff0000000000))>>24) | (((x)&ORC_UINT64_C(0xff000000000000))>>40) | (((x)&ORC_UINT64_C(0xff00000000000000))>>56))
+#define ORC_PTR_OFFSET(ptr,offset) ((void *)(((unsigned char *)(ptr)) + (offset)))
+#define ORC_DENORMAL(x) ((x) & ((((x)&0x7f800000) == 0) ? 0xff800000 : 0xffffffff))
+#define ORC_ISNAN(x) ((((x)&0x7f800000) == 0x7f800000) && (((x)&0x007fffff) != 0))
+#define ORC_DENORMAL_DOUBLE(x) ((x) & ((((x)&ORC_UINT64_C(0x7ff0000000000000)) == 0) ? ORC_UINT64_C(0xfff0000000000000) : ORC_UINT64_C(0xffffffffffffffff)))
+#define ORC_ISNAN_DOUBLE(x) ((((x)&ORC_UINT64_C(0x7ff0000000000000)) == ORC_UINT64_C(0x7ff0000000000000)) && (((x)&ORC_UINT64_C(0x000fffffffffffff)) != 0))
+#ifndef ORC_RESTRICT
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define ORC_RESTRICT restrict
+#elif defined(__GNUC__) && __GNUC__ >= 4
+#define ORC_RESTRICT __restrict__
+#else
+#define ORC_RESTRICT
+#endif
+#endif
+/* end Orc C target preamble */
+
+
+
+/* videolevels_orc_linear_u8 */
+#ifdef DISABLE_ORC
+void
+videolevels_orc_linear_u8 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int p1, int p2, int p3, int p4, int n, int m){
+  int i;
+  int j;
+  orc_int8 * ORC_RESTRICT ptr0;
+  const orc_int8 * ORC_RESTRICT ptr4;
+  orc_int8 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union16 var38;
+  orc_int8 var39;
+  orc_union16 var40;
+  orc_union32 var41;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(d1, d1_stride * j);
+    ptr4 = ORC_PTR_OFFSET(s1, s1_stride * j);
+
+    /* 0: loadpw */
+    var34.i = p1;
+    /* 1: loadpw */
+    var35.i = p2;
+    /* 2: loadpl */
+    var36.i = p3;
+    /* 3: loadpl */
+    var37.i = 0x00000018; /* 24 or 3.36312e-44f */
+    /* 4: loadpw */
+    var38.i = p4;
+
+    for (i = 0; i < n; i++) {
+      /* 5: loadb */
+      var33 = ptr4[i];
+      /* 6: convubw */
+      var40.i = (orc_uint8) var33;
+      /* 7: subusw */
+      var40.i = ORC_CLAMP_UW ((orc_uint16) var40.i - (orc_uint16) var34.i);
+      /* 8: minuw */
+      var40.i = ORC_MIN ((orc_uint16) var40.i, (orc_uint16) var35.i);
+      /* 9: convuwl */
+      var41.i = (orc_uint16) var40.i;
+      /* 10: mulll */
+      var41.i = (((orc_uint32) var41.i) * ((orc_uint32) var36.i)) & 0xffffffff;
+      /* 11: shrul */
+      var41.i = ((orc_uint32) var41.i) >> var37.i;
+      /* 12: convlw */
+      var40.i = var41.i;
+      /* 13: addw */
+      var40.i = var40.i + var38.i;
+      /* 14: convwb */
+      var39 = var40.i;
+      /* 15: storeb */
+      ptr0[i] = var39;
+    }
+  }
+
+}
+
+#else
+static void
+_backup_videolevels_orc_linear_u8 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int j;
+  int n = ex->n;
+  int m = ex->params[ORC_VAR_A1];
+  orc_int8 * ORC_RESTRICT ptr0;
+  const orc_int8 * ORC_RESTRICT ptr4;
+  orc_int8 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union16 var38;
+  orc_int8 var39;
+  orc_union16 var40;
+  orc_union32 var41;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(ex->arrays[0], ex->params[0] * j);
+    ptr4 = ORC_PTR_OFFSET(ex->arrays[4], ex->params[4] * j);
+
+    /* 0: loadpw */
+    var34.i = ex->params[24];
+    /* 1: loadpw */
+    var35.i = ex->params[25];
+    /* 2: loadpl */
+    var36.i = ex->params[26];
+    /* 3: loadpl */
+    var37.i = 0x00000018; /* 24 or 3.36312e-44f */
+    /* 4: loadpw */
+    var38.i = ex->params[27];
+
+    for (i = 0; i < n; i++) {
+      /* 5: loadb */
+      var33 = ptr4[i];
+      /* 6: convubw */
+      var40.i = (orc_uint8) var33;
+      /* 7: subusw */
+      var40.i = ORC_CLAMP_UW ((orc_uint16) var40.i - (orc_uint16) var34.i);
+      /* 8: minuw */
+      var40.i = ORC_MIN ((orc_uint16) var40.i, (orc_uint16) var35.i);
+      /* 9: convuwl */
+      var41.i = (orc_uint16) var40.i;
+      /* 10: mulll */
+      var41.i = (((orc_uint32) var41.i) * ((orc_uint32) var36.i)) & 0xffffffff;
+      /* 11: shrul */
+      var41.i = ((orc_uint32) var41.i) >> var37.i;
+      /* 12: convlw */
+      var40.i = var41.i;
+      /* 13: addw */
+      var40.i = var40.i + var38.i;
+      /* 14: convwb */
+      var39 = var40.i;
+      /* 15: storeb */
+      ptr0[i] = var39;
+    }
+  }
+
+}
+
+void
+videolevels_orc_linear_u8 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint8 * ORC_RESTRICT s1, int s1_stride, int p1, int p2, int p3, int p4, int n, int m)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 7, 9, 25, 118, 105, 100, 101, 111, 108, 101, 118, 101, 108, 115, 95, 
+        111, 114, 99, 95, 108, 105, 110, 101, 97, 114, 95, 117, 56, 11, 1, 1, 
+        12, 1, 1, 14, 4, 24, 16, 2, 16, 2, 16, 4, 16, 2, 20, 2, 
+        20, 4, 150, 32, 4, 100, 32, 32, 24, 88, 32, 32, 25, 154, 33, 32, 
+        120, 33, 33, 26, 126, 33, 33, 16, 163, 32, 33, 70, 32, 32, 27, 157, 
+        0, 32, 2, 0, 
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_videolevels_orc_linear_u8);
+#else
+      p = orc_program_new ();
+      orc_program_set_2d (p);
+      orc_program_set_name (p, "videolevels_orc_linear_u8");
+      orc_program_set_backup_function (p, _backup_videolevels_orc_linear_u8);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_constant (p, 4, 0x00000018, "c1");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_parameter (p, 2, "p2");
+      orc_program_add_parameter (p, 4, "p3");
+      orc_program_add_parameter (p, 2, "p4");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "subusw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_P1, ORC_VAR_D1);
+      orc_program_append_2 (p, "minuw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_P2, ORC_VAR_D1);
+      orc_program_append_2 (p, "convuwl", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "mulll", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_P3, ORC_VAR_D1);
+      orc_program_append_2 (p, "shrul", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convlw", 0, ORC_VAR_T1, ORC_VAR_T2, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_P4, ORC_VAR_D1);
+      orc_program_append_2 (p, "convwb", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ORC_EXECUTOR_M(ex) = m;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->params[ORC_VAR_D1] = d1_stride;
+  ex->arrays[ORC_VAR_S1] = (void *)s1;
+  ex->params[ORC_VAR_S1] = s1_stride;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+  ex->params[ORC_VAR_P3] = p3;
+  ex->params[ORC_VAR_P4] = p4;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* videolevels_orc_linear_u16 */
+#ifdef DISABLE_ORC
+void
+videolevels_orc_linear_u16 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int p1, int p2, int p3, int p4, int n, int m){
+  int i;
+  int j;
+  orc_int8 * ORC_RESTRICT ptr0;
+  const orc_union16 * ORC_RESTRICT ptr4;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union16 var38;
+  orc_int8 var39;
+  orc_union16 var40;
+  orc_union32 var41;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(d1, d1_stride * j);
+    ptr4 = ORC_PTR_OFFSET(s1, s1_stride * j);
+
+    /* 0: loadpw */
+    var34.i = p1;
+    /* 1: loadpw */
+    var35.i = p2;
+    /* 2: loadpl */
+    var36.i = p3;
+    /* 3: loadpl */
+    var37.i = 0x00000018; /* 24 or 3.36312e-44f */
+    /* 4: loadpw */
+    var38.i = p4;
+
+    for (i = 0; i < n; i++) {
+      /* 5: loadw */
+      var33 = ptr4[i];
+      /* 6: subusw */
+      var40.i = ORC_CLAMP_UW ((orc_uint16) var33.i - (orc_uint16) var34.i);
+      /* 7: minuw */
+      var40.i = ORC_MIN ((orc_uint16) var40.i, (orc_uint16) var35.i);
+      /* 8: convuwl */
+      var41.i = (orc_uint16) var40.i;
+      /* 9: mulll */
+      var41.i = (((orc_uint32) var41.i) * ((orc_uint32) var36.i)) & 0xffffffff;
+      /* 10: shrul */
+      var41.i = ((orc_uint32) var41.i) >> var37.i;
+      /* 11: convlw */
+      var40.i = var41.i;
+      /* 12: addw */
+      var40.i = var40.i + var38.i;
+      /* 13: convwb */
+      var39 = var40.i;
+      /* 14: storeb */
+      ptr0[i] = var39;
+    }
+  }
+
+}
+
+#else
+static void
+_backup_videolevels_orc_linear_u16 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int j;
+  int n = ex->n;
+  int m = ex->params[ORC_VAR_A1];
+  orc_int8 * ORC_RESTRICT ptr0;
+  const orc_union16 * ORC_RESTRICT ptr4;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union16 var38;
+  orc_int8 var39;
+  orc_union16 var40;
+  orc_union32 var41;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(ex->arrays[0], ex->params[0] * j);
+    ptr4 = ORC_PTR_OFFSET(ex->arrays[4], ex->params[4] * j);
+
+    /* 0: loadpw */
+    var34.i = ex->params[24];
+    /* 1: loadpw */
+    var35.i = ex->params[25];
+    /* 2: loadpl */
+    var36.i = ex->params[26];
+    /* 3: loadpl */
+    var37.i = 0x00000018; /* 24 or 3.36312e-44f */
+    /* 4: loadpw */
+    var38.i = ex->params[27];
+
+    for (i = 0; i < n; i++) {
+      /* 5: loadw */
+      var33 = ptr4[i];
+      /* 6: subusw */
+      var40.i = ORC_CLAMP_UW ((orc_uint16) var33.i - (orc_uint16) var34.i);
+      /* 7: minuw */
+      var40.i = ORC_MIN ((orc_uint16) var40.i, (orc_uint16) var35.i);
+      /* 8: convuwl */
+      var41.i = (orc_uint16) var40.i;
+      /* 9: mulll */
+      var41.i = (((orc_uint32) var41.i) * ((orc_uint32) var36.i)) & 0xffffffff;
+      /* 10: shrul */
+      var41.i = ((orc_uint32) var41.i) >> var37.i;
+      /* 11: convlw */
+      var40.i = var41.i;
+      /* 12: addw */
+      var40.i = var40.i + var38.i;
+      /* 13: convwb */
+      var39 = var40.i;
+      /* 14: storeb */
+      ptr0[i] = var39;
+    }
+  }
+
+}
+
+void
+videolevels_orc_linear_u16 (guint8 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int p1, int p2, int p3, int p4, int n, int m)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 7, 9, 26, 118, 105, 100, 101, 111, 108, 101, 118, 101, 108, 115, 95, 
+        111, 114, 99, 95, 108, 105, 110, 101, 97, 114, 95, 117, 49, 54, 11, 1, 
+        1, 12, 2, 2, 14, 4, 24, 16, 2, 16, 2, 16, 4, 16, 2, 20, 
+        2, 20, 4, 100, 32, 4, 24, 88, 32, 32, 25, 154, 33, 32, 120, 33, 
+        33, 26, 126, 33, 33, 16, 163, 32, 33, 70, 32, 32, 27, 157, 0, 32, 
+        2, 0, 
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_videolevels_orc_linear_u16);
+#else
+      p = orc_program_new ();
+      orc_program_set_2d (p);
+      orc_program_set_name (p, "videolevels_orc_linear_u16");
+      orc_program_set_backup_function (p, _backup_videolevels_orc_linear_u16);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_constant (p, 4, 0x00000018, "c1");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_parameter (p, 2, "p2");
+      orc_program_add_parameter (p, 4, "p3");
+      orc_program_add_parameter (p, 2, "p4");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "subusw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_P1, ORC_VAR_D1);
+      orc_program_append_2 (p, "minuw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_P2, ORC_VAR_D1);
+      orc_program_append_2 (p, "convuwl", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "mulll", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_P3, ORC_VAR_D1);
+      orc_program_append_2 (p, "shrul", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convlw", 0, ORC_VAR_T1, ORC_VAR_T2, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_P4, ORC_VAR_D1);
+      orc_program_append_2 (p, "convwb", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ORC_EXECUTOR_M(ex) = m;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->params[ORC_VAR_D1] = d1_stride;
+  ex->arrays[ORC_VAR_S1] = (void *)s1;
+  ex->params[ORC_VAR_S1] = s1_stride;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+  ex->params[ORC_VAR_P3] = p3;
+  ex->params[ORC_VAR_P4] = p4;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* videolevels_orc_linear_u16_swap */
+#ifdef DISABLE_ORC
+void
+videolevels_orc_linear_u16_swap (guint8 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int p1, int p2, int p3, int p4, int n, int m){
+  int i;
+  int j;
+  orc_int8 * ORC_RESTRICT ptr0;
+  const orc_union16 * ORC_RESTRICT ptr4;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union16 var38;
+  orc_int8 var39;
+  orc_union16 var40;
+  orc_union32 var41;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(d1, d1_stride * j);
+    ptr4 = ORC_PTR_OFFSET(s1, s1_stride * j);
+
+    /* 0: loadpw */
+    var34.i = p1;
+    /* 1: loadpw */
+    var35.i = p2;
+    /* 2: loadpl */
+    var36.i = p3;
+    /* 3: loadpl */
+    var37.i = 0x00000018; /* 24 or 3.36312e-44f */
+    /* 4: loadpw */
+    var38.i = p4;
+
+    for (i = 0; i < n; i++) {
+      /* 5: loadw */
+      var33 = ptr4[i];
+      /* 6: swapw */
+      var40.i = ORC_SWAP_W (var33.i);
+      /* 7: subusw */
+      var40.i = ORC_CLAMP_UW ((orc_uint16) var40.i - (orc_uint16) var34.i);
+      /* 8: minuw */
+      var40.i = ORC_MIN ((orc_uint16) var40.i, (orc_uint16) var35.i);
+      /* 9: convuwl */
+      var41.i = (orc_uint16) var40.i;
+      /* 10: mulll */
+      var41.i = (((orc_uint32) var41.i) * ((orc_uint32) var36.i)) & 0xffffffff;
+      /* 11: shrul */
+      var41.i = ((orc_uint32) var41.i) >> var37.i;
+      /* 12: convlw */
+      var40.i = var41.i;
+      /* 13: addw */
+      var40.i = var40.i + var38.i;
+      /* 14: convwb */
+      var39 = var40.i;
+      /* 15: storeb */
+      ptr0[i] = var39;
+    }
+  }
+
+}
+
+#else
+static void
+_backup_videolevels_orc_linear_u16_swap (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int j;
+  int n = ex->n;
+  int m = ex->params[ORC_VAR_A1];
+  orc_int8 * ORC_RESTRICT ptr0;
+  const orc_union16 * ORC_RESTRICT ptr4;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union16 var38;
+  orc_int8 var39;
+  orc_union16 var40;
+  orc_union32 var41;
+
+  for (j = 0; j < m; j++) {
+    ptr0 = ORC_PTR_OFFSET(ex->arrays[0], ex->params[0] * j);
+    ptr4 = ORC_PTR_OFFSET(ex->arrays[4], ex->params[4] * j);
+
+    /* 0: loadpw */
+    var34.i = ex->params[24];
+    /* 1: loadpw */
+    var35.i = ex->params[25];
+    /* 2: loadpl */
+    var36.i = ex->params[26];
+    /* 3: loadpl */
+    var37.i = 0x00000018; /* 24 or 3.36312e-44f */
+    /* 4: loadpw */
+    var38.i = ex->params[27];
+
+    for (i = 0; i < n; i++) {
+      /* 5: loadw */
+      var33 = ptr4[i];
+      /* 6: swapw */
+      var40.i = ORC_SWAP_W (var33.i);
+      /* 7: subusw */
+      var40.i = ORC_CLAMP_UW ((orc_uint16) var40.i - (orc_uint16) var34.i);
+      /* 8: minuw */
+      var40.i = ORC_MIN ((orc_uint16) var40.i, (orc_uint16) var35.i);
+      /* 9: convuwl */
+      var41.i = (orc_uint16) var40.i;
+      /* 10: mulll */
+      var41.i = (((orc_uint32) var41.i) * ((orc_uint32) var36.i)) & 0xffffffff;
+      /* 11: shrul */
+      var41.i = ((orc_uint32) var41.i) >> var37.i;
+      /* 12: convlw */
+      var40.i = var41.i;
+      /* 13: addw */
+      var40.i = var40.i + var38.i;
+      /* 14: convwb */
+      var39 = var40.i;
+      /* 15: storeb */
+      ptr0[i] = var39;
+    }
+  }
+
+}
+
+void
+videolevels_orc_linear_u16_swap (guint8 * ORC_RESTRICT d1, int d1_stride, const guint16 * ORC_RESTRICT s1, int s1_stride, int p1, int p2, int p3, int p4, int n, int m)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 7, 9, 31, 118, 105, 100, 101, 111, 108, 101, 118, 101, 108, 115, 95, 
+        111, 114, 99, 95, 108, 105, 110, 101, 97, 114, 95, 117, 49, 54, 95, 115, 
+        119, 97, 112, 11, 1, 1, 12, 2, 2, 14, 4, 24, 16, 2, 16, 2, 
+        16, 4, 16, 2, 20, 2, 20, 4, 183, 32, 4, 100, 32, 32, 24, 88, 
+        32, 32, 25, 154, 33, 32, 120, 33, 33, 26, 126, 33, 33, 16, 163, 32, 
+        33, 70, 32, 32, 27, 157, 0, 32, 2, 0, 
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_videolevels_orc_linear_u16_swap);
+#else
+      p = orc_program_new ();
+      orc_program_set_2d (p);
+      orc_program_set_name (p, "videolevels_orc_linear_u16_swap");
+      orc_program_set_backup_function (p, _backup_videolevels_orc_linear_u16_swap);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_constant (p, 4, 0x00000018, "c1");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_parameter (p, 2, "p2");
+      orc_program_add_parameter (p, 4, "p3");
+      orc_program_add_parameter (p, 2, "p4");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "swapw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "subusw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_P1, ORC_VAR_D1);
+      orc_program_append_2 (p, "minuw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_P2, ORC_VAR_D1);
+      orc_program_append_2 (p, "convuwl", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "mulll", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_P3, ORC_VAR_D1);
+      orc_program_append_2 (p, "shrul", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convlw", 0, ORC_VAR_T1, ORC_VAR_T2, ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_P4, ORC_VAR_D1);
+      orc_program_append_2 (p, "convwb", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_D1, ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ORC_EXECUTOR_M(ex) = m;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->params[ORC_VAR_D1] = d1_stride;
+  ex->arrays[ORC_VAR_S1] = (void *)s1;
+  ex->params[ORC_VAR_S1] = s1_stride;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+  ex->params[ORC_VAR_P3] = p3;
+  ex->params[ORC_VAR_P4] = p4;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
@@ -156,6 +156,7 @@ static GstCaps *gst_gentlsrc_get_caps (GstBaseSrc * src, GstCaps * filter);
 static gboolean gst_gentlsrc_set_caps (GstBaseSrc * src, GstCaps * caps);
 static gboolean gst_gentlsrc_unlock (GstBaseSrc * src);
 static gboolean gst_gentlsrc_unlock_stop (GstBaseSrc * src);
+static gboolean gst_gentlsrc_event (GstBaseSrc * src, GstEvent * event);
 
 static GstFlowReturn gst_gentlsrc_create (GstPushSrc * src, GstBuffer ** buf);
 
@@ -176,7 +177,8 @@ enum
   PROP_STREAM_ID,
   PROP_NUM_CAPTURE_BUFFERS,
   PROP_TIMEOUT,
-  PROP_ATTRIBUTES
+  PROP_ATTRIBUTES,
+  PROP_FRAME_RATE_ADDRESS
 };
 
 #define DEFAULT_PROP_PRODUCER GST_GENTLSRC_PRODUCER_BASLER
@@ -190,6 +192,7 @@ enum
 #define DEFAULT_PROP_NUM_CAPTURE_BUFFERS 3
 #define DEFAULT_PROP_TIMEOUT 1000
 #define DEFAULT_PROP_ATTRIBUTES ""
+#define DEFAULT_PROP_FRAME_RATE_ADDRESS 0
 
 /* pad templates */
 
@@ -377,6 +380,7 @@ gst_gentlsrc_class_init (GstGenTlSrcClass * klass)
   gstbasesrc_class->set_caps = GST_DEBUG_FUNCPTR (gst_gentlsrc_set_caps);
   gstbasesrc_class->unlock = GST_DEBUG_FUNCPTR (gst_gentlsrc_unlock);
   gstbasesrc_class->unlock_stop = GST_DEBUG_FUNCPTR (gst_gentlsrc_unlock_stop);
+  gstbasesrc_class->event = GST_DEBUG_FUNCPTR (gst_gentlsrc_event);
 
   gstpushsrc_class->create = GST_DEBUG_FUNCPTR (gst_gentlsrc_create);
 
@@ -443,6 +447,14 @@ gst_gentlsrc_class_init (GstGenTlSrcClass * klass)
       PROP_ATTRIBUTES, g_param_spec_string ("attributes",
           "Attributes", "Attributes to change, comma separated key=value pairs",
           DEFAULT_PROP_ATTRIBUTES, G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE));
+  g_object_class_install_property (G_OBJECT_CLASS (klass),
+      PROP_FRAME_RATE_ADDRESS, g_param_spec_uint64 ("frame-rate-address",
+          "Frame rate address",
+          "Address of the camera's 32-bit float frame rate register, such as "
+          "AcquisitionFrameRate, written when a downstream select element "
+          "hints its decimation framerate (0 ignores the hint)", 0,
+          G_MAXUINT64, DEFAULT_PROP_FRAME_RATE_ADDRESS,
+          G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE));
 
   klass->hTL = NULL;
   g_mutex_init (&klass->tl_mutex);
@@ -481,6 +493,7 @@ gst_gentlsrc_init (GstGenTlSrc * src)
   src->num_capture_buffers = DEFAULT_PROP_NUM_CAPTURE_BUFFERS;
   src->timeout = DEFAULT_PROP_TIMEOUT;
   src->attributes = g_strdup (DEFAULT_PROP_ATTRIBUTES);
+  src->frame_rate_address = DEFAULT_PROP_FRAME_RATE_ADDRESS;
 
   src->stop_requested = FALSE;
   src->caps = NULL;
@@ -541,6 +554,9 @@ gst_gentlsrc_set_property (GObject * object, guint property_id,
         g_free (src->attributes);
       src->attributes = g_strdup (g_value_get_string (value));
       break;
+    case PROP_FRAME_RATE_ADDRESS:
+      src->frame_rate_address = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -590,6 +606,9 @@ gst_gentlsrc_get_property (GObject * object, guint property_id,
     case PROP_ATTRIBUTES:
       g_value_set_string (value, src->attributes);
       break;
+    case PROP_FRAME_RATE_ADDRESS:
+      g_value_set_uint64 (value, src->frame_rate_address);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -1859,6 +1878,37 @@ gst_gentlsrc_unlock_stop (GstBaseSrc * bsrc)
   return TRUE;
 }
 
+/* Captures at the rate a downstream select element decimates to. GenTL only
+ * gives access to registers, so this needs the address of the frame rate
+ * register of the camera. */
+static gboolean
+gst_gentlsrc_event (GstBaseSrc * bsrc, GstEvent * event)
+{
+  GstGenTlSrc *src = GST_GENTL_SRC (bsrc);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CUSTOM_UPSTREAM &&
+      gst_event_has_name (event, "GstSelectDecimation")) {
+    const GstStructure *s = gst_event_get_structure (event);
+    gint fps_n, fps_d;
+    union
+    {
+      gfloat f;
+      guint32 u;
+    } fps;
+
+    if (src->frame_rate_address != 0 && src->hDEV &&
+        gst_structure_get_fraction (s, "framerate", &fps_n, &fps_d) &&
+        fps_n > 0 && fps_d > 0) {
+      fps.f = (gfloat) fps_n / fps_d;
+      GST_DEBUG_OBJECT (src, "Decimation hint, capturing at %.2f fps", fps.f);
+      return write_uint32 (src, src->frame_rate_address,
+          fps.u) == GC_ERR_SUCCESS;
+    }
+  }
+
+  return GST_BASE_SRC_CLASS (gst_gentlsrc_parent_class)->event (bsrc, event);
+}
+
 static GstStaticCaps unix_reference = GST_STATIC_CAPS ("timestamp/x-unix");
 
 static GstBuffer *
@@ -104,6 +104,7 @@ struct _GstGenTlSrc
   guint num_capture_buffers;
   gint timeout;
   gchar* attributes;
+  guint64 frame_rate_address;
 
   GstClockTime acq_start_time;
   guint32 last_frame_count;
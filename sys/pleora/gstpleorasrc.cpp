@@ -1714,7 +1714,20 @@ gst_pleorasrc_create (GstPushSrc * psrc, GstBuffer ** buf)
 
       GST_LOG_OBJECT (src, "Adding KLV meta to buffer");
       /* TODO: do we need to exclude padding that may be present? */
-      gst_buffer_add_klv_meta_from_data (*buf, chunk_data, chunk_size);
+      if (src->pleora_stride == src->gst_stride) {
+        /* the chunk lies outside the image, so wrap it in a memory of its
+           own that keeps the image memory, and so the PvBuffer, alive */
+        GstMemory *image_mem = gst_buffer_peek_memory (*buf, 0);
+        GstMemory *chunk_mem =
+            gst_memory_new_wrapped ((GstMemoryFlags) GST_MEMORY_FLAG_READONLY,
+            (gpointer) chunk_data, chunk_size, 0, chunk_size,
+            gst_memory_ref (image_mem), (GDestroyNotify) gst_memory_unref);
+        gst_buffer_add_klv_meta_from_memory (*buf, chunk_mem, 0, chunk_size);
+        gst_memory_unref (chunk_mem);
+      } else {
+        /* the PvBuffer is released below, so the chunk must be copied */
+        gst_buffer_add_klv_meta_from_data (*buf, chunk_data, chunk_size);
+      }
     }
   }
 #endif // GST_PLUGINS_VISION_ENABLE_KLV
@@ -98,6 +98,7 @@ static gboolean gst_pylonsrc_start (GstBaseSrc * bsrc);
 static gboolean gst_pylonsrc_stop (GstBaseSrc * bsrc);
 static GstCaps *gst_pylonsrc_get_caps (GstBaseSrc * bsrc, GstCaps * filter);
 static gboolean gst_pylonsrc_set_caps (GstBaseSrc * bsrc, GstCaps * caps);
+static gboolean gst_pylonsrc_event (GstBaseSrc * bsrc, GstEvent * event);
 
 static GstFlowReturn gst_pylonsrc_create (GstPushSrc * bsrc, GstBuffer ** buf);
 
@@ -406,6 +407,7 @@ gst_pylonsrc_class_init (GstPylonSrcClass * klass)
   base_src_class->stop = GST_DEBUG_FUNCPTR (gst_pylonsrc_stop);
   base_src_class->get_caps = GST_DEBUG_FUNCPTR (gst_pylonsrc_get_caps);
   base_src_class->set_caps = GST_DEBUG_FUNCPTR (gst_pylonsrc_set_caps);
+  base_src_class->event = GST_DEBUG_FUNCPTR (gst_pylonsrc_event);
 
   push_src_class->create = GST_DEBUG_FUNCPTR (gst_pylonsrc_create);
 
@@ -2318,6 +2320,37 @@ error:
   return FALSE;
 }
 
+/* Captures at the rate a downstream select element decimates to, instead of
+ * capturing frames only for them to be dropped. Offset and skip decimation
+ * has no rate to apply, so only a framerate is handled. */
+static gboolean
+gst_pylonsrc_event (GstBaseSrc * bsrc, GstEvent * event)
+{
+  GstPylonSrc *src = GST_PYLONSRC (bsrc);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CUSTOM_UPSTREAM &&
+      gst_event_has_name (event, "GstSelectDecimation")) {
+    const GstStructure *s = gst_event_get_structure (event);
+    gint fps_n, fps_d;
+
+    if (gst_structure_get_fraction (s, "framerate", &fps_n, &fps_d) &&
+        fps_n > 0 && fps_d > 0) {
+      gdouble fps = MIN ((gdouble) fps_n / fps_d, 1024.0);
+
+      GST_DEBUG_OBJECT (src, "Decimation hint, capturing at %0.2lf fps", fps);
+      g_object_set (src, "fps", fps, NULL);
+
+      /* otherwise applied with the other properties when starting */
+      if (src->deviceConnected && !gst_pylonsrc_set_framerate (src))
+        return FALSE;
+
+      return TRUE;
+    }
+  }
+
+  return GST_BASE_SRC_CLASS (gst_pylonsrc_parent_class)->event (bsrc, event);
+}
+
 static gboolean
 gst_pylonsrc_set_lightsource (GstPylonSrc * src)
 {